@@ -6,22 +6,18 @@ CONFIG += c++17
 
 TARGET = NetSecOps
 
+include(core.pri)
+
 SOURCES += \
     main.cpp \
-    src/ActivityLogger.cpp \
-    src/NetworkScanner.cpp \
     src/ScanResultsModel.cpp \
-    src/NetworkMapper.cpp \
-    src/RemoteExecutor.cpp \
-    src/CredentialManager.cpp
+    src/TopologyView.cpp \
+    src/LayoutEngine.cpp
 
 HEADERS += \
-    src/ActivityLogger.h \
-    src/NetworkScanner.h \
     src/ScanResultsModel.h \
-    src/NetworkMapper.h \
-    src/RemoteExecutor.h \
-    src/CredentialManager.h
+    src/TopologyView.h \
+    src/LayoutEngine.h
 
 # Enable MOC for Qt objects
 CONFIG += moc
@@ -0,0 +1,115 @@
+#include "TargetFarm.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QRandomGenerator>
+#include <QFile>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+const quint32 kFirstAddress = (127u << 24) | (1u << 16) | 1u; // 127.1.0.1
+const int kBacklog = 1024;                                    // scanners connect in bursts
+
+QByteArray bannerFor(int port)
+{
+    switch (port) {
+    case 21: return "220 bench FTP ready\r\n";
+    case 22: return "SSH-2.0-OpenSSH_9.6p1 bench\r\n";
+    case 25: return "220 bench ESMTP\r\n";
+    default: return QByteArray();
+    }
+}
+}
+
+TargetFarm::TargetFarm(QObject *parent)
+    : QObject(parent)
+    , m_context(new QObject)
+    , m_latencyMs(0)
+{
+    m_thread.setObjectName("TargetFarm");
+    m_context->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    m_thread.start();
+}
+
+TargetFarm::~TargetFarm()
+{
+    // The listeners belong to the farm thread and are deleted with m_context
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool TargetFarm::start(const Options &options)
+{
+    QMetaObject::invokeMethod(m_context, [this, options]() { listenAll(options); }, Qt::BlockingQueuedConnection);
+    return !m_servers.isEmpty();
+}
+
+void TargetFarm::listenAll(const Options &options)
+{
+    m_latencyMs = options.latencyMs;
+    m_hosts.clear();
+    m_live.clear();
+    m_ports = options.ports;
+
+    QRandomGenerator random(options.seed);
+    for (int i = 0; i < options.hosts; ++i) {
+        const QHostAddress address(kFirstAddress + quint32(i));
+        m_hosts << address.toString();
+        if (random.generateDouble() >= options.liveRatio)
+            continue;
+        m_live << address.toString();
+
+        for (int p = 0; p < m_ports.size();) {
+            const int port = m_ports.at(p);
+            auto *server = new QTcpServer(m_context);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+            server->setListenBacklogSize(kBacklog);
+#endif
+            if (!server->listen(address, quint16(port))) {
+                qWarning() << "Farm cannot listen on" << address.toString() << port << ":" << server->errorString();
+                delete server;
+                m_ports.removeAt(p); // the same failure would repeat on every host
+                continue;
+            }
+            connect(server, &QTcpServer::newConnection, m_context, [this, server, port]() { accept(server, port); });
+            m_servers << server;
+            ++p;
+        }
+    }
+}
+
+void TargetFarm::accept(QTcpServer *server, int port)
+{
+    const QByteArray banner = bannerFor(port);
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        auto reply = [socket, banner]() {
+            if (!banner.isEmpty())
+                socket->write(banner);
+            socket->disconnectFromHost();
+        };
+        if (m_latencyMs > 0)
+            QTimer::singleShot(m_latencyMs, socket, reply);
+        else
+            reply();
+    }
+}
+
+QString TargetFarm::range() const
+{
+    if (m_hosts.isEmpty())
+        return QString();
+    return m_hosts.first() + '-' + m_hosts.last();
+}
+
+bool TargetFarm::writeHostsFile(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    for (const QString &host : m_live)
+        file.write(host.toLatin1() + '\n');
+    return true;
+}
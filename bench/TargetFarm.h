@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QThread>
+
+class QTcpServer;
+
+// Simulated targets for the benchmark: consecutive loopback addresses from
+// 127.1.0.1, a seeded fraction of them live and listening on every
+// configured port, the rest refusing connections. Live hosts send a
+// service banner after the configured latency. The listeners run on their
+// own thread so a busy engine never lets the accept queues fill up.
+class TargetFarm : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        int hosts = 512;
+        QList<int> ports;
+        double liveRatio = 0.5;
+        int latencyMs = 0;
+        quint32 seed = 1;
+    };
+
+    explicit TargetFarm(QObject *parent = nullptr);
+    ~TargetFarm();
+
+    // Blocks until every listener is up; ports that cannot be bound (low
+    // ports outside a network namespace) are dropped with a warning
+    bool start(const Options &options);
+
+    QString range() const;              // "first-last", as the scanner takes it
+    QStringList hosts() const { return m_hosts; }
+    QStringList liveHosts() const { return m_live; }
+    QList<int> ports() const { return m_ports; }
+    int listenerCount() const { return m_servers.size(); }
+
+    // One live address per line, for the fake tools
+    bool writeHostsFile(const QString &path) const;
+
+private:
+    void listenAll(const Options &options);
+    void accept(QTcpServer *server, int port);
+
+    QThread m_thread;
+    QObject *m_context;                 // lives on m_thread; owns the listeners
+    QList<QTcpServer *> m_servers;
+    QStringList m_hosts;
+    QStringList m_live;
+    QList<int> m_ports;
+    int m_latencyMs;
+};
@@ -0,0 +1,23 @@
+# Shared by the fake tools. The benchmark exports:
+#   NETSECOPS_BENCH_HOSTS       file listing the farm's live addresses, one per line
+#   NETSECOPS_BENCH_LATENCY_MS  simulated round trip per invocation
+
+bench_delay() {
+    ms=${NETSECOPS_BENCH_LATENCY_MS:-0}
+    [ "$ms" -gt 0 ] 2>/dev/null && sleep "$(awk "BEGIN { printf \"%.3f\", $ms / 1000 }")"
+    return 0
+}
+
+bench_is_up() {
+    [ -n "$NETSECOPS_BENCH_HOSTS" ] && grep -qxF "$1" "$NETSECOPS_BENCH_HOSTS"
+}
+
+# Locally administered MAC derived from the address, stable across runs
+bench_mac() {
+    echo "$1" | awk -F. '{ printf "02:00:%02x:%02x:%02x:%02x\n", $1, $2, $3, $4 }'
+}
+
+bench_last_arg() {
+    for arg; do :; done
+    echo "$arg"
+}
@@ -0,0 +1,519 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include "NetworkScanner.h"
+#include "NetworkMapper.h"
+#include "PerformanceMonitor.h"
+#include "ProbeScheduler.h"
+#include "RemoteExecutor.h"
+#include "TargetFarm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Benchmarks the engines against a farm of simulated targets on loopback,
+// with fake ping, arp, nmap and ssh on PATH for the subprocess paths. One
+// JSON object per engine on stdout, so runs can be diffed or compared with
+// --compare.
+
+namespace {
+QFile *out = nullptr;
+
+void emitEvent(const QString &event, QJsonObject fields = QJsonObject())
+{
+    fields.insert("event", event);
+    out->write(QJsonDocument(fields).toJson(QJsonDocument::Compact));
+    out->write("\n");
+    out->flush();
+}
+
+struct Usage {
+    qint64 cpuMs = 0;       // this process, user + system
+    qint64 childCpuMs = 0;  // reaped subprocesses
+    qint64 rssKb = 0;
+};
+
+Usage usage()
+{
+    Usage result;
+#ifdef Q_OS_UNIX
+    auto toMs = [](const rusage &r) {
+        return qint64(r.ru_utime.tv_sec + r.ru_stime.tv_sec) * 1000 + (r.ru_utime.tv_usec + r.ru_stime.tv_usec) / 1000;
+    };
+    rusage self = {};
+    rusage children = {};
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    result.cpuMs = toMs(self);
+    result.childCpuMs = toMs(children);
+#endif
+#ifdef Q_OS_LINUX
+    // Current resident set; ru_maxrss only ever grows across engines
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        result.rssKb = fields.value(1).toLongLong() * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+#endif
+    return result;
+}
+
+// Nearest-rank percentile, 0 when there are no samples
+double percentile(QList<double> samples, double p)
+{
+    if (samples.isEmpty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    const int rank = qBound(0, int(std::ceil(p / 100.0 * samples.size())) - 1, int(samples.size()) - 1);
+    return samples.at(rank);
+}
+
+double round2(double value)
+{
+    return qRound64(value * 100) / 100.0;
+}
+
+// Times one engine run and reports rate, latency percentiles and resources.
+// run returns the number of items processed and fills latencies in ms.
+QJsonObject measure(const QString &engine, const QString &unit,
+                    const std::function<int(QList<double> *, QJsonObject *)> &run)
+{
+    const Usage before = usage();
+    const Metrics::Snapshot metricsBefore = Metrics::snapshot();
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    QList<double> latencies;
+    QJsonObject result;
+    const int items = run(&latencies, &result);
+    const qint64 elapsedMs = qMax<qint64>(1, elapsed.elapsed());
+
+    // Work left on the shared pool would be billed to the next engine
+    QThreadPool::globalInstance()->waitForDone();
+    const Usage after = usage();
+    Metrics::Snapshot metrics = Metrics::snapshot();
+    for (int c = 0; c < Metrics::CounterCount; ++c)
+        metrics.counters[c] -= qMin(metricsBefore.counters[c], metrics.counters[c]);
+    for (int h = 0; h < Metrics::HistogramCount; ++h)
+        metrics.histograms[h] = metrics.histograms[h].since(metricsBefore.histograms[h]);
+
+    result.insert("engine", engine);
+    result.insert("items", items);
+    result.insert("elapsedMs", elapsedMs);
+    result.insert(unit + "PerSec", round2(items * 1000.0 / elapsedMs));
+    result.insert("p50Ms", round2(percentile(latencies, 50)));
+    result.insert("p99Ms", round2(percentile(latencies, 99)));
+    result.insert("cpuMs", after.cpuMs - before.cpuMs);
+    result.insert("childCpuMs", after.childCpuMs - before.childCpuMs);
+    result.insert("rssKb", after.rssKb);
+    result.insert("rssDeltaKb", after.rssKb - before.rssKb);
+    // Where the time went inside the engine during this run
+    result.insert("metrics", PerformanceMonitor::toJson(metrics));
+    return result;
+}
+
+// Scheduler alone, no sockets: the cost of ordering and rate accounting
+int benchSchedule(int hosts, int ports, QList<double> *latencies, QJsonObject *)
+{
+    QStringList targets;
+    for (int i = 0; i < hosts; ++i)
+        targets << QString("10.%1.%2.%3").arg(i >> 16 & 0xff).arg(i >> 8 & 0xff).arg(i & 0xff);
+    QList<int> portList;
+    for (int i = 0; i < ports; ++i)
+        portList << 1 + i;
+
+    ProbeScheduler scheduler(targets, portList, 0, 0);
+    ProbeScheduler::Probe probe;
+    int waitMs = 0;
+    int handed = 0;
+    QElapsedTimer batch;
+    batch.start();
+    while (scheduler.next(&probe, &waitMs)) {
+        scheduler.complete(probe, false);
+        // Per-probe timing would be all clock overhead; sample per 1000
+        if (++handed % 1000 == 0) {
+            latencies->append(batch.nsecsElapsed() / 1e6 / 1000);
+            batch.restart();
+        }
+    }
+    return handed;
+}
+
+// Blocking connects from one thread: the floor under every TCP probe
+int benchProbe(const TargetFarm &farm, int count, QList<double> *latencies, QJsonObject *result)
+{
+    const QStringList hosts = farm.hosts();
+    const QList<int> ports = farm.ports();
+    int open = 0;
+    for (int i = 0; i < count; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        if (HostScanner::isPortOpen(hosts.at(i % hosts.size()), ports.at(i / hosts.size() % ports.size())))
+            ++open;
+        latencies->append(timer.nsecsElapsed() / 1e6);
+    }
+    result->insert("open", open);
+    return count;
+}
+
+int benchScan(const TargetFarm &farm, const QCommandLineParser &parser, QList<double> *latencies, QJsonObject *result)
+{
+    NetworkScanner scanner;
+    scanner.setCheckpointsEnabled(false);
+    scanner.setHostRateLimit(parser.value("host-rate").toInt());
+    scanner.setSubnetRateLimit(parser.value("subnet-rate").toInt());
+
+    QStringList ports;
+    for (int port : farm.ports())
+        ports << QString::number(port);
+
+    QEventLoop loop;
+    QElapsedTimer elapsed;
+    int found = 0;
+    // Time to result: how long after the start each live host is reported
+    QObject::connect(&scanner, &NetworkScanner::hostDiscovered, &loop, [&]() {
+        ++found;
+        latencies->append(elapsed.nsecsElapsed() / 1e6);
+    });
+    QObject::connect(&scanner, &NetworkScanner::scanCompleted, &loop, &QEventLoop::quit);
+
+    elapsed.start();
+    scanner.startScan(farm.range(), ports.join(','), parser.value("threads").toInt());
+    loop.exec();
+
+    const double seconds = qMax<qint64>(1, elapsed.elapsed()) / 1000.0;
+    result->insert("hostsFound", found);
+    result->insert("hostsExpected", int(farm.liveHosts().size()));
+    result->insert("probesPerSec", round2(farm.hosts().size() * ports.size() / seconds));
+    return farm.hosts().size();
+}
+
+int benchMap(NetworkMapper &mapper, const TargetFarm &farm, int count, QList<double> *latencies, QJsonObject *result)
+{
+    const QStringList targets = farm.hosts().mid(0, count);
+
+    QEventLoop loop;
+    QElapsedTimer elapsed;
+    int profiled = 0;
+    QObject::connect(&mapper, &NetworkMapper::hostProfiled, &loop, [&]() {
+        ++profiled;
+        latencies->append(elapsed.nsecsElapsed() / 1e6);
+    });
+    QObject::connect(&mapper, &NetworkMapper::mappingCompleted, &loop, &QEventLoop::quit);
+
+    elapsed.start();
+    mapper.startMapping(targets);
+    loop.exec();
+
+    result->insert("profiled", profiled);
+    return targets.size();
+}
+
+// Every export format, repeatedly, over the profiles of the map run
+int benchExport(NetworkMapper &mapper, const QString &directory, int rounds, QList<double> *latencies,
+                QJsonObject *result)
+{
+    const QStringList formats = {"json", "csv", "xml"};
+    QJsonObject bytes;
+    for (int round = 0; round < rounds; ++round) {
+        for (const QString &format : formats) {
+            const QString path = directory + "/map." + format;
+            QElapsedTimer timer;
+            timer.start();
+            mapper.exportMap(format, path);
+            latencies->append(timer.nsecsElapsed() / 1e6);
+            bytes.insert(format, QFileInfo(path).size());
+        }
+    }
+    result->insert("profiles", int(mapper.profiles().size()));
+    result->insert("bytes", bytes);
+    return rounds * formats.size();
+}
+
+int benchExec(const TargetFarm &farm, int count, QList<double> *latencies, QJsonObject *result)
+{
+    RemoteExecutor executor;
+    const QStringList targets = farm.liveHosts().mid(0, count);
+    if (targets.isEmpty())
+        return 0;
+
+    QEventLoop loop;
+    QHash<int, QElapsedTimer> started;
+    int finished = 0;
+    int failed = 0;
+    auto done = [&](int jobId, bool ok) {
+        if (!started.contains(jobId))
+            return;
+        latencies->append(started.take(jobId).nsecsElapsed() / 1e6);
+        if (!ok)
+            ++failed;
+        if (++finished == targets.size())
+            loop.quit();
+    };
+
+    QObject::connect(&executor, &RemoteExecutor::jobStarted, &loop, [&](int jobId) {
+        started[jobId].start();
+    });
+    // No vault here; answer the prompt the way the GUI dialog would
+    QObject::connect(&executor, &RemoteExecutor::credentialRequired, &loop,
+                     [&](const QString &, const QString &, int jobId) {
+        executor.executeWithCredential(jobId, "bench", "bench");
+    }, Qt::QueuedConnection);
+    QObject::connect(&executor, &RemoteExecutor::jobCompleted, &loop, [&](int jobId) { done(jobId, true); });
+    QObject::connect(&executor, &RemoteExecutor::jobFailed, &loop, [&](int jobId) { done(jobId, false); });
+
+    executor.executeCommand(targets.join(','), "uptime", "SSH");
+    loop.exec();
+
+    result->insert("failed", failed);
+    return targets.size();
+}
+
+// Metrics ending in PerSec should not drop, latencies should not rise
+QJsonArray compare(const QList<QJsonObject> &results, const QString &baselinePath, double threshold, bool *regressed)
+{
+    QHash<QString, QJsonObject> baseline;
+    QFile file(baselinePath);
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!file.atEnd()) {
+            const QJsonObject line = QJsonDocument::fromJson(file.readLine()).object();
+            if (line.value("event").toString() == "bench")
+                baseline.insert(line.value("engine").toString(), line);
+        }
+    } else {
+        qWarning() << "Cannot read baseline" << baselinePath;
+    }
+
+    QJsonArray changes;
+    for (const QJsonObject &result : results) {
+        const QJsonObject before = baseline.value(result.value("engine").toString());
+        for (auto it = result.begin(); it != result.end(); ++it) {
+            const bool rate = it.key().endsWith("PerSec");
+            if (!rate && it.key() != "p50Ms" && it.key() != "p99Ms")
+                continue;
+            const double old = before.value(it.key()).toDouble();
+            if (old <= 0)
+                continue;
+            const double change = (it.value().toDouble() - old) / old * 100.0;
+            const bool worse = rate ? change < -threshold : change > threshold;
+            *regressed = *regressed || worse;
+            changes.append(QJsonObject{{"engine", result.value("engine")}, {"metric", it.key()},
+                                       {"baseline", old}, {"current", it.value()},
+                                       {"changePercent", round2(change)}, {"regression", worse}});
+        }
+    }
+    return changes;
+}
+
+#ifdef Q_OS_LINUX
+// Re-runs the benchmark inside a private network namespace, where netem
+// on lo can add real packet delay and loss without touching the host
+bool enterNetworkNamespace(char *argv[])
+{
+    if (qEnvironmentVariableIsSet("NETSECOPS_BENCH_NETNS"))
+        return true;
+    qputenv("NETSECOPS_BENCH_NETNS", "1");
+
+    QList<QByteArray> args = {"unshare", "--user", "--map-root-user", "--net"};
+    for (char **arg = argv; *arg; ++arg)
+        args << *arg;
+    QVector<char *> raw;
+    for (QByteArray &arg : args)
+        raw << arg.data();
+    raw << nullptr;
+    execvp(raw.first(), raw.data());
+    qWarning() << "Cannot start unshare; run without --netns or install util-linux";
+    return false;
+}
+
+void shapeLoopback(int latencyMs, int jitterMs, double lossPercent)
+{
+    QProcess::execute("ip", {"link", "set", "lo", "up"});
+    if (latencyMs <= 0 && jitterMs <= 0 && lossPercent <= 0)
+        return;
+    // Every loopback packet passes netem once, so half the delay each way
+    const QStringList args = {"qdisc", "add", "dev", "lo", "root", "netem",
+                              "delay", QString("%1ms").arg(latencyMs / 2.0), QString("%1ms").arg(jitterMs / 2.0),
+                              "loss", QString("%1%").arg(lossPercent)};
+    if (QProcess::execute("tc", args) != 0)
+        qWarning() << "tc netem failed; latency and loss apply to the fake tools only";
+}
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("NetSecOps");
+    app.setApplicationVersion("1.0");
+    app.setOrganizationName("NetSecOps");
+
+    qRegisterMetaType<QList<int>>("QList<int>");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Benchmarks the NetSecOps engines against simulated targets on loopback.\n"
+        "Writes one JSON object per engine to stdout.\n\n"
+        "Engines: schedule, probe, scan, map, export, exec");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"engines", "Engines to run, comma separated.", "list", "schedule,probe,scan,map,export,exec"},
+        {"hosts", "Simulated hosts.", "count", "512"},
+        {"ports", "Ports live hosts listen on.", "ports", "22,80,443,3306,8080"},
+        {"live", "Fraction of hosts that are up.", "ratio", "0.5"},
+        {"seed", "Seed for choosing the live hosts.", "seed", "1"},
+        {"latency", "Round trip added to the fake tools and banners; with --netns, to every packet.", "ms", "0"},
+        {"jitter", "Latency variation, --netns only.", "ms", "0"},
+        {"loss", "Packet loss, --netns only.", "percent", "0"},
+        {"netns", "Run in a private network namespace with netem on lo (Linux)."},
+        {{"t", "threads"}, "Scanner probe workers.", "count", "50"},
+        {"host-rate", "Scanner probes per second per host, 0 for no limit.", "rate", "0"},
+        {"subnet-rate", "Scanner probes per second per subnet, 0 for no limit.", "rate", "0"},
+        {"probes", "Probes for the probe engine.", "count", "2000"},
+        {"map-hosts", "Hosts profiled by the map engine.", "count", "64"},
+        {"export-rounds", "Passes over every export format.", "count", "20"},
+        {"exec-targets", "Live hosts given a command by the exec engine.", "count", "64"},
+        {"fakebin", "Directory with the fake ping, arp, nmap and ssh.", "dir", NETSECOPS_BENCH_FAKEBIN},
+        {"compare", "Baseline output to compare against.", "file"},
+        {"threshold", "Change in percent counted as a regression.", "percent", "10"},
+        {{"v", "verbose"}, "Engine diagnostics on stderr."},
+    });
+    parser.process(app);
+
+    if (!parser.isSet("verbose"))
+        QLoggingCategory::setFilterRules("*.debug=false");
+
+    QFile stdoutFile;
+    stdoutFile.open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered);
+    out = &stdoutFile;
+
+    const int latencyMs = parser.value("latency").toInt();
+    const double lossPercent = parser.value("loss").toDouble();
+    const bool netns = parser.isSet("netns");
+#ifdef Q_OS_LINUX
+    if (netns) {
+        if (!enterNetworkNamespace(argv))
+            return 1;
+        shapeLoopback(latencyMs, parser.value("jitter").toInt(), lossPercent);
+    }
+#else
+    if (netns)
+        qWarning() << "--netns needs Linux; latency applies to the fake tools only";
+#endif
+
+#ifdef Q_OS_UNIX
+    // Every live host holds a descriptor per port, and so does every probe
+    rlimit files = {};
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+#endif
+
+    TargetFarm::Options options;
+    options.hosts = qMax(1, parser.value("hosts").toInt());
+    options.liveRatio = parser.value("live").toDouble();
+    options.latencyMs = netns ? 0 : latencyMs; // netem already delays every packet
+    options.seed = parser.value("seed").toUInt();
+    for (const QString &port : parser.value("ports").split(',', Qt::SkipEmptyParts))
+        options.ports << port.toInt();
+
+    TargetFarm farm;
+    if (!farm.start(options) || farm.ports().isEmpty()) {
+        emitEvent("error", {{"message", "No farm listener could be started"}});
+        return 1;
+    }
+
+    QTemporaryDir scratch;
+    const QString hostsFile = scratch.filePath("hosts");
+    farm.writeHostsFile(hostsFile);
+    qputenv("NETSECOPS_BENCH_HOSTS", hostsFile.toLocal8Bit());
+    qputenv("NETSECOPS_BENCH_LATENCY_MS", QByteArray::number(latencyMs));
+    qputenv("PATH", QFile::encodeName(parser.value("fakebin") + QDir::listSeparator()) + qgetenv("PATH"));
+
+    QJsonArray ports;
+    for (int port : farm.ports())
+        ports.append(port);
+    emitEvent("bench_config", {{"hosts", int(farm.hosts().size())}, {"live", int(farm.liveHosts().size())},
+                               {"ports", ports}, {"listeners", farm.listenerCount()},
+                               {"latencyMs", latencyMs}, {"lossPercent", lossPercent}, {"netns", netns},
+                               {"threads", parser.value("threads").toInt()}, {"cpus", QThread::idealThreadCount()},
+                               {"qt", QString(qVersion())},
+                               {"startedAt", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)}});
+
+    const QStringList engines = parser.value("engines").split(',', Qt::SkipEmptyParts);
+    QList<QJsonObject> results;
+    auto report = [&](const QJsonObject &result) {
+        results << result;
+        emitEvent("bench", result);
+    };
+
+    if (engines.contains("schedule")) {
+        report(measure("schedule", "probes", [&](QList<double> *latencies, QJsonObject *result) {
+            return benchSchedule(qMax(options.hosts, 65536), 16, latencies, result);
+        }));
+    }
+    if (engines.contains("probe")) {
+        report(measure("probe", "probes", [&](QList<double> *latencies, QJsonObject *result) {
+            return benchProbe(farm, parser.value("probes").toInt(), latencies, result);
+        }));
+    }
+    if (engines.contains("scan")) {
+        report(measure("scan", "hosts", [&](QList<double> *latencies, QJsonObject *result) {
+            return benchScan(farm, parser, latencies, result);
+        }));
+    }
+
+    // export reuses the profiles of the map run, so one mapper serves both
+    NetworkMapper mapper;
+    if (engines.contains("map") || engines.contains("export")) {
+        auto map = [&](QList<double> *latencies, QJsonObject *result) {
+            return benchMap(mapper, farm, parser.value("map-hosts").toInt(), latencies, result);
+        };
+        if (engines.contains("map")) {
+            report(measure("map", "hosts", map));
+        } else {
+            QList<double> ignored;
+            QJsonObject unused;
+            map(&ignored, &unused);
+        }
+    }
+    if (engines.contains("export")) {
+        report(measure("export", "exports", [&](QList<double> *latencies, QJsonObject *result) {
+            return benchExport(mapper, scratch.path(), parser.value("export-rounds").toInt(), latencies, result);
+        }));
+    }
+    if (engines.contains("exec")) {
+        report(measure("exec", "jobs", [&](QList<double> *latencies, QJsonObject *result) {
+            return benchExec(farm, parser.value("exec-targets").toInt(), latencies, result);
+        }));
+    }
+
+    if (!parser.isSet("compare"))
+        return 0;
+
+    bool regressed = false;
+    const QJsonArray changes = compare(results, parser.value("compare"), parser.value("threshold").toDouble(), &regressed);
+    for (const QJsonValue &change : changes)
+        emitEvent("bench_compare", change.toObject());
+    return regressed ? 3 : 0;
+}
@@ -0,0 +1,17 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = netsecops-bench
+
+include(../core.pri)
+
+DEFINES += NETSECOPS_BENCH_FAKEBIN=\\\"$$PWD/fakebin\\\"
+
+SOURCES += \
+    main.cpp \
+    TargetFarm.cpp
+
+HEADERS += \
+    TargetFarm.h
@@ -0,0 +1,454 @@
+#include <QCoreApplication>
+#include <QThreadPool>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QHostInfo>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTimer>
+#include "NetworkScanner.h"
+#include "NetworkMapper.h"
+#include "NetworkMonitor.h"
+#include "ActivityLogger.h"
+#include "ControlServer.h"
+#include "CredentialManager.h"
+#include "RemoteExecutor.h"
+#include "ScanCheckpoint.h"
+#include "ScanCoordinator.h"
+#include "ScanWorker.h"
+#include "ScanProtocol.h"
+#include "Trace.h"
+
+#include <functional>
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Headless front end for cron and scripts: the same engines as the GUI,
+// without a display, QML engine or GPU context. Every result is one JSON
+// object per line on stdout; diagnostics go to stderr.
+
+namespace {
+QFile *out = nullptr;
+
+void emitEvent(const QString &event, QJsonObject fields = QJsonObject())
+{
+    fields.insert("event", event);
+    out->write(QJsonDocument(fields).toJson(QJsonDocument::Compact));
+    out->write("\n");
+    out->flush();
+}
+
+QJsonArray toJson(const QList<int> &ports)
+{
+    QJsonArray array;
+    for (int port : ports)
+        array.append(port);
+    return array;
+}
+
+#ifdef Q_OS_UNIX
+int signalPipe[2];
+
+void onSignal(int)
+{
+    // Only async-signal-safe work here; the event loop does the rest
+    const char byte = 1;
+    (void)::write(signalPipe[0], &byte, 1);
+}
+
+// Runs stop on SIGINT/SIGTERM so an interrupted sweep leaves a checkpoint
+void watchSignals(QObject *context, const std::function<void()> &stop)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalPipe) != 0)
+        return;
+
+    auto *notifier = new QSocketNotifier(signalPipe[1], QSocketNotifier::Read, context);
+    QObject::connect(notifier, &QSocketNotifier::activated, context, [notifier, stop]() {
+        char byte;
+        (void)::read(signalPipe[1], &byte, 1);
+        notifier->setEnabled(false);
+        stop();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+#else
+void watchSignals(QObject *, const std::function<void()> &)
+{
+}
+#endif
+
+int runScan(QCoreApplication &app, const QCommandLineParser &parser, const QString &resumeId)
+{
+    NetworkScanner scanner;
+    ActivityLogger logger;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    bool interrupted = false;
+
+    if (parser.isSet("host-rate"))
+        scanner.setHostRateLimit(parser.value("host-rate").toInt());
+    if (parser.isSet("subnet-rate"))
+        scanner.setSubnetRateLimit(parser.value("subnet-rate").toInt());
+
+    QObject::connect(&scanner, &NetworkScanner::scanStarted, &app, [](const QString &network, const QString &ports) {
+        emitEvent("scan_started", {{"network", network}, {"ports", ports}});
+    });
+    QObject::connect(&scanner, &NetworkScanner::scanIdChanged, &app, [&scanner]() {
+        emitEvent("scan_id", {{"id", scanner.scanId()}});
+    });
+    QObject::connect(&scanner, &NetworkScanner::hostDiscovered, &app,
+                     [](const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports,
+                        const QList<int> &udpPorts) {
+        emitEvent("host", {{"ip", ip}, {"hostname", hostname}, {"mac", mac},
+                           {"tcp", toJson(ports)}, {"udp", toJson(udpPorts)}});
+    });
+    QObject::connect(&scanner, &NetworkScanner::scanFailed, &app, [](const QString &error) {
+        emitEvent("error", {{"message", error}});
+    });
+
+    if (parser.isSet("progress")) {
+        int lastProgress = -1;
+        QObject::connect(&scanner, &NetworkScanner::progressChanged, &app, [&scanner, lastProgress]() mutable {
+            if (scanner.progress() == lastProgress)
+                return;
+            lastProgress = scanner.progress();
+            emitEvent("progress", {{"percent", lastProgress}});
+        });
+    }
+
+    QObject::connect(&scanner, &NetworkScanner::scanCompleted, &app, [&]() {
+        emitEvent(interrupted ? "scan_interrupted" : "scan_completed",
+                  {{"id", scanner.scanId()}, {"hosts", scanner.hostsFound()}, {"ports", scanner.portsFound()},
+                   {"elapsedMs", elapsed.elapsed()}});
+        logger.logActivity("discovery", "Headless Scan", scanner.scanId(), interrupted ? "interrupted" : "success");
+        app.exit(interrupted ? 130 : 0);
+    });
+
+    watchSignals(&app, [&]() {
+        interrupted = true;
+        scanner.stopScan();
+    });
+
+    // Start once the loop runs so early signals reach the handlers above
+    QTimer::singleShot(0, &app, [&]() {
+        if (!resumeId.isEmpty()) {
+            if (!scanner.resumeScan(resumeId))
+                app.exit(1);
+            return;
+        }
+        scanner.startScan(parser.positionalArguments().value(1), parser.value("ports"),
+                          parser.value("threads").toInt());
+    });
+
+    // Workers of a stopped scan still hold the scanner until their probe returns
+    const int code = app.exec();
+    QThreadPool::globalInstance()->waitForDone();
+    return code;
+}
+
+int runMap(QCoreApplication &app, const QCommandLineParser &parser)
+{
+    NetworkMapper mapper;
+
+    QObject::connect(&mapper, &NetworkMapper::hostProfiled, &app,
+                     [](const QString &ip, const QString &os, const QString &services, const QString &vendor) {
+        emitEvent("host_profile", {{"ip", ip}, {"os", os}, {"services", services}, {"vendor", vendor}});
+    });
+    QObject::connect(&mapper, &NetworkMapper::topologyCompleted, &app, [&]() {
+        const TopologyGraph *graph = mapper.topology();
+        emitEvent("map_completed", {{"hosts", mapper.hostsProfiled()}, {"nodes", graph->nodeCount()},
+                                    {"links", graph->edgeCount()}});
+        if (parser.isSet("export")) {
+            mapper.exportMap(parser.value("format"), parser.value("export"));
+            emitEvent("exported", {{"path", parser.value("export")}, {"format", parser.value("format")}});
+        }
+        app.exit(0);
+    });
+
+    watchSignals(&app, [&]() {
+        mapper.stopMapping();
+        app.exit(130);
+    });
+
+    QTimer::singleShot(0, &app, [&]() {
+        const QString subnet = parser.positionalArguments().value(1);
+        mapper.startFullMapping(subnet);
+        // Wide IPv6 blocks start mapping only once their harvest is back
+        if (!mapper.isMapping() && !IpSubnet::parse(subnet).network.isIPv6()) {
+            emitEvent("error", {{"message", "No hosts to map in " + subnet}});
+            app.exit(1);
+        }
+    });
+
+    const int code = app.exec();
+    QThreadPool::globalInstance()->waitForDone();
+    return code;
+}
+
+// Same events as runScan, with the sweep sharded across worker processes
+int runCoordinator(QCoreApplication &app, const QCommandLineParser &parser)
+{
+    ScanCoordinator coordinator;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    bool interrupted = false;
+    QList<QProcess *> children;
+
+    coordinator.setToken(parser.value("token"));
+    coordinator.setRateLimits(parser.isSet("host-rate") ? parser.value("host-rate").toInt() : 50,
+                              parser.isSet("subnet-rate") ? parser.value("subnet-rate").toInt() : 500);
+    const QStringList addresses = parser.values("listen");
+    for (const QString &address : addresses) {
+        if (!coordinator.listen(address)) {
+            emitEvent("error", {{"message", "Cannot listen on " + address}});
+            return 1;
+        }
+    }
+
+    QObject::connect(&coordinator, &ScanCoordinator::scanStarted, &app, [](const QString &network, const QString &ports) {
+        emitEvent("scan_started", {{"network", network}, {"ports", ports}});
+    });
+    QObject::connect(&coordinator, &ScanCoordinator::hostDiscovered, &app,
+                     [](const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports,
+                        const QList<int> &udpPorts) {
+        emitEvent("host", {{"ip", ip}, {"hostname", hostname}, {"mac", mac},
+                           {"tcp", toJson(ports)}, {"udp", toJson(udpPorts)}});
+    });
+    QObject::connect(&coordinator, &ScanCoordinator::workerJoined, &app, [](const QString &name) {
+        emitEvent("worker_joined", {{"worker", name}});
+    });
+    QObject::connect(&coordinator, &ScanCoordinator::workerLost, &app, [](const QString &name) {
+        emitEvent("worker_lost", {{"worker", name}});
+    });
+    QObject::connect(&coordinator, &ScanCoordinator::shardRequeued, &app, [](int shard, const QString &worker) {
+        emitEvent("shard_requeued", {{"shard", shard}, {"worker", worker}});
+    });
+    if (parser.isSet("progress")) {
+        QObject::connect(&coordinator, &ScanCoordinator::progressChanged, &app, [&coordinator]() {
+            emitEvent("progress", {{"percent", coordinator.progress()}});
+        });
+    }
+    QObject::connect(&coordinator, &ScanCoordinator::scanCompleted, &app, [&]() {
+        emitEvent(interrupted ? "scan_interrupted" : "scan_completed",
+                  {{"hosts", coordinator.hostsFound()}, {"ports", coordinator.portsFound()},
+                   {"workers", coordinator.workerCount()}, {"elapsedMs", elapsed.elapsed()}});
+        app.exit(interrupted ? 130 : 0);
+    });
+
+    watchSignals(&app, [&]() {
+        interrupted = true;
+        coordinator.stopScan();
+    });
+
+    // Worker processes on this host, for trying the protocol or using every core
+    const int localWorkers = parser.value("local-workers").toInt();
+    for (int i = 0; i < localWorkers && !addresses.isEmpty(); ++i) {
+        auto *child = new QProcess(&app);
+        child->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        child->setStandardOutputFile(QProcess::nullDevice()); // hosts arrive through the coordinator
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert("NETSECOPS_TOKEN", parser.value("token"));
+        child->setProcessEnvironment(environment);
+        child->start(QCoreApplication::applicationFilePath(),
+                     {"worker", "--connect", addresses.first(), "--name", QString("local-%1").arg(i + 1)});
+        children << child;
+    }
+
+    QTimer::singleShot(0, &app, [&]() {
+        coordinator.startScan(parser.positionalArguments().value(1), parser.value("ports"),
+                              parser.value("threads").toInt());
+    });
+
+    const int code = app.exec();
+    for (QProcess *child : std::as_const(children)) {
+        child->terminate();
+        child->waitForFinished(3000);
+    }
+    return code;
+}
+
+// Runs shards for a coordinator until stopped
+int runWorker(QCoreApplication &app, const QCommandLineParser &parser)
+{
+    const QString name = parser.isSet("name") ? parser.value("name")
+                                              : QHostInfo::localHostName() + "-" + QString::number(app.applicationPid());
+    ScanWorker worker(name);
+
+    QObject::connect(&worker, &ScanWorker::connected, &app, [&name]() {
+        emitEvent("worker_connected", {{"worker", name}});
+    });
+    QObject::connect(&worker, &ScanWorker::shardStarted, &app, [](int shard, int targets) {
+        emitEvent("shard_started", {{"shard", shard}, {"targets", targets}});
+    });
+    QObject::connect(&worker, &ScanWorker::shardFinished, &app, [](int shard, int hosts) {
+        emitEvent("shard_finished", {{"shard", shard}, {"hosts", hosts}});
+    });
+
+    watchSignals(&app, [&]() { app.exit(0); });
+    worker.connectTo(parser.value("connect"), parser.value("token"));
+
+    const int code = app.exec();
+    QThreadPool::globalInstance()->waitForDone();
+    return code;
+}
+
+// Serves the control API until stopped; clients drive the engines over HTTP
+int runServer(QCoreApplication &app, const QCommandLineParser &parser)
+{
+    NetworkScanner scanner;
+    NetworkMapper mapper;
+    CredentialManager credentials;
+    RemoteExecutor executor;
+    executor.setCredentialManager(&credentials);
+    // Jobs and their output go to the same searchable log as the GUI's
+    ActivityLogger logger;
+    logger.watchExecutor(&executor);
+
+    // Scheduled sweeps and the background monitor, as configured from the GUI
+    NetworkMonitor monitor;
+    monitor.setScanner(&scanner);
+
+    ControlServer server;
+    server.setScanner(&scanner);
+    server.setMapper(&mapper);
+    server.setExecutor(&executor);
+    server.setMonitor(&monitor);
+    server.setToken(parser.value("token"));
+
+    const QStringList addresses = parser.isSet("listen")
+        ? parser.values("listen")
+        : QStringList{QString("127.0.0.1:%1").arg(ControlServer::DefaultPort)};
+    for (const QString &address : addresses) {
+        if (!server.listen(address)) {
+            emitEvent("error", {{"message", "Cannot listen on " + address}});
+            return 1;
+        }
+    }
+    emitEvent("control_listening", {{"addresses", QJsonArray::fromStringList(addresses)},
+                                    {"tokenFile", server.writeTokenFile()}});
+
+    watchSignals(&app, [&]() {
+        scanner.stopScan();
+        mapper.stopMapping();
+        app.exit(0);
+    });
+
+    const int code = app.exec();
+    QThreadPool::globalInstance()->waitForDone();
+    return code;
+}
+
+int listScans()
+{
+    const QList<ScanCheckpoint> checkpoints = ScanCheckpoint::list();
+    for (const ScanCheckpoint &checkpoint : checkpoints) {
+        emitEvent("saved_scan", {{"id", checkpoint.id}, {"network", checkpoint.network},
+                                 {"ports", checkpoint.portRange},
+                                 {"savedAt", checkpoint.savedAt.toString(Qt::ISODate)},
+                                 {"completedProbes", qint64(checkpoint.completedProbes)},
+                                 {"totalProbes", qint64(checkpoint.totalProbes)}});
+    }
+    return 0;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("NetSecOps");
+    app.setApplicationVersion("1.0");
+    app.setOrganizationName("NetSecOps");
+
+    qRegisterMetaType<QList<int>>("QList<int>");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Headless NetSecOps. Results are written to stdout as NDJSON.\n\n"
+        "Commands:\n"
+        "  scan <targets>   Sweep CIDR blocks, ranges, addresses or names\n"
+        "  resume <id>      Continue an interrupted scan from its checkpoint\n"
+        "  scans            List interrupted scans that can be resumed\n"
+        "  map <subnet>     Profile hosts and build the topology\n"
+        "  coordinate <targets>  Shard a sweep across connected workers\n"
+        "  worker           Run shards for a coordinator (--connect)\n"
+        "  serve            Local HTTP/JSON control API for automation");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("command", "scan, resume, scans, map, coordinate, worker or serve");
+    parser.addPositionalArgument("target", "Targets, scan id or subnet, depending on the command");
+    parser.addOptions({
+        {{"p", "ports"}, "Ports to probe, e.g. 22,80,443 or U:53,161.", "ports", "22,80,443"},
+        {{"t", "threads"}, "Concurrent probe workers.", "count", "50"},
+        {"host-rate", "TCP probes per second per host, 0 for no limit.", "rate"},
+        {"subnet-rate", "TCP probes per second per subnet, 0 for no limit.", "rate"},
+        {"progress", "Emit progress events."},
+        {"export", "Write the map to this file when mapping completes.", "file"},
+        {"format", "Map export format: json, csv or xml.", "format", "json"},
+        {"listen", "Coordinator or control API address: host:port, :port or local:<name>. Repeatable.", "address",
+         QString(":%1").arg(ScanProtocol::DefaultPort)},
+        {"connect", "Coordinator a worker connects to.", "address",
+         QString("127.0.0.1:%1").arg(ScanProtocol::DefaultPort)},
+        {"token", "Shared secret for workers, or the control API bearer token. Defaults to $NETSECOPS_TOKEN.", "token",
+         QProcessEnvironment::systemEnvironment().value("NETSECOPS_TOKEN")},
+        {"name", "Worker name reported to the coordinator.", "name"},
+        {"local-workers", "Worker processes the coordinator starts on this host.", "count", "0"},
+        {"trace", "Record a timeline of host phases and jobs to this Chrome trace JSON file.", "file"},
+        {{"v", "verbose"}, "Engine diagnostics on stderr."},
+    });
+    parser.process(app);
+
+    if (!parser.isSet("verbose"))
+        QLoggingCategory::setFilterRules("*.debug=false");
+
+    QFile stdoutFile;
+    stdoutFile.open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered);
+    out = &stdoutFile;
+
+    const QStringList args = parser.positionalArguments();
+    const QString command = args.value(0);
+    const auto run = [&]() {
+        if (command == "scans")
+            return listScans();
+        if (command == "scan" && args.size() >= 2)
+            return runScan(app, parser, QString());
+        if (command == "resume" && args.size() >= 2)
+            return runScan(app, parser, args[1]);
+        if (command == "map" && args.size() >= 2)
+            return runMap(app, parser);
+        if (command == "coordinate" && args.size() >= 2)
+            return runCoordinator(app, parser);
+        if (command == "worker")
+            return runWorker(app, parser);
+        if (command == "serve")
+            return runServer(app, parser);
+        parser.showHelp(2);
+    };
+
+    if (!parser.isSet("trace"))
+        return run();
+
+    Trace::setEnabled(true);
+    const int code = run();
+    Trace::setEnabled(false);
+    const QString traceFile = parser.value("trace");
+    if (!Trace::writeChromeJson(traceFile))
+        return code ? code : 1;
+    emitEvent("trace", {{"file", traceFile}});
+    return code;
+}
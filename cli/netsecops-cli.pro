@@ -0,0 +1,15 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = netsecops-cli
+
+include(../core.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+unix:!android: target.path = /opt/NetSecOps/bin
+!isEmpty(target.path): INSTALLS += target
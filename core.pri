@@ -0,0 +1,68 @@
+# Engines shared by the GUI (NetSecOps.pro) and the headless CLI
+# (cli/netsecops-cli.pro). Nothing here may depend on Qt Gui or Qml.
+QT += core network sql
+
+INCLUDEPATH += $$PWD/src
+
+# DEFINES += NETSECOPS_NO_METRICS  # compile out hot-path metrics
+# DEFINES += NETSECOPS_TRACE       # per-probe and per-row debug output
+
+SOURCES += \
+    $$PWD/src/ActivityArchive.cpp \
+    $$PWD/src/ActivityLogger.cpp \
+    $$PWD/src/ActivitySearchModel.cpp \
+    $$PWD/src/NetworkScanner.cpp \
+    $$PWD/src/NetworkMonitor.cpp \
+    $$PWD/src/CronExpression.cpp \
+    $$PWD/src/IpAddress.cpp \
+    $$PWD/src/Ipv6Discovery.cpp \
+    $$PWD/src/UdpProber.cpp \
+    $$PWD/src/ProbeScheduler.cpp \
+    $$PWD/src/Metrics.cpp \
+    $$PWD/src/PerformanceMonitor.cpp \
+    $$PWD/src/OpenMetrics.cpp \
+    $$PWD/src/Trace.cpp \
+    $$PWD/src/ScanCheckpoint.cpp \
+    $$PWD/src/ScanCoordinator.cpp \
+    $$PWD/src/ScanWorker.cpp \
+    $$PWD/src/ControlServer.cpp \
+    $$PWD/src/NetworkMapper.cpp \
+    $$PWD/src/NetworkTreeModel.cpp \
+    $$PWD/src/ArpTableModel.cpp \
+    $$PWD/src/RemoteExecutor.cpp \
+    $$PWD/src/CredentialManager.cpp \
+    $$PWD/src/CredentialIndex.cpp \
+    $$PWD/src/Aead.cpp \
+    $$PWD/src/SecureBuffer.cpp \
+    $$PWD/src/TopologyGraph.cpp
+
+HEADERS += \
+    $$PWD/src/ActivityArchive.h \
+    $$PWD/src/ActivityLogger.h \
+    $$PWD/src/ActivitySearchModel.h \
+    $$PWD/src/NetworkScanner.h \
+    $$PWD/src/NetworkMonitor.h \
+    $$PWD/src/CronExpression.h \
+    $$PWD/src/IpAddress.h \
+    $$PWD/src/Ipv6Discovery.h \
+    $$PWD/src/UdpProber.h \
+    $$PWD/src/ProbeScheduler.h \
+    $$PWD/src/Metrics.h \
+    $$PWD/src/PerformanceMonitor.h \
+    $$PWD/src/OpenMetrics.h \
+    $$PWD/src/Trace.h \
+    $$PWD/src/ScanCheckpoint.h \
+    $$PWD/src/ScanCoordinator.h \
+    $$PWD/src/ScanProtocol.h \
+    $$PWD/src/ScanWorker.h \
+    $$PWD/src/ControlServer.h \
+    $$PWD/src/NetworkMapper.h \
+    $$PWD/src/NetworkTreeModel.h \
+    $$PWD/src/ArpTableModel.h \
+    $$PWD/src/RemoteExecutor.h \
+    $$PWD/src/CredentialManager.h \
+    $$PWD/src/CredentialIndex.h \
+    $$PWD/src/CredentialHandle.h \
+    $$PWD/src/Aead.h \
+    $$PWD/src/SecureBuffer.h \
+    $$PWD/src/TopologyGraph.h
@@ -3,11 +3,17 @@
 #include <QIcon>
 #include <QQuickStyle>
 #include "src/NetworkScanner.h"
+#include "src/NetworkMonitor.h"
+#include "src/ScanCoordinator.h"
+#include "src/ControlServer.h"
 #include "src/ScanResultsModel.h"
 #include "src/NetworkMapper.h"
 #include "src/RemoteExecutor.h"
 #include "src/CredentialManager.h"
 #include "src/ActivityLogger.h"
+#include "src/ActivitySearchModel.h"
+#include "src/PerformanceMonitor.h"
+#include "src/TopologyView.h"
 
 int main(int argc, char *argv[])
 {
@@ -18,11 +24,20 @@ int main(int argc, char *argv[])
     
     qRegisterMetaType<QList<int>>("QList<int>");
     qmlRegisterType<NetworkScanner>("NetSecOps", 1, 0, "NetworkScanner");
+    qmlRegisterType<NetworkMonitor>("NetSecOps", 1, 0, "NetworkMonitor");
+    qmlRegisterType<ScanCoordinator>("NetSecOps", 1, 0, "ScanCoordinator");
+    qmlRegisterType<ControlServer>("NetSecOps", 1, 0, "ControlServer");
     qmlRegisterType<ScanResultsModel>("NetSecOps", 1, 0, "ScanResultsModel");
     qmlRegisterType<NetworkMapper>("NetSecOps", 1, 0, "NetworkMapper");
     qmlRegisterType<RemoteExecutor>("NetSecOps", 1, 0, "RemoteExecutor");
     qmlRegisterType<CredentialManager>("NetSecOps", 1, 0, "CredentialManager");
     qmlRegisterType<ActivityLogger>("NetSecOps", 1, 0, "ActivityLogger");
+    qmlRegisterType<ActivitySearchModel>("NetSecOps", 1, 0, "ActivitySearchModel");
+    qmlRegisterType<PerformanceMonitor>("NetSecOps", 1, 0, "PerformanceMonitor");
+    qmlRegisterType<TopologyView>("NetSecOps", 1, 0, "TopologyView");
+    qmlRegisterUncreatableType<NetworkTreeModel>("NetSecOps", 1, 0, "NetworkTreeModel", "Provided by NetworkMapper");
+    qmlRegisterUncreatableType<ArpTableModel>("NetSecOps", 1, 0, "ArpTableModel", "Provided by NetworkMapper");
+    qmlRegisterUncreatableType<TopologyGraph>("NetSecOps", 1, 0, "TopologyGraph", "Provided by NetworkMapper");
     
     app.setApplicationName("NetSecOps");
     app.setApplicationVersion("1.0");
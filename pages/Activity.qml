@@ -11,6 +11,11 @@ Item {
         id: activityLogger
     }
     
+    ActivitySearchModel {
+        id: searchModel
+        logger: activityLogger
+    }
+    
     property var logs: [
         {id: 1, timestamp: "2024-01-15 14:30:25", type: "scan", action: "Network Discovery", target: "192.168.1.0/24", status: "success", user: "admin"},
         {id: 2, timestamp: "2024-01-15 14:28:15", type: "execution", action: "Remote Command", target: "192.168.1.100", status: "success", user: "admin"},
@@ -156,38 +161,53 @@ Item {
     // Logs Tab Component
     Component {
         id: logsTabComponent
-        
+
         Column {
             anchors.fill: parent
             spacing: 24
-            
+
             // Search & Filter
             Card {
                 width: parent.width
                 height: 130
                 title: "Search & Filter"
-                
+                description: searchModel.text.length > 0
+                             ? searchModel.count + " matches loaded in " + searchModel.elapsedMs + " ms"
+                             : ""
+
                 Row {
                     anchors.fill: parent
                     spacing: 16
-                    
+
                     Input {
                         width: 300
-                        placeholderText: "Search logs..."
+                        placeholderText: "Search logs and command output..."
+                        onTextChanged: searchModel.text = text
                     }
-                    
+
                     ComboBox {
                         width: 160
                         height: 40
-                        model: ["All Types", "Network Discovery", "Network Mapping", "Port Scan", "File Transfer", "Remote Execution", "Authentication", "Credential Management"]
-                        
+                        textRole: "label"
+                        model: [
+                            {label: "All Types", type: ""},
+                            {label: "Network Discovery", type: "discovery"},
+                            {label: "Network Mapping", type: "mapping"},
+                            {label: "Port Scan", type: "scan"},
+                            {label: "File Transfer", type: "file"},
+                            {label: "Remote Execution", type: "execution"},
+                            {label: "Authentication", type: "auth"},
+                            {label: "Credential Management", type: "credential"}
+                        ]
+                        onActivated: function(index) { searchModel.type = model[index].type }
+
                         background: Rectangle {
                             radius: 6
                             color: "#1e293b"
                             border.color: "#475569"
                             border.width: 1
                         }
-                        
+
                         contentItem: Text {
                             text: parent.currentText
                             color: "#f8fafc"
@@ -196,19 +216,57 @@ Item {
                             verticalAlignment: Text.AlignVCenter
                         }
                     }
-                    
+
                     ComboBox {
                         width: 128
                         height: 40
-                        model: ["All Status", "Success", "Failed", "Pending"]
-                        
+                        textRole: "label"
+                        model: [
+                            {label: "All Status", status: ""},
+                            {label: "Success", status: "success"},
+                            {label: "Failed", status: "failed"},
+                            {label: "Pending", status: "started"}
+                        ]
+                        onActivated: function(index) { searchModel.status = model[index].status }
+
                         background: Rectangle {
                             radius: 6
                             color: "#1e293b"
                             border.color: "#475569"
                             border.width: 1
                         }
-                        
+
+                        contentItem: Text {
+                            text: parent.currentText
+                            color: "#f8fafc"
+                            font.pixelSize: 14
+                            leftPadding: 12
+                            verticalAlignment: Text.AlignVCenter
+                        }
+                    }
+
+                    ComboBox {
+                        width: 140
+                        height: 40
+                        textRole: "label"
+                        model: [
+                            {label: "Any Time", days: 0},
+                            {label: "Last 24 Hours", days: 1},
+                            {label: "Last 7 Days", days: 7},
+                            {label: "Last 30 Days", days: 30}
+                        ]
+                        onActivated: function(index) {
+                            var days = model[index].days
+                            searchModel.since = days > 0 ? new Date(Date.now() - days * 24 * 3600 * 1000) : new Date(NaN)
+                        }
+
+                        background: Rectangle {
+                            radius: 6
+                            color: "#1e293b"
+                            border.color: "#475569"
+                            border.width: 1
+                        }
+
                         contentItem: Text {
                             text: parent.currentText
                             color: "#f8fafc"
@@ -219,114 +277,118 @@ Item {
                     }
                 }
             }
-            
+
             // Recent Activity
             Card {
                 width: parent.width
                 height: parent.height - 148
                 title: "Recent Activity"
-                description: "Last 100 operations"
-                
-                ScrollView {
+                description: "Newest first; older entries load as you scroll"
+
+                // Pulls further pages from the model as it scrolls
+                ListView {
                     anchors.fill: parent
-                    
-                    Column {
-                        width: parent.width
-                        spacing: 8
-                        
-                        Repeater {
-                            model: activityLogger.activities
-                            
-                            Rectangle {
-                                width: parent.width
-                                height: 60
-                                radius: 8
-                                color: "#0f1419"
-                                border.color: "#1e2328"
-                                border.width: 1
-                                
-                                RowLayout {
-                                    anchors.fill: parent
-                                    anchors.leftMargin: 16
-                                    anchors.topMargin: 6
-                                    anchors.bottomMargin: 6
-                                    anchors.rightMargin: 6
+                    clip: true
+                    spacing: 8
+                    model: searchModel
+                    ScrollBar.vertical: ScrollBar {}
+
+                    delegate: Rectangle {
+                        width: ListView.view.width
+                        height: model.snippet.length > 0 ? 80 : 60
+                        radius: 8
+                        color: "#0f1419"
+                        border.color: "#1e2328"
+                        border.width: 1
+
+                        RowLayout {
+                            anchors.fill: parent
+                            anchors.leftMargin: 16
+                            anchors.topMargin: 6
+                            anchors.bottomMargin: 6
+                            anchors.rightMargin: 6
 
-                                    spacing: 12
-                                    
-                                    // Text {
-                                    //     text: {
-                                    //         switch(modelData.status) {
-                                    //             case "success": return "✅"
-                                    //             case "failed": return "❌"
-                                    //             default: return "⏱️"
-                                    //         }
-                                    //     }
-                                    //     font.pixelSize: 16
-                                    // }
-                                    Image{
-                                        width: 20
-                                        height: 20
-                                        source: {
-                                            switch(modelData.type) {
-                                                case "discovery": return "qrc:/svgs/search-white.svg"
-                                                case "mapping": return "qrc:/svgs/network_map/map.svg"
-                                                case "scan": return "qrc:/svgs/network_discovery/radar.svg"
-                                                case "execution": return "qrc:/svgs/terminal-white.svg"
-                                                case "file": return "qrc:/svgs/operation/file-text.svg"
-                                                case "credential": return "qrc:/svgs/key.svg"
-                                                default: {
-                                                    switch(modelData.status) {
-                                                        case "success": return "qrc:/svgs/activity/square-check-big.svg"
-                                                        case "failed": return "qrc:/svgs/operation/square-x.svg"
-                                                        default: return "qrc:/svgs/clock-white.svg"
-                                                    }
-                                                }
+                            spacing: 12
+
+                            Image{
+                                width: 20
+                                height: 20
+                                source: {
+                                    switch(model.type) {
+                                        case "discovery": return "qrc:/svgs/search-white.svg"
+                                        case "mapping": return "qrc:/svgs/network_map/map.svg"
+                                        case "scan": return "qrc:/svgs/network_discovery/radar.svg"
+                                        case "execution": return "qrc:/svgs/terminal-white.svg"
+                                        case "file": return "qrc:/svgs/operation/file-text.svg"
+                                        case "credential": return "qrc:/svgs/key.svg"
+                                        default: {
+                                            switch(model.status) {
+                                                case "success": return "qrc:/svgs/activity/square-check-big.svg"
+                                                case "failed": return "qrc:/svgs/operation/square-x.svg"
+                                                default: return "qrc:/svgs/clock-white.svg"
                                             }
                                         }
                                     }
-                                    
-                                    Column {
-                                        Layout.fillWidth: true
-                                        spacing: 4
-                                        
-                                        RowLayout {
-                                            spacing: 8
-                                            
-                                            Text {
-                                                text: modelData.action
-                                                color: "#f8fafc"
-                                                font.pixelSize: 14
-                                                font.weight: Font.Medium
-                                            }
-                                            
-                                            Badge {
-                                                text: modelData.status
-                                                variant: {
-                                                    switch(modelData.status) {
-                                                        case "success": return "success"
-                                                        case "failed": return "destructive"
-                                                        default: return "warning"
-                                                    }
-                                                }
+                                }
+                            }
+
+                            Column {
+                                Layout.fillWidth: true
+                                spacing: 4
+
+                                RowLayout {
+                                    spacing: 8
+
+                                    Text {
+                                        text: model.action
+                                        color: "#f8fafc"
+                                        font.pixelSize: 14
+                                        font.weight: Font.Medium
+                                    }
+
+                                    Badge {
+                                        text: model.status
+                                        variant: {
+                                            switch(model.status) {
+                                                case "success": return "success"
+                                                case "failed": return "destructive"
+                                                default: return "warning"
                                             }
                                         }
-                                        
-                                        Text {
-                                            text: modelData.timestamp + " • Target: " + modelData.target + " • User: " + modelData.user
-                                            color: "#64748b"
-                                            font.pixelSize: 12
-                                        }
                                     }
-                                    
-                                    Button {
-                                        Layout.preferredHeight: 26
-                                        Layout.preferredWidth: 90
-                                        Layout.alignment: Qt.AlignRight
-                                        text: "View Details"
-                                        variant: "ghost"
-                                        onClicked: logDetailDialog.open()
+                                }
+
+                                Text {
+                                    text: model.timestamp + " • Target: " + model.target + " • User: " + model.user
+                                    color: "#64748b"
+                                    font.pixelSize: 12
+                                }
+
+                                // Matching part of the command output, hits in [brackets]
+                                Text {
+                                    visible: model.snippet.length > 0
+                                    width: parent.width
+                                    text: model.snippet
+                                    color: "#94a3b8"
+                                    font.pixelSize: 12
+                                    font.family: "monospace"
+                                    elide: Text.ElideRight
+                                }
+                            }
+
+                            Button {
+                                Layout.preferredHeight: 26
+                                Layout.preferredWidth: 90
+                                Layout.alignment: Qt.AlignRight
+                                text: "View Details"
+                                variant: "ghost"
+                                onClicked: {
+                                    logDetailDialog.entry = {
+                                        timestamp: model.timestamp, target: model.target,
+                                        action: model.action, status: model.status
                                     }
+                                    logDetailDialog.output = activityLogger.output(model.id)
+                                    logDetailDialog.open()
                                 }
                             }
                         }
@@ -335,7 +397,7 @@ Item {
             }
         }
     }
-    
+
     // Alerts Tab Component
     Component {
         id: alertsTabComponent
@@ -415,6 +477,8 @@ Item {
     // Log Details Dialog
     Dialog {
         id: logDetailDialog
+        property var entry: ({})
+        property string output: ""
         title: "Activity Details"
         width: 600
         height: 400
@@ -457,7 +521,7 @@ Item {
                         }
                         
                         Text {
-                            text: "2024-01-15 14:30:25"
+                            text: logDetailDialog.entry.timestamp || ""
                             color: "#64748b"
                             font.pixelSize: 12
                         }
@@ -475,7 +539,7 @@ Item {
                         }
                         
                         Text {
-                            text: "192.168.1.100"
+                            text: logDetailDialog.entry.target || ""
                             color: "#64748b"
                             font.pixelSize: 12
                         }
@@ -498,7 +562,7 @@ Item {
                         }
                         
                         Text {
-                            text: "Network Discovery"
+                            text: logDetailDialog.entry.action || ""
                             color: "#64748b"
                             font.pixelSize: 12
                         }
@@ -516,7 +580,7 @@ Item {
                         }
                         
                         Text {
-                            text: "success"
+                            text: logDetailDialog.entry.status || ""
                             color: "#64748b"
                             font.pixelSize: 12
                         }
@@ -529,7 +593,7 @@ Item {
                 spacing: 8
                 
                 Text {
-                    text: "Additional Details"
+                    text: "Output"
                     color: "#f8fafc"
                     font.pixelSize: 14
                     font.weight: Font.Medium
@@ -541,33 +605,18 @@ Item {
                     radius: 6
                     color: "#1e293b"
                     
-                    Column {
+                    ScrollView {
                         anchors.fill: parent
                         anchors.margins: 12
-                        spacing: 4
-                        
-                        Text {
-                            text: "Command executed: whoami"
-                            color: "#f8fafc"
-                            font.pixelSize: 12
-                        }
-                        
-                        Text {
-                            text: "Protocol used: SSH"
-                            color: "#f8fafc"
-                            font.pixelSize: 12
-                        }
                         
-                        Text {
-                            text: "Duration: 2.3 seconds"
-                            color: "#f8fafc"
-                            font.pixelSize: 12
-                        }
-                        
-                        Text {
-                            text: "Output: 134 bytes"
+                        TextArea {
+                            readOnly: true
+                            text: logDetailDialog.output.length > 0 ? logDetailDialog.output : "No output recorded"
                             color: "#f8fafc"
                             font.pixelSize: 12
+                            font.family: "monospace"
+                            wrapMode: TextEdit.WrapAnywhere
+                            background: null
                         }
                     }
                 }
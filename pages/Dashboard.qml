@@ -1,6 +1,7 @@
 import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
+import NetSecOps 1.0
 import "../components"
 
 ScrollView {
@@ -287,6 +288,118 @@ ScrollView {
                     }
                 }
             }
+            
+            // Engine Performance
+            PerformanceMonitor {
+                id: performanceMonitor
+                active: root.visible
+            }
+            
+            Card {
+                width: parent.width - 48
+                height: 140 + Math.max(performanceMonitor.histograms.length, performanceMonitor.counters.length) * 40
+                icon: "qrc:/svgs/activity.svg"
+                title: "Engine Performance"
+                description: "Rates and latencies over the last second"
+                
+                Row {
+                    anchors.fill: parent
+                    spacing: 24
+                    
+                    Column {
+                        width: (parent.width - 24) * 2 / 3
+                        spacing: 8
+                        
+                        Repeater {
+                            model: performanceMonitor.histograms
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 32
+                                radius: 8
+                                color: "#1e293b"
+                                
+                                RowLayout {
+                                    anchors.fill: parent
+                                    anchors.leftMargin: 12
+                                    anchors.rightMargin: 12
+                                    spacing: 12
+                                    
+                                    Text {
+                                        text: modelData.name
+                                        color: "#f8fafc"
+                                        font.pixelSize: 13
+                                        Layout.fillWidth: true
+                                    }
+                                    
+                                    Text {
+                                        text: modelData.perSecond + "/s"
+                                        color: "#64748b"
+                                        font.pixelSize: 12
+                                    }
+                                    
+                                    Text {
+                                        text: "p50 " + formatValue(modelData.p50, modelData.unit)
+                                              + "  p99 " + formatValue(modelData.p99, modelData.unit)
+                                        color: "#64748b"
+                                        font.pixelSize: 12
+                                    }
+                                    
+                                    Text {
+                                        visible: modelData.totalMs !== undefined
+                                        text: modelData.totalMs + " ms busy"
+                                        color: "#64748b"
+                                        font.pixelSize: 12
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    
+                    Column {
+                        width: (parent.width - 24) / 3
+                        spacing: 8
+                        
+                        Repeater {
+                            model: performanceMonitor.counters
+                            
+                            Rectangle {
+                                width: parent.width
+                                height: 32
+                                radius: 8
+                                color: "#1e293b"
+                                
+                                RowLayout {
+                                    anchors.fill: parent
+                                    anchors.leftMargin: 12
+                                    anchors.rightMargin: 12
+                                    spacing: 12
+                                    
+                                    Text {
+                                        text: modelData.name
+                                        color: "#f8fafc"
+                                        font.pixelSize: 13
+                                        Layout.fillWidth: true
+                                    }
+                                    
+                                    Text {
+                                        text: modelData.total + "  (" + modelData.perSecond + "/s)"
+                                        color: "#64748b"
+                                        font.pixelSize: 12
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
         }
     }
+    
+    // Microsecond timings read better in ms once they pass a millisecond
+    function formatValue(value, unit) {
+        if (unit !== "us")
+            return value
+        return value >= 1000 ? (value / 1000).toFixed(1) + " ms" : value + " us"
+    }
 }
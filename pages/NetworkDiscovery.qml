@@ -11,30 +11,19 @@ ScrollView {
     property string currentScanPorts: ""
     property int currentScanThreads: 50
 
-    function toArray(qtList) {
-        if (Array.isArray(qtList)) return qtList;
-        if (qtList === null || qtList === undefined) return [];
-
-        // Force conversion by copying
-        var arr = [];
-        for (var i = 0; i < qtList.length; ++i) {
-            arr.push(qtList[i]);
-        }
-        return arr;
-    }
-    
     ActivityLogger {
         id: activityLogger
     }
     
     property var networkScanner
+    property var networkMonitor
     property var scanResults
     
     onNetworkScannerChanged: {
         if (networkScanner) {
-            networkScanner.hostDiscovered.connect(function(ip, hostname, mac, ports) {
+            networkScanner.hostDiscovered.connect(function(ip, hostname, mac, ports, udpPorts) {
                 if (scanResults) {
-                    scanResults.addResult(ip, hostname, mac, ports)
+                    scanResults.addResult(ip, hostname, mac, ports, udpPorts || [])
                 }
                 activityLogger.logActivity("discovery", "Host Discovered", ip, "success")
             })
@@ -106,10 +95,10 @@ ScrollView {
                     property int currentTab: 0
                     
                     Repeater {
-                        model: ["Network Scan", "Scan Results", "Scan History"]
+                        model: ["Network Scan", "Scan Results", "Scan History", "Monitoring"]
                         
                         Rectangle {
-                            width: parent.width / 3
+                            width: parent.width / 4
                             height: parent.height
                             color: parent.currentTab === index ? "#3b82f6" : "#1e293b"
                             border.color: "#475569"
@@ -141,6 +130,7 @@ ScrollView {
                         case 0: return scanTabComponent
                         case 1: return resultsTabComponent
                         case 2: return historyTabComponent
+                        case 3: return monitorTabComponent
                         default: return scanTabComponent
                         }
                     }
@@ -182,7 +172,7 @@ ScrollView {
                         Input {
                             id: targetNetworkInput
                             width: parent.width
-                            placeholderText: "192.168.1.0/24 or 127.0.0.1"
+                            placeholderText: "192.168.1.0/24, 2001:db8::/64 or 127.0.0.1"
                             text: "127.0.0.1"
                         }
                     }
@@ -201,7 +191,7 @@ ScrollView {
                         Input {
                             id: portRangeInput
                             width: parent.width
-                            placeholderText: "1-100, 80, 443 or 22,80,443"
+                            placeholderText: "22,80,443 or U:53,161 for UDP"
                             text: "22,80,443,3389,5900"
                         }
                     }
@@ -260,10 +250,20 @@ ScrollView {
                             }
                         }
                         
+                        // Resume the most recent interrupted scan
                         Button {
                             width: 40
                             icon: "qrc:/svgs/network_discovery/rotate-ccw.svg"
                             variant: "outline"
+                            enabled: !networkScanner.isScanning && networkScanner.savedScans.length > 0
+                            onClicked: {
+                                var saved = networkScanner.savedScans[0]
+                                root.currentScanTarget = saved.network
+                                root.currentScanPorts = saved.ports
+                                scanResults.clear()
+                                activityLogger.logActivity("discovery", "Network Scan Resumed", saved.network, "started")
+                                networkScanner.resumeScan(saved.id)
+                            }
                         }
                     }
                 }
@@ -437,131 +437,186 @@ ScrollView {
             anchors.fill: parent
             description: networkScanner.hostsFound + " hosts discovered in the last scan"
             
-            ScrollView {
+            ColumnLayout {
                 anchors.fill: parent
+                spacing: 16
                 
-                Column {
-                    width: parent.width
-                    spacing: 16
+                // Filtering and sorting run in the model, not over delegates
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 12
                     
-                    Repeater {
-                        model: scanResults
+                    Input {
+                        Layout.fillWidth: true
+                        placeholderText: "IP range (10.0.0.0/24, 10.0.0.5-90)"
+                        onTextChanged: if (scanResults) scanResults.ipFilter = text
+                    }
+                    
+                    Input {
+                        Layout.preferredWidth: 160
+                        placeholderText: "Ports (22,80,8000-8100)"
+                        onTextChanged: if (scanResults) scanResults.portFilter = text
+                    }
+                    
+                    Input {
+                        Layout.fillWidth: true
+                        placeholderText: "Hostname contains..."
+                        onTextChanged: if (scanResults) scanResults.hostnameFilter = text
+                    }
+                    
+                    ComboBox {
+                        id: sortCombo
+                        Layout.preferredWidth: 140
+                        Layout.preferredHeight: 40
+                        model: ["Sort: IP", "Sort: Hostname", "Sort: Open ports"]
                         
-                        Rectangle {
-
-                            id: hostItem
-
-                            width: parent.width
-                            height: 100
-                            radius: 8
-                            color: "#0f1419"
-                            border.color: "#1e2328"
+                        background: Rectangle {
+                            radius: 6
+                            color: "#1e293b"
+                            border.color: "#475569"
                             border.width: 1
+                        }
+                        
+                        onCurrentIndexChanged: {
+                            if (!scanResults) return
+                            var roles = [ScanResultsModel.IpRole, ScanResultsModel.HostnameRole, ScanResultsModel.PortsRole]
+                            scanResults.sortRole = roles[currentIndex]
+                            scanResults.sortOrder = currentIndex === 2 ? Qt.DescendingOrder : Qt.AscendingOrder
+                        }
+                    }
+                }
+                
+                Text {
+                    visible: scanResults && scanResults.count !== scanResults.totalCount
+                    text: scanResults ? "Showing " + scanResults.count + " of " + scanResults.totalCount + " hosts" : ""
+                    color: "#64748b"
+                    font.pixelSize: 12
+                }
+                
+                ListView {
+                    id: resultsList
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    clip: true
+                    spacing: 16
+                    reuseItems: true
+                    model: scanResults
+                    
+                    ScrollBar.vertical: ScrollBar {}
+                    
+                    delegate: Rectangle {
 
-                            property var cachedPorts: model.ports || []  // ✅ Safe
+                        id: hostItem
 
-                            Column {
-                                anchors.fill: parent
-                                anchors.margins: 16
-                                spacing: 12
-
-                                RowLayout {
-                                    width: parent.width
-
-                                    Row {
-                                        spacing: 12
-
-                                        Rectangle {
-                                            width: 32
-                                            height: 32
-                                            radius: 8
-                                            color: "transparent"//"#3b82f600"
-                                            border.width: 1
-                                            border.color: "#1e2328"
-                                            // opacity: 0.1
-
-                                            Text {
-                                                anchors.centerIn: parent
-                                                text: "🖥️"
-                                                font.pixelSize: 16
-                                            }
-                                        }
+                        width: ListView.view.width
+                        height: 100
+                        radius: 8
+                        color: "#0f1419"
+                        border.color: "#1e2328"
+                        border.width: 1
 
-                                        Column {
-                                            spacing: 4
+                        property var cachedPorts: model.ports || []
 
-                                            Text {
-                                                text: (typeof model !== 'undefined' && model.ip) ? model.ip : ""
-                                                color: "#f8fafc"
-                                                font.pixelSize: 14
-                                                font.weight: Font.Medium
-                                            }
+                        Column {
+                            anchors.fill: parent
+                            anchors.margins: 16
+                            spacing: 12
 
-                                            Text {
-                                                text: (typeof model !== 'undefined' && model.hostname) ? model.hostname : ""
-                                                color: "#64748b"
-                                                font.pixelSize: 12
-                                            }
-                                        }
-                                    }
+                            RowLayout {
+                                width: parent.width
 
-                                    Item { Layout.fillWidth: true }
+                                Row {
+                                    spacing: 12
 
-                                    Badge {
-                                        text: "✅ " + ((typeof model !== 'undefined' && model.status) ? model.status : "online")
-                                        variant: "success"
-                                    }
-                                }
+                                    Rectangle {
+                                        width: 32
+                                        height: 32
+                                        radius: 8
+                                        color: "transparent"//"#3b82f600"
+                                        border.width: 1
+                                        border.color: "#1e2328"
+                                        // opacity: 0.1
 
-                                Row {
-                                    width: parent.width
-                                    spacing: 32
+                                        Text {
+                                            anchors.centerIn: parent
+                                            text: "🖥️"
+                                            font.pixelSize: 16
+                                        }
+                                    }
 
                                     Column {
                                         spacing: 4
 
                                         Text {
-                                            text: "MAC Address: " + ((typeof model !== 'undefined' && model.mac) ? model.mac : "Unknown")
+                                            text: (typeof model !== 'undefined' && model.ip) ? model.ip : ""
+                                            color: "#f8fafc"
+                                            font.pixelSize: 14
+                                            font.weight: Font.Medium
+                                        }
+
+                                        Text {
+                                            text: (typeof model !== 'undefined' && model.hostname) ? model.hostname : ""
                                             color: "#64748b"
                                             font.pixelSize: 12
-                                            font.family: "monospace"
                                         }
                                     }
+                                }
+
+                                Item { Layout.fillWidth: true }
+
+                                Badge {
+                                    text: "✅ " + ((typeof model !== 'undefined' && model.status) ? model.status : "online")
+                                    variant: "success"
+                                }
+                            }
+
+                            Row {
+                                width: parent.width
+                                spacing: 32
+
+                                Column {
+                                    spacing: 4
+
+                                    Text {
+                                        text: "MAC Address: " + ((typeof model !== 'undefined' && model.mac) ? model.mac : "Unknown")
+                                        color: "#64748b"
+                                        font.pixelSize: 12
+                                        font.family: "monospace"
+                                    }
+                                }
+
+                                Row {
+                                    spacing: 4
+
+                                    Text {
+                                        id: open_port_text
+                                        text: "Open Ports:"
+                                        color: "#64748b"
+                                        font.pixelSize: 12
+                                    }
 
-                                    Row {
+                                    Flow {
+                                        width: 200
                                         spacing: 4
+                                        anchors.verticalCenter: open_port_text.verticalCenter
 
-                                        Text {
-                                            id: open_port_text
-                                            text: "Open Ports:"
-                                            color: "#64748b"
-                                            font.pixelSize: 12
-                                        }
+                                        // Display port badges
+                                        Repeater {
+                                            id: portRepeater
+                                            model: hostItem.cachedPorts
 
-                                        Flow {
-                                            width: 200
-                                            spacing: 4
-                                            anchors.verticalCenter: open_port_text.verticalCenter
-
-                                            // Display port badges
-                                            Repeater {
-                                                id: portRepeater
-                                                // model: model.ports//[22, 34]
-                                                model : toArray(hostItem.cachedPorts)
-
-                                                Badge {
-                                                    text: modelData.toString()  // modelData = individual port number
-                                                    variant: "outline"
-                                                }
+                                            Badge {
+                                                text: modelData.toString()  // modelData = individual port number
+                                                variant: "outline"
                                             }
+                                        }
 
-                                            // Show "No open ports" if no ports
-                                            Text {
-                                                visible: portRepeater.count === 0
-                                                text: "No open ports"
-                                                color: "#64748b"
-                                                font.pixelSize: 12
-                                            }
+                                        // Show "No open ports" if no ports
+                                        Text {
+                                            visible: portRepeater.count === 0
+                                            text: "No open ports"
+                                            color: "#64748b"
+                                            font.pixelSize: 12
                                         }
                                     }
                                 }
@@ -649,6 +704,216 @@ ScrollView {
         }
     }
 
+    // Monitoring Tab Component
+    Component {
+        id: monitorTabComponent
+
+        RowLayout {
+            spacing: 24
+
+            // Scheduled Sweeps
+            Card {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                icon: "qrc:/svgs/clock-white.svg"
+                title: "Scheduled Sweeps"
+                description: "Recurring scans on a cron schedule (minute hour day month weekday)"
+
+                Column {
+                    anchors.fill: parent
+                    spacing: 12
+
+                    Input {
+                        id: scheduleNameInput
+                        width: parent.width
+                        placeholderText: "Name (optional)"
+                    }
+
+                    Row {
+                        width: parent.width
+                        spacing: 8
+
+                        Input {
+                            id: scheduleCronInput
+                            width: (parent.width - 8) / 2
+                            placeholderText: "0 */6 * * * or @daily"
+                        }
+
+                        Input {
+                            id: schedulePortsInput
+                            width: (parent.width - 8) / 2
+                            placeholderText: "Ports, e.g. 22,80,443"
+                            text: "22,80,443,3389,5900"
+                        }
+                    }
+
+                    Input {
+                        id: scheduleNetworkInput
+                        width: parent.width
+                        placeholderText: "192.168.1.0/24"
+                    }
+
+                    Text {
+                        id: scheduleError
+                        visible: text.length > 0
+                        color: "#ef4444"
+                        font.pixelSize: 12
+                    }
+
+                    Button {
+                        width: parent.width
+                        text: "Add Schedule"
+                        icon: "qrc:/svgs/network_discovery/play.svg"
+                        variant: "cyber"
+                        enabled: !!networkMonitor
+                        onClicked: {
+                            var id = networkMonitor.addSchedule(scheduleNameInput.text, scheduleCronInput.text,
+                                                                scheduleNetworkInput.text, schedulePortsInput.text)
+                            if (id.length === 0) {
+                                scheduleError.text = "Enter a network and a valid cron expression"
+                                return
+                            }
+                            scheduleError.text = ""
+                            scheduleNameInput.text = ""
+                            scheduleCronInput.text = ""
+                        }
+                    }
+
+                    ListView {
+                        width: parent.width
+                        height: parent.height - y
+                        clip: true
+                        spacing: 8
+                        model: networkMonitor ? networkMonitor.schedules : []
+
+                        delegate: Rectangle {
+                            width: ListView.view.width
+                            height: 60
+                            radius: 8
+                            color: "#1e293b90"
+
+                            RowLayout {
+                                anchors.fill: parent
+                                anchors.margins: 12
+                                spacing: 8
+
+                                Column {
+                                    Layout.fillWidth: true
+                                    spacing: 4
+
+                                    Text {
+                                        text: modelData.name + " • " + modelData.cron
+                                        color: "#f8fafc"
+                                        font.pixelSize: 14
+                                        font.weight: Font.Medium
+                                    }
+
+                                    Text {
+                                        text: modelData.network + " • next "
+                                              + (isNaN(modelData.nextRun) ? "never" : Qt.formatDateTime(modelData.nextRun, "yyyy-MM-dd hh:mm"))
+                                        color: "#64748b"
+                                        font.pixelSize: 12
+                                    }
+                                }
+
+                                Button {
+                                    text: "Run"
+                                    variant: "ghost"
+                                    onClicked: networkMonitor.runSchedule(modelData.id)
+                                }
+
+                                Button {
+                                    text: "Remove"
+                                    variant: "ghost"
+                                    onClicked: networkMonitor.removeSchedule(modelData.id)
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Continuous Monitor
+            Card {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                icon: "qrc:/svgs/activity.svg"
+                title: "Continuous Monitor"
+                description: networkMonitor
+                             ? networkMonitor.onlineCount + " of " + networkMonitor.hostCount + " hosts up • "
+                               + networkMonitor.probesSent + " probes sent"
+                             : ""
+
+                Column {
+                    anchors.fill: parent
+                    spacing: 12
+
+                    Button {
+                        width: parent.width
+                        text: networkMonitor && networkMonitor.continuous ? "Stop Monitoring" : "Start Monitoring"
+                        icon: networkMonitor && networkMonitor.continuous ? "qrc:/svgs/network_discovery/pause.svg" : "qrc:/svgs/network_discovery/play.svg"
+                        variant: networkMonitor && networkMonitor.continuous ? "outline" : "cyber"
+                        enabled: !!networkMonitor
+                        onClicked: networkMonitor.continuous = !networkMonitor.continuous
+                    }
+
+                    Text {
+                        text: "Recent Changes"
+                        color: "#f8fafc"
+                        font.pixelSize: 14
+                        font.weight: Font.Medium
+                    }
+
+                    ListView {
+                        width: parent.width
+                        height: parent.height - y
+                        clip: true
+                        spacing: 8
+                        model: networkMonitor ? networkMonitor.changes : []
+
+                        delegate: Rectangle {
+                            width: ListView.view.width
+                            height: 48
+                            radius: 8
+                            color: "#1e293b90"
+
+                            RowLayout {
+                                anchors.fill: parent
+                                anchors.margins: 12
+                                spacing: 8
+
+                                Badge {
+                                    text: modelData.change
+                                    variant: {
+                                        switch(modelData.change) {
+                                            case "down": return "destructive"
+                                            case "portClosed": return "warning"
+                                            default: return "success"
+                                        }
+                                    }
+                                }
+
+                                Text {
+                                    Layout.fillWidth: true
+                                    text: modelData.ip + (modelData.detail.length > 0 ? " • " + modelData.detail : "")
+                                    color: "#f8fafc"
+                                    font.pixelSize: 13
+                                    elide: Text.ElideRight
+                                }
+
+                                Text {
+                                    text: Qt.formatDateTime(modelData.time, "hh:mm:ss")
+                                    color: "#64748b"
+                                    font.pixelSize: 12
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
     Timer {
         id: progressTimer
         interval: 500
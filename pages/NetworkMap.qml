@@ -13,9 +13,7 @@ ScrollView {
     
     // property var networkScanner
     property var networkMapper
-    property var arpModel
     property var profiledHosts
-    property var topologyNodes
     
     /*
     // Connect to NetworkScanner for discovered hosts
@@ -49,7 +47,7 @@ ScrollView {
     */
     
     onNetworkMapperChanged: {
-        // if (networkMapper && profiledHosts && arpModel) {
+        // if (networkMapper && profiledHosts) {
             console.log("NetworkMap: Connecting signals to networkMapper")
             networkMapper.hostProfiled.connect(function(ip, os, services, vendor) {
                 console.log("NetworkMap: Host profiled:", ip, os, services, vendor)
@@ -61,95 +59,14 @@ ScrollView {
                                              vendor: vendor,
                                              deviceType: "computer"
                                          })
-                    updateTopology()
-                    redrawTimer.restart()
                 }
             })
-            networkMapper.arpTableUpdated.connect(function(entries) {
-                console.log("NetworkMap: ARP table updated with", entries.length, "entries")
-                if (arpModel) {
-                    arpModel.clear()
-                    for (var i = 0; i < entries.length; i++) {
-                        var parts = entries[i].split('|')
-                        if (parts.length >= 4) {
-                            arpModel.append({
-                                                ip: parts[0],
-                                                mac: parts[1],
-                                                vendor: parts[2],
-                                                type: parts[3]
-                                            })
-                        }
-                    }
-                }
+            networkMapper.topologyCompleted.connect(function() {
+                if (topologyView) topologyView.resetView()
             })
         // }
     }
     
-    function updateTopology() {
-        topologyNodes.clear()
-        
-        // Add gateway/router first (usually .1)
-        var gatewayFound = false
-        for (var i = 0; i < profiledHosts.count; i++) {
-            var host = profiledHosts.get(i)
-            if (host.ip.endsWith('.1')) {
-                topologyNodes.append({
-                                         ip: host.ip,
-                                         name: "Gateway",
-                                         os: host.os,
-                                         iconSource: "qrc:/svgs/types/network.svg",
-                                         x: 0.5,
-                                         y: 0.5
-                                     })
-                gatewayFound = true
-                break
-            }
-        }
-        
-        // Position other hosts in a circle around gateway
-        var hostCount = 0
-        var radius = 0.3
-        
-        for (var j = 0; j < profiledHosts.count; j++) {
-            var host = profiledHosts.get(j)
-            if (host.ip.endsWith('.1')) continue // Skip gateway
-            
-            var angle = (hostCount * 2 * Math.PI) / Math.max(1, profiledHosts.count - (gatewayFound ? 1 : 0))
-            var x = 0.5 + radius * Math.cos(angle)
-            var y = 0.5 + radius * Math.sin(angle)
-            
-            // Determine icon based on device type
-            var iconSource = "qrc:/svgs/types/monitor.svg"
-            var deviceType = host.deviceType || "computer"
-            
-            switch(deviceType) {
-            case "router": iconSource = "qrc:/svgs/types/network.svg"; break;
-            case "switch": iconSource = "qrc:/svgs/types/switch-camera.svg"; break;
-            case "printer": iconSource = "qrc:/svgs/types/printer.svg"; break;
-            case "phone": iconSource = "qrc:/svgs/types/smartphone.svg"; break;
-            case "audio": iconSource = "qrc:/svgs/types/volume-1.svg"; break;
-            case "iot": iconSource = "qrc:/svgs/types/monitor-dot.svg"; break;
-            case "camera": iconSource = "qrc:/svgs/types/camera.svg"; break;
-            case "server": iconSource = "qrc:/svgs/types/server.svg"; break;
-            case "workstation": iconSource = "qrc:/svgs/types/monitor.svg"; break;
-            case "mac": iconSource = "qrc:/svgs/types/app-window-mac.svg"; break;
-            case "mobile": iconSource = "qrc:/svgs/types/smartphone.svg"; break;
-            default: iconSource = "qrc:/svgs/types/monitor.svg";
-            }
-            
-            topologyNodes.append({
-                                     ip: host.ip,
-                                     name: host.ip,
-                                     os: host.os,
-                                     iconSource: iconSource,
-                                     x: Math.max(0.1, Math.min(0.9, x)),
-                                     y: Math.max(0.1, Math.min(0.9, y))
-                                 })
-            
-            hostCount++
-        }
-    }
-    
     ColumnLayout {
         // anchors.fill: parent
         width: root.width-48
@@ -212,7 +129,6 @@ ScrollView {
                         }*/
                         if (networkMapper && !networkMapper.isMapping) {
                             if (profiledHosts) profiledHosts.clear()
-                            if (topologyNodes) topologyNodes.clear()
                             activityLogger.logActivity("mapping", "Quick Network Mapping", "ARP Table", "started")
                             networkMapper.startQuickMapping() // Arp table only
                         }
@@ -227,7 +143,6 @@ ScrollView {
                     onClicked: {
                         if (networkMapper && !networkMapper.isMapping) {
                             if (profiledHosts) profiledHosts.clear()
-                            if (topologyNodes) topologyNodes.clear()
                             activityLogger.logActivity("mapping", "Full Network Mapping", "192.168.130.0/24", "started")
                             networkMapper.startFullMapping("192.168.130.0/24") // Full subnet
                         }
@@ -273,7 +188,8 @@ ScrollView {
                 Layout.preferredHeight: 600
                 icon: "qrc:/svgs/lucide-map-white.svg"
                 title: "Network Topology"
-                description: "Interactive map of discovered network devices"
+                description: topologyView.layoutRunning ? "Arranging " + topologyView.nodeCount + " devices..."
+                                                        : "Interactive map of discovered network devices"
 
                 Rectangle {
                     anchors.fill: parent
@@ -283,203 +199,48 @@ ScrollView {
                     border.width: 1
                     clip: true
 
-                    Flickable {
-                        id: topologyFlickable
+                    // Nodes and links are batched on the scene graph in C++
+                    TopologyView {
+                        id: topologyView
                         anchors.fill: parent
-                        contentWidth: topologyContent.width * topologyContent.scale
-                        contentHeight: topologyContent.height * topologyContent.scale
-                        boundsBehavior: Flickable.StopAtBounds
-
-                        Item {
-                            id: topologyContent
-                            width: 2000
-                            height: 2000
-                            scale: 1.0
-                            transformOrigin: Item.TopLeft
-
-                            // Grid Background
-                            Canvas {
-                                anchors.fill: parent
-                                onPaint: {
-                                    var ctx = getContext("2d")
-                                    ctx.strokeStyle = "#1e2328"
-                                    ctx.lineWidth = 0.5
-
-                                    for (var x = 0; x < width; x += 40) {
-                                        ctx.beginPath()
-                                        ctx.moveTo(x, 0)
-                                        ctx.lineTo(x, height)
-                                        ctx.stroke()
-                                    }
-
-                                    for (var y = 0; y < height; y += 40) {
-                                        ctx.beginPath()
-                                        ctx.moveTo(0, y)
-                                        ctx.lineTo(width, y)
-                                        ctx.stroke()
-                                    }
-                                }
-                            }
-
-                            // Connection Lines - Dynamic based on topology
-                            Canvas {
-                                id: connectionCanvas
-                                anchors.fill: parent
-
-                                function redrawConnections() {
-                                    requestPaint()
-                                }
-
-                                onPaint: {
-                                    var ctx = getContext("2d")
-                                    ctx.clearRect(0, 0, width, height)
-                                    ctx.strokeStyle = "#3b82f6"
-                                    ctx.lineWidth = 2
-                                    ctx.globalAlpha = 0.6
-
-                                    // Find gateway position
-                                    var gatewayX = width * 0.5
-                                    var gatewayY = height * 0.5
-                                    var hasGateway = false
-
-                                    for (var i = 0; i < topologyNodes.count; i++) {
-                                        var node = topologyNodes.get(i)
-                                        if (node.ip.endsWith('.1')) {
-                                            gatewayX = width * node.x
-                                            gatewayY = height * node.y
-                                            hasGateway = true
-                                            break
-                                        }
-                                    }
-
-                                    // Draw connections from gateway to all other nodes
-                                    if (hasGateway) {
-                                        for (var j = 0; j < topologyNodes.count; j++) {
-                                            var host = topologyNodes.get(j)
-                                            if (!host.ip.endsWith('.1')) {
-                                                ctx.beginPath()
-                                                ctx.moveTo(gatewayX, gatewayY)
-                                                ctx.lineTo(width * host.x, height * host.y)
-                                                ctx.stroke()
-                                            }
-                                        }
-                                    }
-                                }
-
-                                Timer {
-                                    id: redrawTimer
-                                    interval: 500
-                                    onTriggered: connectionCanvas.redrawConnections()
-                                }
-                            }
-
-                            // Network Nodes - Dynamic based on profiled hosts
-                            Repeater {
-                                model: topologyNodes || []
-
-                                Item {
-                                    x: parent.width * model.x - 20
-                                    y: parent.height * model.y - 20
-                                    width: 40
-                                    height: 40
-
-                            Rectangle {
-                                anchors.centerIn: parent
-                                width: 48
-                                height: 48
-                                radius: 24
-                                color: "#0f1419"
-                                border.color: nodeMouseArea.containsMouse ? "#3b82f6" : "#1e2328"
-                                border.width: 2
-
-                                Image {
-                                    anchors.centerIn: parent
-                                    source: model.iconSource
-                                    width: 20
-                                    height: 20
-                                }
-
-                                // Status indicator
-                                Rectangle {
-                                    anchors.top: parent.top
-                                    anchors.right: parent.right
-                                    anchors.topMargin: -2
-                                    anchors.rightMargin: -2
-                                    width: 12
-                                    height: 12
-                                    radius: 6
-                                    color: "#16a34a"
-                                    border.color: "#0a0e1a"
-                                    border.width: 2
-
-                                    SequentialAnimation on opacity {
-                                        running: true
-                                        loops: Animation.Infinite
-                                        NumberAnimation { to: 0.3; duration: 1000 }
-                                        NumberAnimation { to: 1.0; duration: 1000 }
-                                    }
-                                }
-                            }
-
-                            // Tooltip
-                            Rectangle {
-                                visible: nodeMouseArea.containsMouse
-                                anchors.bottom: parent.top
-                                anchors.horizontalCenter: parent.horizontalCenter
-                                anchors.bottomMargin: 8
-                                width: tooltipText.width + 16
-                                height: tooltipText.height + 12
-                                color: "#1e293b"
-                                border.color: "#475569"
-                                border.width: 1
-                                radius: 6
-
-                                Column {
-                                    id: tooltipText
-                                    anchors.centerIn: parent
-                                    spacing: 2
-
-                                    Text {
-                                        text: model.name
-                                        color: "#f8fafc"
-                                        font.pixelSize: 12
-                                        font.weight: Font.Medium
-                                    }
+                        // The mapper owns the graph, so the map survives page reloads
+                        graph: networkMapper ? networkMapper.topology : null
+                    }
 
-                                    Text {
-                                        text: model.ip
-                                        color: "#64748b"
-                                        font.pixelSize: 10
-                                    }
+                    // Tooltip
+                    Rectangle {
+                        visible: topologyView.hoveredIp !== ""
+                        x: Math.max(0, Math.min(parent.width - width, topologyView.hoveredPosition.x - width / 2))
+                        y: Math.max(0, topologyView.hoveredPosition.y - height - 36 * Math.min(1, topologyView.zoom))
+                        width: tooltipText.width + 16
+                        height: tooltipText.height + 12
+                        color: "#1e293b"
+                        border.color: "#475569"
+                        border.width: 1
+                        radius: 6
 
-                                    Text {
-                                        text: model.os || "Unknown"
-                                        color: "#64748b"
-                                        font.pixelSize: 10
-                                    }
-                                }
+                        Column {
+                            id: tooltipText
+                            anchors.centerIn: parent
+                            spacing: 2
+
+                            Text {
+                                text: topologyView.hoveredName
+                                color: "#f8fafc"
+                                font.pixelSize: 12
+                                font.weight: Font.Medium
                             }
 
-                                    MouseArea {
-                                        id: nodeMouseArea
-                                        anchors.fill: parent
-                                        hoverEnabled: true
-                                    }
-                                }
+                            Text {
+                                text: topologyView.hoveredIp
+                                color: "#64748b"
+                                font.pixelSize: 10
                             }
-                        }
 
-                        // Mouse wheel zoom
-                        MouseArea {
-                            anchors.fill: parent
-                            acceptedButtons: Qt.NoButton
-                            onWheel: function(wheel) {
-                                var scaleFactor = wheel.angleDelta.y > 0 ? 1.1 : 0.9
-                                var newScale = topologyContent.scale * scaleFactor
-                                newScale = Math.max(0.5, Math.min(3.0, newScale))
-                                topologyContent.scale = newScale
-                                topologyFlickable.contentWidth = topologyContent.width * newScale
-                                topologyFlickable.contentHeight = topologyContent.height * newScale
+                            Text {
+                                text: topologyView.hoveredOs || "Unknown"
+                                color: "#64748b"
+                                font.pixelSize: 10
                             }
                         }
                     }
@@ -497,12 +258,7 @@ ScrollView {
                         height: 32
                         icon: "qrc:/svgs/credential/plus.svg"
                         variant: "outline"
-                        onClicked: {
-                            var newScale = Math.min(3.0, topologyContent.scale * 1.2)
-                            topologyContent.scale = newScale
-                            topologyFlickable.contentWidth = topologyContent.width * newScale
-                            topologyFlickable.contentHeight = topologyContent.height * newScale
-                        }
+                        onClicked: topologyView.zoomBy(1.2)
                     }
                     
                     Button {
@@ -510,12 +266,7 @@ ScrollView {
                         height: 32
                         icon: "qrc:/svgs/network_map/minus.svg"
                         variant: "outline"
-                        onClicked: {
-                            var newScale = Math.max(0.5, topologyContent.scale * 0.8)
-                            topologyContent.scale = newScale
-                            topologyFlickable.contentWidth = topologyContent.width * newScale
-                            topologyFlickable.contentHeight = topologyContent.height * newScale
-                        }
+                        onClicked: topologyView.zoomBy(0.8)
                     }
                     
                     Button {
@@ -523,13 +274,7 @@ ScrollView {
                         height: 32
                         icon: "qrc:/svgs/network_map/house.svg"
                         variant: "outline"
-                        onClicked: {
-                            topologyContent.scale = 1.0
-                            topologyFlickable.contentX = 0
-                            topologyFlickable.contentY = 0
-                            topologyFlickable.contentWidth = topologyContent.width
-                            topologyFlickable.contentHeight = topologyContent.height
-                        }
+                        onClicked: topologyView.resetView()
                     }
                 }
             }
@@ -631,7 +376,8 @@ ScrollView {
                             spacing: 4
                             
                             Repeater {
-                                model: arpModel || []
+                                // Typed model owned by the mapper; rows update in place
+                                model: networkMapper ? networkMapper.arpTable : []
                                 
                                 Rectangle {
                                     width: parent.width
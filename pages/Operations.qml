@@ -19,6 +19,8 @@ ScrollView {
         id: remoteExecutor
         Component.onCompleted: {
             setCredentialManager(credentialManager)
+            // Logs each job's start and its result with the output
+            activityLogger.watchExecutor(remoteExecutor)
         }
         onJobStarted: function(jobId, type, target) {
             activeJobsModel.append({
@@ -28,25 +30,16 @@ ScrollView {
                 progress: 0,
                 status: "running"
             })
-            activityLogger.logActivity("execution", type, target, "started")
         }
         onJobProgress: function(jobId, progress) {
             updateJobProgress(jobId, progress)
         }
         onJobCompleted: function(jobId, output) {
             updateJobStatus(jobId, "completed", 100)
-            var job = getJobById(jobId)
-            if (job) {
-                activityLogger.logActivity("execution", job.type, job.target, "success")
-            }
             console.log("Job", jobId, "completed:", output)
         }
         onJobFailed: function(jobId, error) {
             updateJobStatus(jobId, "failed", 100)
-            var job = getJobById(jobId)
-            if (job) {
-                activityLogger.logActivity("execution", job.type, job.target, "failed")
-            }
             console.log("Job", jobId, "failed:", error)
         }
         onOutputReceived: function(jobId, output) {
@@ -494,7 +487,7 @@ ScrollView {
                             id: fileProtocolCombo
                             width: parent.width
                             height: 40
-                            model: ["SCP/SFTP", "SMB", "WinRM"]
+                            model: ["SCP/SFTP", "SCP/SFTP Delta", "SCP/SFTP Fan-out", "SCP/SFTP Fan-out Relay", "SMB", "WinRM"]
                             
                             background: Rectangle {
                                 radius: 6
@@ -15,6 +15,12 @@ Item {
         id: persistentNetworkScanner
     }
     
+    // Scheduled sweeps and the background monitor run whatever page is open
+    NetworkMonitor {
+        id: persistentNetworkMonitor
+        scanner: persistentNetworkScanner
+    }
+    
     ScanResultsModel {
         id: persistentScanResults
     }
@@ -23,18 +29,10 @@ Item {
         id: persistentNetworkMapper
     }
     
-    ListModel {
-        id: persistentArpModel
-    }
-    
     ListModel {
         id: persistentProfiledHosts
     }
     
-    ListModel {
-        id: persistentTopologyNodes
-    }
-    
     RowLayout {
         anchors.fill: parent
         spacing: 0
@@ -79,21 +77,18 @@ Item {
                         if ('networkScanner' in item) {
                             item.networkScanner = persistentNetworkScanner
                         }
+                        if ('networkMonitor' in item) {
+                            item.networkMonitor = persistentNetworkMonitor
+                        }
                         if ('scanResults' in item) {
                             item.scanResults = persistentScanResults
                         }
                         if ('networkMapper' in item) {
                             item.networkMapper = persistentNetworkMapper
                         }
-                        if ('arpModel' in item) {
-                            item.arpModel = persistentArpModel
-                        }
                         if ('profiledHosts' in item) {
                             item.profiledHosts = persistentProfiledHosts
                         }
-                        if ('topologyNodes' in item) {
-                            item.topologyNodes = persistentTopologyNodes
-                        }
                     }
                 }
             }
@@ -0,0 +1,519 @@
+#include "ActivityArchive.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDir>
+#include <QMap>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const char *const kTimestampFormat = "yyyy-MM-dd hh:mm:ss";
+const char *const kSegmentPattern = "activities-*.db";
+const int kSegmentPrefixLength = 11; // "activities-"
+const int kBatchRows = 2000;         // rows per copy/delete round trip
+const int kPreviewLength = 160;
+const int kBusyTimeoutMs = 5000;
+
+const char *const kCreateTable =
+    "CREATE TABLE IF NOT EXISTS activities ("
+    "id INTEGER PRIMARY KEY, "
+    "timestamp TEXT NOT NULL, "
+    "type TEXT NOT NULL, "
+    "action TEXT NOT NULL, "
+    "target TEXT NOT NULL, "
+    "status TEXT NOT NULL, "
+    "user TEXT NOT NULL, "
+    "preview TEXT NOT NULL, "
+    "output BLOB NOT NULL)";
+// Contentless: the index keeps only terms, the text stays compressed in activities
+const char *const kCreateIndex =
+    "CREATE VIRTUAL TABLE IF NOT EXISTS activities_fts USING fts5("
+    "action, target, output, content='')";
+
+struct ArchivedRow {
+    qint64 id;
+    QString timestamp;
+    QString type;
+    QString action;
+    QString target;
+    QString status;
+    QString user;
+    QString output;
+};
+
+// One pass at a time per process; separate processes stay consistent
+// because rows are copied before they are deleted and copies are idempotent
+QMutex &rolloverMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QString monthOf(const QString &fileName)
+{
+    return fileName.mid(kSegmentPrefixLength, 7);
+}
+
+QString segmentPath(const QString &directory, const QString &month)
+{
+    return directory + "/activities-" + month + ".db";
+}
+
+// Stands in for FTS5 snippet(), which contentless tables can't produce
+QString snippet(const QString &output, const QString &text)
+{
+    static const QRegularExpression termRegex(R"re("([^"]*)"|(\S+))re");
+    QRegularExpressionMatchIterator it = termRegex.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        QString term = match.captured(1).isNull() ? match.captured(2) : match.captured(1);
+        if (match.captured(1).isNull() && term.endsWith('*'))
+            term.chop(1);
+        if (term.trimmed().isEmpty())
+            continue;
+        const int at = output.indexOf(term, 0, Qt::CaseInsensitive);
+        if (at < 0)
+            continue;
+        const int from = qMax(0, at - 60);
+        const int end = at + term.size();
+        QString result = output.mid(from, at - from) + '[' + output.mid(at, term.size()) + ']' + output.mid(end, 60);
+        if (from > 0)
+            result.prepend("...");
+        if (end + 60 < output.size())
+            result.append("...");
+        return result.simplified();
+    }
+    return output.left(kPreviewLength).simplified();
+}
+
+bool writeSegment(const QString &path, const QString &connectionName, const QList<ArchivedRow> &rows)
+{
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+        if (!db.open()) {
+            qWarning() << "Failed to open activity segment" << path << db.lastError().text();
+        } else {
+            QSqlQuery query(db);
+            query.exec(QString("PRAGMA busy_timeout=%1").arg(kBusyTimeoutMs));
+            query.exec("PRAGMA journal_mode=WAL");
+            query.exec(kCreateTable);
+            query.exec("CREATE INDEX IF NOT EXISTS activities_timestamp ON activities(timestamp)");
+            const bool fullText = query.exec(kCreateIndex);
+
+            db.transaction();
+            QSqlQuery insert(db);
+            insert.prepare("INSERT OR IGNORE INTO activities "
+                           "(id, timestamp, type, action, target, status, user, preview, output) "
+                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+            QSqlQuery index(db);
+            index.prepare("INSERT INTO activities_fts(rowid, action, target, output) VALUES (?, ?, ?, ?)");
+            ok = true;
+            for (const ArchivedRow &row : rows) {
+                insert.addBindValue(row.id);
+                insert.addBindValue(row.timestamp);
+                insert.addBindValue(row.type);
+                insert.addBindValue(row.action);
+                insert.addBindValue(row.target);
+                insert.addBindValue(row.status);
+                insert.addBindValue(row.user);
+                insert.addBindValue(row.output.left(kPreviewLength));
+                insert.addBindValue(qCompress(row.output.toUtf8()));
+                if (!insert.exec()) {
+                    qWarning() << "Failed to archive activity:" << insert.lastError().text();
+                    ok = false;
+                    break;
+                }
+                // A row already copied by an interrupted pass is already indexed
+                if (fullText && insert.numRowsAffected() > 0) {
+                    index.addBindValue(row.id);
+                    index.addBindValue(row.action);
+                    index.addBindValue(row.target);
+                    index.addBindValue(row.output);
+                    index.exec();
+                }
+            }
+            ok = ok && db.commit();
+            if (!ok)
+                db.rollback();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+// A month that gets no more rows: merge the FTS b-trees into one, rewrite
+// the file without free pages and drop the WAL so it is a single file
+void sealSegment(const QString &path, const QString &connectionName)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.exec(QString("PRAGMA busy_timeout=%1").arg(kBusyTimeoutMs));
+            query.exec("PRAGMA user_version");
+            if (query.next() && query.value(0).toInt() == 0) {
+                query.exec("INSERT INTO activities_fts(activities_fts) VALUES ('optimize')");
+                if (query.exec("PRAGMA journal_mode=DELETE") && query.exec("VACUUM")) {
+                    query.exec("PRAGMA user_version=1");
+                    qDebug() << "Sealed activity segment" << path;
+                } else {
+                    // Readers held it; the next pass tries again
+                    qWarning() << "Activity segment compaction deferred:" << query.lastError().text();
+                }
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+void rollOverSegments(const QString &hotPath, const QString &directory, const ActivityArchive::Policy &policy)
+{
+    QMutexLocker locker(&rolloverMutex());
+    QDir().mkpath(directory);
+
+    const QString connectionName = QString("ActivityRollover_%1")
+                                       .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    const QString segmentConnection = connectionName + "_segment";
+    int moved = 0;
+    QString newestMonth;
+    {
+        QSqlDatabase hot = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        hot.setDatabaseName(hotPath);
+        if (!hot.open()) {
+            qWarning() << "Activity rollover failed to open database:" << hot.lastError().text();
+        } else {
+            QSqlQuery query(hot);
+            query.exec(QString("PRAGMA busy_timeout=%1").arg(kBusyTimeoutMs));
+
+            // Everything up to cutoff leaves: too old, or beyond the row budget
+            qint64 cutoff = 0;
+            query.prepare("SELECT max(id) FROM activities WHERE timestamp < ?");
+            query.addBindValue(QDateTime::currentDateTime().addDays(-policy.hotDays).toString(kTimestampFormat));
+            if (query.exec() && query.next())
+                cutoff = query.value(0).toLongLong();
+            query.prepare("SELECT id FROM activities ORDER BY id DESC LIMIT 1 OFFSET ?");
+            query.addBindValue(policy.maxHotRows);
+            if (query.exec() && query.next())
+                cutoff = qMax(cutoff, query.value(0).toLongLong());
+
+            while (cutoff > 0) {
+                query.prepare("SELECT id, timestamp, type, action, target, status, user, output "
+                              "FROM activities WHERE id <= ? ORDER BY id LIMIT ?");
+                query.addBindValue(cutoff);
+                query.addBindValue(kBatchRows);
+                if (!query.exec()) {
+                    qWarning() << "Activity rollover failed:" << query.lastError().text();
+                    break;
+                }
+                QMap<QString, QList<ArchivedRow>> months;
+                qint64 first = 0;
+                qint64 last = 0;
+                int count = 0;
+                while (query.next()) {
+                    ArchivedRow row{query.value(0).toLongLong(), query.value(1).toString(),
+                                    query.value(2).toString(), query.value(3).toString(),
+                                    query.value(4).toString(), query.value(5).toString(),
+                                    query.value(6).toString(), query.value(7).toString()};
+                    if (count++ == 0)
+                        first = row.id;
+                    last = row.id;
+                    months[row.timestamp.left(7)] << row;
+                }
+                if (count == 0)
+                    break;
+
+                bool written = true;
+                for (auto it = months.cbegin(); it != months.cend() && written; ++it) {
+                    written = writeSegment(segmentPath(directory, it.key()), segmentConnection, it.value());
+                    newestMonth = qMax(newestMonth, it.key());
+                }
+                if (!written)
+                    break;
+
+                // Copied first, deleted second: a crash in between leaves a row
+                // in both places, which searches skip by id, never in neither
+                hot.transaction();
+                query.prepare("DELETE FROM activities WHERE id BETWEEN ? AND ?");
+                query.addBindValue(first);
+                query.addBindValue(last);
+                if (!query.exec() || !hot.commit()) {
+                    qWarning() << "Activity rollover failed to trim:" << query.lastError().text();
+                    hot.rollback();
+                    break;
+                }
+                moved += count;
+                if (count < kBatchRows)
+                    break;
+            }
+
+            if (moved > 0) {
+                query.exec("PRAGMA incremental_vacuum");
+                query.exec("PRAGMA wal_checkpoint(TRUNCATE)");
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    const QStringList names = QDir(directory).entryList({kSegmentPattern}, QDir::Files, QDir::Name);
+    // Rows move in id order, so months before the newest one written are complete
+    if (!newestMonth.isEmpty()) {
+        for (const QString &name : names) {
+            if (monthOf(name) < newestMonth)
+                sealSegment(directory + '/' + name, segmentConnection);
+        }
+    }
+    if (policy.retentionMonths > 0) {
+        const QString oldest = QDate::currentDate().addMonths(-policy.retentionMonths).toString("yyyy-MM");
+        QDir dir(directory);
+        for (const QString &name : names) {
+            if (monthOf(name) >= oldest)
+                continue;
+            qDebug() << "Removing expired activity segment" << name;
+            dir.remove(name);
+            dir.remove(name + "-wal");
+            dir.remove(name + "-shm");
+        }
+    }
+    if (moved > 0)
+        qDebug() << "Archived" << moved << "activity entries";
+}
+}
+
+ActivityArchive::ActivityArchive(const QString &hotPath, const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_hotPath(hotPath)
+    , m_directory(directory)
+{
+    m_worker.setMaxThreadCount(1);
+}
+
+ActivityArchive::~ActivityArchive()
+{
+    m_worker.waitForDone();
+    closeSegments();
+}
+
+QList<ActivityArchive::Segment> ActivityArchive::segments(const QDateTime &since, const QDateTime &until) const
+{
+    const QStringList names = QDir(m_directory).entryList({kSegmentPattern}, QDir::Files,
+                                                          QDir::Name | QDir::Reversed);
+    QSet<QString> months;
+    for (const QString &name : names)
+        months.insert(monthOf(name));
+
+    // Drop connections to segments that retention or another logger removed
+    for (auto it = m_segments.begin(); it != m_segments.end();) {
+        if (months.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        const QString connectionName = it->database.connectionName();
+        it->database.close();
+        it = m_segments.erase(it);
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+
+    const QString from = since.isValid() ? since.toString("yyyy-MM") : QString();
+    const QString to = until.isValid() ? until.toString("yyyy-MM") : QString();
+    QList<Segment> result;
+    for (const QString &name : names) {
+        const QString month = monthOf(name);
+        if ((!from.isEmpty() && month < from) || (!to.isEmpty() && month > to))
+            continue;
+        auto it = m_segments.find(month);
+        if (it == m_segments.end()) {
+            Segment segment;
+            segment.month = month;
+            segment.database = QSqlDatabase::addDatabase(
+                "QSQLITE", QString("ActivitySegment_%1_%2").arg(reinterpret_cast<quintptr>(this)).arg(month));
+            segment.database.setDatabaseName(m_directory + '/' + name);
+            if (!segment.database.open())
+                qWarning() << "Failed to open activity segment" << name << segment.database.lastError().text();
+            QSqlQuery query(segment.database);
+            query.exec(QString("PRAGMA busy_timeout=%1").arg(kBusyTimeoutMs));
+            query.exec("SELECT 1 FROM sqlite_master WHERE name = 'activities_fts'");
+            segment.fullText = query.next();
+            it = m_segments.insert(month, segment);
+        }
+        result << *it;
+    }
+    return result;
+}
+
+void ActivityArchive::closeSegments()
+{
+    QStringList connectionNames;
+    for (Segment &segment : m_segments) {
+        connectionNames << segment.database.connectionName();
+        segment.database.close();
+    }
+    m_segments.clear();
+    for (const QString &connectionName : std::as_const(connectionNames))
+        QSqlDatabase::removeDatabase(connectionName);
+}
+
+QList<QVariantMap> ActivityArchive::search(const ActivityFilter &filter, const QString &match, qint64 beforeId, int limit) const
+{
+    QList<QVariantMap> rows;
+    qint64 cursor = beforeId;
+    const QString like = filter.text.trimmed();
+    // Newest month first; each segment only holds ids older than the one before
+    for (const Segment &segment : segments(filter.since, filter.until)) {
+        if (rows.size() >= limit)
+            break;
+
+        const bool indexed = segment.fullText && !match.isEmpty();
+        QString sql;
+        QStringList where;
+        QVariantList values;
+        if (indexed) {
+            sql = "SELECT a.id, a.timestamp, a.type, a.action, a.target, a.status, a.user, a.preview, a.output "
+                  "FROM activities_fts JOIN activities a ON a.id = activities_fts.rowid";
+            where << "activities_fts MATCH ?";
+            values << match;
+        } else {
+            sql = "SELECT a.id, a.timestamp, a.type, a.action, a.target, a.status, a.user, a.preview, NULL "
+                  "FROM activities a";
+            // Output is compressed, so without the index only action and target match
+            if (!segment.fullText && !like.isEmpty()) {
+                where << "(a.action LIKE ? OR a.target LIKE ?)";
+                const QString pattern = '%' + like + '%';
+                values << pattern << pattern;
+            }
+        }
+        if (!filter.type.isEmpty()) {
+            where << "a.type = ?";
+            values << filter.type;
+        }
+        if (!filter.status.isEmpty()) {
+            where << "a.status = ?";
+            values << filter.status;
+        }
+        if (filter.since.isValid()) {
+            where << "a.timestamp >= ?";
+            values << filter.since.toString(kTimestampFormat);
+        }
+        if (filter.until.isValid()) {
+            where << "a.timestamp < ?";
+            values << filter.until.toString(kTimestampFormat);
+        }
+        const QString idColumn = indexed ? "activities_fts.rowid" : "a.id";
+        if (cursor > 0) {
+            where << idColumn + " < ?";
+            values << cursor;
+        }
+        if (!where.isEmpty())
+            sql += " WHERE " + where.join(" AND ");
+        sql += " ORDER BY " + idColumn + " DESC LIMIT " + QString::number(limit - rows.size());
+
+        QSqlQuery query(segment.database);
+        query.prepare(sql);
+        for (const QVariant &value : std::as_const(values))
+            query.addBindValue(value);
+        if (!query.exec()) {
+            qWarning() << "Archived activity search failed:" << segment.month << query.lastError().text();
+            continue;
+        }
+        while (query.next()) {
+            cursor = query.value(0).toLongLong();
+            const QString preview = indexed
+                ? snippet(QString::fromUtf8(qUncompress(query.value(8).toByteArray())), filter.text)
+                : query.value(7).toString().simplified();
+            rows << QVariantMap{
+                {"id", cursor},
+                {"timestamp", query.value(1).toString()},
+                {"type", query.value(2).toString()},
+                {"action", query.value(3).toString()},
+                {"target", query.value(4).toString()},
+                {"status", query.value(5).toString()},
+                {"user", query.value(6).toString()},
+                {"snippet", preview},
+            };
+        }
+    }
+    return rows;
+}
+
+QSet<QString> ActivityArchive::targets(const QString &text, const QString &match, const QDateTime &since, const QDateTime &until) const
+{
+    QSet<QString> targets;
+    for (const Segment &segment : segments(since, until)) {
+        QStringList where;
+        QVariantList values;
+        if (segment.fullText && !match.isEmpty()) {
+            where << "a.id IN (SELECT rowid FROM activities_fts WHERE activities_fts MATCH ?)";
+            values << match;
+        } else if (!segment.fullText && !text.trimmed().isEmpty()) {
+            where << "(a.action LIKE ? OR a.target LIKE ?)";
+            const QString pattern = '%' + text.trimmed() + '%';
+            values << pattern << pattern;
+        }
+        if (since.isValid()) {
+            where << "a.timestamp >= ?";
+            values << since.toString(kTimestampFormat);
+        }
+        if (until.isValid()) {
+            where << "a.timestamp < ?";
+            values << until.toString(kTimestampFormat);
+        }
+
+        QString sql = "SELECT DISTINCT a.target FROM activities a";
+        if (!where.isEmpty())
+            sql += " WHERE " + where.join(" AND ");
+
+        QSqlQuery query(segment.database);
+        query.prepare(sql);
+        for (const QVariant &value : std::as_const(values))
+            query.addBindValue(value);
+        if (!query.exec()) {
+            qWarning() << "Archived activity target search failed:" << segment.month << query.lastError().text();
+            continue;
+        }
+        while (query.next())
+            targets.insert(query.value(0).toString());
+    }
+    return targets;
+}
+
+QString ActivityArchive::output(qint64 id) const
+{
+    for (const Segment &segment : segments(QDateTime(), QDateTime())) {
+        QSqlQuery query(segment.database);
+        query.prepare("SELECT output FROM activities WHERE id = ?");
+        query.addBindValue(id);
+        if (query.exec() && query.next())
+            return QString::fromUtf8(qUncompress(query.value(0).toByteArray()));
+    }
+    return QString();
+}
+
+void ActivityArchive::rollOver(const Policy &policy)
+{
+    // A timer firing while the first, long pass still runs is dropped
+    if (m_worker.activeThreadCount() > 0)
+        return;
+
+    const QString hotPath = m_hotPath;
+    const QString directory = m_directory;
+    QRunnable *task = QRunnable::create([hotPath, directory, policy]() {
+        rollOverSegments(hotPath, directory, policy);
+    });
+    task->setAutoDelete(true);
+    m_worker.start(task);
+}
+
+void ActivityArchive::clear()
+{
+    m_worker.waitForDone();
+    QMutexLocker locker(&rolloverMutex());
+    closeSegments();
+    QDir dir(m_directory);
+    for (const QString &name : dir.entryList({"activities-*"}, QDir::Files))
+        dir.remove(name);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+#include <QVariantMap>
+#include "ActivityLogger.h"
+
+// Cold half of the activity log: one SQLite file per calendar month under
+// activity-archive/, with job output zlib-compressed and action, target and
+// output kept in a contentless FTS5 index. Rows move here from the hot
+// table in id order, so every archived id is older than every hot one.
+class ActivityArchive : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Policy {
+        int hotDays = 30;          // entries older than this leave the hot table
+        int maxHotRows = 100000;   // and so does anything beyond this many rows
+        int retentionMonths = 0;   // segments older than this are deleted, 0 keeps all
+    };
+
+    ActivityArchive(const QString &hotPath, const QString &directory, QObject *parent = nullptr);
+    ~ActivityArchive();
+
+    // Same contract as ActivityLogger::search, over the segments newest
+    // first; match is the FTS5 form of filter.text, empty without FTS5
+    QList<QVariantMap> search(const ActivityFilter &filter, const QString &match, qint64 beforeId, int limit) const;
+    QSet<QString> targets(const QString &text, const QString &match, const QDateTime &since, const QDateTime &until) const;
+    QString output(qint64 id) const;
+
+    // Moves rows past the policy into segments, then seals and compacts
+    // segments that will get no more rows. Runs on a worker thread.
+    void rollOver(const Policy &policy);
+    // Deletes every segment, after any running rollover has finished
+    void clear();
+
+private:
+    struct Segment {
+        QString month;
+        QSqlDatabase database;
+        bool fullText = false;
+    };
+
+    QList<Segment> segments(const QDateTime &since, const QDateTime &until) const;
+    void closeSegments();
+
+    QString m_hotPath;
+    QString m_directory;
+    mutable QHash<QString, Segment> m_segments; // read connections by month
+    QThreadPool m_worker;
+};
@@ -1,17 +1,70 @@
 #include "ActivityLogger.h"
+#include "ActivityArchive.h"
+#include "RemoteExecutor.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QStandardPaths>
 #include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QTimer>
 #include <QDebug>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QRegularExpression>
+
+namespace {
+const char *const kTimestampFormat = "yyyy-MM-dd hh:mm:ss";
+const int kMaxStoredOutput = 1024 * 1024; // tail kept per job
+const int kFirstRolloverMs = 30 * 1000;   // clear of startup work
+const int kRolloverIntervalMs = 60 * 60 * 1000;
+
+// User text as an FTS5 query: every term quoted so operators and column
+// filters typed by accident stay literal; a trailing * keeps prefix search
+QString ftsQuery(const QString &text)
+{
+    static const QRegularExpression termRegex(R"re("([^"]*)"|(\S+))re");
+    QStringList terms;
+    QRegularExpressionMatchIterator it = termRegex.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        QString term = match.captured(1).isNull() ? match.captured(2) : match.captured(1);
+        const bool prefix = match.captured(1).isNull() && term.endsWith('*') && term.size() > 1;
+        if (prefix)
+            term.chop(1);
+        if (term.trimmed().isEmpty())
+            continue;
+        term.replace('"', "\"\"");
+        terms << '"' + term + '"' + (prefix ? "*" : "");
+    }
+    return terms.join(' ');
+}
+
+const char *const kDeleteTrigger =
+    "CREATE TRIGGER IF NOT EXISTS activities_fts_delete AFTER DELETE ON activities BEGIN "
+    "INSERT INTO activities_fts(activities_fts, rowid, action, target, output) "
+    "VALUES ('delete', old.id, old.action, old.target, old.output); END";
+
+QString jobCategory(const QString &type)
+{
+    return type.startsWith("File") ? "file" : "execution";
+}
+}
 
 ActivityLogger::ActivityLogger(QObject *parent)
     : QObject(parent)
+    , m_fullText(false)
 {
     initDatabase();
     loadActivities();
+
+    m_archive = new ActivityArchive(m_database.databaseName(),
+                                    QFileInfo(m_database.databaseName()).absolutePath() + "/activity-archive", this);
+    m_rolloverTimer = new QTimer(this);
+    m_rolloverTimer->setInterval(kRolloverIntervalMs);
+    connect(m_rolloverTimer, &QTimer::timeout, this, &ActivityLogger::rollOver);
+    m_rolloverTimer->start();
+    QTimer::singleShot(kFirstRolloverMs, this, &ActivityLogger::rollOver);
 }
 
 void ActivityLogger::initDatabase()
@@ -29,6 +82,11 @@ void ActivityLogger::initDatabase()
     }
     
     QSqlQuery query(m_database);
+    // Takes effect on a new database only; lets rollover hand pages back
+    query.exec("PRAGMA auto_vacuum=INCREMENTAL");
+    // Every page keeps its own connection; WAL lets them read while one writes
+    query.exec("PRAGMA journal_mode=WAL");
+    query.exec("PRAGMA synchronous=NORMAL");
     query.exec("CREATE TABLE IF NOT EXISTS activities ("
                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                "timestamp TEXT NOT NULL, "
@@ -36,18 +94,55 @@ void ActivityLogger::initDatabase()
                "action TEXT NOT NULL, "
                "target TEXT NOT NULL, "
                "status TEXT NOT NULL, "
-               "user TEXT NOT NULL)");
+               "user TEXT NOT NULL, "
+               "output TEXT NOT NULL DEFAULT '')");
+
+    // Databases from before job output was kept
+    bool hasOutput = false;
+    query.exec("PRAGMA table_info(activities)");
+    while (query.next())
+        hasOutput = hasOutput || query.value(1).toString() == "output";
+    if (!hasOutput)
+        query.exec("ALTER TABLE activities ADD COLUMN output TEXT NOT NULL DEFAULT ''");
+    query.exec("CREATE INDEX IF NOT EXISTS activities_timestamp ON activities(timestamp)");
+
+    // External-content index: the text lives once, in activities
+    query.exec("SELECT 1 FROM sqlite_master WHERE name = 'activities_fts'");
+    const bool indexed = query.next();
+    if (!indexed && !query.exec("CREATE VIRTUAL TABLE activities_fts USING fts5("
+                                "action, target, output, content='activities', content_rowid='id')")) {
+        qWarning() << "FTS5 unavailable, activity search scans the table:" << query.lastError().text();
+        return;
+    }
+    query.exec("CREATE TRIGGER IF NOT EXISTS activities_fts_insert AFTER INSERT ON activities BEGIN "
+               "INSERT INTO activities_fts(rowid, action, target, output) "
+               "VALUES (new.id, new.action, new.target, new.output); END");
+    query.exec(kDeleteTrigger);
+    query.exec("CREATE TRIGGER IF NOT EXISTS activities_fts_update AFTER UPDATE ON activities BEGIN "
+               "INSERT INTO activities_fts(activities_fts, rowid, action, target, output) "
+               "VALUES ('delete', old.id, old.action, old.target, old.output); "
+               "INSERT INTO activities_fts(rowid, action, target, output) "
+               "VALUES (new.id, new.action, new.target, new.output); END");
+    if (!indexed)
+        query.exec("INSERT INTO activities_fts(activities_fts) VALUES ('rebuild')");
+    m_fullText = true;
 }
 
 void ActivityLogger::logActivity(const QString &type, const QString &action, const QString &target, const QString &status, const QString &user)
 {
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    logOutput(type, action, target, status, QString(), user);
+}
+
+void ActivityLogger::logOutput(const QString &type, const QString &action, const QString &target, const QString &status, const QString &output, const QString &user)
+{
+    QString timestamp = QDateTime::currentDateTime().toString(kTimestampFormat);
     
     // Save to database
-    saveActivity(timestamp, type, action, target, status, user);
+    const qint64 id = saveActivity(timestamp, type, action, target, status, user, output.right(kMaxStoredOutput));
     
     // Add to current activities array
     QJsonObject activity;
+    activity["id"] = id;
     activity["timestamp"] = timestamp;
     activity["type"] = type;
     activity["action"] = action;
@@ -69,20 +164,23 @@ void ActivityLogger::logActivity(const QString &type, const QString &action, con
     emit activitiesChanged();
 }
 
-void ActivityLogger::saveActivity(const QString &timestamp, const QString &type, const QString &action, const QString &target, const QString &status, const QString &user)
+qint64 ActivityLogger::saveActivity(const QString &timestamp, const QString &type, const QString &action, const QString &target, const QString &status, const QString &user, const QString &output)
 {
     QSqlQuery query(m_database);
-    query.prepare("INSERT INTO activities (timestamp, type, action, target, status, user) VALUES (?, ?, ?, ?, ?, ?)");
+    query.prepare("INSERT INTO activities (timestamp, type, action, target, status, user, output) VALUES (?, ?, ?, ?, ?, ?, ?)");
     query.addBindValue(timestamp);
     query.addBindValue(type);
     query.addBindValue(action);
     query.addBindValue(target);
     query.addBindValue(status);
     query.addBindValue(user);
+    query.addBindValue(output);
     
     if (!query.exec()) {
         qWarning() << "Failed to save activity:" << query.lastError().text();
+        return 0;
     }
+    return query.lastInsertId().toLongLong();
 }
 
 void ActivityLogger::loadActivities()
@@ -90,7 +188,7 @@ void ActivityLogger::loadActivities()
     m_activities = QJsonArray();
     
     QSqlQuery query(m_database);
-    query.exec("SELECT timestamp, type, action, target, status, user FROM activities ORDER BY timestamp DESC LIMIT 100");
+    query.exec("SELECT timestamp, type, action, target, status, user, id FROM activities ORDER BY timestamp DESC LIMIT 100");
     
     while (query.next()) {
         QJsonObject activity;
@@ -100,6 +198,7 @@ void ActivityLogger::loadActivities()
         activity["target"] = query.value(3).toString();
         activity["status"] = query.value(4).toString();
         activity["user"] = query.value(5).toString();
+        activity["id"] = query.value(6).toLongLong();
         
         m_activities.append(activity);
     }
@@ -118,8 +217,204 @@ ActivityLogger::~ActivityLogger()
 void ActivityLogger::clearActivities()
 {
     QSqlQuery query(m_database);
-    query.exec("DELETE FROM activities");
+    if (m_fullText) {
+        // Emptying the index in one step beats a delete trigger per row
+        m_database.transaction();
+        query.exec("DROP TRIGGER IF EXISTS activities_fts_delete");
+        query.exec("DELETE FROM activities");
+        query.exec("INSERT INTO activities_fts(activities_fts) VALUES ('delete-all')");
+        query.exec(kDeleteTrigger);
+        m_database.commit();
+    } else {
+        query.exec("DELETE FROM activities");
+    }
+    
+    m_archive->clear();
     
     m_activities = QJsonArray();
     emit activitiesChanged();
 }
+
+void ActivityLogger::rollOver()
+{
+    QSettings settings;
+    ActivityArchive::Policy policy;
+    policy.hotDays = settings.value("activity/hotDays", policy.hotDays).toInt();
+    policy.maxHotRows = settings.value("activity/maxHotRows", policy.maxHotRows).toInt();
+    policy.retentionMonths = settings.value("activity/retentionMonths", policy.retentionMonths).toInt();
+    m_archive->rollOver(policy);
+}
+
+QList<QVariantMap> ActivityLogger::search(const ActivityFilter &filter, qint64 beforeId, int limit) const
+{
+    const QString match = m_fullText ? ftsQuery(filter.text) : QString();
+    const QString like = m_fullText ? QString() : filter.text.trimmed();
+
+    // With a text query FTS5 walks its rowids newest first and stops at the limit
+    QString sql;
+    QStringList where;
+    QVariantList values;
+    if (!match.isEmpty()) {
+        sql = "SELECT a.id, a.timestamp, a.type, a.action, a.target, a.status, a.user, "
+              "snippet(activities_fts, -1, '[', ']', '...', 12) "
+              "FROM activities_fts JOIN activities a ON a.id = activities_fts.rowid";
+        where << "activities_fts MATCH ?";
+        values << match;
+    } else {
+        sql = "SELECT a.id, a.timestamp, a.type, a.action, a.target, a.status, a.user, substr(a.output, 1, 160) "
+              "FROM activities a";
+        if (!like.isEmpty()) {
+            where << "(a.action LIKE ? OR a.target LIKE ? OR a.output LIKE ?)";
+            const QString pattern = '%' + like + '%';
+            values << pattern << pattern << pattern;
+        }
+    }
+    if (!filter.type.isEmpty()) {
+        where << "a.type = ?";
+        values << filter.type;
+    }
+    if (!filter.status.isEmpty()) {
+        where << "a.status = ?";
+        values << filter.status;
+    }
+    if (filter.since.isValid()) {
+        where << "a.timestamp >= ?";
+        values << filter.since.toString(kTimestampFormat);
+    }
+    if (filter.until.isValid()) {
+        where << "a.timestamp < ?";
+        values << filter.until.toString(kTimestampFormat);
+    }
+    const QString idColumn = match.isEmpty() ? "a.id" : "activities_fts.rowid";
+    if (beforeId > 0) {
+        where << idColumn + " < ?";
+        values << beforeId;
+    }
+    if (!where.isEmpty())
+        sql += " WHERE " + where.join(" AND ");
+    sql += " ORDER BY " + idColumn + " DESC LIMIT " + QString::number(qMax(1, limit));
+
+    QSqlQuery query(m_database);
+    query.prepare(sql);
+    for (const QVariant &value : std::as_const(values))
+        query.addBindValue(value);
+    QList<QVariantMap> rows;
+    if (!query.exec()) {
+        qWarning() << "Activity search failed:" << query.lastError().text();
+        return rows;
+    }
+    while (query.next()) {
+        rows << QVariantMap{
+            {"id", query.value(0).toLongLong()},
+            {"timestamp", query.value(1).toString()},
+            {"type", query.value(2).toString()},
+            {"action", query.value(3).toString()},
+            {"target", query.value(4).toString()},
+            {"status", query.value(5).toString()},
+            {"user", query.value(6).toString()},
+            {"snippet", query.value(7).toString().simplified()},
+        };
+    }
+    // Archived ids are all older than the hot ones, so the page just continues there
+    if (rows.size() < limit) {
+        const qint64 cursor = rows.isEmpty() ? beforeId : rows.last().value("id").toLongLong();
+        rows += m_archive->search(filter, match, cursor, qMax(1, limit) - rows.size());
+    }
+    return rows;
+}
+
+QStringList ActivityLogger::searchTargets(const QString &text, const QDateTime &since, const QDateTime &until) const
+{
+    QStringList where;
+    QVariantList values;
+    const QString match = m_fullText ? ftsQuery(text) : QString();
+    if (!match.isEmpty()) {
+        where << "a.id IN (SELECT rowid FROM activities_fts WHERE activities_fts MATCH ?)";
+        values << match;
+    } else if (!text.trimmed().isEmpty()) {
+        where << "(a.action LIKE ? OR a.target LIKE ? OR a.output LIKE ?)";
+        const QString pattern = '%' + text.trimmed() + '%';
+        values << pattern << pattern << pattern;
+    }
+    if (since.isValid()) {
+        where << "a.timestamp >= ?";
+        values << since.toString(kTimestampFormat);
+    }
+    if (until.isValid()) {
+        where << "a.timestamp < ?";
+        values << until.toString(kTimestampFormat);
+    }
+
+    QString sql = "SELECT DISTINCT a.target FROM activities a";
+    if (!where.isEmpty())
+        sql += " WHERE " + where.join(" AND ");
+    sql += " ORDER BY a.target";
+
+    QSqlQuery query(m_database);
+    query.prepare(sql);
+    for (const QVariant &value : std::as_const(values))
+        query.addBindValue(value);
+    QStringList targets;
+    if (!query.exec()) {
+        qWarning() << "Activity target search failed:" << query.lastError().text();
+        return targets;
+    }
+    while (query.next())
+        targets << query.value(0).toString();
+
+    QSet<QString> archived = m_archive->targets(text, match, since, until);
+    if (!archived.isEmpty()) {
+        for (const QString &target : std::as_const(targets))
+            archived.insert(target);
+        targets = archived.values();
+        targets.sort();
+    }
+    return targets;
+}
+
+QString ActivityLogger::output(qint64 id) const
+{
+    QSqlQuery query(m_database);
+    query.prepare("SELECT output FROM activities WHERE id = ?");
+    query.addBindValue(id);
+    if (query.exec() && query.next())
+        return query.value(0).toString();
+    return m_archive->output(id);
+}
+
+void ActivityLogger::watchExecutor(RemoteExecutor *executor)
+{
+    if (!executor)
+        return;
+    connect(executor, &RemoteExecutor::jobStarted, this, [this](int jobId, const QString &type, const QString &target) {
+        m_watchedJobs.insert(jobId, {type, target});
+        logActivity(jobCategory(type), type, target, "started");
+    });
+    connect(executor, &RemoteExecutor::outputReceived, this, [this](int jobId, const QString &output) {
+        auto it = m_watchedJobs.find(jobId);
+        if (it == m_watchedJobs.end())
+            return;
+        it->output += output;
+        if (it->output.size() > kMaxStoredOutput)
+            it->output = it->output.right(kMaxStoredOutput);
+    });
+    // Both outcomes keep everything the job printed on either stream
+    connect(executor, &RemoteExecutor::jobCompleted, this, [this](int jobId, const QString &output) {
+        const WatchedJob job = m_watchedJobs.take(jobId);
+        if (job.type.isEmpty())
+            return;
+        QString stored = job.output;
+        if (!stored.contains(output))
+            stored += (stored.isEmpty() || stored.endsWith('\n') ? "" : "\n") + output; // e.g. a fan-out summary
+        logOutput(jobCategory(job.type), job.type, job.target, "success", stored);
+    });
+    connect(executor, &RemoteExecutor::jobFailed, this, [this](int jobId, const QString &error) {
+        const WatchedJob job = m_watchedJobs.take(jobId);
+        if (job.type.isEmpty())
+            return;
+        QString stored = job.output;
+        if (!stored.contains(error))
+            stored += (stored.isEmpty() || stored.endsWith('\n') ? "" : "\n") + error;
+        logOutput(jobCategory(job.type), job.type, job.target, "failed", stored);
+    });
+}
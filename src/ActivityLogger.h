@@ -4,30 +4,78 @@
 #include <QSqlDatabase>
 #include <QJsonArray>
 #include <QDateTime>
+#include <QHash>
+#include <QVariantMap>
 
+class RemoteExecutor;
+class ActivityArchive;
+class QTimer;
+
+// What ActivityLogger::search matches; empty fields don't filter
+struct ActivityFilter {
+    QString text;        // words, "quoted phrases" and prefix* terms, all required
+    QString type;
+    QString status;
+    QDateTime since;
+    QDateTime until;
+};
+
+// Audit log in SQLite. Job output is stored with the activity that ends
+// the job, and action, target and output are indexed with FTS5, so text
+// searches stay fast however long the log gets. Recent entries live in a
+// bounded hot table; older ones roll over into compressed monthly
+// segments (see ActivityArchive) that searches read transparently.
 class ActivityLogger : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QJsonArray activities READ activities NOTIFY activitiesChanged)
+    Q_PROPERTY(bool fullTextSearch READ fullTextSearch CONSTANT)
 
 public:
     explicit ActivityLogger(QObject *parent = nullptr);
     ~ActivityLogger();
-    
+
     QJsonArray activities() const { return m_activities; }
+    // False when the SQLite build lacks FTS5; search then falls back to LIKE
+    bool fullTextSearch() const { return m_fullText; }
+
+    // Newest first, only rows with an id below beforeId when it is set.
+    // Rows carry id, timestamp, type, action, target, status, user and
+    // snippet, the matching part of the output with hits in [brackets].
+    QList<QVariantMap> search(const ActivityFilter &filter, qint64 beforeId = 0, int limit = 100) const;
+
+    // Distinct targets with a matching entry, e.g. hosts that printed an error
+    Q_INVOKABLE QStringList searchTargets(const QString &text, const QDateTime &since = QDateTime(),
+                                          const QDateTime &until = QDateTime()) const;
+    Q_INVOKABLE QString output(qint64 id) const;
+    // Logs every job of executor, with its output once it ends
+    Q_INVOKABLE void watchExecutor(RemoteExecutor *executor);
 
 public slots:
     void logActivity(const QString &type, const QString &action, const QString &target, const QString &status, const QString &user = "admin");
+    void logOutput(const QString &type, const QString &action, const QString &target, const QString &status, const QString &output, const QString &user = "admin");
     void loadActivities();
     void clearActivities();
+    // Moves entries past the retention settings into the archive, in the background
+    void rollOver();
 
 signals:
     void activitiesChanged();
 
 private:
+    struct WatchedJob {
+        QString type;
+        QString target;
+        QString output;  // stdout and stderr as they streamed in
+    };
+
     void initDatabase();
-    void saveActivity(const QString &timestamp, const QString &type, const QString &action, const QString &target, const QString &status, const QString &user);
-    
+    qint64 saveActivity(const QString &timestamp, const QString &type, const QString &action, const QString &target, const QString &status, const QString &user, const QString &output);
+
     QSqlDatabase m_database;
+    ActivityArchive *m_archive;
+    QTimer *m_rolloverTimer;
     QJsonArray m_activities;
-};
\ No newline at end of file
+    bool m_fullText;
+    QHash<int, WatchedJob> m_watchedJobs;
+};
@@ -0,0 +1,157 @@
+#include "ActivitySearchModel.h"
+#include <QElapsedTimer>
+
+namespace {
+const int kPageSize = 100;
+const int kDebounceMs = 150; // one query per pause in typing
+}
+
+ActivitySearchModel::ActivitySearchModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_exhausted(true)
+    , m_elapsedMs(0)
+{
+    m_debounce = new QTimer(this);
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(kDebounceMs);
+    connect(m_debounce, &QTimer::timeout, this, &ActivitySearchModel::refresh);
+}
+
+int ActivitySearchModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant ActivitySearchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return QVariant();
+
+    const QVariantMap &row = m_rows.at(index.row());
+    switch (role) {
+    case IdRole: return row.value("id");
+    case TimestampRole: return row.value("timestamp");
+    case TypeRole: return row.value("type");
+    case ActionRole: return row.value("action");
+    case TargetRole: return row.value("target");
+    case StatusRole: return row.value("status");
+    case UserNameRole: return row.value("user");
+    case SnippetRole: return row.value("snippet");
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> ActivitySearchModel::roleNames() const
+{
+    return {
+        {IdRole, "id"},
+        {TimestampRole, "timestamp"},
+        {TypeRole, "type"},
+        {ActionRole, "action"},
+        {TargetRole, "target"},
+        {StatusRole, "status"},
+        {UserNameRole, "user"},
+        {SnippetRole, "snippet"},
+    };
+}
+
+bool ActivitySearchModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_exhausted && m_logger;
+}
+
+void ActivitySearchModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent) || m_rows.isEmpty())
+        return;
+
+    const qint64 lastId = m_rows.last().value("id").toLongLong();
+    const QList<QVariantMap> page = m_logger->search(m_filter, lastId, kPageSize);
+    m_exhausted = page.size() < kPageSize;
+    if (page.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + page.size() - 1);
+    m_rows += page;
+    endInsertRows();
+    emit countChanged();
+}
+
+void ActivitySearchModel::setLogger(ActivityLogger *logger)
+{
+    if (logger == m_logger)
+        return;
+    if (m_logger)
+        m_logger->disconnect(this);
+    m_logger = logger;
+    // New entries land at the top, so the first page is simply read again
+    if (logger)
+        connect(logger, &ActivityLogger::activitiesChanged, this, &ActivitySearchModel::scheduleRefresh);
+    emit loggerChanged();
+    refresh();
+}
+
+void ActivitySearchModel::setText(const QString &text)
+{
+    if (text == m_filter.text)
+        return;
+    m_filter.text = text;
+    emit filterChanged();
+    scheduleRefresh();
+}
+
+void ActivitySearchModel::setType(const QString &type)
+{
+    if (type == m_filter.type)
+        return;
+    m_filter.type = type;
+    emit filterChanged();
+    scheduleRefresh();
+}
+
+void ActivitySearchModel::setStatus(const QString &status)
+{
+    if (status == m_filter.status)
+        return;
+    m_filter.status = status;
+    emit filterChanged();
+    scheduleRefresh();
+}
+
+void ActivitySearchModel::setSince(const QDateTime &since)
+{
+    if (since == m_filter.since)
+        return;
+    m_filter.since = since;
+    emit filterChanged();
+    scheduleRefresh();
+}
+
+void ActivitySearchModel::setUntil(const QDateTime &until)
+{
+    if (until == m_filter.until)
+        return;
+    m_filter.until = until;
+    emit filterChanged();
+    scheduleRefresh();
+}
+
+void ActivitySearchModel::scheduleRefresh()
+{
+    m_debounce->start();
+}
+
+void ActivitySearchModel::refresh()
+{
+    m_debounce->stop();
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    beginResetModel();
+    m_rows = m_logger ? m_logger->search(m_filter, 0, kPageSize) : QList<QVariantMap>();
+    m_exhausted = m_rows.size() < kPageSize;
+    endResetModel();
+
+    m_elapsedMs = int(elapsed.elapsed());
+    emit countChanged();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantMap>
+#include "ActivityLogger.h"
+
+// Paged view over ActivityLogger::search. Only the first page is queried
+// when the filter changes; views pull the next page through fetchMore
+// as they scroll, keyed on the last id so deep pages cost the same.
+class ActivitySearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(ActivityLogger *logger READ logger WRITE setLogger NOTIFY loggerChanged)
+    Q_PROPERTY(QString text READ text WRITE setText NOTIFY filterChanged)
+    Q_PROPERTY(QString type READ type WRITE setType NOTIFY filterChanged)
+    Q_PROPERTY(QString status READ status WRITE setStatus NOTIFY filterChanged)
+    Q_PROPERTY(QDateTime since READ since WRITE setSince NOTIFY filterChanged)
+    Q_PROPERTY(QDateTime until READ until WRITE setUntil NOTIFY filterChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int elapsedMs READ elapsedMs NOTIFY countChanged)
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,
+        TimestampRole,
+        TypeRole,
+        ActionRole,
+        TargetRole,
+        StatusRole,
+        UserNameRole,
+        SnippetRole
+    };
+    Q_ENUM(Roles)
+
+    explicit ActivitySearchModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    ActivityLogger *logger() const { return m_logger; }
+    void setLogger(ActivityLogger *logger);
+    QString text() const { return m_filter.text; }
+    void setText(const QString &text);
+    QString type() const { return m_filter.type; }
+    void setType(const QString &type);
+    QString status() const { return m_filter.status; }
+    void setStatus(const QString &status);
+    QDateTime since() const { return m_filter.since; }
+    void setSince(const QDateTime &since);
+    QDateTime until() const { return m_filter.until; }
+    void setUntil(const QDateTime &until);
+    int count() const { return m_rows.size(); }
+    // How long the first page took, for the view's status line
+    int elapsedMs() const { return m_elapsedMs; }
+
+public slots:
+    void refresh();
+
+signals:
+    void loggerChanged();
+    void filterChanged();
+    void countChanged();
+
+private:
+    void scheduleRefresh();
+
+    QPointer<ActivityLogger> m_logger;
+    ActivityFilter m_filter;
+    QList<QVariantMap> m_rows;
+    bool m_exhausted;
+    int m_elapsedMs;
+    QTimer *m_debounce;
+};
@@ -0,0 +1,291 @@
+#include "Aead.h"
+#include <cstring>
+
+namespace {
+
+inline quint32 load32(const quint8 *p)
+{
+    return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+}
+
+inline void store32(quint8 *p, quint32 v)
+{
+    p[0] = quint8(v);
+    p[1] = quint8(v >> 8);
+    p[2] = quint8(v >> 16);
+    p[3] = quint8(v >> 24);
+}
+
+inline void store64(quint8 *p, quint64 v)
+{
+    store32(p, quint32(v));
+    store32(p + 4, quint32(v >> 32));
+}
+
+inline quint32 rotl(quint32 v, int c)
+{
+    return (v << c) | (v >> (32 - c));
+}
+
+inline void quarterRound(quint32 &a, quint32 &b, quint32 &c, quint32 &d)
+{
+    a += b; d ^= a; d = rotl(d, 16);
+    c += d; b ^= c; b = rotl(b, 12);
+    a += b; d ^= a; d = rotl(d, 8);
+    c += d; b ^= c; b = rotl(b, 7);
+}
+
+void wipe(void *data, size_t size)
+{
+    volatile quint8 *p = static_cast<volatile quint8 *>(data);
+    while (size--) *p++ = 0;
+}
+
+class ChaCha20
+{
+public:
+    ChaCha20(const quint8 *key, const quint8 *nonce, quint32 counter)
+    {
+        m_state[0] = 0x61707865;
+        m_state[1] = 0x3320646e;
+        m_state[2] = 0x79622d32;
+        m_state[3] = 0x6b206574;
+        for (int i = 0; i < 8; ++i) m_state[4 + i] = load32(key + 4 * i);
+        m_state[12] = counter;
+        for (int i = 0; i < 3; ++i) m_state[13 + i] = load32(nonce + 4 * i);
+    }
+
+    ~ChaCha20() { wipe(m_state, sizeof(m_state)); }
+
+    void block(quint8 out[64])
+    {
+        quint32 x[16];
+        std::memcpy(x, m_state, sizeof(x));
+        for (int i = 0; i < 10; ++i) {
+            quarterRound(x[0], x[4], x[8], x[12]);
+            quarterRound(x[1], x[5], x[9], x[13]);
+            quarterRound(x[2], x[6], x[10], x[14]);
+            quarterRound(x[3], x[7], x[11], x[15]);
+            quarterRound(x[0], x[5], x[10], x[15]);
+            quarterRound(x[1], x[6], x[11], x[12]);
+            quarterRound(x[2], x[7], x[8], x[13]);
+            quarterRound(x[3], x[4], x[9], x[14]);
+        }
+        for (int i = 0; i < 16; ++i) store32(out + 4 * i, x[i] + m_state[i]);
+        m_state[12]++;
+        wipe(x, sizeof(x));
+    }
+
+    void xorStream(const quint8 *in, quint8 *out, size_t length)
+    {
+        quint8 stream[64];
+        while (length > 0) {
+            block(stream);
+            size_t n = length < 64 ? length : 64;
+            for (size_t i = 0; i < n; ++i) out[i] = in[i] ^ stream[i];
+            in += n;
+            out += n;
+            length -= n;
+        }
+        wipe(stream, sizeof(stream));
+    }
+
+private:
+    quint32 m_state[16];
+};
+
+// 26-bit limb Poly1305, after poly1305-donna
+class Poly1305
+{
+public:
+    explicit Poly1305(const quint8 key[32])
+    {
+        m_r[0] = load32(key + 0) & 0x3ffffff;
+        m_r[1] = (load32(key + 3) >> 2) & 0x3ffff03;
+        m_r[2] = (load32(key + 6) >> 4) & 0x3ffc0ff;
+        m_r[3] = (load32(key + 9) >> 6) & 0x3f03fff;
+        m_r[4] = (load32(key + 12) >> 8) & 0x00fffff;
+        for (int i = 0; i < 4; ++i) m_pad[i] = load32(key + 16 + 4 * i);
+    }
+
+    ~Poly1305()
+    {
+        wipe(m_r, sizeof(m_r));
+        wipe(m_pad, sizeof(m_pad));
+        wipe(m_buffer, sizeof(m_buffer));
+    }
+
+    void update(const quint8 *m, size_t bytes)
+    {
+        if (m_leftover) {
+            size_t want = 16 - m_leftover;
+            if (want > bytes) want = bytes;
+            std::memcpy(m_buffer + m_leftover, m, want);
+            m_leftover += want;
+            m += want;
+            bytes -= want;
+            if (m_leftover < 16) return;
+            blocks(m_buffer, 16, 1 << 24);
+            m_leftover = 0;
+        }
+        if (bytes >= 16) {
+            size_t want = bytes & ~size_t(15);
+            blocks(m, want, 1 << 24);
+            m += want;
+            bytes -= want;
+        }
+        if (bytes) {
+            std::memcpy(m_buffer, m, bytes);
+            m_leftover = bytes;
+        }
+    }
+
+    void padTo16(size_t length)
+    {
+        static const quint8 zeros[16] = {};
+        if (length % 16) update(zeros, 16 - length % 16);
+    }
+
+    void finish(quint8 mac[16])
+    {
+        if (m_leftover) {
+            m_buffer[m_leftover] = 1;
+            for (size_t i = m_leftover + 1; i < 16; ++i) m_buffer[i] = 0;
+            blocks(m_buffer, 16, 0);
+        }
+
+        quint32 h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+        quint32 c;
+        c = h1 >> 26; h1 &= 0x3ffffff; h2 += c;
+        c = h2 >> 26; h2 &= 0x3ffffff; h3 += c;
+        c = h3 >> 26; h3 &= 0x3ffffff; h4 += c;
+        c = h4 >> 26; h4 &= 0x3ffffff; h0 += c * 5;
+        c = h0 >> 26; h0 &= 0x3ffffff; h1 += c;
+
+        // Compute h - p and keep it if it did not underflow
+        quint32 g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+        quint32 g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+        quint32 g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+        quint32 g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+        quint32 g4 = h4 + c - (1u << 26);
+
+        quint32 mask = (g4 >> 31) - 1;
+        g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+        mask = ~mask;
+        h0 = (h0 & mask) | g0;
+        h1 = (h1 & mask) | g1;
+        h2 = (h2 & mask) | g2;
+        h3 = (h3 & mask) | g3;
+        h4 = (h4 & mask) | g4;
+
+        h0 = h0 | (h1 << 26);
+        h1 = (h1 >> 6) | (h2 << 20);
+        h2 = (h2 >> 12) | (h3 << 14);
+        h3 = (h3 >> 18) | (h4 << 8);
+
+        quint64 f;
+        f = quint64(h0) + m_pad[0];             h0 = quint32(f);
+        f = quint64(h1) + m_pad[1] + (f >> 32); h1 = quint32(f);
+        f = quint64(h2) + m_pad[2] + (f >> 32); h2 = quint32(f);
+        f = quint64(h3) + m_pad[3] + (f >> 32); h3 = quint32(f);
+
+        store32(mac + 0, h0);
+        store32(mac + 4, h1);
+        store32(mac + 8, h2);
+        store32(mac + 12, h3);
+    }
+
+private:
+    void blocks(const quint8 *m, size_t bytes, quint32 hibit)
+    {
+        const quint32 r0 = m_r[0], r1 = m_r[1], r2 = m_r[2], r3 = m_r[3], r4 = m_r[4];
+        const quint32 s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+        quint32 h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+
+        while (bytes >= 16) {
+            h0 += load32(m + 0) & 0x3ffffff;
+            h1 += (load32(m + 3) >> 2) & 0x3ffffff;
+            h2 += (load32(m + 6) >> 4) & 0x3ffffff;
+            h3 += (load32(m + 9) >> 6) & 0x3ffffff;
+            h4 += (load32(m + 12) >> 8) | hibit;
+
+            quint64 d0 = quint64(h0) * r0 + quint64(h1) * s4 + quint64(h2) * s3 + quint64(h3) * s2 + quint64(h4) * s1;
+            quint64 d1 = quint64(h0) * r1 + quint64(h1) * r0 + quint64(h2) * s4 + quint64(h3) * s3 + quint64(h4) * s2;
+            quint64 d2 = quint64(h0) * r2 + quint64(h1) * r1 + quint64(h2) * r0 + quint64(h3) * s4 + quint64(h4) * s3;
+            quint64 d3 = quint64(h0) * r3 + quint64(h1) * r2 + quint64(h2) * r1 + quint64(h3) * r0 + quint64(h4) * s4;
+            quint64 d4 = quint64(h0) * r4 + quint64(h1) * r3 + quint64(h2) * r2 + quint64(h3) * r1 + quint64(h4) * r0;
+
+            quint32 c;
+            c = quint32(d0 >> 26); h0 = quint32(d0) & 0x3ffffff; d1 += c;
+            c = quint32(d1 >> 26); h1 = quint32(d1) & 0x3ffffff; d2 += c;
+            c = quint32(d2 >> 26); h2 = quint32(d2) & 0x3ffffff; d3 += c;
+            c = quint32(d3 >> 26); h3 = quint32(d3) & 0x3ffffff; d4 += c;
+            c = quint32(d4 >> 26); h4 = quint32(d4) & 0x3ffffff; h0 += c * 5;
+            c = h0 >> 26; h0 &= 0x3ffffff; h1 += c;
+
+            m += 16;
+            bytes -= 16;
+        }
+
+        m_h[0] = h0; m_h[1] = h1; m_h[2] = h2; m_h[3] = h3; m_h[4] = h4;
+    }
+
+    quint32 m_r[5];
+    quint32 m_h[5] = {0, 0, 0, 0, 0};
+    quint32 m_pad[4];
+    quint8 m_buffer[16];
+    size_t m_leftover = 0;
+};
+
+void computeTag(const quint8 *key, const quint8 *nonce,
+                const quint8 *aad, size_t aadLength,
+                const quint8 *ciphertext, size_t length, quint8 tag[16])
+{
+    // One-time Poly1305 key is the first half of ChaCha20 block 0
+    quint8 block0[64];
+    ChaCha20(key, nonce, 0).block(block0);
+    Poly1305 poly(block0);
+    wipe(block0, sizeof(block0));
+
+    poly.update(aad, aadLength);
+    poly.padTo16(aadLength);
+    poly.update(ciphertext, length);
+    poly.padTo16(length);
+
+    quint8 lengths[16];
+    store64(lengths, aadLength);
+    store64(lengths + 8, length);
+    poly.update(lengths, sizeof(lengths));
+    poly.finish(tag);
+}
+
+}
+
+namespace Aead {
+
+void seal(const quint8 *key, const quint8 *nonce,
+          const quint8 *aad, size_t aadLength,
+          const quint8 *plaintext, size_t length,
+          quint8 *ciphertext, quint8 *tag)
+{
+    ChaCha20(key, nonce, 1).xorStream(plaintext, ciphertext, length);
+    computeTag(key, nonce, aad, aadLength, ciphertext, length, tag);
+}
+
+bool open(const quint8 *key, const quint8 *nonce,
+          const quint8 *aad, size_t aadLength,
+          const quint8 *ciphertext, size_t length,
+          const quint8 *tag, quint8 *plaintext)
+{
+    quint8 expected[TagSize];
+    computeTag(key, nonce, aad, aadLength, ciphertext, length, expected);
+
+    quint8 diff = 0;
+    for (int i = 0; i < TagSize; ++i) diff |= quint8(expected[i] ^ tag[i]);
+    if (diff != 0) return false;
+
+    ChaCha20(key, nonce, 1).xorStream(ciphertext, plaintext, length);
+    return true;
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QtGlobal>
+#include <cstddef>
+
+// ChaCha20-Poly1305 authenticated encryption (RFC 8439).
+// Ciphertext has the same length as the plaintext; the 16-byte tag is separate.
+namespace Aead {
+
+constexpr int KeySize = 32;
+constexpr int NonceSize = 12;
+constexpr int TagSize = 16;
+
+void seal(const quint8 *key, const quint8 *nonce,
+          const quint8 *aad, size_t aadLength,
+          const quint8 *plaintext, size_t length,
+          quint8 *ciphertext, quint8 *tag);
+
+// Returns false (and writes nothing) if the tag does not verify
+bool open(const quint8 *key, const quint8 *nonce,
+          const quint8 *aad, size_t aadLength,
+          const quint8 *ciphertext, size_t length,
+          const quint8 *tag, quint8 *plaintext);
+
+}
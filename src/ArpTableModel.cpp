@@ -0,0 +1,110 @@
+#include "ArpTableModel.h"
+#include <QSet>
+
+ArpTableModel::ArpTableModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int ArpTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_entries.size();
+}
+
+QVariant ArpTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_entries.size())
+        return QVariant();
+
+    const ArpEntry &entry = m_entries[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+    case IpRole: return entry.ip;
+    case MacRole: return entry.mac;
+    case VendorRole: return entry.vendor;
+    case TypeRole: return entry.type;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> ArpTableModel::roleNames() const
+{
+    return {
+        {IpRole, "ip"},
+        {MacRole, "mac"},
+        {VendorRole, "vendor"},
+        {TypeRole, "type"}
+    };
+}
+
+void ArpTableModel::setEntries(const QList<ArpEntry> &entries)
+{
+    const int before = m_entries.size();
+
+    QSet<QString> seen;
+    seen.reserve(entries.size());
+    for (const ArpEntry &entry : entries)
+        seen.insert(entry.ip);
+
+    // Drop entries that aged out, walking backwards so rows stay valid
+    int firstRemoved = -1;
+    for (int row = m_entries.size() - 1; row >= 0; --row) {
+        if (seen.contains(m_entries[row].ip))
+            continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rowByIp.remove(m_entries[row].ip);
+        m_entries.remove(row);
+        endRemoveRows();
+        firstRemoved = row;
+    }
+    if (firstRemoved >= 0)
+        reindexFrom(firstRemoved);
+
+    QVector<ArpEntry> added;
+    for (const ArpEntry &entry : entries) {
+        auto it = m_rowByIp.constFind(entry.ip);
+        if (it == m_rowByIp.constEnd()) {
+            added.append(entry);
+            m_rowByIp.insert(entry.ip, -1); // placeholder, guards duplicate IPs in one snapshot
+            continue;
+        }
+        if (it.value() < 0)
+            continue;
+
+        ArpEntry &current = m_entries[it.value()];
+        if (current.mac != entry.mac || current.vendor != entry.vendor || current.type != entry.type) {
+            current = entry;
+            const QModelIndex changed = index(it.value());
+            emit dataChanged(changed, changed);
+        }
+    }
+
+    if (!added.isEmpty()) {
+        const int first = m_entries.size();
+        beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+        m_entries += added;
+        endInsertRows();
+        reindexFrom(first);
+    }
+
+    if (m_entries.size() != before)
+        emit countChanged();
+}
+
+void ArpTableModel::clear()
+{
+    if (m_entries.isEmpty())
+        return;
+
+    beginResetModel();
+    m_entries.clear();
+    m_rowByIp.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+void ArpTableModel::reindexFrom(int row)
+{
+    for (int i = row; i < m_entries.size(); ++i)
+        m_rowByIp.insert(m_entries[i].ip, i);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QVector>
+
+struct ArpEntry {
+    QString ip;
+    QString mac;
+    QString vendor;
+    QString type;
+};
+
+// ARP cache as a list model. Refreshes are diffed by IP, so views only see
+// the rows that were added, removed or changed.
+class ArpTableModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        IpRole = Qt::UserRole + 1,
+        MacRole,
+        VendorRole,
+        TypeRole
+    };
+    Q_ENUM(Roles)
+
+    explicit ArpTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return m_entries.size(); }
+    const QVector<ArpEntry> &entries() const { return m_entries; }
+
+    // Replaces the table with a fresh snapshot of the ARP cache
+    void setEntries(const QList<ArpEntry> &entries);
+
+public slots:
+    void clear();
+
+signals:
+    void countChanged();
+
+private:
+    void reindexFrom(int row);
+
+    QVector<ArpEntry> m_entries;
+    QHash<QString, int> m_rowByIp;
+};
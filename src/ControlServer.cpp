@@ -0,0 +1,817 @@
+#include "ControlServer.h"
+#include "NetworkScanner.h"
+#include "NetworkMapper.h"
+#include "NetworkMonitor.h"
+#include "RemoteExecutor.h"
+#include "ScanCheckpoint.h"
+#include "ScanProtocol.h"
+#include "OpenMetrics.h"
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QDir>
+#include <QDebug>
+
+namespace {
+const int kMaxHeaderBytes = 16 * 1024;
+const int kMaxBodyBytes = 1024 * 1024;
+const qint64 kMaxPendingBytes = 8 * 1024 * 1024; // event stream client this far behind is dropped
+const int kHeartbeatMs = 15000;
+const int kMaxJobs = 1000;
+const int kMaxJobOutput = 256 * 1024;            // tail kept per job
+const int kDefaultPageSize = 100;
+const int kMaxPageSize = 1000;
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 503: return "Service Unavailable";
+    default: return "Error";
+    }
+}
+
+QJsonObject error(int *status, int code, const QString &message)
+{
+    *status = code;
+    return {{"error", message}};
+}
+
+QJsonObject hostJson(const HostInfo &host)
+{
+    return {{"ip", host.ip}, {"hostname", host.hostname}, {"mac", host.mac},
+            {"tcp", ScanProtocol::toArray(host.openPorts)}, {"udp", ScanProtocol::toArray(host.openUdpPorts)},
+            {"responseTime", host.responseTime}};
+}
+
+QJsonObject profileJson(const HostProfile &profile)
+{
+    return {{"ip", profile.ip}, {"mac", profile.mac}, {"hostname", profile.hostname},
+            {"os", profile.osType}, {"osVersion", profile.osVersion}, {"vendor", profile.vendor},
+            {"deviceType", profile.deviceType}, {"services", QJsonArray::fromStringList(profile.services)},
+            {"tcp", ScanProtocol::toArray(profile.openPorts)}, {"udp", ScanProtocol::toArray(profile.openUdpPorts)},
+            {"responseTime", profile.responseTime}};
+}
+
+// offset/limit from the query string, clamped to the list size
+template <typename T, typename F>
+QJsonObject page(const QList<T> &items, const QUrlQuery &query, F toJson)
+{
+    const int offset = qBound(0, query.queryItemValue("offset").toInt(), int(items.size()));
+    int limit = query.hasQueryItem("limit") ? query.queryItemValue("limit").toInt() : kDefaultPageSize;
+    limit = qBound(0, limit, kMaxPageSize);
+
+    QJsonArray array;
+    for (int i = offset; i < items.size() && i < offset + limit; ++i)
+        array.append(toJson(items.at(i)));
+    return {{"total", int(items.size())}, {"offset", offset}, {"items", array}};
+}
+
+QString randomToken()
+{
+    QByteArray bytes(24, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(bytes.data()), bytes.size() / 4);
+    return QString::fromLatin1(bytes.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+}
+
+ControlServer::ControlServer(QObject *parent)
+    : QObject(parent)
+    , m_token(randomToken())
+    , m_nextClientId(1)
+    , m_capturedJobs(nullptr)
+{
+    m_heartbeat = new QTimer(this);
+    m_heartbeat->setInterval(kHeartbeatMs);
+    connect(m_heartbeat, &QTimer::timeout, this, &ControlServer::sendHeartbeats);
+}
+
+void ControlServer::setToken(const QString &token)
+{
+    if (token.isEmpty() || token == m_token)
+        return;
+    m_token = token;
+    emit tokenChanged();
+}
+
+void ControlServer::setScanner(NetworkScanner *scanner)
+{
+    if (scanner == m_scanner)
+        return;
+    if (m_scanner)
+        m_scanner->disconnect(this);
+    m_scanner = scanner;
+
+    if (scanner) {
+        connect(scanner, &NetworkScanner::hostDiscovered, this,
+                [this](const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports,
+                       const QList<int> &udpPorts) {
+            broadcast("host", {{"ip", ip}, {"hostname", hostname}, {"mac", mac},
+                               {"tcp", ScanProtocol::toArray(ports)}, {"udp", ScanProtocol::toArray(udpPorts)}});
+        });
+        connect(scanner, &NetworkScanner::scanStarted, this, [this](const QString &network, const QString &ports) {
+            broadcast("scan", {{"state", "started"}, {"network", network}, {"ports", ports}});
+        });
+        connect(scanner, &NetworkScanner::scanCompleted, this, [this]() {
+            broadcast("scan", {{"state", "completed"}, {"status", scanStatus()}});
+        });
+        connect(scanner, &NetworkScanner::scanFailed, this, [this](const QString &message) {
+            broadcast("scan", {{"state", "failed"}, {"error", message}});
+        });
+    }
+    emit enginesChanged();
+}
+
+void ControlServer::setMapper(NetworkMapper *mapper)
+{
+    if (mapper == m_mapper)
+        return;
+    if (m_mapper)
+        m_mapper->disconnect(this);
+    m_mapper = mapper;
+
+    if (mapper) {
+        connect(mapper, &NetworkMapper::hostProfiled, this,
+                [this](const QString &ip, const QString &os, const QString &services, const QString &vendor) {
+            broadcast("profile", {{"ip", ip}, {"os", os}, {"services", services}, {"vendor", vendor}});
+        });
+        connect(mapper, &NetworkMapper::mappingCompleted, this, [this]() {
+            broadcast("map", {{"state", "completed"}, {"status", mapStatus()}});
+        });
+    }
+    emit enginesChanged();
+}
+
+void ControlServer::setExecutor(RemoteExecutor *executor)
+{
+    if (executor == m_executor)
+        return;
+    if (m_executor)
+        m_executor->disconnect(this);
+    m_executor = executor;
+
+    if (executor) {
+        connect(executor, &RemoteExecutor::jobStarted, this,
+                [this](int jobId, const QString &type, const QString &target) {
+            JobRecord &record = job(jobId);
+            record.type = type;
+            record.target = target;
+            record.status = "running";
+            record.started = QDateTime::currentDateTimeUtc();
+            if (m_capturedJobs)
+                m_capturedJobs->append(jobId);
+            broadcast("job", jobJson(record, false));
+            pruneJobs();
+        });
+        connect(executor, &RemoteExecutor::jobProgress, this, [this](int jobId, int progress) {
+            job(jobId).progress = progress;
+        });
+        connect(executor, &RemoteExecutor::outputReceived, this, [this](int jobId, const QString &output) {
+            JobRecord &record = job(jobId);
+            if (record.status == "waiting_for_credential")
+                record.status = "running";
+            record.output += output;
+            if (record.output.size() > kMaxJobOutput)
+                record.output = record.output.right(kMaxJobOutput);
+            broadcast("output", {{"job", jobId}, {"target", record.target}, {"data", output}});
+        });
+        connect(executor, &RemoteExecutor::jobCompleted, this, [this](int jobId, const QString &output) {
+            JobRecord &record = job(jobId);
+            record.status = "completed";
+            record.progress = 100;
+            record.finished = QDateTime::currentDateTimeUtc();
+            // Streaming jobs already delivered their output piece by piece
+            if (record.output.isEmpty())
+                record.output = output.right(kMaxJobOutput);
+            broadcast("job", jobJson(record, false));
+        });
+        connect(executor, &RemoteExecutor::jobFailed, this, [this](int jobId, const QString &message) {
+            JobRecord &record = job(jobId);
+            record.status = "failed";
+            record.error = message;
+            record.finished = QDateTime::currentDateTimeUtc();
+            broadcast("job", jobJson(record, false));
+        });
+        connect(executor, &RemoteExecutor::credentialRequired, this,
+                [this](const QString &host, const QString &protocol, int jobId) {
+            JobRecord &record = job(jobId);
+            record.status = "waiting_for_credential";
+            broadcast("job", QJsonObject{{"id", jobId}, {"status", record.status}, {"target", host},
+                                         {"protocol", protocol}});
+        });
+    }
+    emit enginesChanged();
+}
+
+void ControlServer::setMonitor(NetworkMonitor *monitor)
+{
+    if (monitor == m_monitor)
+        return;
+    if (m_monitor)
+        m_monitor->disconnect(this);
+    m_monitor = monitor;
+
+    if (monitor) {
+        connect(monitor, &NetworkMonitor::hostChanged, this,
+                [this](const QString &ip, const QString &change, const QString &detail) {
+            broadcast("change", {{"ip", ip}, {"change", change}, {"detail", detail}});
+        });
+    }
+    emit enginesChanged();
+}
+
+bool ControlServer::listen(const QString &address)
+{
+    const ScanProtocol::Endpoint endpoint = ScanProtocol::Endpoint::parse(address);
+
+    if (endpoint.local) {
+        QLocalServer::removeServer(endpoint.name); // stale socket from a crashed run
+        auto *server = new QLocalServer(this);
+        server->setSocketOptions(QLocalServer::UserAccessOption);
+        if (!server->listen(endpoint.name)) {
+            qWarning() << "Control API cannot listen on" << address << ":" << server->errorString();
+            delete server;
+            return false;
+        }
+        connect(server, &QLocalServer::newConnection, this, [this, server]() {
+            while (QLocalSocket *socket = server->nextPendingConnection())
+                addClient(socket, true);
+        });
+        m_localServers << server;
+    } else {
+        // Never reachable from the network; remote automation goes through an SSH tunnel
+        const QHostAddress host = endpoint.name.isEmpty() ? QHostAddress(QHostAddress::LocalHost)
+                                                          : QHostAddress(endpoint.name);
+        if (!host.isLoopback()) {
+            qWarning() << "Control API only listens on loopback, refusing" << address;
+            return false;
+        }
+        auto *server = new QTcpServer(this);
+        if (!server->listen(host, endpoint.port)) {
+            qWarning() << "Control API cannot listen on" << address << ":" << server->errorString();
+            delete server;
+            return false;
+        }
+        connect(server, &QTcpServer::newConnection, this, [this, server]() {
+            while (QTcpSocket *socket = server->nextPendingConnection())
+                addClient(socket, false);
+        });
+        m_tcpServers << server;
+    }
+
+    qDebug() << "Control API listening on" << address;
+    return true;
+}
+
+QString ControlServer::writeTokenFile() const
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    QDir().mkpath(dir);
+    const QString path = dir + "/control.token";
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write control token to" << path << ":" << file.errorString();
+        return QString();
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    file.write(m_token.toUtf8() + '\n');
+    if (!file.commit()) {
+        qWarning() << "Cannot write control token to" << path << ":" << file.errorString();
+        return QString();
+    }
+    return path;
+}
+
+void ControlServer::addClient(QIODevice *socket, bool trusted)
+{
+    const int id = m_nextClientId++;
+    Client client;
+    client.socket = socket;
+    client.trusted = trusted;
+    m_clients.insert(id, client);
+
+    connect(socket, &QIODevice::readyRead, this, [this, id]() { onReadyRead(id); });
+    if (auto *tcp = qobject_cast<QTcpSocket *>(socket))
+        connect(tcp, &QTcpSocket::disconnected, this, [this, id]() { removeClient(id); });
+    else if (auto *local = qobject_cast<QLocalSocket *>(socket))
+        connect(local, &QLocalSocket::disconnected, this, [this, id]() { removeClient(id); });
+    emit clientsChanged();
+}
+
+void ControlServer::removeClient(int clientId)
+{
+    auto it = m_clients.find(clientId);
+    if (it == m_clients.end())
+        return;
+    QIODevice *socket = it->socket;
+    m_clients.erase(it);
+    socket->disconnect(this);
+    socket->deleteLater();
+    emit clientsChanged();
+}
+
+void ControlServer::onReadyRead(int clientId)
+{
+    auto it = m_clients.find(clientId);
+    if (it == m_clients.end())
+        return;
+    it->buffer += it->socket->readAll();
+    if (it->streaming) {
+        it->buffer.clear(); // nothing more is expected on an event stream
+        return;
+    }
+
+    // Pipelined requests are answered in order
+    for (;;) {
+        it = m_clients.find(clientId);
+        if (it == m_clients.end() || it->streaming)
+            return;
+
+        Request request;
+        int status = 0;
+        if (!takeRequest(*it, &request, &status)) {
+            if (status) {
+                respond(clientId, status, {{"error", QString::fromLatin1(reasonPhrase(status))}}, false);
+            }
+            return;
+        }
+        handle(clientId, request);
+    }
+}
+
+bool ControlServer::takeRequest(Client &client, Request *request, int *error)
+{
+    const int headerEnd = client.buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (client.buffer.size() > kMaxHeaderBytes)
+            *error = 413;
+        return false;
+    }
+
+    const QList<QByteArray> lines = client.buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3 || !requestLine.at(2).startsWith("HTTP/1.")) {
+        *error = 400;
+        return false;
+    }
+
+    for (int i = 1; i < lines.size(); ++i) {
+        const int colon = lines.at(i).indexOf(':');
+        if (colon > 0)
+            request->headers.insert(lines.at(i).left(colon).trimmed().toLower(), lines.at(i).mid(colon + 1).trimmed());
+    }
+
+    bool ok = true;
+    const int length = request->headers.value("content-length", "0").toInt(&ok);
+    if (!ok || length < 0) {
+        *error = 400;
+        return false;
+    }
+    if (length > kMaxBodyBytes) {
+        *error = 413;
+        return false;
+    }
+    if (client.buffer.size() < headerEnd + 4 + length)
+        return false;
+
+    const QUrl url(QString::fromLatin1(requestLine.at(1)));
+    request->method = requestLine.at(0);
+    request->path = url.path();
+    request->query = QUrlQuery(url);
+    request->body = client.buffer.mid(headerEnd + 4, length);
+
+    const QByteArray connection = request->headers.value("connection").toLower();
+    request->keepAlive = requestLine.at(2) == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+
+    client.buffer.remove(0, headerEnd + 4 + length);
+    return true;
+}
+
+void ControlServer::handle(int clientId, const Request &request)
+{
+    // A browser page can reach loopback too; the bearer token is what keeps it out
+    if (!m_clients.value(clientId).trusted) {
+        const QByteArray expected = "Bearer " + m_token.toUtf8();
+        if (request.headers.value("authorization") != expected) {
+            respond(clientId, 401, {{"error", "missing or wrong bearer token"}}, request.keepAlive);
+            return;
+        }
+    }
+
+    if (request.path == "/events") {
+        if (request.method != "GET") {
+            respond(clientId, 405, {{"error", "use GET"}}, request.keepAlive);
+            return;
+        }
+        startEventStream(clientId, request);
+        return;
+    }
+
+    if (request.path == "/metrics") {
+        if (request.method != "GET") {
+            respond(clientId, 405, {{"error", "use GET"}}, request.keepAlive);
+            return;
+        }
+        respond(clientId, 200, OpenMetrics::ContentType, metrics(), request.keepAlive);
+        return;
+    }
+
+    if (request.path == "/trace/start" || request.path == "/trace/stop") {
+        if (request.method != "POST") {
+            respond(clientId, 405, {{"error", "use POST"}}, request.keepAlive);
+            return;
+        }
+        const bool start = request.path == "/trace/start";
+        Trace::setEnabled(start);
+        if (start)
+            respond(clientId, 200, {{"tracing", true}}, request.keepAlive);
+        else
+            respond(clientId, 200, "application/json", Trace::toChromeJson(), request.keepAlive);
+        return;
+    }
+
+    int status = 200;
+    const QJsonObject body = route(request, &status);
+    respond(clientId, status, body, request.keepAlive);
+}
+
+QJsonObject ControlServer::route(const Request &request, int *status)
+{
+    const QByteArray &method = request.method;
+    const QStringList parts = request.path.split('/', Qt::SkipEmptyParts);
+    const QJsonObject body = QJsonDocument::fromJson(request.body).object();
+
+    if (request.path == "/status" && method == "GET") {
+        QJsonObject result{{"version", QCoreApplication::applicationVersion()}, {"clients", clientCount()}};
+        if (m_scanner)
+            result["scan"] = scanStatus();
+        if (m_mapper)
+            result["map"] = mapStatus();
+        if (m_executor)
+            result["activeJobs"] = m_executor->activeJobs();
+        if (m_monitor)
+            result["monitor"] = monitorStatus();
+        return result;
+    }
+
+    if (!parts.isEmpty() && parts.first() == "monitor") {
+        if (!m_monitor)
+            return error(status, 503, "no monitor attached");
+
+        if (parts.size() == 1 && method == "GET")
+            return monitorStatus();
+        if (parts.size() == 1 && method == "POST") {
+            if (body.contains("probesPerSecond"))
+                m_monitor->setProbesPerSecond(body.value("probesPerSecond").toInt());
+            if (body.contains("continuous"))
+                m_monitor->setContinuous(body.value("continuous").toBool());
+            return monitorStatus();
+        }
+        if (parts.size() == 2 && parts.at(1) == "changes" && method == "GET")
+            return {{"items", QJsonArray::fromVariantList(m_monitor->changes())}};
+        if (parts.size() == 2 && parts.at(1) == "schedules" && method == "POST") {
+            const QString id = m_monitor->addSchedule(body.value("name").toString(), body.value("cron").toString(),
+                                                      body.value("network").toString(),
+                                                      body.value("ports").toString());
+            if (id.isEmpty())
+                return error(status, 400, "network and a valid five-field cron expression are required");
+            *status = 201;
+            return {{"id", id}};
+        }
+        if (parts.size() >= 3 && parts.at(1) == "schedules") {
+            const QString id = parts.at(2);
+            bool known = false;
+            for (const QVariant &schedule : m_monitor->schedules())
+                known = known || schedule.toMap().value("id").toString() == id;
+            if (!known)
+                return error(status, 404, "no such schedule");
+            if (parts.size() == 3 && method == "DELETE") {
+                m_monitor->removeSchedule(id);
+                return monitorStatus();
+            }
+            if (parts.size() == 4 && parts.at(3) == "run" && method == "POST") {
+                m_monitor->runSchedule(id);
+                *status = 202;
+                return monitorStatus();
+            }
+        }
+        return error(status, 404, "no such route");
+    }
+
+    if (!parts.isEmpty() && parts.first() == "scans") {
+        if (!m_scanner)
+            return error(status, 503, "no scanner attached");
+
+        if (parts.size() == 1 && method == "POST") {
+            const QString network = body.value("network").toString();
+            if (network.isEmpty())
+                return error(status, 400, "network is required");
+            if (m_scanner->isScanning())
+                return error(status, 409, "a scan is already running");
+            if (body.contains("hostRateLimit"))
+                m_scanner->setHostRateLimit(body.value("hostRateLimit").toInt());
+            if (body.contains("subnetRateLimit"))
+                m_scanner->setSubnetRateLimit(body.value("subnetRateLimit").toInt());
+            m_scanner->startScan(network, body.value("ports").toString("1-1024"), body.value("threads").toInt(50));
+            *status = 202;
+            return scanStatus();
+        }
+        if (parts.size() == 2 && parts.at(1) == "stop" && method == "POST") {
+            m_scanner->stopScan();
+            return scanStatus();
+        }
+        if (parts.size() == 2 && parts.at(1) == "resume" && method == "POST") {
+            const QString id = body.value("id").toString();
+            if (!ScanCheckpoint::isValidId(id))
+                return error(status, 400, "invalid scan id");
+            if (m_scanner->isScanning())
+                return error(status, 409, "a scan is already running");
+            if (!m_scanner->resumeScan(id))
+                return error(status, 404, "no saved scan with that id");
+            *status = 202;
+            return scanStatus();
+        }
+        if (parts.size() == 2 && parts.at(1) == "saved" && method == "GET")
+            return {{"items", QJsonArray::fromVariantList(m_scanner->savedScans())}};
+        if (parts.size() >= 2 && parts.at(1) == "current" && method == "GET") {
+            if (parts.size() == 2)
+                return scanStatus();
+            if (parts.size() == 3 && parts.at(2) == "hosts")
+                return page(m_scanner->results(), request.query, hostJson);
+        }
+        return error(status, 404, "no such route");
+    }
+
+    if (!parts.isEmpty() && parts.first() == "maps") {
+        if (!m_mapper)
+            return error(status, 503, "no mapper attached");
+
+        if (parts.size() == 1 && method == "POST") {
+            if (m_mapper->isMapping())
+                return error(status, 409, "mapping is already running");
+            const QString subnet = body.value("subnet").toString();
+            if (!subnet.isEmpty()) {
+                m_mapper->startFullMapping(subnet);
+            } else if (body.contains("targets")) {
+                QStringList targets;
+                for (const QJsonValue &target : body.value("targets").toArray())
+                    targets << target.toString();
+                m_mapper->startMapping(targets);
+            } else {
+                m_mapper->startQuickMapping();
+            }
+            *status = 202;
+            return mapStatus();
+        }
+        if (parts.size() == 2 && parts.at(1) == "stop" && method == "POST") {
+            m_mapper->stopMapping();
+            return mapStatus();
+        }
+        if (parts.size() >= 2 && parts.at(1) == "current" && method == "GET") {
+            if (parts.size() == 2)
+                return mapStatus();
+            if (parts.size() == 3 && parts.at(2) == "hosts")
+                return page(m_mapper->profiles(), request.query, profileJson);
+        }
+        return error(status, 404, "no such route");
+    }
+
+    if (!parts.isEmpty() && parts.first() == "jobs") {
+        if (parts.size() == 1 && method == "POST") {
+            if (!m_executor)
+                return error(status, 503, "no executor attached");
+            const QString command = body.value("command").toString();
+            QString targets = body.value("targets").toString();
+            if (body.value("targets").isArray()) {
+                QStringList list;
+                for (const QJsonValue &target : body.value("targets").toArray())
+                    list << target.toString();
+                targets = list.join(',');
+            }
+            if (targets.isEmpty() || command.isEmpty())
+                return error(status, 400, "targets and command are required");
+
+            // jobStarted fires synchronously for each target; collect the ids
+            QList<int> started;
+            m_capturedJobs = &started;
+            m_executor->executeCommand(targets, command, body.value("protocol").toString("SSH"));
+            m_capturedJobs = nullptr;
+
+            *status = 202;
+            return {{"jobs", ScanProtocol::toArray(started)}};
+        }
+        if (parts.size() == 1 && method == "GET") {
+            QList<JobRecord> records;
+            for (int id : std::as_const(m_jobOrder))
+                records << m_jobs.value(id);
+            return page(records, request.query, [this](const JobRecord &record) { return jobJson(record, false); });
+        }
+        if (parts.size() == 2) {
+            bool ok = false;
+            const int id = parts.at(1).toInt(&ok);
+            if (!ok || !m_jobs.contains(id))
+                return error(status, 404, "no such job");
+            if (method == "GET")
+                return jobJson(m_jobs.value(id), true);
+            if (method == "DELETE") {
+                if (m_executor)
+                    m_executor->stopExecution(id);
+                return jobJson(m_jobs.value(id), false);
+            }
+            return error(status, 405, "use GET or DELETE");
+        }
+        return error(status, 404, "no such route");
+    }
+
+    return error(status, 404, "no such route");
+}
+
+void ControlServer::respond(int clientId, int status, const QJsonObject &body, bool keepAlive)
+{
+    respond(clientId, status, "application/json", QJsonDocument(body).toJson(QJsonDocument::Compact) + '\n',
+            keepAlive);
+}
+
+void ControlServer::respond(int clientId, int status, const QByteArray &contentType, const QByteArray &payload,
+                            bool keepAlive)
+{
+    auto it = m_clients.find(clientId);
+    if (it == m_clients.end())
+        return;
+
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n"
+                          "Content-Type: " + contentType + "\r\n"
+                          "Cache-Control: no-store\r\n"
+                          "Content-Length: " + QByteArray::number(payload.size()) + "\r\n";
+    response += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    response += payload;
+    it->socket->write(response);
+
+    if (!keepAlive) {
+        it->buffer.clear(); // anything pipelined after this request goes unanswered
+        if (auto *tcp = qobject_cast<QTcpSocket *>(it->socket))
+            tcp->disconnectFromHost();
+        else if (auto *local = qobject_cast<QLocalSocket *>(it->socket))
+            local->disconnectFromServer();
+    }
+}
+
+QByteArray ControlServer::metrics() const
+{
+    // Engine state a scrape can read cheaply; the rest comes from the snapshot
+    QList<OpenMetrics::Gauge> gauges;
+    if (m_scanner) {
+        gauges << OpenMetrics::Gauge{"scan_running", "1 while a scan runs", double(m_scanner->isScanning())}
+               << OpenMetrics::Gauge{"scan_progress_percent", "Progress of the current scan", double(m_scanner->progress())};
+    }
+    if (m_mapper) {
+        gauges << OpenMetrics::Gauge{"map_running", "1 while mapping runs", double(m_mapper->isMapping())}
+               << OpenMetrics::Gauge{"map_progress_percent", "Progress of the current mapping", double(m_mapper->progress())};
+    }
+    if (m_monitor) {
+        gauges << OpenMetrics::Gauge{"monitor_hosts", "Hosts in the monitor inventory", double(m_monitor->hostCount())}
+               << OpenMetrics::Gauge{"monitor_hosts_online", "Inventory hosts last seen up", double(m_monitor->onlineCount())};
+    }
+    if (m_executor)
+        gauges << OpenMetrics::Gauge{"jobs_active", "Remote jobs running or waiting", double(m_executor->activeJobs())};
+    gauges << OpenMetrics::Gauge{"pool_active_threads", "Busy worker threads",
+                                 double(QThreadPool::globalInstance()->activeThreadCount())}
+           << OpenMetrics::Gauge{"control_clients", "Connected control API clients", double(clientCount())};
+    return OpenMetrics::format(Metrics::snapshot(), gauges);
+}
+
+void ControlServer::startEventStream(int clientId, const Request &request)
+{
+    Client &client = m_clients[clientId];
+    client.streaming = true;
+    client.buffer.clear();
+    const QString types = request.query.queryItemValue("types");
+    for (const QString &type : types.split(',', Qt::SkipEmptyParts))
+        client.eventTypes.insert(type.trimmed());
+
+    client.socket->write("HTTP/1.1 200 OK\r\n"
+                         "Content-Type: text/event-stream\r\n"
+                         "Cache-Control: no-store\r\n"
+                         "Connection: keep-alive\r\n\r\n"
+                         ": connected\n\n");
+    m_heartbeat->start();
+}
+
+void ControlServer::broadcast(const QString &type, const QJsonObject &data)
+{
+    QByteArray event;
+    QList<int> behind;
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        if (!it->streaming || (!it->eventTypes.isEmpty() && !it->eventTypes.contains(type)))
+            continue;
+        // A reader this far behind would only grow our buffers; it can reconnect
+        if (it->socket->bytesToWrite() > kMaxPendingBytes) {
+            behind << it.key();
+            continue;
+        }
+        if (event.isEmpty())
+            event = "event: " + type.toUtf8() + "\ndata: " + QJsonDocument(data).toJson(QJsonDocument::Compact) + "\n\n";
+        it->socket->write(event);
+    }
+
+    for (int id : std::as_const(behind)) {
+        qWarning() << "Dropping event stream client" << id << ": not keeping up";
+        removeClient(id);
+    }
+}
+
+void ControlServer::sendHeartbeats()
+{
+    // Keeps idle streams alive through proxies and notices vanished readers
+    bool any = false;
+    for (const Client &client : std::as_const(m_clients)) {
+        if (client.streaming) {
+            client.socket->write(": ping\n\n");
+            any = true;
+        }
+    }
+    if (!any)
+        m_heartbeat->stop();
+}
+
+QJsonObject ControlServer::scanStatus() const
+{
+    return {{"id", m_scanner->scanId()}, {"scanning", m_scanner->isScanning()}, {"progress", m_scanner->progress()},
+            {"hostsFound", m_scanner->hostsFound()}, {"portsFound", m_scanner->portsFound()},
+            {"hostRateLimit", m_scanner->hostRateLimit()}, {"subnetRateLimit", m_scanner->subnetRateLimit()}};
+}
+
+QJsonObject ControlServer::mapStatus() const
+{
+    return {{"mapping", m_mapper->isMapping()}, {"progress", m_mapper->progress()},
+            {"hostsProfiled", m_mapper->hostsProfiled()}};
+}
+
+QJsonObject ControlServer::monitorStatus() const
+{
+    return {{"continuous", m_monitor->continuous()}, {"probesPerSecond", m_monitor->probesPerSecond()},
+            {"hosts", m_monitor->hostCount()}, {"online", m_monitor->onlineCount()},
+            {"probesSent", m_monitor->probesSent()},
+            {"schedules", QJsonArray::fromVariantList(m_monitor->schedules())}};
+}
+
+QJsonObject ControlServer::jobJson(const JobRecord &job, bool withOutput) const
+{
+    QJsonObject result{{"id", job.id}, {"type", job.type}, {"target", job.target}, {"status", job.status},
+                       {"progress", job.progress}, {"started", job.started.toString(Qt::ISODateWithMs)}};
+    if (job.finished.isValid())
+        result["finished"] = job.finished.toString(Qt::ISODateWithMs);
+    if (!job.error.isEmpty())
+        result["error"] = job.error;
+    if (withOutput)
+        result["output"] = job.output;
+    return result;
+}
+
+ControlServer::JobRecord &ControlServer::job(int id)
+{
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end()) {
+        JobRecord record;
+        record.id = id;
+        record.status = "running";
+        record.started = QDateTime::currentDateTimeUtc();
+        it = m_jobs.insert(id, record);
+        m_jobOrder << id;
+    }
+    return *it;
+}
+
+void ControlServer::pruneJobs()
+{
+    // Oldest finished jobs go first; running ones are kept whatever the count
+    for (int i = 0; m_jobOrder.size() > kMaxJobs && i < m_jobOrder.size();) {
+        const int id = m_jobOrder.at(i);
+        const QString status = m_jobs.value(id).status;
+        if (status == "completed" || status == "failed") {
+            m_jobs.remove(id);
+            m_jobOrder.removeAt(i);
+        } else {
+            ++i;
+        }
+    }
+}
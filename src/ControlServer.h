@@ -0,0 +1,144 @@
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QUrlQuery>
+
+class QIODevice;
+class QTcpServer;
+class QLocalServer;
+class NetworkScanner;
+class NetworkMapper;
+class NetworkMonitor;
+class RemoteExecutor;
+
+// Local HTTP/1.1 + JSON API over the engines, for scripts and pipelines.
+// Listens on a user-only local socket or on loopback TCP (bearer token
+// required). Everything runs on the event loop; requests only read engine
+// state or call the same slots QML does, so a busy engine never blocks a
+// client and vice versa. GET /events is a Server-Sent Events stream of
+// hosts, profiles, job state, command output and monitor changes
+// (host up/down, port opened/closed). GET /metrics is the
+// OpenMetrics exposition of the engine counters and histograms; POST
+// /trace/stop returns the spans recorded since /trace/start as Chrome
+// trace JSON.
+//
+//   GET  /status                       GET  /scans/current[/hosts?offset=&limit=]
+//   POST /scans {network,ports,threads}   POST /scans/stop   POST /scans/resume {id}
+//   GET  /scans/saved                  POST /maps {subnet}   POST /maps/stop
+//   GET  /maps/current[/hosts?offset=&limit=]
+//   POST /jobs {targets,command,protocol}  GET /jobs   GET /jobs/<id>   DELETE /jobs/<id>
+//   GET  /monitor   POST /monitor {continuous,probesPerSecond}   GET /monitor/changes
+//   POST /monitor/schedules {name,cron,network,ports}   DELETE /monitor/schedules/<id>
+//   POST /monitor/schedules/<id>/run
+//   GET  /events[?types=host,profile,job,output,scan,map,change]
+//   GET  /metrics                      POST /trace/start   POST /trace/stop
+class ControlServer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(NetworkScanner *scanner READ scanner WRITE setScanner NOTIFY enginesChanged)
+    Q_PROPERTY(NetworkMapper *mapper READ mapper WRITE setMapper NOTIFY enginesChanged)
+    Q_PROPERTY(RemoteExecutor *executor READ executor WRITE setExecutor NOTIFY enginesChanged)
+    Q_PROPERTY(NetworkMonitor *monitor READ monitor WRITE setMonitor NOTIFY enginesChanged)
+    Q_PROPERTY(QString token READ token WRITE setToken NOTIFY tokenChanged)
+    Q_PROPERTY(int clientCount READ clientCount NOTIFY clientsChanged)
+
+public:
+    static constexpr quint16 DefaultPort = 47801;
+
+    explicit ControlServer(QObject *parent = nullptr);
+
+    NetworkScanner *scanner() const { return m_scanner; }
+    NetworkMapper *mapper() const { return m_mapper; }
+    RemoteExecutor *executor() const { return m_executor; }
+    NetworkMonitor *monitor() const { return m_monitor; }
+    void setScanner(NetworkScanner *scanner);
+    void setMapper(NetworkMapper *mapper);
+    void setExecutor(RemoteExecutor *executor);
+    void setMonitor(NetworkMonitor *monitor);
+
+    QString token() const { return m_token; }
+    void setToken(const QString &token);
+    int clientCount() const { return m_clients.size(); }
+
+    // "local:<name>" or loopback "host:port"; may be called for several addresses
+    Q_INVOKABLE bool listen(const QString &address);
+    // Saves the token, readable by this user only, for local scripts; returns the path
+    Q_INVOKABLE QString writeTokenFile() const;
+
+signals:
+    void enginesChanged();
+    void tokenChanged();
+    void clientsChanged();
+
+private:
+    struct Request {
+        QByteArray method;
+        QString path;
+        QUrlQuery query;
+        QHash<QByteArray, QByteArray> headers; // names lower-cased
+        QByteArray body;
+        bool keepAlive = true;
+    };
+
+    struct Client {
+        QIODevice *socket = nullptr;
+        QByteArray buffer;
+        bool trusted = false;   // local socket: the file mode already limits who connects
+        bool streaming = false;
+        QSet<QString> eventTypes; // empty for all
+    };
+
+    struct JobRecord {
+        int id = 0;
+        QString type;
+        QString target;
+        QString status;
+        int progress = 0;
+        QString output;
+        QString error;
+        QDateTime started;
+        QDateTime finished;
+    };
+
+    void addClient(QIODevice *socket, bool trusted);
+    void onReadyRead(int clientId);
+    void removeClient(int clientId);
+    bool takeRequest(Client &client, Request *request, int *error);
+    void handle(int clientId, const Request &request);
+    QJsonObject route(const Request &request, int *status);
+    void respond(int clientId, int status, const QJsonObject &body, bool keepAlive);
+    void respond(int clientId, int status, const QByteArray &contentType, const QByteArray &payload, bool keepAlive);
+    QByteArray metrics() const;
+    void startEventStream(int clientId, const Request &request);
+    void broadcast(const QString &type, const QJsonObject &data);
+    void sendHeartbeats();
+
+    QJsonObject scanStatus() const;
+    QJsonObject mapStatus() const;
+    QJsonObject monitorStatus() const;
+    QJsonObject jobJson(const JobRecord &job, bool withOutput) const;
+    JobRecord &job(int id);
+    void pruneJobs();
+
+    QPointer<NetworkScanner> m_scanner;
+    QPointer<NetworkMapper> m_mapper;
+    QPointer<RemoteExecutor> m_executor;
+    QPointer<NetworkMonitor> m_monitor;
+    QString m_token;
+
+    QList<QTcpServer *> m_tcpServers;
+    QList<QLocalServer *> m_localServers;
+    QHash<int, Client> m_clients;
+    int m_nextClientId;
+    QTimer *m_heartbeat;
+
+    QHash<int, JobRecord> m_jobs;
+    QList<int> m_jobOrder;          // oldest first, for paging and pruning
+    QList<int> *m_capturedJobs;     // filled while a POST /jobs runs
+};
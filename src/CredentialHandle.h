@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QSharedPointer>
+#include <QString>
+#include <cstring>
+#include "SecureBuffer.h"
+
+// Decrypted material of one credential. Password and private key sit back
+// to back in a single locked buffer that is zeroed when the last owner goes.
+struct CredentialSecret {
+    explicit CredentialSecret(qsizetype size) : buffer(size) {}
+
+    int id = 0;
+    QString name;
+    QString host;
+    QString username;
+    QString type;
+    qsizetype passwordLength = 0;
+    SecureBuffer buffer;
+};
+
+// Cheap, copyable reference to decrypted credential material. Copies share
+// the same locked buffer instead of duplicating the secret on the heap.
+class CredentialHandle
+{
+public:
+    CredentialHandle() = default;
+    explicit CredentialHandle(QSharedPointer<const CredentialSecret> secret)
+        : m_secret(std::move(secret)) {}
+
+    // Wraps credentials typed in at a prompt; the UTF-8 copy is wiped
+    static CredentialHandle fromPassword(const QString &username, const QString &password,
+                                         const QString &type = QStringLiteral("Password"))
+    {
+        QByteArray utf8 = password.toUtf8();
+        auto secret = QSharedPointer<CredentialSecret>::create(utf8.size());
+        secret->username = username;
+        secret->type = type;
+        if (secret->buffer.size() > 0) {
+            std::memcpy(secret->buffer.data(), utf8.constData(), utf8.size());
+            secret->passwordLength = utf8.size();
+        }
+        SecureBuffer::wipe(utf8.data(), utf8.size());
+        return CredentialHandle(secret);
+    }
+
+    bool isValid() const { return !m_secret.isNull(); }
+    int id() const { return m_secret ? m_secret->id : 0; }
+    QString name() const { return m_secret ? m_secret->name : QString(); }
+    QString host() const { return m_secret ? m_secret->host : QString(); }
+    QString username() const { return m_secret ? m_secret->username : QString(); }
+    QString type() const { return m_secret ? m_secret->type : QString(); }
+
+    // Views into locked memory, valid while this handle is alive
+    QByteArrayView password() const
+    {
+        if (!m_secret) return QByteArrayView();
+        return m_secret->buffer.view(0, m_secret->passwordLength);
+    }
+
+    QByteArrayView privateKey() const
+    {
+        if (!m_secret || m_secret->buffer.size() == 0) return QByteArrayView();
+        return m_secret->buffer.view(m_secret->passwordLength,
+                                     m_secret->buffer.size() - m_secret->passwordLength);
+    }
+
+private:
+    QSharedPointer<const CredentialSecret> m_secret;
+};
@@ -0,0 +1,140 @@
+#include "CredentialIndex.h"
+#include "CredentialManager.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Bound on memoized wildcard/subnet resolutions before the cache is dropped
+const int kMaxResolvedHosts = 65536;
+
+// Trie roots, one per address family
+int rootFor(const IpAddress &address)
+{
+    return address.isIPv4() ? 0 : 1;
+}
+}
+
+void CredentialIndex::clear()
+{
+    m_byId.clear();
+    m_byHost.clear();
+    m_trie.clear();
+    m_globs.clear();
+    m_resolved.clear();
+}
+
+void CredentialIndex::rebuild(const QList<Credential> &credentials)
+{
+    clear();
+    m_trie.resize(2); // IPv4 and IPv6 roots, each matches /0
+
+    for (int i = 0; i < credentials.size(); ++i) {
+        const Credential &cred = credentials[i];
+        m_byId.insert(cred.id, i);
+
+        QString host = cred.host.trimmed();
+        if (host.isEmpty()) continue;
+
+        if (host.contains('/')) {
+            const IpSubnet subnet = IpSubnet::parse(host);
+            if (subnet.isValid()) {
+                insertSubnet(subnet, i);
+            } else {
+                qDebug() << "Credential" << cred.id << "has unsupported subnet" << host;
+            }
+        } else if (host.contains('*') || host.contains('?')) {
+            int first = host.indexOf(QRegularExpression("[*?]"));
+            int last = host.lastIndexOf(QRegularExpression("[*?]"));
+
+            Glob glob;
+            glob.prefix = host.left(first);
+            glob.suffix = host.mid(last + 1);
+            glob.literalLength = host.size() - host.count('*') - host.count('?');
+            glob.credential = i;
+
+            // "prefix*suffix" is a plain prefix/suffix test, anything else needs a regex
+            QString middle = host.mid(first, last - first + 1);
+            if (middle.count('*') != middle.size()) {
+                glob.regex = QRegularExpression(QRegularExpression::wildcardToRegularExpression(host));
+                glob.regex.optimize();
+            }
+            m_globs.append(glob);
+        } else if (!m_byHost.contains(host)) {
+            m_byHost.insert(host, i);
+        }
+    }
+
+    // Most specific pattern first, list order among equals
+    std::stable_sort(m_globs.begin(), m_globs.end(), [](const Glob &a, const Glob &b) {
+        return a.literalLength > b.literalLength;
+    });
+}
+
+int CredentialIndex::indexForHost(const QString &host) const
+{
+    int index = m_byHost.value(host, -1);
+    if (index >= 0) return index;
+
+    auto cached = m_resolved.constFind(host);
+    if (cached != m_resolved.constEnd()) return cached.value();
+
+    index = -1;
+    const IpAddress address = IpAddress::fromString(host);
+    if (address.isValid()) {
+        index = matchSubnet(address);
+    }
+    if (index < 0) {
+        index = matchGlob(host);
+    }
+
+    if (m_resolved.size() >= kMaxResolvedHosts) {
+        m_resolved.clear();
+    }
+    m_resolved.insert(host, index);
+    return index;
+}
+
+void CredentialIndex::insertSubnet(const IpSubnet &subnet, int credential)
+{
+    int node = rootFor(subnet.network);
+    for (int bit = 0; bit < subnet.prefixLength; ++bit) {
+        int branch = subnet.network.bit(bit);
+        if (m_trie[node].child[branch] < 0) {
+            m_trie[node].child[branch] = static_cast<int>(m_trie.size());
+            m_trie.emplace_back();
+        }
+        node = m_trie[node].child[branch];
+    }
+
+    // First credential in list order wins for an identical subnet
+    if (m_trie[node].credential < 0) {
+        m_trie[node].credential = credential;
+    }
+}
+
+int CredentialIndex::matchSubnet(const IpAddress &address) const
+{
+    if (m_trie.empty()) return -1;
+
+    int node = rootFor(address);
+    int best = m_trie[node].credential;
+    for (int bit = 0; bit < address.bitLength(); ++bit) {
+        node = m_trie[node].child[address.bit(bit)];
+        if (node < 0) break;
+        if (m_trie[node].credential >= 0) {
+            best = m_trie[node].credential;
+        }
+    }
+    return best;
+}
+
+int CredentialIndex::matchGlob(const QString &host) const
+{
+    for (const Glob &glob : m_globs) {
+        if (host.size() < glob.prefix.size() + glob.suffix.size()) continue;
+        if (!host.startsWith(glob.prefix) || !host.endsWith(glob.suffix)) continue;
+        if (!glob.regex.pattern().isEmpty() && !glob.regex.match(host).hasMatch()) continue;
+        return glob.credential;
+    }
+    return -1;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QRegularExpression>
+#include <vector>
+#include "IpAddress.h"
+
+struct Credential;
+
+// Host -> credential lookup over CredentialManager's list. Ids and exact hosts
+// are hashed, "a.b.c.d/n" and IPv6 "prefix/n" subnets live in a binary radix
+// trie (one root per family) for longest-prefix match and wildcard hosts are
+// precompiled globs.
+// All lookups return an index into the list the index was built from, or -1.
+class CredentialIndex
+{
+public:
+    void rebuild(const QList<Credential> &credentials);
+    void clear();
+
+    int indexOfId(int id) const { return m_byId.value(id, -1); }
+    int indexOfHost(const QString &host) const { return m_byHost.value(host, -1); }
+    int indexForHost(const QString &host) const;
+
+private:
+    struct TrieNode {
+        int child[2] = {-1, -1};
+        int credential = -1;
+    };
+
+    struct Glob {
+        QString prefix;
+        QString suffix;
+        QRegularExpression regex; // only used when wildcards appear mid-pattern
+        int literalLength;
+        int credential;
+    };
+
+    void insertSubnet(const IpSubnet &subnet, int credential);
+    int matchSubnet(const IpAddress &address) const;
+    int matchGlob(const QString &host) const;
+
+    QHash<int, int> m_byId;
+    QHash<QString, int> m_byHost;
+    std::vector<TrieNode> m_trie;
+    QList<Glob> m_globs;
+    mutable QHash<QString, int> m_resolved; // memoized subnet/glob results
+};
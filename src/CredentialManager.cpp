@@ -5,39 +5,91 @@
 #include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThread>
+#include "Aead.h"
+#include <cstring>
 
 #include <QRandomGenerator>
 
+namespace {
+// Coalesces lastUsed updates from a whole job into one background write
+const int kFlushDelayMs = 2000;
+
+// Stored secrets are "v1:" + base64(nonce | ciphertext | tag)
+const QString kSecretPrefix = QStringLiteral("v1:");
+const int kSealOverhead = Aead::NonceSize + Aead::TagSize;
+
+QByteArray secretAad(int id, const char *field)
+{
+    return QByteArray::number(id) + ':' + field;
+}
+
+QString formatLastUsed(qint64 msecs)
+{
+    return msecs > 0 ? QDateTime::fromMSecsSinceEpoch(msecs).toString(Qt::ISODate) : QString();
+}
+}
+
 CredentialManager::CredentialManager(QObject *parent)
     : QObject(parent)
+    , m_masterKey(Aead::KeySize)
+    , m_available(false)
     , m_nextId(1)
 {
     // Initialize settings in secure location
     QString configPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
     QDir().mkpath(configPath);
     m_settings = new QSettings(configPath + "/credentials.conf", QSettings::IniFormat, this);
+    m_databasePath = configPath + "/credentials.db";
     
-    // Generate secure encryption key from system entropy
-    generateEncryptionKey();
+    m_writer.setMaxThreadCount(1);
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFlushDelayMs);
+    connect(m_flushTimer, &QTimer::timeout, this, [this]() { flushDirty(); });
     
+    // The database first, a key is only ever created for a store without secrets
+    initDatabase();
+    m_available = loadMasterKey(configPath + "/credentials.key");
     loadCredentials();
 }
 
+CredentialManager::~CredentialManager()
+{
+    // Nothing buffered may be lost on shutdown
+    m_flushTimer->stop();
+    flushDirty();
+    m_writer.waitForDone();
+    
+    if (m_database.isOpen()) {
+        m_database.close();
+    }
+    QSqlDatabase::removeDatabase(m_database.connectionName());
+}
+
 void CredentialManager::addCredential(const QString &name, const QString &host, const QString &username, 
                                      const QString &password, const QString &type)
 {
+    if (!m_available) {
+        qWarning() << "Credential store is unavailable, not adding" << name;
+        return;
+    }
+    
     Credential cred;
     cred.id = generateId();
     cred.name = name;
     cred.host = host;
     cred.username = username;
-    cred.password = encryptPassword(password);
+    cred.password = encryptSecret(password, cred.id, "password");
     cred.type = type;
-    cred.lastUsed = QDateTime::currentDateTime().toString(Qt::ISODate);
+    cred.lastUsed = QDateTime::currentMSecsSinceEpoch();
     cred.isDefault = false;
     
     m_credentials.append(cred);
-    saveCredentials();
+    m_index.rebuild(m_credentials);
+    markDirty(cred.id);
     
     qDebug() << "Added credential:" << name << "for host:" << host;
     qDebug() << "Activity: Credential added -" << name << "for" << host << "type" << type;
@@ -48,18 +100,24 @@ void CredentialManager::addCredential(const QString &name, const QString &host,
 void CredentialManager::addSSHKey(const QString &name, const QString &host, const QString &username, 
                                  const QString &privateKey)
 {
+    if (!m_available) {
+        qWarning() << "Credential store is unavailable, not adding" << name;
+        return;
+    }
+    
     Credential cred;
     cred.id = generateId();
     cred.name = name;
     cred.host = host;
     cred.username = username;
-    cred.privateKey = encryptPassword(privateKey); // Encrypt SSH key too
+    cred.privateKey = encryptSecret(privateKey, cred.id, "privateKey"); // Encrypt SSH key too
     cred.type = "SSH Key";
-    cred.lastUsed = QDateTime::currentDateTime().toString(Qt::ISODate);
+    cred.lastUsed = QDateTime::currentMSecsSinceEpoch();
     cred.isDefault = false;
     
     m_credentials.append(cred);
-    saveCredentials();
+    m_index.rebuild(m_credentials);
+    markDirty(cred.id);
     
     emit credentialAdded(cred.id, name, host, "SSH Key");
     emit credentialCountChanged();
@@ -67,90 +125,132 @@ void CredentialManager::addSSHKey(const QString &name, const QString &host, cons
 
 void CredentialManager::removeCredential(int id)
 {
-    for (int i = 0; i < m_credentials.size(); ++i) {
-        if (m_credentials[i].id == id) {
-            QString removedName = m_credentials[i].name;
-            QString removedHost = m_credentials[i].host;
-            m_credentials.removeAt(i);
-            saveCredentials();
-            
-            qDebug() << "Activity: Credential removed -" << removedName << "for" << removedHost;
-            emit credentialRemoved(id);
-            emit credentialCountChanged();
-            break;
-        }
-    }
+    int index = m_index.indexOfId(id);
+    if (index < 0) return;
+    
+    QString removedName = m_credentials[index].name;
+    QString removedHost = m_credentials[index].host;
+    m_credentials.removeAt(index);
+    m_secretCache.remove(id);
+    m_index.rebuild(m_credentials);
+    markDirty(id);
+    
+    qDebug() << "Activity: Credential removed -" << removedName << "for" << removedHost;
+    emit credentialRemoved(id);
+    emit credentialCountChanged();
 }
 
-QJsonObject CredentialManager::getCredentialForHost(const QString &host)
+CredentialHandle CredentialManager::credentialForHost(const QString &host, QString *error)
 {
     // First check if there's a default credential for this host
     if (m_hostDefaults.contains(host)) {
-        int defaultId = m_hostDefaults[host];
-        QJsonObject defaultCred = getCredentialById(defaultId);
-        if (!defaultCred.isEmpty()) {
-            return defaultCred;
+        int index = m_index.indexOfId(m_hostDefaults[host]);
+        if (index >= 0) {
+            return handleAt(index, error);
         }
     }
     
-    // Look for exact host match
-    for (const Credential &cred : m_credentials) {
+    // Exact host, then longest subnet prefix, then most specific wildcard
+    int index = m_index.indexForHost(host);
+    if (index >= 0) {
+        Credential &cred = m_credentials[index];
         if (cred.host == host) {
-            QJsonObject obj;
-            obj["id"] = cred.id;
-            obj["name"] = cred.name;
-            obj["host"] = cred.host;
-            obj["username"] = cred.username;
-            obj["password"] = decryptPassword(cred.password);
-            obj["privateKey"] = decryptPassword(cred.privateKey);
-            obj["type"] = cred.type;
-            
-            // Update last used
-            const_cast<Credential&>(cred).lastUsed = QDateTime::currentDateTime().toString(Qt::ISODate);
-            saveCredentials();
-            
-            return obj;
-        }
-    }
-    
-    // Look for wildcard or subnet match
-    for (const Credential &cred : m_credentials) {
-        if (cred.host.contains("*") || cred.host.contains("/")) {
-            // Simple wildcard matching (could be enhanced)
-            if (host.startsWith(cred.host.left(cred.host.indexOf('*')))) {
-                QJsonObject obj;
-                obj["id"] = cred.id;
-                obj["username"] = cred.username;
-                obj["password"] = decryptPassword(cred.password);
-                obj["privateKey"] = decryptPassword(cred.privateKey);
-                obj["type"] = cred.type;
-                return obj;
-            }
+            // Update last used in memory only; the writer persists it later
+            cred.lastUsed = QDateTime::currentMSecsSinceEpoch();
+            markDirty(cred.id);
         }
+        return handleAt(index, error);
     }
     
     qDebug() << "No credential found for host:" << host;
     emit credentialNotFound(host);
-    return QJsonObject();
+    return CredentialHandle();
 }
 
-QJsonObject CredentialManager::getCredentialById(int id)
+CredentialHandle CredentialManager::credentialById(int id, QString *error)
 {
-    for (const Credential &cred : m_credentials) {
-        if (cred.id == id) {
-            QJsonObject obj;
-            obj["id"] = cred.id;
-            obj["name"] = cred.name;
-            obj["host"] = cred.host;
-            obj["username"] = cred.username;
-            obj["password"] = decryptPassword(cred.password);
-            obj["privateKey"] = decryptPassword(cred.privateKey);
-            obj["type"] = cred.type;
-            obj["lastUsed"] = cred.lastUsed;
-            return obj;
+    int index = m_index.indexOfId(id);
+    return index >= 0 ? handleAt(index, error) : CredentialHandle();
+}
+
+CredentialHandle CredentialManager::handleAt(int index, QString *error)
+{
+    const Credential &cred = m_credentials[index];
+    auto cached = m_secretCache.constFind(cred.id);
+    if (cached != m_secretCache.constEnd()) {
+        return CredentialHandle(cached.value());
+    }
+    
+    if (!m_available) {
+        if (error) {
+            *error = QString("Credential \"%1\" is locked, the credential key file is missing or damaged")
+                         .arg(cred.name);
         }
+        return CredentialHandle();
     }
-    return QJsonObject();
+    
+    // Decrypt once per session, straight into locked memory
+    QByteArray sealedPassword = unwrapSecret(cred.password, cred.id);
+    QByteArray sealedKey = unwrapSecret(cred.privateKey, cred.id);
+    qsizetype passwordLength = sealedPassword.isEmpty() ? 0 : sealedPassword.size() - kSealOverhead;
+    qsizetype keyLength = sealedKey.isEmpty() ? 0 : sealedKey.size() - kSealOverhead;
+    
+    auto secret = QSharedPointer<CredentialSecret>::create(passwordLength + keyLength);
+    // A stored value that doesn't unwrap (legacy format) counts as a failure too
+    bool ok = (cred.password.isEmpty() || !sealedPassword.isEmpty())
+              && (cred.privateKey.isEmpty() || !sealedKey.isEmpty())
+              && secret->buffer.size() == passwordLength + keyLength
+              && openSecret(sealedPassword, cred.id, "password", secret->buffer.data())
+              && openSecret(sealedKey, cred.id, "privateKey", secret->buffer.data() + passwordLength);
+    if (!ok) {
+        // Not cached, and never handed out as an empty secret that looks usable
+        if (error) {
+            *error = QString("Credential \"%1\" could not be decrypted").arg(cred.name);
+        }
+        qWarning() << "Credential" << cred.id << "could not be decrypted";
+        return CredentialHandle();
+    }
+    
+    secret->id = cred.id;
+    secret->name = cred.name;
+    secret->host = cred.host;
+    secret->username = cred.username;
+    secret->type = cred.type;
+    secret->passwordLength = passwordLength;
+    
+    m_secretCache.insert(cred.id, secret);
+    return CredentialHandle(secret);
+}
+
+QJsonObject CredentialManager::getCredentialForHost(const QString &host)
+{
+    return credentialToJson(credentialForHost(host));
+}
+
+QJsonObject CredentialManager::getCredentialById(int id)
+{
+    int index = m_index.indexOfId(id);
+    if (index < 0) return QJsonObject();
+    
+    QJsonObject obj = credentialToJson(handleAt(index));
+    obj["lastUsed"] = formatLastUsed(m_credentials[index].lastUsed);
+    return obj;
+}
+
+QJsonObject CredentialManager::credentialToJson(const CredentialHandle &handle)
+{
+    // Copies the secrets out of locked memory; C++ callers should keep the handle
+    if (!handle.isValid()) return QJsonObject();
+    
+    QJsonObject obj;
+    obj["id"] = handle.id();
+    obj["name"] = handle.name();
+    obj["host"] = handle.host();
+    obj["username"] = handle.username();
+    obj["password"] = QString::fromUtf8(handle.password());
+    obj["privateKey"] = QString::fromUtf8(handle.privateKey());
+    obj["type"] = handle.type();
+    return obj;
 }
 
 QJsonArray CredentialManager::getAllCredentials()
@@ -163,7 +263,7 @@ QJsonArray CredentialManager::getAllCredentials()
         obj["host"] = cred.host;
         obj["username"] = cred.username;
         obj["type"] = cred.type;
-        obj["lastUsed"] = cred.lastUsed;
+        obj["lastUsed"] = formatLastUsed(cred.lastUsed);
         // Don't include password/key in list view
         array.append(obj);
     }
@@ -187,13 +287,76 @@ bool CredentialManager::testCredential(int id)
 {
     // This would test the credential by attempting a connection
     // For now, just return true if credential exists
-    return !getCredentialById(id).isEmpty();
+    return credentialById(id).isValid();
+}
+
+void CredentialManager::initDatabase()
+{
+    QString connectionName = QString("CredentialDB_%1").arg(reinterpret_cast<quintptr>(this));
+    m_database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    m_database.setDatabaseName(m_databasePath);
+    
+    if (!m_database.open()) {
+        qWarning() << "Failed to open credential database:" << m_database.lastError().text();
+        return;
+    }
+    
+    // WAL keeps small incremental writes append-only and readers unblocked
+    QSqlQuery query(m_database);
+    query.exec("PRAGMA journal_mode=WAL");
+    query.exec("CREATE TABLE IF NOT EXISTS credentials ("
+               "id INTEGER PRIMARY KEY, "
+               "name TEXT NOT NULL, "
+               "host TEXT NOT NULL, "
+               "username TEXT, "
+               "password TEXT, "
+               "private_key TEXT, "
+               "type TEXT, "
+               "last_used INTEGER, "
+               "is_default INTEGER)");
 }
 
 void CredentialManager::loadCredentials()
 {
     m_credentials.clear();
     
+    QSqlQuery query(m_database);
+    query.exec("SELECT id, name, host, username, password, private_key, type, last_used, is_default "
+               "FROM credentials ORDER BY id");
+    
+    while (query.next()) {
+        Credential cred;
+        cred.id = query.value(0).toInt();
+        cred.name = query.value(1).toString();
+        cred.host = query.value(2).toString();
+        cred.username = query.value(3).toString();
+        cred.password = query.value(4).toString();
+        cred.privateKey = query.value(5).toString();
+        cred.type = query.value(6).toString();
+        cred.lastUsed = query.value(7).toLongLong();
+        cred.isDefault = query.value(8).toBool();
+        
+        m_credentials.append(cred);
+        m_nextId = qMax(m_nextId, cred.id + 1);
+    }
+    
+    importLegacyCredentials();
+    m_index.rebuild(m_credentials);
+    
+    // Load host defaults
+    m_settings->beginGroup("HostDefaults");
+    QStringList hosts = m_settings->childKeys();
+    for (const QString &host : hosts) {
+        m_hostDefaults[host] = m_settings->value(host).toInt();
+    }
+    m_settings->endGroup();
+    
+    qDebug() << "Loaded" << m_credentials.size() << "credentials";
+}
+
+void CredentialManager::importLegacyCredentials()
+{
+    // Move credentials from the old QSettings array into the database once
     int size = m_settings->beginReadArray("Credentials");
     for (int i = 0; i < size; ++i) {
         m_settings->setArrayIndex(i);
@@ -206,112 +369,246 @@ void CredentialManager::loadCredentials()
         cred.password = m_settings->value("password").toString();
         cred.privateKey = m_settings->value("privateKey").toString();
         cred.type = m_settings->value("type").toString();
-        cred.lastUsed = m_settings->value("lastUsed").toString();
+        cred.lastUsed = QDateTime::fromString(m_settings->value("lastUsed").toString(), Qt::ISODate).toMSecsSinceEpoch();
         cred.isDefault = m_settings->value("isDefault").toBool();
         
         m_credentials.append(cred);
         m_nextId = qMax(m_nextId, cred.id + 1);
+        m_dirtyIds.insert(cred.id);
     }
     m_settings->endArray();
     
-    // Load host defaults
-    m_settings->beginGroup("HostDefaults");
-    QStringList hosts = m_settings->childKeys();
-    for (const QString &host : hosts) {
-        m_hostDefaults[host] = m_settings->value(host).toInt();
+    if (size > 0) {
+        qDebug() << "Migrating" << size << "credentials from" << m_settings->fileName();
+        
+        // flushDirty resolves ids through the index; unindexed ids would be
+        // taken for deletions. The legacy array stays the only copy until the
+        // database has committed.
+        m_index.rebuild(m_credentials);
+        bool committed = false;
+        flushDirty(&committed);
+        m_writer.waitForDone();
+        if (committed) {
+            m_settings->remove("Credentials");
+            m_settings->sync();
+        } else {
+            qWarning() << "Credential migration failed, keeping" << m_settings->fileName();
+        }
     }
-    m_settings->endGroup();
-    
-    qDebug() << "Loaded" << m_credentials.size() << "credentials";
 }
 
-void CredentialManager::saveCredentials()
+void CredentialManager::markDirty(int id)
 {
-    m_settings->beginWriteArray("Credentials");
-    for (int i = 0; i < m_credentials.size(); ++i) {
-        m_settings->setArrayIndex(i);
-        const Credential &cred = m_credentials[i];
-        
-        m_settings->setValue("id", cred.id);
-        m_settings->setValue("name", cred.name);
-        m_settings->setValue("host", cred.host);
-        m_settings->setValue("username", cred.username);
-        m_settings->setValue("password", cred.password);
-        m_settings->setValue("privateKey", cred.privateKey);
-        m_settings->setValue("type", cred.type);
-        m_settings->setValue("lastUsed", cred.lastUsed);
-        m_settings->setValue("isDefault", cred.isDefault);
+    m_dirtyIds.insert(id);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
     }
-    m_settings->endArray();
-    m_settings->sync();
 }
 
-QString CredentialManager::encryptPassword(const QString &password)
+void CredentialManager::flushDirty(bool *committed)
 {
-    if (password.isEmpty()) return QString();
-    
-    // Simple XOR encryption (in production, use proper AES encryption)
-    QByteArray data = password.toUtf8();
-    QByteArray key = m_encryptionKey.toUtf8();
+    if (m_dirtyIds.isEmpty()) {
+        if (committed) *committed = true;
+        return;
+    }
     
-    for (int i = 0; i < data.size(); ++i) {
-        data[i] = data[i] ^ key[i % key.size()];
+    // Snapshot only the changed records; ids no longer present are deletions
+    QList<Credential> changed;
+    QList<int> removed;
+    for (int id : std::as_const(m_dirtyIds)) {
+        int index = m_index.indexOfId(id);
+        if (index >= 0) {
+            changed.append(m_credentials[index]);
+        } else {
+            removed.append(id);
+        }
     }
+    m_dirtyIds.clear();
     
-    return data.toBase64();
+    QString databasePath = m_databasePath;
+    QRunnable *task = QRunnable::create([databasePath, changed, removed, committed]() {
+        bool ok = false;
+        QString connectionName = QString("CredentialWriter_%1")
+                                     .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+            db.setDatabaseName(databasePath);
+            if (!db.open()) {
+                qWarning() << "Credential writer failed to open database:" << db.lastError().text();
+            } else {
+                // All or nothing, so a failed flush never leaves a partial store
+                ok = db.transaction();
+                
+                QSqlQuery upsert(db);
+                upsert.prepare("INSERT OR REPLACE INTO credentials "
+                               "(id, name, host, username, password, private_key, type, last_used, is_default) "
+                               "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+                for (const Credential &cred : changed) {
+                    upsert.addBindValue(cred.id);
+                    upsert.addBindValue(cred.name);
+                    upsert.addBindValue(cred.host);
+                    upsert.addBindValue(cred.username);
+                    upsert.addBindValue(cred.password);
+                    upsert.addBindValue(cred.privateKey);
+                    upsert.addBindValue(cred.type);
+                    upsert.addBindValue(cred.lastUsed);
+                    upsert.addBindValue(cred.isDefault);
+                    if (!upsert.exec()) {
+                        qWarning() << "Failed to save credential" << cred.id << upsert.lastError().text();
+                        ok = false;
+                    }
+                }
+                
+                QSqlQuery remove(db);
+                remove.prepare("DELETE FROM credentials WHERE id = ?");
+                for (int id : removed) {
+                    remove.addBindValue(id);
+                    if (!remove.exec()) {
+                        qWarning() << "Failed to delete credential" << id << remove.lastError().text();
+                        ok = false;
+                    }
+                }
+                
+                if (ok && !db.commit()) {
+                    qWarning() << "Failed to commit credentials:" << db.lastError().text();
+                    ok = false;
+                }
+                if (!ok) {
+                    db.rollback();
+                }
+                db.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+        if (committed) *committed = ok;
+    });
+    task->setAutoDelete(true);
+    m_writer.start(task);
 }
 
-QString CredentialManager::decryptPassword(const QString &encryptedPassword)
+QString CredentialManager::encryptSecret(const QString &secret, int id, const char *field)
 {
-    if (encryptedPassword.isEmpty()) return QString();
+    if (secret.isEmpty()) return QString();
+    
+    QByteArray plaintext = secret.toUtf8();
+    QByteArray aad = secretAad(id, field);
+    QByteArray sealed(Aead::NonceSize + plaintext.size() + Aead::TagSize, Qt::Uninitialized);
+    quint8 *out = reinterpret_cast<quint8*>(sealed.data());
+    
+    // Random 96-bit nonce per secret, fresh on every re-encryption
+    quint32 nonce[Aead::NonceSize / sizeof(quint32)];
+    QRandomGenerator::system()->fillRange(nonce);
+    memcpy(out, nonce, Aead::NonceSize);
     
-    QByteArray data = QByteArray::fromBase64(encryptedPassword.toUtf8());
-    QByteArray key = m_encryptionKey.toUtf8();
+    Aead::seal(reinterpret_cast<const quint8*>(m_masterKey.constData()), out,
+               reinterpret_cast<const quint8*>(aad.constData()), aad.size(),
+               reinterpret_cast<const quint8*>(plaintext.constData()), plaintext.size(),
+               out + Aead::NonceSize, out + Aead::NonceSize + plaintext.size());
+    SecureBuffer::wipe(plaintext.data(), plaintext.size());
+    
+    return kSecretPrefix + QString::fromLatin1(sealed.toBase64());
+}
+
+QByteArray CredentialManager::unwrapSecret(const QString &stored, int id)
+{
+    if (stored.isEmpty()) return QByteArray();
     
-    for (int i = 0; i < data.size(); ++i) {
-        data[i] = data[i] ^ key[i % key.size()];
+    if (!stored.startsWith(kSecretPrefix)) {
+        // Pre-AEAD values were XORed with a per-launch key and cannot be recovered
+        qWarning() << "Credential" << id << "uses the legacy format and must be re-entered";
+        return QByteArray();
     }
     
-    return QString::fromUtf8(data);
+    QByteArray sealed = QByteArray::fromBase64(stored.mid(kSecretPrefix.size()).toLatin1());
+    return sealed.size() >= kSealOverhead ? sealed : QByteArray();
+}
+
+bool CredentialManager::openSecret(const QByteArray &sealed, int id, const char *field, char *out)
+{
+    if (sealed.isEmpty()) return true;
+    
+    QByteArray aad = secretAad(id, field);
+    const quint8 *in = reinterpret_cast<const quint8*>(sealed.constData());
+    qsizetype length = sealed.size() - kSealOverhead;
+    
+    return Aead::open(reinterpret_cast<const quint8*>(m_masterKey.constData()), in,
+                      reinterpret_cast<const quint8*>(aad.constData()), aad.size(),
+                      in + Aead::NonceSize, length, in + Aead::NonceSize + length,
+                      reinterpret_cast<quint8*>(out));
 }
 
 void CredentialManager::updateCredential(int id, const QString &name, const QString &host, 
                                          const QString &username, const QString &password, const QString &type)
 {
-    for (Credential &cred : m_credentials) {
-        if (cred.id == id) {
-            cred.name = name;
-            cred.host = host;
-            cred.username = username;
-            if (!password.isEmpty()) {
-                cred.password = encryptPassword(password);
-            }
-            cred.type = type;
-            cred.lastUsed = QDateTime::currentDateTime().toString(Qt::ISODate);
-            
-            saveCredentials();
-            emit credentialUpdated(id);
-            break;
-        }
+    int index = m_index.indexOfId(id);
+    if (index < 0) return;
+    if (!m_available && !password.isEmpty()) {
+        qWarning() << "Credential store is unavailable, not updating" << id;
+        return;
+    }
+    
+    Credential &cred = m_credentials[index];
+    cred.name = name;
+    cred.host = host;
+    cred.username = username;
+    if (!password.isEmpty()) {
+        cred.password = encryptSecret(password, id, "password");
     }
+    cred.type = type;
+    cred.lastUsed = QDateTime::currentMSecsSinceEpoch();
+    
+    m_secretCache.remove(id);
+    m_index.rebuild(m_credentials);
+    markDirty(id);
+    emit credentialUpdated(id);
 }
 
-void CredentialManager::generateEncryptionKey()
+bool CredentialManager::loadMasterKey(const QString &keyPath)
 {
-    // Generate secure 32-byte key from system entropy
-    QByteArray entropy;
-    QFile urandom("/dev/urandom");
-    if (urandom.open(QIODevice::ReadOnly)) {
-        entropy = urandom.read(32);
-        urandom.close();
-    } else {
-        // Fallback for Windows - use current time + process ID
-        entropy = QByteArray::number(QDateTime::currentMSecsSinceEpoch());
-        entropy += QByteArray::number(QCoreApplication::applicationPid());
-        entropy += QByteArray::number(QRandomGenerator::global()->bounded(100));
+    // 256-bit key kept beside the store, readable by the owner only
+    QFile keyFile(keyPath);
+    if (keyFile.exists()) {
+        if (keyFile.open(QIODevice::ReadOnly) && keyFile.read(m_masterKey.data(), Aead::KeySize) == Aead::KeySize) {
+            return true;
+        }
+        // A new key would make every stored secret unrecoverable; leave the file for repair
+        qCritical() << "Credential key file" << keyPath << "is unreadable or corrupt,"
+                    << "the credential store stays locked until it is restored";
+        return false;
+    }
+    
+    if (hasSealedSecrets()) {
+        qCritical() << "Credential key file" << keyPath << "is missing but the store holds encrypted"
+                    << "secrets, the credential store stays locked until it is restored";
+        return false;
     }
     
-    m_encryptionKey = entropy.toBase64().left(32);
+    quint32 *words = reinterpret_cast<quint32*>(m_masterKey.data());
+    QRandomGenerator::system()->fillRange(words, Aead::KeySize / int(sizeof(quint32)));
+    
+    // Created owner-only, and never over an existing file
+    if (!keyFile.open(QIODevice::WriteOnly | QIODevice::NewOnly, QFile::ReadOwner | QFile::WriteOwner)) {
+        qCritical() << "Failed to create credential key:" << keyFile.errorString();
+        return false;
+    }
+    if (keyFile.write(m_masterKey.constData(), Aead::KeySize) != Aead::KeySize || !keyFile.flush()) {
+        qCritical() << "Failed to persist credential key:" << keyFile.errorString();
+        keyFile.close();
+        keyFile.remove();
+        return false;
+    }
+    keyFile.close();
+    return true;
+}
+
+bool CredentialManager::hasSealedSecrets()
+{
+    QSqlQuery query(m_database);
+    if (!query.exec("SELECT 1 FROM credentials WHERE password LIKE 'v1:%' OR private_key LIKE 'v1:%' LIMIT 1")) {
+        // Can't tell, so assume there are
+        return m_database.isOpen() || QFile::exists(m_databasePath);
+    }
+    return query.next();
 }
 
 int CredentialManager::generateId()
@@ -8,6 +8,12 @@
 #include <QJsonArray>
 #include <QCoreApplication>
 #include <QFile>
+#include <QSqlDatabase>
+#include <QSet>
+#include <QTimer>
+#include <QThreadPool>
+#include "CredentialIndex.h"
+#include "CredentialHandle.h"
 
 struct Credential {
     int id;
@@ -17,7 +23,7 @@ struct Credential {
     QString password;
     QString privateKey;
     QString type; // SSH, Password, Windows, Domain
-    QString lastUsed;
+    qint64 lastUsed; // ms since epoch, kept in memory and flushed lazily
     bool isDefault;
 };
 
@@ -25,11 +31,20 @@ class CredentialManager : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(int credentialCount READ credentialCount NOTIFY credentialCountChanged)
+    Q_PROPERTY(bool available READ isAvailable CONSTANT)
 
 public:
     explicit CredentialManager(QObject *parent = nullptr);
+    ~CredentialManager();
     
     int credentialCount() const { return m_credentials.size(); }
+    // False when the key file is missing or damaged; nothing can be sealed or opened
+    bool isAvailable() const { return m_available; }
+    
+    // Secrets decrypted once per session into locked memory and shared by handle.
+    // A credential that fails to decrypt gives an invalid handle and sets error.
+    CredentialHandle credentialForHost(const QString &host, QString *error = nullptr);
+    CredentialHandle credentialById(int id, QString *error = nullptr);
 
 public slots:
     void addCredential(const QString &name, const QString &host, const QString &username, 
@@ -60,16 +75,32 @@ signals:
     void credentialPromptRequired(const QString &host, const QString &protocol);
 
 private:
+    void initDatabase();
     void loadCredentials();
-    void saveCredentials();
-    void generateEncryptionKey();
-    QString encryptPassword(const QString &password);
-    QString decryptPassword(const QString &encryptedPassword);
+    void importLegacyCredentials();
+    void markDirty(int id);
+    // committed, if given, is set once the write finishes; wait on m_writer first
+    void flushDirty(bool *committed = nullptr);
+    bool loadMasterKey(const QString &keyPath);
+    bool hasSealedSecrets();
+    QString encryptSecret(const QString &secret, int id, const char *field);
+    bool openSecret(const QByteArray &sealed, int id, const char *field, char *out);
+    QByteArray unwrapSecret(const QString &stored, int id);
+    CredentialHandle handleAt(int index, QString *error = nullptr);
+    QJsonObject credentialToJson(const CredentialHandle &handle);
     int generateId();
     
     QList<Credential> m_credentials;
+    CredentialIndex m_index;
     QHash<QString, int> m_hostDefaults; // host -> credential ID mapping
     QSettings *m_settings;
-    QString m_encryptionKey;
+    QSqlDatabase m_database;
+    QString m_databasePath;
+    QSet<int> m_dirtyIds;
+    QTimer *m_flushTimer;
+    QThreadPool m_writer; // single thread, flushes run in submission order
+    SecureBuffer m_masterKey;
+    bool m_available;
+    QHash<int, QSharedPointer<const CredentialSecret>> m_secretCache;
     int m_nextId;
 };
@@ -0,0 +1,129 @@
+#include "CronExpression.h"
+#include <QRegularExpression>
+#include <QStringList>
+
+namespace {
+const int kSearchYears = 5;
+
+// Sets a bit per value a field allows; false on anything out of range
+bool parseField(const QString &field, int min, int max, quint64 *bits)
+{
+    *bits = 0;
+    const QStringList items = field.split(',');
+    for (const QString &item : items) {
+        QString range = item;
+        int step = 1;
+        const int slash = item.indexOf('/');
+        if (slash >= 0) {
+            bool ok = false;
+            step = item.mid(slash + 1).toInt(&ok);
+            if (!ok || step < 1)
+                return false;
+            range = item.left(slash);
+        }
+
+        int first = min;
+        int last = max;
+        if (range != "*") {
+            const int dash = range.indexOf('-');
+            bool ok = false;
+            first = (dash < 0 ? range : range.left(dash)).toInt(&ok);
+            if (!ok)
+                return false;
+            if (dash >= 0) {
+                last = range.mid(dash + 1).toInt(&ok);
+                if (!ok)
+                    return false;
+            } else if (slash < 0) {
+                last = first; // "n"; "n/step" runs to the end of the field
+            }
+        }
+        if (first < min || last > max || first > last)
+            return false;
+        for (int value = first; value <= last; value += step)
+            *bits |= quint64(1) << value;
+    }
+    return *bits != 0;
+}
+}
+
+CronExpression CronExpression::parse(const QString &text)
+{
+    CronExpression cron;
+    cron.m_text = text.trimmed();
+
+    QString expanded = cron.m_text;
+    if (expanded == "@hourly")
+        expanded = "0 * * * *";
+    else if (expanded == "@daily")
+        expanded = "0 0 * * *";
+    else if (expanded == "@weekly")
+        expanded = "0 0 * * 0";
+    else if (expanded == "@monthly")
+        expanded = "0 0 1 * *";
+
+    const QStringList fields = expanded.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    if (fields.size() != 5)
+        return cron;
+
+    quint64 hours = 0;
+    quint64 days = 0;
+    quint64 months = 0;
+    quint64 weekdays = 0;
+    if (!parseField(fields.at(0), 0, 59, &cron.m_minutes) || !parseField(fields.at(1), 0, 23, &hours)
+        || !parseField(fields.at(2), 1, 31, &days) || !parseField(fields.at(3), 1, 12, &months)
+        || !parseField(fields.at(4), 0, 7, &weekdays))
+        return cron;
+
+    cron.m_hours = quint32(hours);
+    cron.m_days = quint32(days);
+    cron.m_months = quint32(months);
+    cron.m_weekdays = quint32((weekdays | (weekdays >> 7)) & 0x7f); // 7 is Sunday as well
+    cron.m_anyDay = fields.at(2).startsWith('*');
+    cron.m_anyWeekday = fields.at(4).startsWith('*');
+    cron.m_valid = true;
+    return cron;
+}
+
+bool CronExpression::matchesDay(const QDate &date) const
+{
+    if (!(m_months >> date.month() & 1))
+        return false;
+    const bool day = m_days >> date.day() & 1;
+    const bool weekday = m_weekdays >> (date.dayOfWeek() % 7) & 1;
+    if (m_anyDay && m_anyWeekday)
+        return true;
+    if (m_anyDay)
+        return weekday;
+    if (m_anyWeekday)
+        return day;
+    return day || weekday;
+}
+
+QDateTime CronExpression::next(const QDateTime &from) const
+{
+    if (!m_valid || !from.isValid())
+        return QDateTime();
+
+    // Whole minutes, strictly after from
+    const QDateTime start = from.toLocalTime().addSecs(60);
+    const QDate startDate = start.date();
+    const QDate limit = startDate.addYears(kSearchYears);
+
+    // Day by day, then the first allowed hour and minute within the day
+    for (QDate date = startDate; date <= limit; date = date.addDays(1)) {
+        if (!matchesDay(date))
+            continue;
+        const bool today = date == startDate;
+        for (int hour = today ? start.time().hour() : 0; hour < 24; ++hour) {
+            if (!(m_hours >> hour & 1))
+                continue;
+            const int firstMinute = today && hour == start.time().hour() ? start.time().minute() : 0;
+            for (int minute = firstMinute; minute < 60; ++minute) {
+                if (m_minutes >> minute & 1)
+                    return QDateTime(date, QTime(hour, minute));
+            }
+        }
+    }
+    return QDateTime();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QDateTime>
+#include <QString>
+
+// Five-field cron schedule, "minute hour day-of-month month day-of-week",
+// each field "*", "n", "a-b" or a comma list of those, any of them with a
+// "/step". Day-of-week counts 0-6 from Sunday, 7 being Sunday too, and as
+// in cron a time matches either day field when both are restricted.
+// "@hourly", "@daily", "@weekly" and "@monthly" are accepted as well.
+class CronExpression
+{
+public:
+    CronExpression() = default;
+
+    static CronExpression parse(const QString &text);
+
+    bool isValid() const { return m_valid; }
+    QString text() const { return m_text; }
+
+    // First matching minute after from, in local time; invalid when nothing
+    // matches within five years (e.g. "0 0 31 2 *")
+    QDateTime next(const QDateTime &from) const;
+
+private:
+    bool matchesDay(const QDate &date) const;
+
+    quint64 m_minutes = 0;  // one bit per allowed value
+    quint32 m_hours = 0;
+    quint32 m_days = 0;     // bits 1-31
+    quint32 m_months = 0;   // bits 1-12
+    quint32 m_weekdays = 0; // bits 0-6, Sunday first
+    bool m_anyDay = false;     // day-of-month field starts with "*"
+    bool m_anyWeekday = false; // day-of-week field starts with "*"
+    bool m_valid = false;
+    QString m_text;
+};
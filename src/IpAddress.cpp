@@ -0,0 +1,218 @@
+#include "IpAddress.h"
+#include <limits>
+
+IpAddress IpAddress::fromIPv4(quint32 address)
+{
+    IpAddress ip;
+    ip.m_family = IPv4;
+    ip.m_bytes[12] = quint8(address >> 24);
+    ip.m_bytes[13] = quint8(address >> 16);
+    ip.m_bytes[14] = quint8(address >> 8);
+    ip.m_bytes[15] = quint8(address);
+    return ip;
+}
+
+IpAddress IpAddress::fromIPv6(const Q_IPV6ADDR &address)
+{
+    IpAddress ip;
+    ip.m_family = IPv6;
+    std::memcpy(ip.m_bytes, address.c, 16);
+    return ip;
+}
+
+IpAddress IpAddress::fromHostAddress(const QHostAddress &address)
+{
+    switch (address.protocol()) {
+    case QAbstractSocket::IPv4Protocol:
+        return fromIPv4(address.toIPv4Address());
+    case QAbstractSocket::IPv6Protocol: {
+        // Treat ::ffff:a.b.c.d as the IPv4 host it is
+        bool mapped = false;
+        const quint32 v4 = address.toIPv4Address(&mapped);
+        return mapped ? fromIPv4(v4) : fromIPv6(address.toIPv6Address());
+    }
+    default:
+        return IpAddress();
+    }
+}
+
+IpAddress IpAddress::fromString(const QString &text)
+{
+    QString trimmed = text.trimmed();
+    const int scope = trimmed.indexOf('%');
+    if (scope >= 0)
+        trimmed.truncate(scope);
+
+    QHostAddress address;
+    if (!address.setAddress(trimmed))
+        return IpAddress();
+    return fromHostAddress(address);
+}
+
+quint32 IpAddress::toIPv4() const
+{
+    if (m_family != IPv4)
+        return 0;
+    return (quint32(m_bytes[12]) << 24) | (quint32(m_bytes[13]) << 16) | (quint32(m_bytes[14]) << 8) | m_bytes[15];
+}
+
+Q_IPV6ADDR IpAddress::toIPv6() const
+{
+    Q_IPV6ADDR address;
+    std::memcpy(address.c, m_bytes, 16);
+    if (m_family == IPv4) {
+        address.c[10] = 0xff;
+        address.c[11] = 0xff;
+    }
+    return address;
+}
+
+QHostAddress IpAddress::toHostAddress() const
+{
+    switch (m_family) {
+    case IPv4: return QHostAddress(toIPv4());
+    case IPv6: return QHostAddress(toIPv6());
+    default: return QHostAddress();
+    }
+}
+
+QString IpAddress::toString() const
+{
+    return isValid() ? toHostAddress().toString() : QString();
+}
+
+bool IpAddress::bit(int index) const
+{
+    if (index < 0 || index >= bitLength())
+        return false;
+    return (familyBytes()[index / 8] >> (7 - index % 8)) & 1;
+}
+
+IpAddress IpAddress::masked(int prefixLength) const
+{
+    IpAddress result = *this;
+    quint8 *bytes = result.m_bytes + (m_family == IPv4 ? 12 : 0);
+    const int length = bitLength() / 8;
+    for (int i = 0; i < length; ++i) {
+        const int keep = qBound(0, prefixLength - i * 8, 8);
+        bytes[i] &= quint8(0xFF00 >> keep);
+    }
+    return result;
+}
+
+IpAddress IpAddress::lastInBlock(int prefixLength) const
+{
+    IpAddress result = *this;
+    quint8 *bytes = result.m_bytes + (m_family == IPv4 ? 12 : 0);
+    const int length = bitLength() / 8;
+    for (int i = 0; i < length; ++i) {
+        const int keep = qBound(0, prefixLength - i * 8, 8);
+        bytes[i] |= quint8(0xFF >> keep);
+    }
+    return result;
+}
+
+IpAddress IpAddress::offset(quint64 delta) const
+{
+    IpAddress result = *this;
+    const int first = m_family == IPv4 ? 12 : 0;
+    for (int i = 15; i >= first && delta; --i) {
+        const quint64 sum = quint64(result.m_bytes[i]) + (delta & 0xFF);
+        result.m_bytes[i] = quint8(sum);
+        delta = (delta >> 8) + (sum >> 8);
+    }
+    return result;
+}
+
+quint64 IpAddress::distanceTo(const IpAddress &other) const
+{
+    if (m_family != other.m_family || other < *this)
+        return 0;
+
+    // Borrowing subtraction over the family bytes, high bytes must cancel
+    quint8 diff[16];
+    int borrow = 0;
+    for (int i = 15; i >= 0; --i) {
+        const int value = int(other.m_bytes[i]) - int(m_bytes[i]) - borrow;
+        borrow = value < 0 ? 1 : 0;
+        diff[i] = quint8(value + (borrow << 8));
+    }
+    for (int i = 0; i < 8; ++i) {
+        if (diff[i])
+            return std::numeric_limits<quint64>::max();
+    }
+    quint64 distance = 0;
+    for (int i = 8; i < 16; ++i)
+        distance = (distance << 8) | diff[i];
+    return distance;
+}
+
+IpSubnet IpSubnet::parse(const QString &cidr)
+{
+    const QString trimmed = cidr.trimmed();
+    const int slash = trimmed.indexOf('/');
+    const IpAddress address = IpAddress::fromString(slash < 0 ? trimmed : trimmed.left(slash));
+    if (!address.isValid())
+        return IpSubnet();
+
+    int prefix = address.bitLength();
+    if (slash >= 0) {
+        bool ok = false;
+        prefix = trimmed.mid(slash + 1).toInt(&ok);
+        if (!ok || prefix < 0 || prefix > address.bitLength())
+            return IpSubnet();
+    }
+    return of(address, prefix);
+}
+
+IpSubnet IpSubnet::of(const IpAddress &address, int prefixLength)
+{
+    IpSubnet subnet;
+    subnet.network = address.masked(prefixLength);
+    subnet.prefixLength = prefixLength;
+    return subnet;
+}
+
+bool IpSubnet::contains(const IpAddress &address) const
+{
+    return isValid() && address.family() == network.family() && address.masked(prefixLength) == network;
+}
+
+IpAddress IpSubnet::last() const
+{
+    return network.lastInBlock(prefixLength);
+}
+
+quint64 IpSubnet::size() const
+{
+    const int hostBits = network.bitLength() - prefixLength;
+    return hostBits >= 64 ? std::numeric_limits<quint64>::max() : quint64(1) << hostBits;
+}
+
+QString IpSubnet::toString() const
+{
+    return QString("%1/%2").arg(network.toString()).arg(prefixLength);
+}
+
+QStringList IpSubnet::hosts(int limit) const
+{
+    QStringList result;
+    if (!isValid() || limit <= 0)
+        return result;
+
+    quint64 first = 0;
+    quint64 count = size();
+    if (network.isIPv4() && prefixLength < 31) {
+        first = 1;     // network address
+        count -= 2;    // and broadcast
+    } else if (network.isIPv6() && prefixLength < 127) {
+        first = 1;     // subnet-router anycast
+        count -= 1;
+    }
+
+    const quint64 total = qMin<quint64>(count, quint64(limit));
+    result.reserve(int(total));
+    for (quint64 i = 0; i < total; ++i)
+        result << network.offset(first + i).toString();
+    return result;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QHostAddress>
+#include <QString>
+#include <QStringList>
+#include <cstring>
+
+// Compact value type for either address family: 16 bytes plus a family tag,
+// IPv4 stored in its last 4 bytes. Ordering (IPv4 first), hashing and prefix
+// arithmetic work the same for both families, without QHostAddress's shared
+// private data or string round trips.
+class IpAddress
+{
+public:
+    enum Family : quint8 { Invalid, IPv4, IPv6 };
+
+    IpAddress() : m_family(Invalid) { std::memset(m_bytes, 0, sizeof(m_bytes)); }
+
+    static IpAddress fromIPv4(quint32 address);
+    static IpAddress fromIPv6(const Q_IPV6ADDR &address);
+    static IpAddress fromHostAddress(const QHostAddress &address);
+    static IpAddress fromString(const QString &text); // scope ids are dropped
+
+    bool isValid() const { return m_family != Invalid; }
+    bool isIPv4() const { return m_family == IPv4; }
+    bool isIPv6() const { return m_family == IPv6; }
+    Family family() const { return Family(m_family); }
+    int bitLength() const { return m_family == IPv4 ? 32 : 128; }
+
+    quint32 toIPv4() const;
+    Q_IPV6ADDR toIPv6() const;
+    QHostAddress toHostAddress() const;
+    QString toString() const;
+
+    bool bit(int index) const; // from the most significant bit of the family
+    IpAddress masked(int prefixLength) const;
+    IpAddress lastInBlock(int prefixLength) const; // host bits all set
+    IpAddress offset(quint64 delta) const; // wraps within the family
+    quint64 distanceTo(const IpAddress &other) const; // saturates at quint64 max
+
+    bool operator==(const IpAddress &other) const
+    {
+        return m_family == other.m_family && std::memcmp(m_bytes, other.m_bytes, sizeof(m_bytes)) == 0;
+    }
+    bool operator!=(const IpAddress &other) const { return !(*this == other); }
+    bool operator<(const IpAddress &other) const
+    {
+        if (m_family != other.m_family)
+            return m_family < other.m_family;
+        return std::memcmp(m_bytes, other.m_bytes, sizeof(m_bytes)) < 0;
+    }
+    bool operator>(const IpAddress &other) const { return other < *this; }
+    bool operator<=(const IpAddress &other) const { return !(other < *this); }
+    bool operator>=(const IpAddress &other) const { return !(*this < other); }
+
+    friend size_t qHash(const IpAddress &address, size_t seed = 0)
+    {
+        return qHashBits(address.m_bytes, sizeof(address.m_bytes), seed ^ address.m_family);
+    }
+
+private:
+    const quint8 *familyBytes() const { return m_bytes + (m_family == IPv4 ? 12 : 0); }
+
+    quint8 m_bytes[16];
+    quint8 m_family;
+};
+
+// "address/prefix" block with the host bits cleared
+struct IpSubnet {
+    IpAddress network;
+    int prefixLength = -1;
+
+    static IpSubnet parse(const QString &cidr);
+    static IpSubnet of(const IpAddress &address, int prefixLength);
+
+    bool isValid() const { return network.isValid() && prefixLength >= 0; }
+    bool contains(const IpAddress &address) const;
+    IpAddress last() const;
+    quint64 size() const; // saturates for IPv6 blocks wider than 2^64
+    QString toString() const;
+
+    // Usable host addresses in order, skipping IPv4 network/broadcast, at most limit
+    QStringList hosts(int limit) const;
+};
@@ -0,0 +1,212 @@
+#include "Ipv6Discovery.h"
+#include <QProcess>
+#include <QRegularExpression>
+#include <QNetworkInterface>
+#include <QHostInfo>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSet>
+#include <QMap>
+#include <QDebug>
+
+namespace {
+const int kEchoTimeoutMs = 4000;
+const int kMaxLookupThreads = 16;
+
+QString runTool(const QString &program, const QStringList &arguments, int timeoutMs)
+{
+    QProcess process;
+    process.start(program, arguments);
+    if (!process.waitForFinished(timeoutMs)) {
+        process.kill();
+        process.waitForFinished(500);
+    }
+    return QString::fromLocal8Bit(process.readAllStandardOutput());
+}
+
+bool isUsableNeighbor(const IpAddress &address)
+{
+    // Skip multicast entries some stacks list alongside real neighbours
+    return address.isIPv6() && address.toIPv6()[0] != 0xff;
+}
+}
+
+QList<Ipv6Discovery::Neighbor> Ipv6Discovery::neighborCache()
+{
+    QList<Neighbor> neighbors;
+
+#ifdef Q_OS_WIN
+    // "Interface 12: Ethernet" headers, then "address  mac  state" rows
+    const QString output = runTool("netsh", QStringList() << "interface" << "ipv6" << "show" << "neighbors", 5000);
+    static const QRegularExpression headerRegex(R"(^Interface\s+(\d+):)");
+    static const QRegularExpression rowRegex(R"(^([0-9a-fA-F:]+)\s+([0-9a-fA-F]{2}(?:-[0-9a-fA-F]{2}){5})\s+(\w+))");
+
+    QString scope;
+    for (const QString &line : output.split('\n', Qt::SkipEmptyParts)) {
+        const QString trimmed = line.trimmed();
+        const QRegularExpressionMatch header = headerRegex.match(trimmed);
+        if (header.hasMatch()) {
+            scope = header.captured(1);
+            continue;
+        }
+        const QRegularExpressionMatch row = rowRegex.match(trimmed);
+        if (!row.hasMatch() || row.captured(3).compare("Unreachable", Qt::CaseInsensitive) == 0)
+            continue;
+
+        const IpAddress address = IpAddress::fromString(row.captured(1));
+        if (!isUsableNeighbor(address))
+            continue;
+        Neighbor neighbor;
+        neighbor.address = address.toString();
+        if (neighbor.address.startsWith("fe80", Qt::CaseInsensitive) && !scope.isEmpty())
+            neighbor.address += '%' + scope;
+        neighbor.mac = row.captured(2).replace('-', ':').toLower();
+        neighbors.append(neighbor);
+    }
+#else
+    // "fe80::1 dev eth0 lladdr aa:bb:cc:dd:ee:ff router REACHABLE"
+    const QString output = runTool("ip", QStringList() << "-6" << "neigh" << "show", 5000);
+    static const QRegularExpression rowRegex(R"(^(\S+)\s+dev\s+(\S+)(?:\s+lladdr\s+([0-9a-fA-F:]{17}))?.*\s(\S+)$)");
+
+    for (const QString &line : output.split('\n', Qt::SkipEmptyParts)) {
+        const QRegularExpressionMatch row = rowRegex.match(line.trimmed());
+        if (!row.hasMatch() || row.captured(3).isEmpty())
+            continue;
+        const QString state = row.captured(4);
+        if (state == "FAILED" || state == "INCOMPLETE")
+            continue;
+
+        const IpAddress address = IpAddress::fromString(row.captured(1));
+        if (!isUsableNeighbor(address))
+            continue;
+        Neighbor neighbor;
+        neighbor.address = address.toString();
+        if (neighbor.address.startsWith("fe80", Qt::CaseInsensitive))
+            neighbor.address += '%' + row.captured(2);
+        neighbor.mac = row.captured(3).toLower();
+        neighbors.append(neighbor);
+    }
+#endif
+
+    return neighbors;
+}
+
+QString Ipv6Discovery::macFor(const QString &address)
+{
+    const IpAddress target = IpAddress::fromString(address);
+    for (const Neighbor &neighbor : neighborCache()) {
+        if (IpAddress::fromString(neighbor.address) == target)
+            return neighbor.mac;
+    }
+    return QString();
+}
+
+QStringList Ipv6Discovery::multicastEcho(const IpSubnet &subnet)
+{
+    QStringList responders;
+
+    // Echo ff02::1 on every IPv6 link. Sourcing from our own address in the
+    // target block makes hosts answer from theirs rather than link-local.
+    const auto interfaces = QNetworkInterface::allInterfaces();
+    for (const QNetworkInterface &iface : interfaces) {
+        const auto flags = iface.flags();
+        if (!(flags & QNetworkInterface::IsUp) || (flags & QNetworkInterface::IsLoopBack)
+            || !(flags & QNetworkInterface::CanMulticast))
+            continue;
+
+        QString source;
+        bool hasIPv6 = false;
+        for (const QNetworkAddressEntry &entry : iface.addressEntries()) {
+            const IpAddress address = IpAddress::fromHostAddress(entry.ip());
+            if (!address.isIPv6())
+                continue;
+            hasIPv6 = true;
+            if (subnet.contains(address))
+                source = address.toString();
+        }
+        if (!hasIPv6)
+            continue;
+
+#ifdef Q_OS_WIN
+        QStringList arguments{"-6", "-n", "2", "-w", "1000"};
+        if (!source.isEmpty())
+            arguments << "-S" << source;
+        arguments << "ff02::1%" + QString::number(iface.index());
+#else
+        QStringList arguments{"-6", "-c", "2", "-w", "2"};
+        arguments << "-I" << (source.isEmpty() ? iface.name() : source);
+        arguments << "ff02::1%" + iface.name();
+#endif
+        const QString output = runTool("ping", arguments, kEchoTimeoutMs);
+
+        // "64 bytes from fe80::1%eth0: icmp_seq=1" / "Reply from 2001:db8::5: time<1ms"
+        static const QRegularExpression replyRegex(R"(from\s+([0-9a-fA-F:.]+?(?:%[\w.-]+)?):\s)");
+        auto it = replyRegex.globalMatch(output);
+        while (it.hasNext()) {
+            QString responder = it.next().captured(1);
+            if (responder.startsWith("fe80", Qt::CaseInsensitive) && !responder.contains('%'))
+                responder += '%' + iface.name();
+            responders << responder;
+        }
+    }
+
+    return responders;
+}
+
+QStringList Ipv6Discovery::resolveAddresses(const QStringList &knownHosts)
+{
+    if (knownHosts.isEmpty())
+        return QStringList();
+
+    // One slot per host so the lookups can run side by side without locking
+    QVector<QStringList> found(knownHosts.size());
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMin(kMaxLookupThreads, int(knownHosts.size())));
+
+    for (int i = 0; i < knownHosts.size(); ++i) {
+        const QString host = knownHosts[i];
+        QStringList *out = &found[i];
+        pool.start(QRunnable::create([host, out]() {
+            QString name = host;
+            if (IpAddress::fromString(host).isIPv4()) {
+                name = QHostInfo::fromName(host).hostName();
+                if (name.isEmpty() || name == host)
+                    return; // no PTR record, nothing to look up
+            }
+            for (const QHostAddress &address : QHostInfo::fromName(name).addresses()) {
+                if (address.protocol() == QAbstractSocket::IPv6Protocol)
+                    out->append(address.toString());
+            }
+        }));
+    }
+    pool.waitForDone();
+
+    QStringList addresses;
+    for (const QStringList &list : std::as_const(found))
+        addresses += list;
+    return addresses;
+}
+
+QStringList Ipv6Discovery::candidates(const IpSubnet &subnet, const QStringList &knownHosts)
+{
+    if (!subnet.isValid() || !subnet.network.isIPv6())
+        return QStringList();
+
+    // The echo also fills the neighbour cache, so read it afterwards
+    QStringList harvested = multicastEcho(subnet);
+    for (const Neighbor &neighbor : neighborCache())
+        harvested << neighbor.address;
+    harvested += resolveAddresses(knownHosts);
+
+    // Deduplicate on the numeric address, keep the first (scoped) spelling
+    QMap<IpAddress, QString> inSubnet;
+    for (const QString &candidate : std::as_const(harvested)) {
+        const IpAddress address = IpAddress::fromString(candidate);
+        if (subnet.contains(address) && !inSubnet.contains(address))
+            inSubnet.insert(address, candidate);
+    }
+
+    qDebug() << "Harvested" << inSubnet.size() << "IPv6 candidates in" << subnet.toString()
+             << "from" << harvested.size() << "sightings";
+    return inSubnet.values();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QList>
+#include <QStringList>
+#include "IpAddress.h"
+
+// IPv6 host discovery without sweeping. A /64 holds 2^64 addresses, so
+// candidates are harvested instead: hosts answering an all-nodes (ff02::1)
+// echo, the kernel's neighbour (NDP) cache, and AAAA records of names the
+// caller already knows. Every call blocks on the system tools; run it off
+// the GUI thread.
+class Ipv6Discovery
+{
+public:
+    struct Neighbor {
+        QString address; // link-local addresses keep their %scope
+        QString mac;
+    };
+
+    // Addresses inside subnet worth probing, in address order. knownHosts may
+    // hold names or IPv4 addresses of dual-stack machines; IPv4 addresses are
+    // reverse-resolved first.
+    static QStringList candidates(const IpSubnet &subnet, const QStringList &knownHosts = QStringList());
+
+    static QList<Neighbor> neighborCache();
+    static QString macFor(const QString &address);
+    static QStringList multicastEcho(const IpSubnet &subnet);
+    static QStringList resolveAddresses(const QStringList &knownHosts);
+};
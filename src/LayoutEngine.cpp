@@ -0,0 +1,346 @@
+#include "LayoutEngine.h"
+#include <QRunnable>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const float kIdealLength = 80.0f;    // preferred edge length in world units
+const float kTheta = 0.8f;           // Barnes-Hut opening criterion
+const float kAnchorPull = 0.02f;
+const float kStartTemperature = 120.0f;
+const float kReheatTemperature = 40.0f;
+const float kMinTemperature = 0.5f;
+const float kCooling = 0.96f;
+const int kBatchBudgetMs = 16;       // hand back positions about once a frame
+const int kMaxDepth = 24;            // coincident points stop subdividing here
+const int kChunkSize = 512;
+
+struct QuadNode {
+    float massX = 0;   // mass-weighted position sum, then centre of mass
+    float massY = 0;
+    float mass = 0;
+    float size = 0;
+    int child[4] = {-1, -1, -1, -1};
+    int body = -1;     // single body in a leaf, -1 for internal or merged leaves
+};
+
+class QuadTree
+{
+public:
+    QuadTree(const float *x, const float *y, int count)
+        : m_x(x), m_y(y)
+    {
+        if (count == 0)
+            return;
+
+        float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+        for (int i = 1; i < count; ++i) {
+            minX = std::min(minX, x[i]);
+            maxX = std::max(maxX, x[i]);
+            minY = std::min(minY, y[i]);
+            maxY = std::max(maxY, y[i]);
+        }
+        const float size = std::max(maxX - minX, maxY - minY) + 1.0f;
+
+        m_order.resize(count);
+        for (int i = 0; i < count; ++i)
+            m_order[i] = i;
+        m_nodes.reserve(count * 2);
+        build(0, count, minX, minY, size, 0);
+    }
+
+    // Repulsive displacement on body i, k^2 / d summed over the tree
+    void repulsion(int i, float k2, float &dx, float &dy) const
+    {
+        if (m_nodes.isEmpty())
+            return;
+
+        int stack[kMaxDepth * 4 + 8];
+        int top = 0;
+        stack[top++] = 0;
+        const float xi = m_x[i];
+        const float yi = m_y[i];
+
+        while (top > 0) {
+            const QuadNode &node = m_nodes[stack[--top]];
+            if (node.body == i)
+                continue;
+
+            float ddx = xi - node.massX;
+            float ddy = yi - node.massY;
+            float dist2 = ddx * ddx + ddy * ddy;
+            const bool leaf = node.child[0] < 0 && node.child[1] < 0 && node.child[2] < 0 && node.child[3] < 0;
+
+            if (leaf || node.size * node.size < kTheta * kTheta * dist2) {
+                if (dist2 < 0.01f) {
+                    // Overlapping points: push apart along a fixed per-body direction
+                    ddx = 0.1f * float((i % 7) - 3);
+                    ddy = 0.1f * float((i % 5) - 2);
+                    dist2 = ddx * ddx + ddy * ddy + 0.01f;
+                }
+                const float f = k2 * node.mass / dist2;
+                dx += ddx * f;
+                dy += ddy * f;
+                continue;
+            }
+
+            for (int c = 0; c < 4; ++c) {
+                if (node.child[c] >= 0)
+                    stack[top++] = node.child[c];
+            }
+        }
+    }
+
+private:
+    int build(int begin, int end, float x0, float y0, float size, int depth)
+    {
+        const int index = m_nodes.size();
+        m_nodes.append(QuadNode());
+        m_nodes[index].size = size;
+
+        if (end - begin == 1 || depth >= kMaxDepth) {
+            float sx = 0, sy = 0;
+            for (int n = begin; n < end; ++n) {
+                sx += m_x[m_order[n]];
+                sy += m_y[m_order[n]];
+            }
+            QuadNode &leaf = m_nodes[index];
+            leaf.mass = float(end - begin);
+            leaf.massX = sx / leaf.mass;
+            leaf.massY = sy / leaf.mass;
+            leaf.body = end - begin == 1 ? m_order[begin] : -1;
+            return index;
+        }
+
+        // Partition the index range into the four quadrants in place
+        const float half = size / 2;
+        const float midX = x0 + half;
+        const float midY = y0 + half;
+        int *first = m_order.data() + begin;
+        int *last = m_order.data() + end;
+        int *splitY = std::partition(first, last, [&](int b) { return m_y[b] < midY; });
+        int *splitTop = std::partition(first, splitY, [&](int b) { return m_x[b] < midX; });
+        int *splitBottom = std::partition(splitY, last, [&](int b) { return m_x[b] < midX; });
+
+        const int bounds[5] = {begin, int(splitTop - m_order.data()), int(splitY - m_order.data()),
+                               int(splitBottom - m_order.data()), end};
+        const float origins[4][2] = {{x0, y0}, {midX, y0}, {x0, midY}, {midX, midY}};
+
+        float sx = 0, sy = 0, mass = 0;
+        for (int q = 0; q < 4; ++q) {
+            if (bounds[q] == bounds[q + 1])
+                continue;
+            const int child = build(bounds[q], bounds[q + 1], origins[q][0], origins[q][1], half, depth + 1);
+            m_nodes[index].child[q] = child;
+            const QuadNode &c = m_nodes[child];
+            sx += c.massX * c.mass;
+            sy += c.massY * c.mass;
+            mass += c.mass;
+        }
+
+        QuadNode &node = m_nodes[index];
+        node.mass = mass;
+        node.massX = sx / mass;
+        node.massY = sy / mass;
+        return index;
+    }
+
+    const float *m_x;
+    const float *m_y;
+    QVector<int> m_order;
+    QVector<QuadNode> m_nodes;
+};
+
+// One cooling step over the whole graph; returns the largest move
+float iterate(LayoutEngine::Snapshot &s, QThreadPool &pool)
+{
+    const int n = s.x.size();
+    const float k2 = kIdealLength * kIdealLength;
+    QVector<float> dx(n, 0.0f);
+    QVector<float> dy(n, 0.0f);
+
+    const QuadTree tree(s.x.constData(), s.y.constData(), n);
+
+    // Repulsion dominates the cost and is independent per body
+    for (int begin = 0; begin < n; begin += kChunkSize) {
+        const int end = std::min(n, begin + kChunkSize);
+        float *outX = dx.data();
+        float *outY = dy.data();
+        pool.start(QRunnable::create([&tree, k2, begin, end, outX, outY]() {
+            for (int i = begin; i < end; ++i)
+                tree.repulsion(i, k2, outX[i], outY[i]);
+        }));
+    }
+    pool.waitForDone();
+
+    const int *from = s.edgeFrom.constData();
+    const int *to = s.edgeTo.constData();
+    const float *x = s.x.constData();
+    const float *y = s.y.constData();
+    for (int e = 0; e < s.edgeFrom.size(); ++e) {
+        const float ex = x[from[e]] - x[to[e]];
+        const float ey = y[from[e]] - y[to[e]];
+        const float dist = std::sqrt(ex * ex + ey * ey) + 0.01f;
+        const float f = dist / kIdealLength; // d^2/k along the unit vector
+        dx[from[e]] -= ex * f;
+        dy[from[e]] -= ey * f;
+        dx[to[e]] += ex * f;
+        dy[to[e]] += ey * f;
+    }
+
+    float maxMove = 0;
+    float *px = s.x.data();
+    float *py = s.y.data();
+    const float *ax = s.anchorX.constData();
+    const float *ay = s.anchorY.constData();
+    for (int i = 0; i < n; ++i) {
+        const float mx = dx[i] + (ax[i] - px[i]) * kAnchorPull * kIdealLength;
+        const float my = dy[i] + (ay[i] - py[i]) * kAnchorPull * kIdealLength;
+        const float length = std::sqrt(mx * mx + my * my);
+        if (length < 1e-6f)
+            continue;
+        const float step = std::min(length, s.temperature);
+        px[i] += mx / length * step;
+        py[i] += my / length * step;
+        maxMove = std::max(maxMove, step);
+    }
+
+    s.temperature *= kCooling;
+    return maxMove;
+}
+}
+
+LayoutEngine::LayoutEngine(QObject *parent)
+    : QObject(parent)
+    , m_temperature(0)
+    , m_busy(false)
+    , m_running(false)
+    , m_generation(0)
+{
+    m_worker.setMaxThreadCount(1);
+    m_forcePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+
+    m_kick = new QTimer(this);
+    m_kick->setSingleShot(true);
+    m_kick->setInterval(0);
+    connect(m_kick, &QTimer::timeout, this, &LayoutEngine::schedule);
+}
+
+LayoutEngine::~LayoutEngine()
+{
+    m_worker.waitForDone();
+}
+
+int LayoutEngine::addNode(const QPointF &position, const QPointF &anchor)
+{
+    m_x.append(float(position.x()));
+    m_y.append(float(position.y()));
+    m_anchorX.append(float(anchor.x()));
+    m_anchorY.append(float(anchor.y()));
+
+    // Warm start: keep existing positions, just give the layout some heat back
+    m_temperature = std::max(m_temperature, m_x.size() == 1 ? kStartTemperature : kReheatTemperature);
+    m_kick->start();
+    return m_x.size() - 1;
+}
+
+void LayoutEngine::addEdge(int from, int to)
+{
+    if (from < 0 || to < 0 || from >= m_x.size() || to >= m_x.size())
+        return;
+
+    m_edgeFrom.append(from);
+    m_edgeTo.append(to);
+    m_temperature = std::max(m_temperature, kReheatTemperature);
+    m_kick->start();
+}
+
+void LayoutEngine::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_anchorX.clear();
+    m_anchorY.clear();
+    m_edgeFrom.clear();
+    m_edgeTo.clear();
+    m_temperature = 0;
+    ++m_generation;
+    setRunning(false);
+}
+
+void LayoutEngine::schedule()
+{
+    if (m_busy || m_x.isEmpty() || m_temperature < kMinTemperature)
+        return;
+
+    Snapshot snapshot;
+    snapshot.x = m_x;
+    snapshot.y = m_y;
+    snapshot.anchorX = m_anchorX;
+    snapshot.anchorY = m_anchorY;
+    snapshot.edgeFrom = m_edgeFrom;
+    snapshot.edgeTo = m_edgeTo;
+    snapshot.temperature = m_temperature;
+
+    m_busy = true;
+    setRunning(true);
+
+    const int generation = m_generation;
+    QThreadPool *forcePool = &m_forcePool;
+    QRunnable *task = QRunnable::create([this, snapshot, generation, forcePool]() mutable {
+        QElapsedTimer budget;
+        budget.start();
+        do {
+            if (iterate(snapshot, *forcePool) < kMinTemperature || snapshot.temperature < kMinTemperature) {
+                snapshot.settled = true;
+                break;
+            }
+        } while (budget.elapsed() < kBatchBudgetMs);
+
+        QMetaObject::invokeMethod(this, [this, snapshot, generation]() {
+            applyBatch(snapshot, generation);
+        }, Qt::QueuedConnection);
+    });
+    m_worker.start(task);
+}
+
+void LayoutEngine::applyBatch(const Snapshot &result, int generation)
+{
+    m_busy = false;
+    if (generation != m_generation) {
+        // Nodes added after a clear() were kicked while this batch ran
+        schedule();
+        return;
+    }
+
+    // Nodes added while the batch ran keep their seed positions
+    const int computed = result.x.size();
+    std::copy(result.x.cbegin(), result.x.cend(), m_x.begin());
+    std::copy(result.y.cbegin(), result.y.cend(), m_y.begin());
+    const bool grown = m_x.size() != computed || m_edgeFrom.size() != result.edgeFrom.size();
+    m_temperature = grown ? std::max(result.temperature, kReheatTemperature) : result.temperature;
+
+    QVector<QPointF> positions(m_x.size());
+    for (int i = 0; i < m_x.size(); ++i)
+        positions[i] = QPointF(m_x[i], m_y[i]);
+    emit positionsUpdated(positions);
+
+    if (result.settled && !grown) {
+        m_temperature = 0;
+        setRunning(false);
+        qDebug() << "Layout settled for" << m_x.size() << "nodes";
+        return;
+    }
+    schedule();
+}
+
+void LayoutEngine::setRunning(bool running)
+{
+    if (running == m_running)
+        return;
+    m_running = running;
+    emit runningChanged();
+}
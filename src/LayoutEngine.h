@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QPointF>
+#include <QThreadPool>
+#include <QTimer>
+
+// Fruchterman-Reingold layout with Barnes-Hut repulsion, run off the GUI
+// thread. Positions are kept as separate float arrays so the force loops
+// stay branch-light and vectorisable. Each batch starts from the last
+// positions, so nodes added mid-run are absorbed without a restart.
+class LayoutEngine : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+
+public:
+    explicit LayoutEngine(QObject *parent = nullptr);
+    ~LayoutEngine();
+
+    bool isRunning() const { return m_running; }
+    int nodeCount() const { return m_x.size(); }
+
+    // anchor pulls loosely connected nodes towards their subnet
+    int addNode(const QPointF &position, const QPointF &anchor);
+    void addEdge(int from, int to);
+    void clear();
+
+    // Per-frame state handed to the worker and returned by it
+    struct Snapshot {
+        QVector<float> x;
+        QVector<float> y;
+        QVector<float> anchorX;
+        QVector<float> anchorY;
+        QVector<int> edgeFrom;
+        QVector<int> edgeTo;
+        float temperature = 0;
+        bool settled = false;
+    };
+
+signals:
+    void positionsUpdated(const QVector<QPointF> &positions);
+    void runningChanged();
+
+private:
+    void schedule();
+    void applyBatch(const Snapshot &result, int generation);
+    void setRunning(bool running);
+
+    QVector<float> m_x;
+    QVector<float> m_y;
+    QVector<float> m_anchorX;
+    QVector<float> m_anchorY;
+    QVector<int> m_edgeFrom;
+    QVector<int> m_edgeTo;
+    float m_temperature;
+
+    QThreadPool m_worker;     // one batch in flight at a time
+    QThreadPool m_forcePool;  // splits each force pass across cores
+    QTimer *m_kick;           // coalesces bursts of added nodes
+    bool m_busy;
+    bool m_running;
+    int m_generation;         // bumped by clear() to drop stale batches
+};
@@ -0,0 +1,250 @@
+#include "Metrics.h"
+#include <QMutex>
+#include <QProcess>
+#include <QList>
+
+#include <atomic>
+#include <memory>
+
+namespace Metrics {
+
+namespace {
+const int kSubBuckets = 16;                 // per power of two, after the first 32 exact values
+const int kMaxExponent = 32;                // values up to 2^37 - 1
+const int kBuckets = (kMaxExponent + 2) * kSubBuckets;
+
+quint64 bucketValue(int bucket)
+{
+    if (bucket < 2 * kSubBuckets)
+        return quint64(bucket);
+    const int exponent = bucket / kSubBuckets - 1;
+    const quint64 sub = quint64(bucket % kSubBuckets + kSubBuckets);
+    // Middle of the bucket, which halves the worst-case error
+    return (sub << exponent) + ((quint64(1) << exponent) >> 1);
+}
+
+// Largest value that lands in bucket
+quint64 bucketHigh(int bucket)
+{
+    if (bucket < 2 * kSubBuckets)
+        return quint64(bucket);
+    const int exponent = bucket / kSubBuckets - 1;
+    const quint64 sub = quint64(bucket % kSubBuckets + kSubBuckets);
+    return ((sub + 1) << exponent) - 1;
+}
+
+#ifndef NETSECOPS_NO_METRICS
+int bucketOf(quint64 value)
+{
+    if (value < 2 * kSubBuckets)
+        return int(value);
+    int bits = 0;
+    for (quint64 v = value; v; v >>= 1)
+        ++bits;
+    const int exponent = qMin(bits - 5, kMaxExponent);
+    const quint64 sub = qMin<quint64>(value >> exponent, 2 * kSubBuckets - 1);
+    return exponent * kSubBuckets + int(sub);
+}
+
+// Written only by its own thread, so a load and a store replace the
+// locked read-modify-write; readers may see a value one update stale
+inline void bump(std::atomic<quint64> &value, quint64 n)
+{
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct Slot {
+    struct Histogram {
+        std::atomic<quint64> buckets[kBuckets];
+        std::atomic<quint64> count;
+        std::atomic<quint64> sum;
+        std::atomic<quint64> max;
+    };
+
+    std::atomic<quint64> counters[CounterCount];
+    Histogram histograms[HistogramCount];
+};
+
+void addTo(Snapshot *snapshot, const Slot &slot)
+{
+    for (int c = 0; c < CounterCount; ++c)
+        snapshot->counters[c] += slot.counters[c].load(std::memory_order_relaxed);
+    for (int h = 0; h < HistogramCount; ++h) {
+        const Slot::Histogram &from = slot.histograms[h];
+        HistogramSnapshot &to = snapshot->histograms[h];
+        to.count += from.count.load(std::memory_order_relaxed);
+        to.sum += from.sum.load(std::memory_order_relaxed);
+        to.max = qMax(to.max, from.max.load(std::memory_order_relaxed));
+        for (int b = 0; b < kBuckets; ++b)
+            to.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+    }
+}
+
+struct Registry {
+    QMutex mutex;
+    QList<Slot *> live;
+    Snapshot retired; // totals of threads that have exited
+};
+
+Registry &registry()
+{
+    // Never destroyed: pool threads may still exit after static teardown starts
+    static Registry *instance = [] {
+        auto *registry = new Registry;
+        for (HistogramSnapshot &histogram : registry->retired.histograms)
+            histogram.buckets.fill(0, kBuckets);
+        return registry;
+    }();
+    return *instance;
+}
+
+struct LocalSlot {
+    Slot *slot;
+
+    LocalSlot()
+        : slot(new Slot()) // value-initialized: every atomic starts at zero
+    {
+        Registry &r = registry();
+        QMutexLocker locker(&r.mutex);
+        r.live << slot;
+    }
+
+    ~LocalSlot()
+    {
+        Registry &r = registry();
+        QMutexLocker locker(&r.mutex);
+        addTo(&r.retired, *slot);
+        r.live.removeOne(slot);
+        delete slot;
+    }
+};
+
+Slot &local()
+{
+    thread_local LocalSlot local;
+    return *local.slot;
+}
+#endif
+}
+
+const char *name(Counter counter)
+{
+    static const char *const names[CounterCount] = {
+        "probesOpen", "probesRefused", "probesTimedOut", "probesFailed",
+        "processesStarted", "processStartFailures", "throttleWaits", "hostsScanned",
+        "hostsFound", "portsFound", "hostsProfiled", "jobsCompleted", "jobsFailed", "transferBytes",
+    };
+    return names[counter];
+}
+
+const char *name(Histogram histogram)
+{
+    static const char *const names[HistogramCount] = {
+        "probeLatency", "processSpawn", "hostPing", "hostResolve", "hostMac", "hostScan",
+        "schedulerQueue", "uiBatch", "jobSsh", "jobWinRm", "jobPowerShell", "jobWmi", "jobSchtasks",
+        "jobCustom", "jobScp", "jobSmb", "jobDelta", "jobOther",
+    };
+    return names[histogram];
+}
+
+const char *unit(Histogram histogram)
+{
+    return histogram == SchedulerQueue || histogram == UiBatch ? "" : "us";
+}
+
+quint64 HistogramSnapshot::percentile(double p) const
+{
+    if (!count)
+        return 0;
+    const quint64 rank = qMax<quint64>(1, quint64(p / 100.0 * count + 0.5));
+    quint64 seen = 0;
+    for (int b = 0; b < buckets.size(); ++b) {
+        seen += buckets.at(b);
+        if (seen >= rank)
+            return qMin(bucketValue(b), max);
+    }
+    return max;
+}
+
+quint64 HistogramSnapshot::countAtMost(quint64 value) const
+{
+    quint64 total = 0;
+    for (int b = 0; b < buckets.size() && bucketHigh(b) <= value; ++b)
+        total += buckets.at(b);
+    return total;
+}
+
+HistogramSnapshot HistogramSnapshot::since(const HistogramSnapshot &earlier) const
+{
+    HistogramSnapshot result = *this;
+    if (earlier.buckets.size() != buckets.size())
+        return result;
+    result.count -= qMin(earlier.count, count);
+    result.sum -= qMin(earlier.sum, sum);
+    for (int b = 0; b < buckets.size(); ++b)
+        result.buckets[b] -= qMin(earlier.buckets.at(b), buckets.at(b));
+    return result;
+}
+
+bool startProcess(QProcess *process, const QString &program, const QStringList &arguments, int timeoutMs)
+{
+    const Timer spawn;
+    process->start(program, arguments);
+    if (!process->waitForStarted(timeoutMs)) {
+        count(ProcessStartFailures);
+        return false;
+    }
+    spawn.record(ProcessSpawn);
+    count(ProcessesStarted);
+    return true;
+}
+
+void watchSpawn(QProcess *process)
+{
+#ifndef NETSECOPS_NO_METRICS
+    auto spawn = std::make_shared<QElapsedTimer>();
+    QObject::connect(process, &QProcess::stateChanged, process, [spawn](QProcess::ProcessState state) {
+        if (state == QProcess::Starting) {
+            spawn->start();
+        } else if (state == QProcess::Running && spawn->isValid()) {
+            record(ProcessSpawn, quint64(spawn->nsecsElapsed() / 1000));
+            count(ProcessesStarted);
+        }
+    });
+    QObject::connect(process, &QProcess::errorOccurred, process, [](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            count(ProcessStartFailures);
+    });
+#else
+    Q_UNUSED(process);
+#endif
+}
+
+#ifndef NETSECOPS_NO_METRICS
+void count(Counter counter, quint64 n)
+{
+    bump(local().counters[counter], n);
+}
+
+void record(Histogram histogram, quint64 value)
+{
+    Slot::Histogram &h = local().histograms[histogram];
+    bump(h.buckets[bucketOf(value)], 1);
+    bump(h.count, 1);
+    bump(h.sum, value);
+    if (value > h.max.load(std::memory_order_relaxed))
+        h.max.store(value, std::memory_order_relaxed);
+}
+
+Snapshot snapshot()
+{
+    Registry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    Snapshot result = r.retired;
+    for (const Slot *slot : std::as_const(r.live))
+        addTo(&result, *slot);
+    return result;
+}
+#endif
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include <QDebug>
+
+class QProcess;
+
+// Low-overhead counters and latency histograms for the engines' hot paths.
+// Each thread writes its own slot with plain relaxed stores, so recording
+// never takes a lock or contends on a cache line; snapshot() sums the
+// slots for readers such as PerformanceMonitor. Histograms are HDR-style:
+// 16 linear sub-buckets per power of two, about 3% relative error from
+// 1 to 2^37. Build with NETSECOPS_NO_METRICS to compile all of it out.
+namespace Metrics {
+
+enum Counter {
+    ProbesOpen,
+    ProbesRefused,
+    ProbesTimedOut,
+    ProbesFailed,
+    ProcessesStarted,
+    ProcessStartFailures,
+    ThrottleWaits,
+    HostsScanned,
+    HostsFound,
+    PortsFound,
+    HostsProfiled,
+    JobsCompleted,
+    JobsFailed,
+    TransferBytes,
+    CounterCount
+};
+
+enum Histogram {
+    ProbeLatency,   // TCP connect attempt, us
+    ProcessSpawn,   // QProcess start until running, us
+    HostPing,       // us
+    HostResolve,    // reverse DNS, us
+    HostMac,        // ARP/NDP lookup, us
+    HostScan,       // whole per-host pass after its probes, us
+    SchedulerQueue, // probes parked behind rate limits, per hand-out
+    UiBatch,        // rows per model update
+    JobSsh,         // remote job start to finish, us, one per protocol
+    JobWinRm,
+    JobPowerShell,
+    JobWmi,
+    JobSchtasks,
+    JobCustom,
+    JobScp,
+    JobSmb,
+    JobDelta,
+    JobOther,
+    HistogramCount
+};
+
+const char *name(Counter counter);
+const char *name(Histogram histogram);
+const char *unit(Histogram histogram); // "us" or "" for plain counts
+
+struct HistogramSnapshot {
+    quint64 count = 0;
+    quint64 sum = 0;
+    quint64 max = 0;
+    QVector<quint64> buckets;
+
+    quint64 percentile(double p) const;
+    // Recorded values no larger than value, to bucket resolution
+    quint64 countAtMost(quint64 value) const;
+    double mean() const { return count ? double(sum) / count : 0; }
+    // What was recorded since an earlier snapshot; max stays the all-time value
+    HistogramSnapshot since(const HistogramSnapshot &earlier) const;
+};
+
+struct Snapshot {
+    quint64 counters[CounterCount] = {};
+    HistogramSnapshot histograms[HistogramCount];
+};
+
+// Trace-level diagnostics on per-probe and per-row paths. Compiled out
+// unless NETSECOPS_TRACE is defined, so they cost nothing in normal builds.
+#ifdef NETSECOPS_TRACE
+#define traceDebug() qDebug()
+#else
+#define traceDebug() QT_NO_QDEBUG_MACRO()
+#endif
+
+#ifdef NETSECOPS_NO_METRICS
+inline void count(Counter, quint64 = 1) {}
+inline void record(Histogram, quint64) {}
+inline Snapshot snapshot() { return Snapshot(); }
+
+class Timer
+{
+public:
+    Timer() {}
+    void record(Histogram) const {}
+};
+#else
+void count(Counter counter, quint64 n = 1);
+void record(Histogram histogram, quint64 value);
+Snapshot snapshot();
+
+// Starts on construction; record() adds the elapsed microseconds
+class Timer
+{
+public:
+    Timer() { m_timer.start(); }
+    void record(Histogram histogram) const { Metrics::record(histogram, quint64(m_timer.nsecsElapsed() / 1000)); }
+
+private:
+    QElapsedTimer m_timer;
+};
+#endif
+
+// Starts program and waits until it runs, recording the spawn time
+bool startProcess(QProcess *process, const QString &program, const QStringList &arguments, int timeoutMs = 5000);
+// The same for processes started asynchronously, however they are started
+void watchSpawn(QProcess *process);
+
+}
@@ -8,6 +8,10 @@
 #include <QTextStream>
 #include <QTcpSocket>
 #include <QNetworkInterface>
+#include "Ipv6Discovery.h"
+#include "UdpProber.h"
+#include "Metrics.h"
+#include "Trace.h"
 
 NetworkMapper::NetworkMapper(QObject *parent)
     : QObject(parent)
@@ -16,10 +20,17 @@ NetworkMapper::NetworkMapper(QObject *parent)
     , m_hostsProfiled(0)
     , m_totalHosts(0)
     , m_completedHosts(0)
+    , m_networkTree(new NetworkTreeModel(this))
+    , m_arpTable(new ArpTableModel(this))
     , m_quickScan(false)
+    , m_topology(new TopologyGraph(this))
+    , m_pendingTraces(0)
+    , m_traceGeneration(0)
 {
     m_progressTimer = new QTimer(this);
     connect(m_progressTimer, &QTimer::timeout, this, &NetworkMapper::updateProgress);
+
+    m_tracePool.setMaxThreadCount(16);
 }
 
 void NetworkMapper::startMapping(const QStringList &targetIPs)
@@ -35,14 +46,24 @@ void NetworkMapper::startMapping(const QStringList &targetIPs)
     m_targetIPs = targetIPs;
     m_totalHosts = targetIPs.size();
     m_profiles.clear();
+
+    // Fresh topology for this run; traces still in flight from a previous run are ignored
+    ++m_traceGeneration;
+    m_pendingTraces = 0;
+    m_tracedSubnets.clear();
+    m_topology->clear();
+    loadLocalSubnets();
+    m_topology->ensureLocal();
     
     emit isMappingChanged();
     emit progressChanged();
     emit hostsProfiledChanged();
     
-    // Get ARP table first
-    QStringList arpEntries = getArpTable();
-    emit arpTableUpdated(arpEntries);
+    m_networkTree->clear();
+
+    // Get ARP table first; a quick scan has just read it
+    if (!m_quickScan)
+        refreshArpTable();
     
     m_progressTimer->start(500);
     
@@ -56,7 +77,11 @@ void NetworkMapper::startMapping(const QStringList &targetIPs)
         HostProfiler *profiler = new HostProfiler(ip);
         connect(profiler, &HostProfiler::profileCompleted, this, &NetworkMapper::onHostProfileCompleted);
         
-        QRunnable *task = QRunnable::create([profiler]() {
+        // Time spent waiting for a pool thread, on a track of its own
+        const qint64 queued = Trace::isEnabled() ? Trace::now() : -1;
+        QRunnable *task = QRunnable::create([profiler, ip, queued]() {
+            if (queued >= 0)
+                Trace::complete("map", "queued", queued, ip, quintptr(profiler));
             QThread::currentThread()->setPriority(QThread::NormalPriority);
             profiler->profile();
             profiler->deleteLater();
@@ -74,6 +99,9 @@ void NetworkMapper::stopMapping()
     m_isMapping = false;
     m_progressTimer->stop();
     QThreadPool::globalInstance()->clear();
+    m_tracePool.clear();
+    ++m_traceGeneration;
+    m_pendingTraces = 0;
     
     emit isMappingChanged();
     emit mappingCompleted();
@@ -83,27 +111,136 @@ void NetworkMapper::onHostProfileCompleted(const HostProfile &profile)
 {
     m_completedHosts++;
     m_profiles.append(profile);
+    m_networkTree->upsertHost(subnetFor(profile.ip), profile.ip, profile.osType, profile.vendor, profile.services);
     
     if (!profile.osType.isEmpty() || !profile.services.isEmpty()) {
         m_hostsProfiled++;
+        Metrics::count(Metrics::HostsProfiled);
         
         QString services = profile.services.join(", ");
         emit hostProfiled(profile.ip, profile.osType, services, profile.vendor);
         emit hostsProfiledChanged();
+        addToTopology(profile);
     }
     
-    qDebug() << "Host profiled:" << profile.ip << "OS:" << profile.osType << "Services:" << profile.services.size();
+    traceDebug() << "Host profiled:" << profile.ip << "OS:" << profile.osType << "Services:" << profile.services.size();
     
     if (m_completedHosts >= m_totalHosts) {
         m_isMapping = false;
         m_progress = 100;
         m_progressTimer->stop();
         
-        buildNetworkTree();
         emit isMappingChanged();
         emit progressChanged();
         emit mappingCompleted();
+
+        if (m_pendingTraces == 0)
+            finishTopology();
+    }
+}
+
+void NetworkMapper::loadLocalSubnets()
+{
+    m_localSubnets.clear();
+
+    const auto interfaces = QNetworkInterface::allInterfaces();
+    for (const QNetworkInterface &iface : interfaces) {
+        const auto flags = iface.flags();
+        if (!(flags & QNetworkInterface::IsUp) || (flags & QNetworkInterface::IsLoopBack))
+            continue;
+
+        for (const QNetworkAddressEntry &entry : iface.addressEntries()) {
+            const int prefix = entry.prefixLength();
+            const IpAddress address = IpAddress::fromHostAddress(entry.ip());
+            if (prefix <= 0 || !address.isValid())
+                continue;
+            m_localSubnets.append(IpSubnet::of(address, prefix));
+        }
+    }
+
+    qDebug() << "Found" << m_localSubnets.size() << "directly attached subnets";
+}
+
+QString NetworkMapper::subnetFor(const QString &ip) const
+{
+    const IpAddress address = IpAddress::fromString(ip);
+    for (const IpSubnet &subnet : m_localSubnets) {
+        if (subnet.contains(address))
+            return subnet.toString();
     }
+
+    // Off-link: the prefix is unknown, assume the common /24 (or /64 for IPv6)
+    if (!address.isValid())
+        return QString("%1/32").arg(ip);
+    return IpSubnet::of(address, address.isIPv4() ? 24 : 64).toString();
+}
+
+bool NetworkMapper::isLocalSubnet(const QString &subnet) const
+{
+    const IpSubnet parsed = IpSubnet::parse(subnet);
+    for (const IpSubnet &local : m_localSubnets) {
+        if (local.network == parsed.network && local.prefixLength == parsed.prefixLength)
+            return true;
+    }
+    return false;
+}
+
+void NetworkMapper::addToTopology(const HostProfile &profile)
+{
+    const QString subnet = subnetFor(profile.ip);
+    m_topology->ensureHost(profile.ip, subnet, profile.osType,
+                           profile.deviceType.isEmpty() ? QStringLiteral("computer") : profile.deviceType);
+
+    if (isLocalSubnet(subnet)) {
+        if (!m_topology->isSubnetLinked(subnet))
+            m_topology->addPath(QStringList(), subnet);
+        return;
+    }
+
+    // The first responsive host of a remote subnet stands in for all of it
+    if (m_tracedSubnets.contains(subnet))
+        return;
+    m_tracedSubnets.insert(subnet);
+    ++m_pendingTraces;
+
+    RouteTracer *tracer = new RouteTracer(profile.ip, subnet);
+    const int generation = m_traceGeneration;
+    connect(tracer, &RouteTracer::traceCompleted, this,
+            [this, generation](const QString &, const QString &subnet, const QStringList &hops) {
+        if (generation == m_traceGeneration)
+            onTraceCompleted(subnet, hops);
+    });
+
+    QRunnable *task = QRunnable::create([tracer]() {
+        tracer->trace();
+        tracer->deleteLater();
+    });
+    task->setAutoDelete(true);
+    m_tracePool.start(task);
+}
+
+void NetworkMapper::onTraceCompleted(const QString &subnet, const QStringList &hops)
+{
+    --m_pendingTraces;
+    qDebug() << "Route to" << subnet << "via" << hops.size() << "hops";
+    m_topology->addPath(hops, subnet);
+
+    if (!m_isMapping && m_pendingTraces == 0)
+        finishTopology();
+}
+
+void NetworkMapper::finishTopology()
+{
+    // Subnets no trace reached still hang off this host so the map stays connected
+    const QVector<TopologyNode> nodes = m_topology->nodes();
+    for (const TopologyNode &node : nodes) {
+        if (node.kind == TopologyNode::Subnet && !m_topology->isSubnetLinked(node.label))
+            m_topology->addPath(QStringList(), node.label);
+    }
+
+    qDebug() << "Topology built with" << m_topology->nodeCount() << "nodes and"
+             << m_topology->edgeCount() << "links";
+    emit topologyCompleted();
 }
 
 void NetworkMapper::updateProgress()
@@ -114,19 +251,10 @@ void NetworkMapper::updateProgress()
     }
 }
 
-QStringList NetworkMapper::getArpTable()
+void NetworkMapper::refreshArpTable()
 {
-    QStringList entries;
-    QList<ArpEntry> arpTable = parseArpTable();
-    
-    for (const ArpEntry &entry : arpTable) {
-        QString entryStr = QString("%1|%2|%3|%4").arg(entry.ip, entry.mac, entry.vendor, entry.type);
-        entries << entryStr;
-        qDebug() << entry.ip<< entry.mac<< entry.vendor<< entry.type;
-    }
-    
-    qDebug() << "Retrieved" << entries.size() << "ARP entries";
-    return entries;
+    m_arpTable->setEntries(parseArpTable());
+    qDebug() << "Retrieved" << m_arpTable->count() << "ARP entries";
 }
 
 QList<ArpEntry> NetworkMapper::parseArpTable()
@@ -176,6 +304,16 @@ QList<ArpEntry> NetworkMapper::parseArpTable()
         }
     }
 #endif
+
+    // IPv6 neighbours come from NDP rather than ARP
+    for (const Ipv6Discovery::Neighbor &neighbor : Ipv6Discovery::neighborCache()) {
+        ArpEntry entry;
+        entry.ip = neighbor.address;
+        entry.mac = neighbor.mac;
+        entry.type = "ndp";
+        entry.vendor = getMacVendor(entry.mac);
+        entries.append(entry);
+    }
     
     return entries;
 }
@@ -226,6 +364,12 @@ void NetworkMapper::exportMap(const QString &format, const QString &filePath)
                 portsArray.append(port);
             }
             hostObj["ports"] = portsArray;
+
+            QJsonArray udpPortsArray;
+            for (int port : profile.openUdpPorts) {
+                udpPortsArray.append(port);
+            }
+            hostObj["udpPorts"] = udpPortsArray;
             
             QJsonArray servicesArray;
             for (const QString &service : profile.services) {
@@ -236,8 +380,26 @@ void NetworkMapper::exportMap(const QString &format, const QString &filePath)
             hostsArray.append(hostObj);
         }
         
+        static const char *const kindNames[] = {"local", "router", "subnet", "host"};
+        QJsonArray nodesArray;
+        for (const TopologyNode &node : m_topology->nodes()) {
+            QJsonObject nodeObj;
+            nodeObj["id"] = node.id;
+            nodeObj["label"] = node.label;
+            nodeObj["kind"] = kindNames[node.kind];
+            nodesArray.append(nodeObj);
+        }
+        QJsonArray linksArray;
+        for (const QPair<int, int> &edge : m_topology->edges()) {
+            linksArray.append(QJsonArray{m_topology->nodes()[edge.first].id, m_topology->nodes()[edge.second].id});
+        }
+        QJsonObject topologyObj;
+        topologyObj["nodes"] = nodesArray;
+        topologyObj["links"] = linksArray;
+
         QJsonObject rootObj;
         rootObj["hosts"] = hostsArray;
+        rootObj["topology"] = topologyObj;
         rootObj["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
         
         out << QJsonDocument(rootObj).toJson();
@@ -288,6 +450,75 @@ void NetworkMapper::exportMap(const QString &format, const QString &filePath)
     emit exportCompleted(filePath);
 }
 
+// RouteTracer Implementation
+RouteTracer::RouteTracer(const QString &target, const QString &subnet, QObject *parent)
+    : QObject(parent), m_target(target), m_subnet(subnet)
+{
+}
+
+void RouteTracer::trace()
+{
+    QProcess process;
+#ifdef Q_OS_WIN
+    process.start("tracert", QStringList() << "-d" << "-h" << "20" << "-w" << "500" << m_target);
+#else
+    process.start("traceroute", QStringList() << "-n" << "-q" << "1" << "-w" << "1" << "-m" << "20" << m_target);
+#endif
+
+    if (!process.waitForStarted(3000)) {
+        qWarning() << "traceroute unavailable, linking" << m_subnet << "directly";
+        emit traceCompleted(m_target, m_subnet, QStringList());
+        return;
+    }
+    if (!process.waitForFinished(30000)) {
+        qDebug() << "traceroute to" << m_target << "timed out";
+        process.kill();
+        process.waitForFinished(1000);
+    }
+
+    const QString output = QString::fromLocal8Bit(process.readAllStandardOutput());
+    emit traceCompleted(m_target, m_subnet, parseHops(output));
+}
+
+QStringList RouteTracer::parseHops(const QString &output) const
+{
+    static const QRegularExpression hopRegex(R"(^\s*(\d+)\s+(.*)$)");
+    static const QRegularExpression ipRegex(R"((\d+\.\d+\.\d+\.\d+|[0-9a-fA-F]*:[0-9a-fA-F:]+))");
+
+    QStringList hops;
+    const QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        const QRegularExpressionMatch match = hopRegex.match(line.trimmed());
+        if (!match.hasMatch())
+            continue;
+
+        const int ttl = match.captured(1).toInt();
+        if (ttl <= 0 || ttl > 64)
+            continue;
+
+#ifdef Q_OS_WIN
+        // tracert puts the address last, after the three timings
+        QString hop;
+        auto it = ipRegex.globalMatch(match.captured(2));
+        while (it.hasNext())
+            hop = it.next().captured(1);
+#else
+        // traceroute -n -q 1: "<ttl>  <address>  <rtt> ms", or "*" when silent
+        const QString field = match.captured(2).section(' ', 0, 0, QString::SectionSkipEmpty);
+        const QString hop = ipRegex.match(field).hasMatch() ? field : QString();
+#endif
+        while (hops.size() < ttl - 1)
+            hops << QString();
+        if (hops.size() == ttl - 1)
+            hops << hop;
+    }
+
+    // Keep only the routers in front of the target
+    while (!hops.isEmpty() && (hops.last().isEmpty() || hops.last() == m_target))
+        hops.removeLast();
+    return hops;
+}
+
 // HostProfiler Implementation
 HostProfiler::HostProfiler(const QString &ip, QObject *parent)
     : QObject(parent), m_ip(ip)
@@ -296,12 +527,16 @@ HostProfiler::HostProfiler(const QString &ip, QObject *parent)
 
 void HostProfiler::profile()
 {
+    const Trace::Span span("map", "profile", m_ip);
     HostProfile profile;
     profile.ip = m_ip;
     profile.responseTime = 0;
     
     // Scan common ports
-    profile.openPorts = scanCommonPorts(m_ip);
+    {
+        const Trace::Span portsSpan("map", "ports");
+        profile.openPorts = scanCommonPorts(m_ip);
+    }
     
     // if (!profile.openPorts.isEmpty()) {
         // Detect OS based on open ports and behavior
@@ -310,23 +545,45 @@ void HostProfiler::profile()
         // Enumerate services
         profile.services = enumerateServices(m_ip, profile.openPorts);
         
-        qDebug() << "Profiled" << m_ip << "- OS:" << profile.osType << "Services:" << profile.services.size();
+        traceDebug() << "Profiled" << m_ip << "- OS:" << profile.osType << "Services:" << profile.services.size();
     // }
+
+    // UDP-only services (SNMP, NTP, NetBIOS-NS, mDNS...) never show up over TCP
+    static const QList<int> commonUdpPorts = {53, 123, 137, 161, 1900, 5060, 5353};
+    QList<UdpProber::Result> udpResults;
+    {
+        const Trace::Span udpSpan("map", "udp");
+        udpResults = UdpProber(m_ip).probe(commonUdpPorts);
+    }
+    for (const UdpProber::Result &result : udpResults) {
+        if (result.state != UdpProber::Open)
+            continue;
+        profile.openUdpPorts << result.port;
+        if (result.confirmed)
+            profile.services << result.service + " (udp)";
+    }
     
     // Determine if host is online based on open ports
-    profile.isOnline = !profile.openPorts.isEmpty();
+    profile.isOnline = !profile.openPorts.isEmpty() || !profile.openUdpPorts.isEmpty();
     
     // Get MAC and vendor for device type detection
     if (profile.isOnline) {
         // Get MAC from ARP (simplified)
-        QProcess arpProcess;
+        QString arpOutput;
+        if (IpAddress::fromString(m_ip).isIPv6()) {
+            const Trace::Span arpSpan("map", "ndp");
+            arpOutput = Ipv6Discovery::macFor(m_ip);
+        } else {
+            const Trace::Span arpSpan("map", "arp");
+            QProcess arpProcess;
 #ifdef Q_OS_WIN
-        arpProcess.start("arp", QStringList() << "-a" << m_ip);
+            Metrics::startProcess(&arpProcess, "arp", QStringList() << "-a" << m_ip, 3000);
 #else
-        arpProcess.start("arp", QStringList() << "-n" << m_ip);
+            Metrics::startProcess(&arpProcess, "arp", QStringList() << "-n" << m_ip, 3000);
 #endif
-        arpProcess.waitForFinished(3000);
-        QString arpOutput = arpProcess.readAllStandardOutput();
+            arpProcess.waitForFinished(3000);
+            arpOutput = arpProcess.readAllStandardOutput();
+        }
         
         QRegularExpression macRegex(R"([0-9a-fA-F]{2}[:-][0-9a-fA-F]{2}[:-][0-9a-fA-F]{2}[:-][0-9a-fA-F]{2}[:-][0-9a-fA-F]{2}[:-][0-9a-fA-F]{2})");
         QRegularExpressionMatch macMatch = macRegex.match(arpOutput);
@@ -372,7 +629,8 @@ QString HostProfiler::detectOperatingSystem(const QString &ip, const QList<int>
     // QString nmapPath = "C:/Program Files (x86)/Nmap/nmap.exe";  // Adjust if installed elsewhere
     // process.start(nmapPath, QStringList() << "-O" << "--osscan-guess" << ip);
 
-    process.start("nmap", QStringList() << "-O" << "--osscan-guess" << ip);
+    const Trace::Span span("map", "nmap -O");
+    Metrics::startProcess(&process, "nmap", QStringList() << "-O" << "--osscan-guess" << ip);
 
     if (!process.waitForFinished(30000)) {
         qDebug() << "Nmap process timed out!";
@@ -387,7 +645,7 @@ QString HostProfiler::detectOperatingSystem(const QString &ip, const QList<int>
     // qDebug() << "Exit code:" << process.exitCode();
     // QString output = stdoutOutput;
 
-    qDebug() << ip << "nmap output length:" << output.length();
+    traceDebug() << ip << "nmap output length:" << output.length();
 
     //Extract OS details via regex
     static const QRegularExpression osRegex("^OS details:\\s*(.+)$", QRegularExpression::MultilineOption);
@@ -466,7 +724,8 @@ QStringList HostProfiler::enumerateServices(const QString &ip, const QList<int>
     }
     
     if (!portList.isEmpty()) {
-        process.start("nmap", QStringList() << "-sV" << "-p" << portList.join(",") << ip);
+        const Trace::Span span("map", "nmap -sV");
+        Metrics::startProcess(&process, "nmap", QStringList() << "-sV" << "-p" << portList.join(",") << ip);
         process.waitForFinished(15000);
         
         QString output = process.readAllStandardOutput();
@@ -513,15 +772,22 @@ QStringList HostProfiler::enumerateServices(const QString &ip, const QList<int>
 
 bool HostProfiler::isPortOpen(const QString &ip, int port)
 {
+    const Metrics::Timer timer;
     QTcpSocket socket;
     socket.connectToHost(ip, port);
     bool connected = socket.waitForConnected(1000);
+    timer.record(Metrics::ProbeLatency);
     
     if (connected) {
+        Metrics::count(Metrics::ProbesOpen);
         socket.disconnectFromHost();
         if (socket.state() != QAbstractSocket::UnconnectedState) {
             socket.waitForDisconnected(500);
         }
+    } else {
+        Metrics::count(socket.error() == QAbstractSocket::ConnectionRefusedError ? Metrics::ProbesRefused
+                       : socket.error() == QAbstractSocket::SocketTimeoutError ? Metrics::ProbesTimedOut
+                                                                               : Metrics::ProbesFailed);
     }
     
     return connected;
@@ -606,50 +872,6 @@ QString HostProfiler::detectDeviceType(const QString &ip, const QList<int> &port
     return "computer";
 }
 
-void NetworkMapper::buildNetworkTree()
-{
-    m_networkTree.clear();
-    
-    // Group hosts by subnet
-    QHash<QString, QStringList> subnets;
-    
-    for (const HostProfile &profile : m_profiles) {
-        QStringList ipParts = profile.ip.split('.');
-        if (ipParts.size() == 4) {
-            QString subnet = QString("%1.%2.%3").arg(ipParts[0], ipParts[1], ipParts[2]);
-            subnets[subnet].append(profile.ip);
-        }
-    }
-    
-    // Build tree structure
-    for (auto it = subnets.begin(); it != subnets.end(); ++it) {
-        QString subnet = it.key();
-        QStringList hosts = it.value();
-        
-        // Add subnet node
-        m_networkTree << QString("SUBNET|%1.0/24|%2 hosts").arg(subnet).arg(hosts.size());
-        
-        // Add host nodes
-        for (const QString &hostIP : hosts) {
-            // Find profile for this host
-            for (const HostProfile &profile : m_profiles) {
-                if (profile.ip == hostIP) {
-                    QString nodeInfo = QString("HOST|%1|%2|%3|%4")
-                                      .arg(profile.ip)
-                                      .arg(profile.osType.isEmpty() ? "Unknown" : profile.osType)
-                                      .arg(profile.vendor.isEmpty() ? "Unknown" : profile.vendor)
-                                      .arg(profile.services.join(","));
-                    m_networkTree << nodeInfo;
-                    break;
-                }
-            }
-        }
-    }
-    
-    qDebug() << "Built network tree with" << m_networkTree.size() << "nodes";
-    emit networkTreeChanged();
-}
-
 void NetworkMapper::startQuickMapping()
 {
     if (m_isMapping) return;
@@ -658,10 +880,10 @@ void NetworkMapper::startQuickMapping()
     m_quickScan = true;
     
     // Get IPs from ARP table
-    QList<ArpEntry> arpEntries = parseArpTable();
+    refreshArpTable();
     QStringList arpIPs;
     
-    for (const ArpEntry &entry : arpEntries) {
+    for (const ArpEntry &entry : m_arpTable->entries()) {
         arpIPs << entry.ip;
     }
     
@@ -678,6 +900,27 @@ void NetworkMapper::startFullMapping(const QString &subnet)
     
     qDebug() << "Starting full mapping for subnet:" << subnet;
     m_quickScan = false;
+
+    const IpSubnet block = IpSubnet::parse(subnet);
+    if (block.network.isIPv6() && block.size() > 254) {
+        // Too wide to sweep: profile the hosts the harvest turns up. Names of
+        // dual-stack neighbours come from the IPv4 ARP cache.
+        QStringList knownHosts;
+        for (const ArpEntry &entry : m_arpTable->entries()) {
+            if (IpAddress::fromString(entry.ip).isIPv4())
+                knownHosts << entry.ip;
+        }
+        QThreadPool::globalInstance()->start(QRunnable::create([this, block, knownHosts]() {
+            const QStringList candidates = Ipv6Discovery::candidates(block, knownHosts);
+            QMetaObject::invokeMethod(this, [this, candidates, block]() {
+                if (candidates.isEmpty())
+                    qDebug() << "No IPv6 hosts harvested in" << block.toString();
+                else
+                    startMapping(candidates);
+            }, Qt::QueuedConnection);
+        }));
+        return;
+    }
     
     QStringList subnetIPs = getSubnetIPs(subnet);
     
@@ -690,28 +933,8 @@ void NetworkMapper::startFullMapping(const QString &subnet)
 
 QStringList NetworkMapper::getSubnetIPs(const QString &subnet)
 {
-    QStringList ips;
-    QRegularExpression cidrRegex(R"((\d+\.\d+\.\d+\.\d+)/(\d+))");
-    QRegularExpressionMatch match = cidrRegex.match(subnet);
-    
-    if (match.hasMatch()) {
-        QString baseIP = match.captured(1);
-        int prefix = match.captured(2).toInt();
-        
-        QHostAddress addr(baseIP);
-        quint32 ip = addr.toIPv4Address();
-        quint32 mask = 0xFFFFFFFF << (32 - prefix);
-        quint32 networkAddr = ip & mask;
-        quint32 broadcastAddr = networkAddr | (~mask);
-        
-        // Generate all IPs in subnet (limit to 254 for /24)
-        int maxHosts = qMin(254, (int)(broadcastAddr - networkAddr - 1));
-        
-        for (quint32 i = networkAddr + 1; i <= networkAddr + maxHosts; ++i) {
-            ips << QHostAddress(i).toString();
-        }
-    }
-    
+    // Generate all IPs in subnet (limit to 254 for /24)
+    const QStringList ips = IpSubnet::parse(subnet).hosts(254);
     qDebug() << "Generated" << ips.size() << "IPs for subnet" << subnet;
     return ips;
 }
@@ -6,6 +6,13 @@
 #include <QStringList>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QHostAddress>
+#include <QSet>
+#include <QThreadPool>
+#include "ArpTableModel.h"
+#include "IpAddress.h"
+#include "NetworkTreeModel.h"
+#include "TopologyGraph.h"
 
 struct HostProfile {
     QString ip;
@@ -14,6 +21,7 @@ struct HostProfile {
     QString osType;
     QString osVersion;
     QList<int> openPorts;
+    QList<int> openUdpPorts;
     QStringList services;
     QString vendor;
     QString deviceType;
@@ -21,20 +29,15 @@ struct HostProfile {
     qint64 responseTime;
 };
 
-struct ArpEntry {
-    QString ip;
-    QString mac;
-    QString vendor;
-    QString type;
-};
-
 class NetworkMapper : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool isMapping READ isMapping NOTIFY isMappingChanged)
     Q_PROPERTY(int progress READ progress NOTIFY progressChanged)
     Q_PROPERTY(int hostsProfiled READ hostsProfiled NOTIFY hostsProfiledChanged)
-    Q_PROPERTY(QStringList networkTree READ networkTree NOTIFY networkTreeChanged)
+    Q_PROPERTY(NetworkTreeModel* networkTree READ networkTree CONSTANT)
+    Q_PROPERTY(ArpTableModel* arpTable READ arpTable CONSTANT)
+    Q_PROPERTY(TopologyGraph* topology READ topology CONSTANT)
 
 public:
     explicit NetworkMapper(QObject *parent = nullptr);
@@ -42,7 +45,10 @@ public:
     bool isMapping() const { return m_isMapping; }
     int progress() const { return m_progress; }
     int hostsProfiled() const { return m_hostsProfiled; }
-    QStringList networkTree() const { return m_networkTree; }
+    NetworkTreeModel *networkTree() const { return m_networkTree; }
+    ArpTableModel *arpTable() const { return m_arpTable; }
+    TopologyGraph *topology() const { return m_topology; }
+    const QList<HostProfile> &profiles() const { return m_profiles; }
 
     QHash<QString, QString> loadVendorDatabase(const QString &filePath);
     
@@ -55,16 +61,15 @@ public slots:
     void startFullMapping(const QString &subnet); // Full subnet scan
     void stopMapping();
     void exportMap(const QString &format, const QString &filePath);
-    QStringList getArpTable();
+    void refreshArpTable();
 
 signals:
     void isMappingChanged();
     void progressChanged();
     void hostsProfiledChanged();
-    void networkTreeChanged();
     void hostProfiled(const QString &ip, const QString &os, const QString &services, const QString &vendor);
-    void arpTableUpdated(const QStringList &entries);
     void mappingCompleted();
+    void topologyCompleted();
     void exportCompleted(const QString &filePath);
 
 private slots:
@@ -77,8 +82,13 @@ private:
     QStringList detectServices(const QString &ip, const QList<int> &ports);
     QString getMacVendor(const QString &mac);
     QList<ArpEntry> parseArpTable();
-    void buildNetworkTree();
     QStringList getSubnetIPs(const QString &subnet);
+    void loadLocalSubnets();
+    QString subnetFor(const QString &ip) const;
+    bool isLocalSubnet(const QString &cidr) const;
+    void addToTopology(const HostProfile &profile);
+    void onTraceCompleted(const QString &subnet, const QStringList &hops);
+    void finishTopology();
     
     bool m_isMapping;
     int m_progress;
@@ -89,8 +99,16 @@ private:
     QStringList m_targetIPs;
     QList<HostProfile> m_profiles;
     QTimer *m_progressTimer;
-    QStringList m_networkTree;
+    NetworkTreeModel *m_networkTree;
+    ArpTableModel *m_arpTable;
     bool m_quickScan;
+
+    TopologyGraph *m_topology;
+    QList<IpSubnet> m_localSubnets; // directly attached networks
+    QSet<QString> m_tracedSubnets;  // one traceroute per remote subnet
+    int m_pendingTraces;
+    int m_traceGeneration;          // bumped per run so stale traces are dropped
+    QThreadPool m_tracePool;        // traces wait on timeouts, keep them off the profiling pool
 };
 
 class HostProfiler : public QObject
@@ -115,3 +133,27 @@ private:
     
     QString m_ip;
 };
+
+// Discovers the routers between this machine and a target with the system
+// traceroute (tracert on Windows), which handles the TTL-limited probes
+// without needing raw socket privileges here.
+class RouteTracer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RouteTracer(const QString &target, const QString &subnet, QObject *parent = nullptr);
+
+public slots:
+    void trace();
+
+signals:
+    // hops in order, "" where a hop did not answer; the target itself is excluded
+    void traceCompleted(const QString &target, const QString &subnet, const QStringList &hops);
+
+private:
+    QStringList parseHops(const QString &output) const;
+
+    QString m_target;
+    QString m_subnet;
+};
@@ -0,0 +1,597 @@
+#include "NetworkMonitor.h"
+#include "NetworkScanner.h"
+#include "ScanProtocol.h"
+#include "Trace.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const int kTickMs = 250;
+const qint64 kMinIntervalMs = 30 * 1000;      // recheck after a change
+const qint64 kMaxIntervalMs = 15 * 60 * 1000; // stable hosts, once per cycle
+const int kMissesForDown = 2;                 // one lost answer is not an outage
+const int kRotatedPorts = 4;                  // extra sweep ports tried per check
+const int kMaxChecks = 4;                     // checks in flight
+const int kMaxChanges = 200;
+const int kSweepThreads = 50;
+const int kMaxScheduleWaitMs = 60 * 60 * 1000; // re-armed at least hourly, clocks move
+
+QString storePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/monitor.json";
+}
+
+// Spreads first checks over a cycle so a restart or a big sweep doesn't burst
+qint64 staggeredDue(qint64 now)
+{
+    return now + kMaxIntervalMs / 2 + QRandomGenerator::global()->bounded(kMaxIntervalMs / 2);
+}
+}
+
+NetworkMonitor::NetworkMonitor(QObject *parent)
+    : QObject(parent)
+    , m_continuous(false)
+    , m_probesPerSecond(2)
+    , m_budget(0)
+    , m_checksInFlight(0)
+    , m_probesSent(0)
+{
+    m_checkPool.setMaxThreadCount(kMaxChecks);
+
+    m_tickTimer = new QTimer(this);
+    m_tickTimer->setInterval(kTickMs);
+    connect(m_tickTimer, &QTimer::timeout, this, &NetworkMonitor::tick);
+
+    m_scheduleTimer = new QTimer(this);
+    m_scheduleTimer->setSingleShot(true);
+    connect(m_scheduleTimer, &QTimer::timeout, this, &NetworkMonitor::runDueSchedules);
+
+    load();
+    armScheduleTimer();
+    if (m_continuous)
+        m_tickTimer->start();
+}
+
+NetworkMonitor::~NetworkMonitor()
+{
+    m_tickTimer->stop();
+    m_checkPool.waitForDone();
+    save();
+}
+
+void NetworkMonitor::setScanner(NetworkScanner *scanner)
+{
+    if (scanner == m_scanner)
+        return;
+    if (m_scanner)
+        m_scanner->disconnect(this);
+    m_scanner = scanner;
+
+    if (scanner) {
+        connect(scanner, &NetworkScanner::hostDiscovered, this,
+                [this](const QString &ip, const QString &, const QString &, const QList<int> &ports, const QList<int> &) {
+            onHostDiscovered(ip, ports);
+        });
+        connect(scanner, &NetworkScanner::scanStarted, this, &NetworkMonitor::onSweepStarted);
+        connect(scanner, &NetworkScanner::scanCompleted, this, &NetworkMonitor::onSweepCompleted);
+    }
+    emit scannerChanged();
+}
+
+void NetworkMonitor::setContinuous(bool enabled)
+{
+    if (enabled == m_continuous)
+        return;
+    m_continuous = enabled;
+    if (enabled) {
+        m_budget = 0;
+        m_tickTimer->start();
+    } else {
+        m_tickTimer->stop();
+    }
+    save();
+    emit continuousChanged();
+}
+
+void NetworkMonitor::setProbesPerSecond(int rate)
+{
+    rate = qMax(1, rate);
+    if (rate == m_probesPerSecond)
+        return;
+    m_probesPerSecond = rate;
+    save();
+    emit probesPerSecondChanged();
+}
+
+QVariantList NetworkMonitor::schedules() const
+{
+    QVariantList list;
+    for (const Schedule &schedule : m_schedules) {
+        list << QVariantMap{
+            {"id", schedule.id},
+            {"name", schedule.name},
+            {"cron", schedule.cron.text()},
+            {"network", schedule.network},
+            {"ports", schedule.ports},
+            {"nextRun", schedule.nextRun},
+            {"lastRun", schedule.lastRun},
+        };
+    }
+    return list;
+}
+
+int NetworkMonitor::onlineCount() const
+{
+    return int(std::count_if(m_hosts.cbegin(), m_hosts.cend(), [](const Host &host) { return host.online; }));
+}
+
+QString NetworkMonitor::addSchedule(const QString &name, const QString &cron, const QString &network,
+                                    const QString &ports)
+{
+    const CronExpression expression = CronExpression::parse(cron);
+    if (!expression.isValid() || network.trimmed().isEmpty())
+        return QString();
+
+    Schedule schedule;
+    schedule.id = QString::number(QDateTime::currentMSecsSinceEpoch(), 36)
+        + QString::number(QRandomGenerator::global()->bounded(0x10000), 16);
+    schedule.name = name.trimmed().isEmpty() ? network.trimmed() : name.trimmed();
+    schedule.cron = expression;
+    schedule.network = network.trimmed();
+    schedule.ports = ports.trimmed().isEmpty() ? QString("1-1024") : ports.trimmed();
+    schedule.nextRun = expression.next(QDateTime::currentDateTime());
+    m_schedules << schedule;
+
+    save();
+    armScheduleTimer();
+    emit schedulesChanged();
+    return schedule.id;
+}
+
+void NetworkMonitor::removeSchedule(const QString &id)
+{
+    const auto removed = std::remove_if(m_schedules.begin(), m_schedules.end(),
+                                        [&id](const Schedule &schedule) { return schedule.id == id; });
+    if (removed == m_schedules.end())
+        return;
+    m_schedules.erase(removed, m_schedules.end());
+    m_pendingSweeps.removeAll(id);
+
+    save();
+    armScheduleTimer();
+    emit schedulesChanged();
+}
+
+void NetworkMonitor::runSchedule(const QString &id)
+{
+    startSweep(id);
+}
+
+void NetworkMonitor::clearInventory()
+{
+    m_hosts.clear();
+    m_portSets.clear();
+    save();
+    emit inventoryChanged();
+}
+
+void NetworkMonitor::onSweepStarted()
+{
+    m_sweepSeen.clear();
+}
+
+void NetworkMonitor::onHostDiscovered(const QString &ip, const QList<int> &ports)
+{
+    m_sweepSeen.insert(ip);
+    const QList<int> covered = m_scanner ? m_scanner->targetPorts() : QList<int>();
+    const int portSet = portSetFor(covered);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    auto it = m_hosts.find(ip);
+    if (it == m_hosts.end()) {
+        Host host;
+        host.ip = ip;
+        host.openPorts = ports;
+        host.portSet = portSet;
+        host.intervalMs = kMaxIntervalMs;
+        host.dueMs = staggeredDue(now);
+        m_hosts.insert(ip, host);
+        QStringList list;
+        for (int port : ports)
+            list << QString::number(port);
+        recordChange(ip, "new", list.join(','));
+        emit inventoryChanged();
+        return;
+    }
+
+    Host &host = *it;
+    bool changed = false;
+    if (!host.online) {
+        host.online = true;
+        recordChange(ip, "up");
+        changed = true;
+    }
+    host.misses = 0;
+
+    // Only ports this sweep covered can have closed; the rest stay as they were
+    QList<int> openPorts = ports;
+    for (int port : std::as_const(host.openPorts)) {
+        if (ports.contains(port))
+            continue;
+        if (std::binary_search(covered.cbegin(), covered.cend(), port)) {
+            recordChange(ip, "portClosed", QString::number(port));
+            changed = true;
+        } else {
+            openPorts << port;
+        }
+    }
+    for (int port : ports) {
+        if (!host.openPorts.contains(port)) {
+            recordChange(ip, "portOpened", QString::number(port));
+            changed = true;
+        }
+    }
+    std::sort(openPorts.begin(), openPorts.end());
+    host.openPorts = openPorts;
+    host.portSet = portSet;
+
+    // A sweep just looked at everything; a quiet host can wait a full cycle
+    if (changed) {
+        reschedule(host, true);
+    } else {
+        host.intervalMs = kMaxIntervalMs;
+        host.dueMs = staggeredDue(now);
+    }
+    emit inventoryChanged();
+}
+
+void NetworkMonitor::onSweepCompleted()
+{
+    // Only a sweep that ran to the end proves the hosts it didn't find are gone
+    if (m_scanner && m_scanner->progress() == 100) {
+        for (const QString &ip : m_scanner->targets()) {
+            if (m_sweepSeen.contains(ip))
+                continue;
+            auto it = m_hosts.find(ip);
+            if (it == m_hosts.end() || !it->online)
+                continue;
+            it->online = false;
+            it->misses = kMissesForDown;
+            recordChange(ip, "down");
+            reschedule(*it, true);
+        }
+    }
+    m_sweepSeen.clear();
+    save();
+    emit inventoryChanged();
+
+    // The scanner is still unwinding this scan; start the next one after it
+    if (!m_pendingSweeps.isEmpty())
+        QTimer::singleShot(0, this, [this]() {
+            if (!m_pendingSweeps.isEmpty())
+                startSweep(m_pendingSweeps.takeFirst());
+        });
+}
+
+void NetworkMonitor::tick()
+{
+    // Sweeps cover the same ground faster; the monitor waits them out
+    if (m_scanner && m_scanner->isScanning())
+        return;
+
+    m_budget = qMin(double(m_probesPerSecond), m_budget + m_probesPerSecond * kTickMs / 1000.0);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    while (m_budget > 0 && m_checksInFlight < kMaxChecks) {
+        Host *next = nullptr;
+        for (Host &host : m_hosts) {
+            if (!host.checking && (!next || host.dueMs < next->dueMs))
+                next = &host;
+        }
+        if (!next || next->dueMs > now)
+            return;
+        dispatch(*next);
+    }
+}
+
+void NetworkMonitor::dispatch(Host &host)
+{
+    // Known open ports, plus a few more from the host's sweep in rotation
+    // so ports that open later are found without a rescan
+    QList<int> ports = host.openPorts;
+    if (host.portSet >= 0 && host.portSet < m_portSets.size()) {
+        const QList<int> &candidates = m_portSets.at(host.portSet);
+        int added = 0;
+        int i = 0;
+        for (; i < candidates.size() && added < kRotatedPorts; ++i) {
+            const int port = candidates.at((host.portCursor + i) % candidates.size());
+            if (!ports.contains(port)) {
+                ports << port;
+                ++added;
+            }
+        }
+        if (!candidates.isEmpty())
+            host.portCursor = (host.portCursor + i) % candidates.size();
+    }
+
+    host.checking = true;
+    ++m_checksInFlight;
+    // Allowed into debt, so a host with many open ports still gets its turn.
+    // A fallback ping is charged once its real cost is known.
+    m_budget -= ports.size();
+
+    const QString ip = host.ip;
+    QRunnable *task = QRunnable::create([this, ip, ports]() {
+        const CheckResult result = check(ip, ports);
+        QMetaObject::invokeMethod(this, [this, result]() { applyCheck(result); }, Qt::QueuedConnection);
+    });
+    task->setAutoDelete(true);
+    m_checkPool.start(task);
+}
+
+NetworkMonitor::CheckResult NetworkMonitor::check(const QString &ip, const QList<int> &ports)
+{
+    const Trace::Span span("monitor", "check", ip);
+    CheckResult result;
+    result.ip = ip;
+    result.probed = ports;
+    for (int port : ports) {
+        ++result.probes;
+        if (HostScanner::isPortOpen(ip, port))
+            result.open << port;
+    }
+    result.answered = !result.open.isEmpty();
+
+    // Nothing listening: only then is the slower ping worth it
+    if (!result.answered) {
+        int pingProbes = 0;
+        result.answered = HostScanner::pingHost(ip, &pingProbes);
+        result.probes += pingProbes;
+    }
+    return result;
+}
+
+void NetworkMonitor::applyCheck(const CheckResult &result)
+{
+    --m_checksInFlight;
+    m_probesSent += result.probes;
+    // ICMP plus up to six TCP connects when the ping fell back
+    m_budget -= result.probes - result.probed.size();
+
+    auto it = m_hosts.find(result.ip);
+    if (it == m_hosts.end())
+        return; // inventory cleared meanwhile
+    Host &host = *it;
+    host.checking = false;
+
+    if (!result.answered) {
+        ++host.misses;
+        if (host.online && host.misses >= kMissesForDown) {
+            host.online = false;
+            recordChange(host.ip, "down");
+        }
+        // Suspect and freshly down hosts are looked at again soon, long-down ones back off
+        reschedule(host, host.misses <= kMissesForDown);
+        emit inventoryChanged();
+        return;
+    }
+
+    bool changed = false;
+    host.misses = 0;
+    if (!host.online) {
+        host.online = true;
+        recordChange(host.ip, "up");
+        changed = true;
+    }
+
+    QList<int> openPorts;
+    for (int port : std::as_const(host.openPorts)) {
+        if (result.probed.contains(port) && !result.open.contains(port)) {
+            recordChange(host.ip, "portClosed", QString::number(port));
+            changed = true;
+        } else {
+            openPorts << port;
+        }
+    }
+    for (int port : result.open) {
+        if (!host.openPorts.contains(port)) {
+            recordChange(host.ip, "portOpened", QString::number(port));
+            openPorts << port;
+            changed = true;
+        }
+    }
+    std::sort(openPorts.begin(), openPorts.end());
+    host.openPorts = openPorts;
+
+    reschedule(host, changed);
+    emit inventoryChanged();
+}
+
+void NetworkMonitor::reschedule(Host &host, bool changed)
+{
+    // Recently changed hosts are watched closely; each quiet check doubles the wait
+    host.intervalMs = changed ? kMinIntervalMs : qBound(kMinIntervalMs, host.intervalMs * 2, kMaxIntervalMs);
+    host.dueMs = QDateTime::currentMSecsSinceEpoch() + host.intervalMs;
+}
+
+void NetworkMonitor::recordChange(const QString &ip, const QString &change, const QString &detail)
+{
+    m_changes.prepend(QVariantMap{
+        {"time", QDateTime::currentDateTime()},
+        {"ip", ip},
+        {"change", change},
+        {"detail", detail},
+    });
+    while (m_changes.size() > kMaxChanges)
+        m_changes.removeLast();
+
+    qDebug() << "Monitor:" << ip << change << detail;
+    emit hostChanged(ip, change, detail);
+    emit changesChanged();
+}
+
+void NetworkMonitor::startSweep(const QString &id)
+{
+    auto it = std::find_if(m_schedules.begin(), m_schedules.end(),
+                           [&id](const Schedule &schedule) { return schedule.id == id; });
+    if (it == m_schedules.end())
+        return;
+    if (!m_scanner) {
+        qWarning() << "Scheduled sweep" << it->name << "skipped: no scanner attached";
+        return;
+    }
+    // Someone else's scan is running; this one goes next
+    if (m_scanner->isScanning()) {
+        if (!m_pendingSweeps.contains(id))
+            m_pendingSweeps << id;
+        return;
+    }
+
+    qDebug() << "Scheduled sweep" << it->name << ":" << it->network << it->ports;
+    it->lastRun = QDateTime::currentDateTime();
+    const QString network = it->network;
+    const QString ports = it->ports;
+    save();
+    emit schedulesChanged();
+    m_scanner->startScan(network, ports, kSweepThreads);
+}
+
+void NetworkMonitor::armScheduleTimer()
+{
+    if (m_schedules.isEmpty()) {
+        m_scheduleTimer->stop();
+        return;
+    }
+    const QDateTime now = QDateTime::currentDateTime();
+    qint64 waitMs = kMaxScheduleWaitMs;
+    for (const Schedule &schedule : std::as_const(m_schedules)) {
+        if (schedule.nextRun.isValid())
+            waitMs = qMin(waitMs, now.msecsTo(schedule.nextRun));
+    }
+    m_scheduleTimer->start(int(qMax<qint64>(0, waitMs)));
+}
+
+void NetworkMonitor::runDueSchedules()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    QStringList due;
+    for (Schedule &schedule : m_schedules) {
+        if (!schedule.nextRun.isValid() || schedule.nextRun > now)
+            continue;
+        schedule.nextRun = schedule.cron.next(now);
+        due << schedule.id;
+    }
+    for (const QString &id : std::as_const(due))
+        startSweep(id);
+
+    armScheduleTimer();
+    if (!due.isEmpty())
+        emit schedulesChanged();
+}
+
+int NetworkMonitor::portSetFor(const QList<int> &ports)
+{
+    const int index = int(m_portSets.indexOf(ports));
+    if (index >= 0)
+        return index;
+    m_portSets << ports;
+    return int(m_portSets.size() - 1);
+}
+
+void NetworkMonitor::load()
+{
+    QFile file(storePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+
+    m_continuous = root.value("continuous").toBool();
+    m_probesPerSecond = qMax(1, root.value("probesPerSecond").toInt(m_probesPerSecond));
+
+    // Runs missed while closed are not made up; the next one is due as usual
+    const QDateTime now = QDateTime::currentDateTime();
+    for (const QJsonValue &value : root.value("schedules").toArray()) {
+        const QJsonObject object = value.toObject();
+        Schedule schedule;
+        schedule.id = object.value("id").toString();
+        schedule.name = object.value("name").toString();
+        schedule.cron = CronExpression::parse(object.value("cron").toString());
+        schedule.network = object.value("network").toString();
+        schedule.ports = object.value("ports").toString();
+        schedule.lastRun = QDateTime::fromString(object.value("lastRun").toString(), Qt::ISODate);
+        schedule.nextRun = schedule.cron.next(now);
+        if (!schedule.id.isEmpty() && schedule.cron.isValid())
+            m_schedules << schedule;
+    }
+
+    for (const QJsonValue &value : root.value("portSets").toArray())
+        m_portSets << ScanProtocol::toIntList(value.toArray());
+
+    const qint64 nowMs = now.toMSecsSinceEpoch();
+    for (const QJsonValue &value : root.value("hosts").toArray()) {
+        const QJsonObject object = value.toObject();
+        Host host;
+        host.ip = object.value("ip").toString();
+        host.openPorts = ScanProtocol::toIntList(object.value("tcp").toArray());
+        host.online = object.value("online").toBool(true);
+        host.portSet = object.value("portSet").toInt(-1);
+        host.intervalMs = kMaxIntervalMs;
+        host.dueMs = staggeredDue(nowMs);
+        if (!host.ip.isEmpty())
+            m_hosts.insert(host.ip, host);
+    }
+}
+
+void NetworkMonitor::save() const
+{
+    QJsonArray schedules;
+    for (const Schedule &schedule : m_schedules) {
+        schedules.append(QJsonObject{
+            {"id", schedule.id},
+            {"name", schedule.name},
+            {"cron", schedule.cron.text()},
+            {"network", schedule.network},
+            {"ports", schedule.ports},
+            {"lastRun", schedule.lastRun.toString(Qt::ISODate)},
+        });
+    }
+    QJsonArray portSets;
+    for (const QList<int> &ports : m_portSets)
+        portSets.append(ScanProtocol::toArray(ports));
+    QJsonArray hosts;
+    for (const Host &host : m_hosts) {
+        hosts.append(QJsonObject{
+            {"ip", host.ip},
+            {"tcp", ScanProtocol::toArray(host.openPorts)},
+            {"online", host.online},
+            {"portSet", host.portSet},
+        });
+    }
+    const QJsonObject root{
+        {"continuous", m_continuous},
+        {"probesPerSecond", m_probesPerSecond},
+        {"schedules", schedules},
+        {"portSets", portSets},
+        {"hosts", hosts},
+    };
+
+    const QString path = storePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot save monitor state to" << path << ":" << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit())
+        qWarning() << "Cannot save monitor state to" << path << ":" << file.errorString();
+}
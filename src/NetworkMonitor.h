@@ -0,0 +1,141 @@
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantList>
+#include "CronExpression.h"
+
+class NetworkScanner;
+
+// Keeps watch over hosts found by discovery. Every sweep of the attached
+// scanner, started by hand or by a cron schedule, updates the inventory;
+// between sweeps a low-rate monitor re-checks one host at a time, probing
+// its known open ports plus a few others from its sweep in rotation. Hosts
+// that just changed are checked again within seconds and stable ones back
+// off to a full cycle, so changes show up quickly for a small fraction of
+// the probes a rescan would send. Schedules, the inventory and the monitor
+// switch are kept in AppDataLocation/monitor.json.
+class NetworkMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(NetworkScanner *scanner READ scanner WRITE setScanner NOTIFY scannerChanged)
+    Q_PROPERTY(bool continuous READ continuous WRITE setContinuous NOTIFY continuousChanged)
+    Q_PROPERTY(int probesPerSecond READ probesPerSecond WRITE setProbesPerSecond NOTIFY probesPerSecondChanged)
+    Q_PROPERTY(QVariantList schedules READ schedules NOTIFY schedulesChanged)
+    Q_PROPERTY(QVariantList changes READ changes NOTIFY changesChanged)
+    Q_PROPERTY(int hostCount READ hostCount NOTIFY inventoryChanged)
+    Q_PROPERTY(int onlineCount READ onlineCount NOTIFY inventoryChanged)
+    Q_PROPERTY(qint64 probesSent READ probesSent NOTIFY inventoryChanged)
+
+public:
+    explicit NetworkMonitor(QObject *parent = nullptr);
+    ~NetworkMonitor();
+
+    NetworkScanner *scanner() const { return m_scanner; }
+    void setScanner(NetworkScanner *scanner);
+
+    bool continuous() const { return m_continuous; }
+    void setContinuous(bool enabled);
+    // Budget of the background monitor; sweeps use the scanner's own limits
+    int probesPerSecond() const { return m_probesPerSecond; }
+    void setProbesPerSecond(int rate);
+
+    // id, name, cron, network, ports, nextRun, lastRun
+    QVariantList schedules() const;
+    // Newest first: time, ip, change ("new", "up", "down", "portOpened",
+    // "portClosed") and detail
+    QVariantList changes() const { return m_changes; }
+    int hostCount() const { return int(m_hosts.size()); }
+    int onlineCount() const;
+    qint64 probesSent() const { return m_probesSent; }
+
+    // Returns the new schedule's id, or an empty string if cron doesn't parse
+    Q_INVOKABLE QString addSchedule(const QString &name, const QString &cron, const QString &network,
+                                    const QString &ports);
+    Q_INVOKABLE void removeSchedule(const QString &id);
+    // Sweeps now, or once the scanner is free, without moving the schedule
+    Q_INVOKABLE void runSchedule(const QString &id);
+    // Forgets every host; the next sweep starts the inventory over
+    Q_INVOKABLE void clearInventory();
+
+signals:
+    void scannerChanged();
+    void continuousChanged();
+    void probesPerSecondChanged();
+    void schedulesChanged();
+    void changesChanged();
+    void inventoryChanged();
+    void hostChanged(const QString &ip, const QString &change, const QString &detail);
+
+private:
+    struct Schedule {
+        QString id;
+        QString name;
+        CronExpression cron;
+        QString network;
+        QString ports;
+        QDateTime nextRun;
+        QDateTime lastRun;
+    };
+
+    struct Host {
+        QString ip;
+        QList<int> openPorts;   // last known open TCP ports
+        int portSet = -1;       // index into m_portSets, the ports its last sweep covered
+        int portCursor = 0;     // rotation through that set
+        bool online = true;
+        int misses = 0;         // checks in a row that got no answer
+        qint64 intervalMs = 0;
+        qint64 dueMs = 0;       // msecs since epoch
+        bool checking = false;
+    };
+
+    struct CheckResult {
+        QString ip;
+        QList<int> open;
+        QList<int> probed;
+        bool answered = false;
+        int probes = 0;
+    };
+
+    static CheckResult check(const QString &ip, const QList<int> &ports);
+
+    void onHostDiscovered(const QString &ip, const QList<int> &ports);
+    void onSweepStarted();
+    void onSweepCompleted();
+    void tick();
+    void dispatch(Host &host);
+    void applyCheck(const CheckResult &result);
+    void recordChange(const QString &ip, const QString &change, const QString &detail = QString());
+    void reschedule(Host &host, bool changed);
+    void startSweep(const QString &id);
+    void armScheduleTimer();
+    void runDueSchedules();
+    int portSetFor(const QList<int> &ports);
+    void load();
+    void save() const;
+
+    QPointer<NetworkScanner> m_scanner;
+    bool m_continuous;
+    int m_probesPerSecond;
+    double m_budget;          // probes the monitor may send now; may run into debt
+    int m_checksInFlight;
+    qint64 m_probesSent;
+
+    QList<Schedule> m_schedules;
+    QStringList m_pendingSweeps;  // schedule ids waiting for the scanner
+    QSet<QString> m_sweepSeen;    // hosts the running sweep reported
+
+    QHash<QString, Host> m_hosts;
+    QList<QList<int>> m_portSets; // shared, sweeps mostly reuse a handful of port lists
+    QVariantList m_changes;
+
+    QTimer *m_tickTimer;
+    QTimer *m_scheduleTimer;
+    QThreadPool m_checkPool;
+};
@@ -8,6 +8,18 @@
 #include <QElapsedTimer>
 #include <QDebug>
 #include <QSet>
+#include "Ipv6Discovery.h"
+#include "UdpProber.h"
+#include "ScanCheckpoint.h"
+#include "Metrics.h"
+#include "Trace.h"
+
+namespace {
+// Blocks up to this size are swept; wider IPv6 blocks are harvested instead
+const int kMaxSweepHosts = 254;
+const int kMaxThrottleSleepMs = 50; // keeps throttled workers responsive to stopScan
+const int kCheckpointIntervalMs = 15000;
+}
 
 NetworkScanner::NetworkScanner(QObject *parent)
     : QObject(parent)
@@ -19,22 +31,41 @@ NetworkScanner::NetworkScanner(QObject *parent)
     , m_totalHosts(0)
     , m_completedHosts(0)
     , m_maxThreads(50)
+    , m_scanGeneration(0)
+    , m_hostRateLimit(50)
+    , m_subnetRateLimit(500)
+    , m_checkpointsEnabled(true)
 {
     m_progressTimer = new QTimer(this);
     connect(m_progressTimer, &QTimer::timeout, this, &NetworkScanner::updateProgress);
+
+    m_checkpointWriter.setMaxThreadCount(1);
+    m_checkpointTimer = new QTimer(this);
+    m_checkpointTimer->setInterval(kCheckpointIntervalMs);
+    connect(m_checkpointTimer, &QTimer::timeout, this, [this]() { writeCheckpoint(false); });
 }
 
-void NetworkScanner::startScan(const QString &network, const QString &portRange, int threads)
+NetworkScanner::~NetworkScanner()
+{
+    // Closing mid-scan leaves a checkpoint behind to resume from
+    if (m_isScanning && m_scheduler) {
+        m_scheduler->cancel();
+        writeCheckpoint(true);
+        QThreadPool::globalInstance()->clear();
+        QThreadPool::globalInstance()->waitForDone();
+    }
+    m_checkpointWriter.waitForDone();
+}
+
+void NetworkScanner::beginScan(const QString &network, const QString &portRange, int threads)
 {
-    if (m_isScanning) return;
-    
-    qDebug() << "Starting scan:" << network << portRange << threads;
-    
     m_isScanning = true;
     m_progress = 0;
     m_hostsFound = 0;
     m_portsFound = 0;
     m_completedHosts = 0;
+    m_network = network;
+    m_portRange = portRange;
     
     emit scanStarted(network, portRange);
     m_currentIP = "";
@@ -45,32 +76,188 @@ void NetworkScanner::startScan(const QString &network, const QString &portRange,
     emit hostsFoundChanged();
     emit portsFoundChanged();
     emit currentIPChanged();
+}
+
+void NetworkScanner::startScan(const QString &network, const QString &portRange, int threads)
+{
+    if (m_isScanning) return;
+    
+    qDebug() << "Starting scan:" << network << portRange << threads;
+    beginScan(network, portRange, threads);
     
     parsePortRange(portRange);
-    m_targetIPs = generateIPList(network);
+    qDebug() << "Port list:" << m_targetPorts << "UDP:" << m_targetUdpPorts;
+
+    QList<IpSubnet> harvest;
+    QStringList names;
+    QStringList targets = generateIPList(network, &harvest, &names);
+    const int generation = ++m_scanGeneration;
+
+    if (harvest.isEmpty()) {
+        launchHostScans(targets);
+        return;
+    }
+
+    // IPv6 blocks too wide to sweep: probe only the harvested candidates.
+    // Harvesting waits on ping and DNS, so it runs off the GUI thread.
+    QThreadPool::globalInstance()->start(QRunnable::create([this, harvest, names, targets, generation]() mutable {
+        for (const IpSubnet &subnet : harvest)
+            targets += Ipv6Discovery::candidates(subnet, names);
+        QMetaObject::invokeMethod(this, [this, targets, generation]() {
+            if (m_isScanning && generation == m_scanGeneration)
+                launchHostScans(targets);
+        }, Qt::QueuedConnection);
+    }));
+}
+
+bool NetworkScanner::resumeScan(const QString &id)
+{
+    if (m_isScanning) return false;
+
+    ScanCheckpoint checkpoint;
+    if (!ScanCheckpoint::load(id, &checkpoint)) {
+        emit scanFailed("Saved scan " + id + " could not be read");
+        return false;
+    }
+
+    QSharedPointer<ProbeScheduler> scheduler = QSharedPointer<ProbeScheduler>::create(
+        checkpoint.targets, checkpoint.tcpPorts, checkpoint.hostRateLimit, checkpoint.subnetRateLimit);
+    if (!scheduler->restore(checkpoint.schedule, checkpoint.finished)) {
+        emit scanFailed("Saved scan " + id + " does not match its target list");
+        return false;
+    }
+
+    qDebug() << "Resuming scan" << id << ":" << checkpoint.network << checkpoint.completedProbes << "of"
+             << checkpoint.totalProbes << "probes done";
+    beginScan(checkpoint.network, checkpoint.portRange, checkpoint.threads);
+    ++m_scanGeneration;
+
+    m_scanId = id;
+    emit scanIdChanged();
+    m_targetIPs = checkpoint.targets;
+    m_targetPorts = checkpoint.tcpPorts;
+    m_targetUdpPorts = checkpoint.udpPorts;
+    m_totalHosts = m_targetIPs.size();
+    m_finished = checkpoint.finished;
+    m_completedHosts = m_finished.count(true);
+    m_results = checkpoint.results;
+    m_scheduler = scheduler;
+
+    // Hosts found before the interruption are reported again so views refill
+    for (const HostInfo &host : std::as_const(m_results)) {
+        m_hostsFound++;
+        m_portsFound += host.openPorts.size() + host.openUdpPorts.size();
+        emit hostDiscovered(host.ip, host.hostname, host.mac, host.openPorts, host.openUdpPorts);
+    }
+    emit hostsFoundChanged();
+    emit portsFoundChanged();
+
+    if (m_completedHosts >= m_totalHosts)
+        finishScan();
+    else
+        startWorkers();
+    return true;
+}
+
+void NetworkScanner::discardScan(const QString &id)
+{
+    m_checkpointWriter.waitForDone();
+    ScanCheckpoint::remove(id);
+    emit savedScansChanged();
+}
+
+QVariantList NetworkScanner::savedScans() const
+{
+    QVariantList scans;
+    const QList<ScanCheckpoint> checkpoints = ScanCheckpoint::list();
+    for (const ScanCheckpoint &checkpoint : checkpoints) {
+        QVariantMap scan;
+        scan["id"] = checkpoint.id;
+        scan["network"] = checkpoint.network;
+        scan["ports"] = checkpoint.portRange;
+        scan["savedAt"] = checkpoint.savedAt;
+        scan["progress"] = checkpoint.totalProbes > 0
+            ? int(checkpoint.completedProbes * 100 / checkpoint.totalProbes) : 0;
+        scans << scan;
+    }
+    return scans;
+}
+
+void NetworkScanner::launchHostScans(const QStringList &targets)
+{
+    m_targetIPs = targets;
     m_totalHosts = m_targetIPs.size();
     
     qDebug() << "Generated" << m_totalHosts << "IPs to scan";
-    qDebug() << "Port list:" << m_targetPorts;
-    
+
+    if (m_targetIPs.isEmpty()) {
+        finishScan();
+        return;
+    }
+
+    // Workers pull (host, port) probes in permuted order instead of each
+    // owning one host, so the load is spread across hosts and subnets. The
+    // worker that completes a host's last probe finishes it (ping if nothing
+    // answered, UDP, name and MAC).
+    m_scheduler = QSharedPointer<ProbeScheduler>::create(
+        m_targetIPs, m_targetPorts, m_hostRateLimit, m_subnetRateLimit);
+    m_scanId = ScanCheckpoint::newId();
+    emit scanIdChanged();
+    m_finished = QBitArray(m_totalHosts);
+    m_results.clear();
+
+    startWorkers();
+}
+
+void NetworkScanner::startWorkers()
+{
     m_progressTimer->start(500);
+    m_checkpointTimer->start();
     
     // Limit concurrent threads
     QThreadPool::globalInstance()->setMaxThreadCount(qMin(m_maxThreads, 100));
     qDebug() << "Using" << QThreadPool::globalInstance()->maxThreadCount() << "threads";
-    
-    for (const QString &ip : m_targetIPs) {
-        HostScanner *scanner = new HostScanner(ip, m_targetPorts);
-        connect(scanner, &HostScanner::scanCompleted, this, &NetworkScanner::onHostScanCompleted);
-        connect(scanner, &HostScanner::scanStarted, this, [this](const QString &ip) {
-            m_currentIP = ip;
-            emit currentIPChanged();
-        });
-        
-        QRunnable *task = QRunnable::create([scanner]() {
+
+    const QSharedPointer<ProbeScheduler> scheduler = m_scheduler;
+    const QList<int> udpPorts = m_targetUdpPorts;
+    const int generation = m_scanGeneration;
+
+    const int workers = QThreadPool::globalInstance()->maxThreadCount();
+    for (int i = 0; i < workers; ++i) {
+        QRunnable *task = QRunnable::create([this, scheduler, udpPorts, generation]() {
             QThread::currentThread()->setPriority(QThread::NormalPriority);
-            scanner->scan();
-            scanner->deleteLater();
+
+            ProbeScheduler::Probe probe;
+            int waitMs = 0;
+            while (!scheduler->isCancelled()) {
+                if (!scheduler->next(&probe, &waitMs)) {
+                    if (waitMs < 0)
+                        break;
+                    QThread::msleep(qMin(waitMs, kMaxThrottleSleepMs));
+                    continue;
+                }
+
+                const QString ip = scheduler->host(probe.host);
+                const bool open = probe.port > 0 && HostScanner::isPortOpen(ip, probe.port);
+                if (open)
+                    traceDebug() << "Port" << probe.port << "is OPEN on" << ip;
+                if (!scheduler->complete(probe, open))
+                    continue;
+
+                const int index = probe.host;
+                HostScanner scanner(ip, scheduler->openPorts(index), udpPorts);
+                connect(&scanner, &HostScanner::scanStarted, this, [this, generation](const QString &ip) {
+                    if (generation != m_scanGeneration)
+                        return;
+                    m_currentIP = ip;
+                    emit currentIPChanged();
+                });
+                connect(&scanner, &HostScanner::scanCompleted, this, [this, generation, index](const HostInfo &host) {
+                    if (m_isScanning && generation == m_scanGeneration)
+                        onHostScanCompleted(host, index);
+                });
+                scanner.scan();
+            }
         });
         task->setAutoDelete(true);
         
@@ -78,95 +265,213 @@ void NetworkScanner::startScan(const QString &network, const QString &portRange,
     }
 }
 
+void NetworkScanner::setHostRateLimit(int limit)
+{
+    limit = qMax(0, limit);
+    if (limit == m_hostRateLimit)
+        return;
+    m_hostRateLimit = limit;
+    emit rateLimitsChanged();
+}
+
+void NetworkScanner::setSubnetRateLimit(int limit)
+{
+    limit = qMax(0, limit);
+    if (limit == m_subnetRateLimit)
+        return;
+    m_subnetRateLimit = limit;
+    emit rateLimitsChanged();
+}
+
 void NetworkScanner::stopScan()
 {
     if (!m_isScanning) return;
     
     m_isScanning = false;
     m_progressTimer->stop();
+    m_checkpointTimer->stop();
+    if (m_scheduler) {
+        // Probes still in flight are recorded as pending and redone on resume
+        m_scheduler->cancel();
+        writeCheckpoint(true);
+        m_scheduler.reset();
+        emit savedScansChanged();
+    }
     QThreadPool::globalInstance()->clear();
     
     emit isScanningChanged();
     emit scanCompleted();
 }
 
-void NetworkScanner::onHostScanCompleted(const HostInfo &host)
+void NetworkScanner::writeCheckpoint(bool wait)
+{
+    if (!m_checkpointsEnabled || !m_scheduler || m_scanId.isEmpty())
+        return;
+
+    ScanCheckpoint checkpoint;
+    checkpoint.id = m_scanId;
+    checkpoint.network = m_network;
+    checkpoint.portRange = m_portRange;
+    checkpoint.savedAt = QDateTime::currentDateTime();
+    checkpoint.threads = m_maxThreads;
+    checkpoint.hostRateLimit = m_hostRateLimit;
+    checkpoint.subnetRateLimit = m_subnetRateLimit;
+    checkpoint.totalProbes = m_scheduler->total();
+    checkpoint.completedProbes = m_scheduler->completed();
+    checkpoint.targets = m_targetIPs;
+    checkpoint.tcpPorts = m_targetPorts;
+    checkpoint.udpPorts = m_targetUdpPorts;
+    checkpoint.schedule = m_scheduler->state();
+    checkpoint.finished = m_finished;
+    checkpoint.results = m_results;
+
+    // Serialising and compressing a large sweep stays off the GUI thread
+    m_checkpointWriter.start(QRunnable::create([checkpoint]() {
+        checkpoint.save();
+    }));
+    if (wait)
+        m_checkpointWriter.waitForDone();
+}
+
+void NetworkScanner::finishScan()
+{
+    m_isScanning = false;
+    m_progress = 100;
+    m_progressTimer->stop();
+    m_checkpointTimer->stop();
+    m_scheduler.reset();
+
+    // A finished scan has nothing left to resume
+    if (!m_scanId.isEmpty()) {
+        m_checkpointWriter.waitForDone();
+        ScanCheckpoint::remove(m_scanId);
+        emit savedScansChanged();
+    }
+    
+    qDebug() << "Scan completed. Found" << m_hostsFound << "hosts with" << m_portsFound << "open ports";
+    
+    emit isScanningChanged();
+    emit progressChanged();
+    emit scanCompleted();
+}
+
+void NetworkScanner::onHostScanCompleted(const HostInfo &host, int index)
 {
     QMutexLocker locker(&m_mutex);
     
     m_completedHosts++;
+    m_finished.setBit(index);
     
-    qDebug() << "Host scan completed:" << host.ip << "Online:" << host.isOnline << "Ports:" << host.openPorts.size();
+    traceDebug() << "Host scan completed:" << host.ip << "Online:" << host.isOnline << "Ports:" << host.openPorts.size();
     
     if (host.isOnline) {
         m_hostsFound++;
-        m_portsFound += host.openPorts.size();
+        m_portsFound += host.openPorts.size() + host.openUdpPorts.size();
+        Metrics::count(Metrics::HostsFound);
+        Metrics::count(Metrics::PortsFound, quint64(host.openPorts.size() + host.openUdpPorts.size()));
+        m_results.append(host);
         
-        emit hostDiscovered(host.ip, host.hostname, host.mac, host.openPorts);
+        emit hostDiscovered(host.ip, host.hostname, host.mac, host.openPorts, host.openUdpPorts);
         emit hostsFoundChanged();
         emit portsFoundChanged();
     }
     
-    if (m_completedHosts >= m_totalHosts) {
-        m_isScanning = false;
-        m_progress = 100;
-        m_progressTimer->stop();
-        
-        qDebug() << "Scan completed. Found" << m_hostsFound << "hosts with" << m_portsFound << "open ports";
-        
-        emit isScanningChanged();
-        emit progressChanged();
-        emit scanCompleted();
-    }
+    if (m_completedHosts >= m_totalHosts)
+        finishScan();
 }
 
 void NetworkScanner::updateProgress()
 {
-    if (m_totalHosts > 0) {
+    // Hosts only finish once their last probe is back, which in permuted
+    // order is near the end, so progress follows the probes instead
+    if (m_scheduler && m_scheduler->total() > 0) {
+        m_progress = qMin<int>(99, int(m_scheduler->completed() * 100 / m_scheduler->total()));
+        emit progressChanged();
+    } else if (m_totalHosts > 0) {
         m_progress = (m_completedHosts * 100) / m_totalHosts;
         emit progressChanged();
     }
 }
 
-QStringList NetworkScanner::generateIPList(const QString &network)
+QStringList NetworkScanner::generateIPList(const QString &network, QList<IpSubnet> *harvest, QStringList *names)
 {
     QStringList ips;
-    QRegularExpression cidrRegex(R"((\d+\.\d+\.\d+\.\d+)/(\d+))");
-    QRegularExpressionMatch match = cidrRegex.match(network);
-    
-    if (match.hasMatch()) {
-        QString baseIP = match.captured(1);
-        int prefix = match.captured(2).toInt();
-        
-        QHostAddress addr(baseIP);
-        quint32 ip = addr.toIPv4Address();
-        quint32 mask = 0xFFFFFFFF << (32 - prefix);
-        quint32 networkAddr = ip & mask;
-        quint32 broadcastAddr = networkAddr | (~mask);
-        
-        // Limit to reasonable range for testing
-        int maxHosts = qMin(254, (int)(broadcastAddr - networkAddr - 1));
-        
-        for (quint32 i = networkAddr + 1; i <= networkAddr + maxHosts; ++i) {
-            ips << QHostAddress(i).toString();
+
+    // Comma/space separated: CIDR blocks of either family, "first-last"
+    // ranges, single addresses, or host names resolved through DNS
+    const QStringList parts = network.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        if (part.contains('/')) {
+            const IpSubnet subnet = IpSubnet::parse(part);
+            if (!subnet.isValid()) {
+                qWarning() << "Invalid network:" << part;
+            } else if (subnet.network.isIPv6() && subnet.size() > quint64(kMaxSweepHosts)) {
+                harvest->append(subnet);
+            } else {
+                // Limit to reasonable range for testing
+                ips += subnet.hosts(kMaxSweepHosts);
+            }
+            continue;
+        }
+
+        const int dash = part.indexOf('-');
+        if (dash > 0) {
+            const IpAddress first = IpAddress::fromString(part.left(dash));
+            IpAddress last = IpAddress::fromString(part.mid(dash + 1));
+            if (first.isIPv4() && !last.isValid()) {
+                // "a.b.c.N-M" shorthand
+                last = IpAddress::fromString(part.left(dash).section('.', 0, 2) + '.' + part.mid(dash + 1));
+            }
+            const quint64 span = first.distanceTo(last);
+            if (first.isValid() && last.family() == first.family() && last >= first) {
+                for (quint64 i = 0; i <= qMin<quint64>(span, kMaxSweepHosts - 1); ++i)
+                    ips << first.offset(i).toString();
+                continue;
+            }
+        }
+
+        if (IpAddress::fromString(part).isValid()) {
+            ips << part; // keeps any %scope
+        } else {
+            names->append(part);
+            const auto addresses = QHostInfo::fromName(part).addresses();
+            for (const QHostAddress &address : addresses)
+                ips << address.toString();
         }
-    } else {
-        // Single IP
-        ips << network;
     }
-    
+
     return ips;
 }
 
 void NetworkScanner::parsePortRange(const QString &portRange)
 {
     m_targetPorts.clear();
+    m_targetUdpPorts.clear();
     
-    // Split by comma, semicolon, or space
+    // Split by comma, semicolon, or space. Ports are TCP unless written
+    // "53/udp" or listed after "U:" (back to TCP after "T:"), as with nmap.
     QStringList parts = portRange.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+    bool udpSection = false;
     
     for (const QString &part : parts) {
         QString trimmed = part.trimmed();
+        if (trimmed.startsWith("U:", Qt::CaseInsensitive)) {
+            udpSection = true;
+            trimmed = trimmed.mid(2);
+        } else if (trimmed.startsWith("T:", Qt::CaseInsensitive)) {
+            udpSection = false;
+            trimmed = trimmed.mid(2);
+        }
+
+        bool udp = udpSection;
+        if (trimmed.endsWith("/udp", Qt::CaseInsensitive)) {
+            udp = true;
+            trimmed.chop(4);
+        } else if (trimmed.endsWith("/tcp", Qt::CaseInsensitive)) {
+            udp = false;
+            trimmed.chop(4);
+        }
+        QList<int> &target = udp ? m_targetUdpPorts : m_targetPorts;
         
         if (trimmed.contains('-')) {
             // Handle range like "1-100"
@@ -178,89 +483,125 @@ void NetworkScanner::parsePortRange(const QString &portRange)
                 
                 if (ok1 && ok2 && start > 0 && end > 0 && start <= end && end <= 65535) {
                     for (int port = start; port <= end; ++port) {
-                        m_targetPorts << port;
+                        target << port;
                     }
-                    qDebug() << "Added port range:" << start << "-" << end;
+                    traceDebug() << "Added port range:" << start << "-" << end << (udp ? "udp" : "tcp");
                 }
             }
-        } else {
+        } else if (!trimmed.isEmpty()) {
             // Handle single port like "80"
             bool ok;
             int port = trimmed.toInt(&ok);
             if (ok && port > 0 && port <= 65535) {
-                m_targetPorts << port;
-                qDebug() << "Added single port:" << port;
+                target << port;
+                traceDebug() << "Added single port:" << port << (udp ? "udp" : "tcp");
             }
         }
     }
     
     // Remove duplicates and sort
-    QSet<int> seen(m_targetPorts.begin(), m_targetPorts.end());
-    m_targetPorts = QList<int>(seen.begin(), seen.end());
-    std::sort(m_targetPorts.begin(), m_targetPorts.end());
+    for (QList<int> *ports : {&m_targetPorts, &m_targetUdpPorts}) {
+        QSet<int> seen(ports->begin(), ports->end());
+        *ports = QList<int>(seen.begin(), seen.end());
+        std::sort(ports->begin(), ports->end());
+    }
     
-    qDebug() << "Final port list:" << m_targetPorts;
+    qDebug() << "Final port list:" << m_targetPorts << "UDP:" << m_targetUdpPorts;
 }
 
 // HostScanner Implementation
-HostScanner::HostScanner(const QString &ip, const QList<int> &ports, QObject *parent)
-    : QObject(parent), m_ip(ip), m_ports(ports)
+HostScanner::HostScanner(const QString &ip, const QList<int> &openPorts, const QList<int> &udpPorts, QObject *parent)
+    : QObject(parent), m_ip(ip), m_openPorts(openPorts), m_udpPorts(udpPorts)
 {
 }
 
 void HostScanner::scan()
 {
+    const Metrics::Timer timer;
+    const Trace::Span span("scan", "host", m_ip);
     emit scanStarted(m_ip);
     
     HostInfo host;
     host.ip = m_ip;
     host.responseTime = 0;
     
-    // Try multiple ping methods
-    host.isOnline = pingHost(m_ip);
-    
-    // Always scan ports if host is online OR if we find any open ports
-    if (host.isOnline || !m_ports.isEmpty()) {
-        host.openPorts = scanPorts(m_ip, m_ports);
-        
-        // If host wasn't detected as online but has open ports, mark as online
-        if (!host.isOnline && !host.openPorts.isEmpty()) {
-            host.isOnline = true;
-            qDebug() << "Host" << m_ip << "detected via open ports:" << host.openPorts;
+    // An open port already proves the host is up; otherwise try the ping methods
+    host.openPorts = m_openPorts;
+    if (host.openPorts.isEmpty()) {
+        const Metrics::Timer ping;
+        const Trace::Span pingSpan("scan", "ping");
+        host.isOnline = pingHost(m_ip);
+        ping.record(Metrics::HostPing);
+    } else {
+        host.isOnline = true;
+    }
+    if (!host.openPorts.isEmpty())
+        traceDebug() << "Host" << m_ip << "detected via open ports:" << host.openPorts;
+
+    if (!m_udpPorts.isEmpty()) {
+        // A port-unreachable answer proves the host is up just as well as a reply
+        const Trace::Span udpSpan("scan", "udp");
+        const QList<UdpProber::Result> results = UdpProber(m_ip).probe(m_udpPorts);
+        for (const UdpProber::Result &result : results) {
+            if (result.state == UdpProber::Open)
+                host.openUdpPorts << result.port;
+            if (result.state == UdpProber::Open || result.state == UdpProber::Closed)
+                host.isOnline = true;
         }
     }
     
     if (host.isOnline) {
-        host.hostname = resolveHostname(m_ip);
-        host.mac = getMacAddress(m_ip);
-        qDebug() << "Host" << m_ip << "is online with" << host.openPorts.size() << "open ports";
+        {
+            const Metrics::Timer resolve;
+            const Trace::Span resolveSpan("scan", "resolve");
+            host.hostname = resolveHostname(m_ip);
+            resolve.record(Metrics::HostResolve);
+        }
+        {
+            const Metrics::Timer mac;
+            const Trace::Span macSpan("scan", "mac");
+            host.mac = getMacAddress(m_ip);
+            mac.record(Metrics::HostMac);
+        }
+        traceDebug() << "Host" << m_ip << "is online with" << host.openPorts.size() << "open ports and"
+                     << host.openUdpPorts.size() << "open UDP ports";
     } else {
-        qDebug() << "Host" << m_ip << "is offline";
+        traceDebug() << "Host" << m_ip << "is offline";
     }
-    
+
+    timer.record(Metrics::HostScan);
+    Metrics::count(Metrics::HostsScanned);
     emit scanCompleted(host);
 }
 
-bool HostScanner::pingHost(const QString &ip)
+bool HostScanner::pingHost(const QString &ip, int *probes)
 {
+    int sent = 1;
+    if (probes) {
+        *probes = sent;
+    }
+    
     // Method 1: ICMP ping first (most reliable)
+    const bool ipv6 = IpAddress::fromString(ip).isIPv6();
 #ifdef Q_OS_WIN
     QProcess process;
-    process.start("ping", QStringList() << "-n" << "1" << "-w" << "500" << ip);
+    Metrics::startProcess(&process, "ping", QStringList() << (ipv6 ? "-6" : "-4") << "-n" << "1" << "-w" << "500" << ip, 1000);
     process.waitForFinished(1000);
     
+    // ICMPv6 replies carry no TTL field in the Windows output
     QString output = process.readAllStandardOutput();
-    if (output.contains("TTL=") && !output.contains("Request timed out")) {
-        qDebug() << "ICMP ping successful for" << ip;
+    if ((ipv6 ? output.contains("time") : output.contains("TTL=")) && !output.contains("Request timed out")
+        && !output.contains("unreachable")) {
+        traceDebug() << "ICMP ping successful for" << ip;
         return true;
     }
 #else
     QProcess process;
-    process.start("ping", QStringList() << "-c" << "1" << "-W" << "1" << ip);
+    Metrics::startProcess(&process, "ping", QStringList() << (ipv6 ? "-6" : "-4") << "-c" << "1" << "-W" << "1" << ip, 1000);
     process.waitForFinished(1000);
     
     if (process.exitCode() == 0) {
-        qDebug() << "ICMP ping successful for" << ip;
+        traceDebug() << "ICMP ping successful for" << ip;
         return true;
     }
 #endif
@@ -269,8 +610,11 @@ bool HostScanner::pingHost(const QString &ip)
     QList<int> commonPorts = {80, 443, 22, 135, 139, 445};
     
     for (int port : commonPorts) {
+        if (probes) {
+            *probes = ++sent;
+        }
         if (isPortOpen(ip, port)) {
-            qDebug() << "TCP connect successful for" << ip << "on port" << port;
+            traceDebug() << "TCP connect successful for" << ip << "on port" << port;
             return true;
         }
     }
@@ -297,9 +641,15 @@ QString HostScanner::resolveHostname(const QString &ip)
 
 QString HostScanner::getMacAddress(const QString &ip)
 {
+    // IPv6 neighbours live in the NDP cache, not the ARP table
+    if (IpAddress::fromString(ip).isIPv6()) {
+        const QString mac = Ipv6Discovery::macFor(ip);
+        return mac.isEmpty() ? QString("Unknown") : mac;
+    }
+
 #ifdef Q_OS_WIN
     QProcess process;
-    process.start("arp", QStringList() << "-a" << ip);
+    Metrics::startProcess(&process, "arp", QStringList() << "-a" << ip, 3000);
     process.waitForFinished(3000);
     
     QString output = process.readAllStandardOutput();
@@ -311,7 +661,7 @@ QString HostScanner::getMacAddress(const QString &ip)
     }
 #else
     QProcess process;
-    process.start("arp", QStringList() << "-n" << ip);
+    Metrics::startProcess(&process, "arp", QStringList() << "-n" << ip, 3000);
     process.waitForFinished(3000);
     
     QString output = process.readAllStandardOutput();
@@ -325,31 +675,17 @@ QString HostScanner::getMacAddress(const QString &ip)
     return "Unknown";
 }
 
-QList<int> HostScanner::scanPorts(const QString &ip, const QList<int> &ports)
-{
-    QList<int> openPorts;
-    
-    qDebug() << "Scanning" << ports.size() << "ports on" << ip;
-    
-    for (int port : ports) {
-        if (isPortOpen(ip, port)) {
-            openPorts << port;
-            qDebug() << "Port" << port << "is OPEN on" << ip;
-        }
-    }
-    
-    qDebug() << "Found" << openPorts.size() << "open ports on" << ip << ":" << openPorts;
-    return openPorts;
-}
-
 bool HostScanner::isPortOpen(const QString &ip, int port)
 {
+    const Metrics::Timer timer;
     QTcpSocket socket;
     socket.connectToHost(ip, port);
     
     bool connected = socket.waitForConnected(800); // Faster timeout
+    timer.record(Metrics::ProbeLatency);
     
     if (connected) {
+        Metrics::count(Metrics::ProbesOpen);
         socket.disconnectFromHost();
         if (socket.state() != QAbstractSocket::UnconnectedState) {
             socket.waitForDisconnected(500);
@@ -357,5 +693,10 @@ bool HostScanner::isPortOpen(const QString &ip, int port)
         return true;
     }
     
+    switch (socket.error()) {
+    case QAbstractSocket::ConnectionRefusedError: Metrics::count(Metrics::ProbesRefused); break;
+    case QAbstractSocket::SocketTimeoutError: Metrics::count(Metrics::ProbesTimedOut); break;
+    default: Metrics::count(Metrics::ProbesFailed); break;
+    }
     return false;
 }
@@ -8,12 +8,19 @@
 #include <QStringList>
 #include <QMutex>
 #include <QAtomicInt>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QBitArray>
+#include <QVariantList>
+#include "IpAddress.h"
+#include "ProbeScheduler.h"
 
 struct HostInfo {
     QString ip;
     QString hostname;
     QString mac;
     QList<int> openPorts;
+    QList<int> openUdpPorts;
     bool isOnline;
     qint64 responseTime;
 };
@@ -26,9 +33,14 @@ class NetworkScanner : public QObject
     Q_PROPERTY(int hostsFound READ hostsFound NOTIFY hostsFoundChanged)
     Q_PROPERTY(int portsFound READ portsFound NOTIFY portsFoundChanged)
     Q_PROPERTY(QString currentIP READ currentIP NOTIFY currentIPChanged)
+    Q_PROPERTY(int hostRateLimit READ hostRateLimit WRITE setHostRateLimit NOTIFY rateLimitsChanged)
+    Q_PROPERTY(int subnetRateLimit READ subnetRateLimit WRITE setSubnetRateLimit NOTIFY rateLimitsChanged)
+    Q_PROPERTY(QString scanId READ scanId NOTIFY scanIdChanged)
+    Q_PROPERTY(QVariantList savedScans READ savedScans NOTIFY savedScansChanged)
 
 public:
     explicit NetworkScanner(QObject *parent = nullptr);
+    ~NetworkScanner();
     
     bool isScanning() const { return m_isScanning; }
     int progress() const { return m_progress; }
@@ -36,9 +48,35 @@ public:
     int portsFound() const { return m_portsFound; }
     QString currentIP() const { return m_currentIP; }
 
+    // TCP probes per second, 0 for no limit; applied from the next scan
+    int hostRateLimit() const { return m_hostRateLimit; }
+    int subnetRateLimit() const { return m_subnetRateLimit; }
+    void setHostRateLimit(int limit);
+    void setSubnetRateLimit(int limit);
+
+    // Id of the current or last scan, the handle for resumeScan()
+    QString scanId() const { return m_scanId; }
+    // Interrupted scans on disk, newest first: id, network, ports, savedAt, progress
+    QVariantList savedScans() const;
+    // Online hosts of the current or last scan, in the order they were found
+    const QList<HostInfo> &results() const { return m_results; }
+    // Addresses and TCP ports the current or last scan covers
+    const QStringList &targets() const { return m_targetIPs; }
+    const QList<int> &targetPorts() const { return m_targetPorts; }
+
+    // Off for shard scans run on behalf of a coordinator, which tracks progress itself
+    void setCheckpointsEnabled(bool enabled) { m_checkpointsEnabled = enabled; }
+
+    // Expands a target list to addresses; IPv6 blocks too wide to sweep go to
+    // harvest and host names to names
+    static QStringList generateIPList(const QString &network, QList<IpSubnet> *harvest, QStringList *names);
+
 public slots:
     void startScan(const QString &network, const QString &portRange, int threads);
     void stopScan();
+    // Continues a stopped or interrupted scan from its last checkpoint
+    bool resumeScan(const QString &id);
+    void discardScan(const QString &id);
 
 signals:
     void isScanningChanged();
@@ -46,19 +84,27 @@ signals:
     void hostsFoundChanged();
     void portsFoundChanged();
     void currentIPChanged();
-    void hostDiscovered(const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports);
+    void rateLimitsChanged();
+    void scanIdChanged();
+    void savedScansChanged();
+    void hostDiscovered(const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports,
+                        const QList<int> &udpPorts);
     void scanCompleted();
     void scanStarted(const QString &network, const QString &ports);
     void scanFailed(const QString &error);
 
 private slots:
-    void onHostScanCompleted(const HostInfo &host);
+    void onHostScanCompleted(const HostInfo &host, int index);
     void updateProgress();
 
 private:
     void parseNetworkRange(const QString &network);
     void parsePortRange(const QString &portRange);
-    QStringList generateIPList(const QString &network);
+    void beginScan(const QString &network, const QString &portRange, int threads);
+    void launchHostScans(const QStringList &targets);
+    void startWorkers();
+    void finishScan();
+    void writeCheckpoint(bool wait);
     
     bool m_isScanning;
     int m_progress;
@@ -70,7 +116,21 @@ private:
     
     QStringList m_targetIPs;
     QList<int> m_targetPorts;
+    QList<int> m_targetUdpPorts;
     int m_maxThreads;
+    int m_scanGeneration; // bumped per scan so a late IPv6 harvest is dropped
+    int m_hostRateLimit;
+    int m_subnetRateLimit;
+    QSharedPointer<ProbeScheduler> m_scheduler;
+
+    QString m_scanId;
+    QString m_network;
+    QString m_portRange;
+    QBitArray m_finished;       // hosts whose results are final
+    QList<HostInfo> m_results;  // online hosts reported so far
+    QTimer *m_checkpointTimer;
+    bool m_checkpointsEnabled;
+    QThreadPool m_checkpointWriter;
     
     QMutex m_mutex;
     QTimer *m_progressTimer;
@@ -81,7 +141,14 @@ class HostScanner : public QObject
     Q_OBJECT
 
 public:
-    explicit HostScanner(const QString &ip, const QList<int> &ports, QObject *parent = nullptr);
+    // openPorts are the TCP ports the scheduler already found open
+    explicit HostScanner(const QString &ip, const QList<int> &openPorts, const QList<int> &udpPorts,
+                         QObject *parent = nullptr);
+
+    static bool isPortOpen(const QString &ip, int port);
+    // ICMP echo, then a TCP connect to a few common ports; probes, if
+    // given, receives how many of those were actually sent
+    static bool pingHost(const QString &ip, int *probes = nullptr);
 
 public slots:
     void scan();
@@ -91,12 +158,10 @@ signals:
     void scanStarted(const QString &ip);
 
 private:
-    bool pingHost(const QString &ip);
     QString resolveHostname(const QString &ip);
     QString getMacAddress(const QString &ip);
-    QList<int> scanPorts(const QString &ip, const QList<int> &ports);
-    bool isPortOpen(const QString &ip, int port);
     
     QString m_ip;
-    QList<int> m_ports;
+    QList<int> m_openPorts;
+    QList<int> m_udpPorts;
 };
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "NetworkTreeModel.h"
+
+namespace {
+// internalId 0 marks a subnet row; hosts carry their subnet's row + 1
+const quintptr kSubnetId = 0;
+}
+
+NetworkTreeModel::NetworkTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_hostCount(0)
+{
+}
+
+QModelIndex NetworkTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column != 0 || row < 0)
+        return QModelIndex();
+
+    if (!parent.isValid())
+        return row < m_subnets.size() ? createIndex(row, column, kSubnetId) : QModelIndex();
+
+    if (parent.internalId() != kSubnetId || row >= m_subnets[parent.row()].hosts.size())
+        return QModelIndex();
+    return createIndex(row, column, quintptr(parent.row() + 1));
+}
+
+QModelIndex NetworkTreeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || child.internalId() == kSubnetId)
+        return QModelIndex();
+    return createIndex(int(child.internalId() - 1), 0, kSubnetId);
+}
+
+int NetworkTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+        return m_subnets.size();
+    if (parent.internalId() == kSubnetId && parent.column() == 0)
+        return m_subnets[parent.row()].hosts.size();
+    return 0;
+}
+
+int NetworkTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+QVariant NetworkTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    if (index.internalId() == kSubnetId) {
+        const Subnet &subnet = m_subnets[index.row()];
+        switch (role) {
+        case Qt::DisplayRole:
+        case LabelRole: return subnet.cidr;
+        case KindRole: return QStringLiteral("subnet");
+        case HostCountRole: return subnet.hosts.size();
+        }
+        return QVariant();
+    }
+
+    const Host &host = m_subnets[int(index.internalId() - 1)].hosts[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+    case LabelRole:
+    case IpRole: return host.ip;
+    case KindRole: return QStringLiteral("host");
+    case OsRole: return host.os.isEmpty() ? QStringLiteral("Unknown") : host.os;
+    case VendorRole: return host.vendor.isEmpty() ? QStringLiteral("Unknown") : host.vendor;
+    case ServicesRole: return host.services;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> NetworkTreeModel::roleNames() const
+{
+    return {
+        {KindRole, "kind"},
+        {LabelRole, "label"},
+        {IpRole, "ip"},
+        {OsRole, "os"},
+        {VendorRole, "vendor"},
+        {ServicesRole, "services"},
+        {HostCountRole, "hostCount"}
+    };
+}
+
+int NetworkTreeModel::ensureSubnet(const QString &cidr)
+{
+    auto it = m_rowBySubnet.constFind(cidr);
+    if (it != m_rowBySubnet.constEnd())
+        return it.value();
+
+    const int row = m_subnets.size();
+    beginInsertRows(QModelIndex(), row, row);
+    Subnet subnet;
+    subnet.cidr = cidr;
+    m_subnets.append(subnet);
+    m_rowBySubnet.insert(cidr, row);
+    endInsertRows();
+    return row;
+}
+
+void NetworkTreeModel::upsertHost(const QString &subnet, const QString &ip, const QString &os,
+                                  const QString &vendor, const QStringList &services)
+{
+    const int subnetRow = ensureSubnet(subnet);
+    Subnet &group = m_subnets[subnetRow];
+    const QModelIndex parentIndex = index(subnetRow, 0);
+
+    auto it = group.rowByIp.constFind(ip);
+    if (it != group.rowByIp.constEnd()) {
+        Host &host = group.hosts[it.value()];
+        if (host.os == os && host.vendor == vendor && host.services == services)
+            return;
+        host.os = os;
+        host.vendor = vendor;
+        host.services = services;
+        const QModelIndex changed = index(it.value(), 0, parentIndex);
+        emit dataChanged(changed, changed, {OsRole, VendorRole, ServicesRole});
+        return;
+    }
+
+    const int row = group.hosts.size();
+    beginInsertRows(parentIndex, row, row);
+    group.hosts.append(Host{ip, os, vendor, services});
+    group.rowByIp.insert(ip, row);
+    endInsertRows();
+
+    ++m_hostCount;
+    emit dataChanged(parentIndex, parentIndex, {HostCountRole});
+    emit countChanged();
+}
+
+void NetworkTreeModel::clear()
+{
+    if (m_subnets.isEmpty())
+        return;
+
+    beginResetModel();
+    m_subnets.clear();
+    m_rowBySubnet.clear();
+    m_hostCount = 0;
+    endResetModel();
+    emit countChanged();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+// Two-level tree of subnets and the hosts profiled in them. Subnets and
+// hosts are found through hashes and only ever appended or updated in
+// place, so every change is a single row insert or dataChanged.
+class NetworkTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int subnetCount READ subnetCount NOTIFY countChanged)
+    Q_PROPERTY(int hostCount READ hostCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        KindRole = Qt::UserRole + 1, // "subnet" or "host"
+        LabelRole,                   // CIDR for subnets, address for hosts
+        IpRole,
+        OsRole,
+        VendorRole,
+        ServicesRole,
+        HostCountRole
+    };
+    Q_ENUM(Roles)
+
+    explicit NetworkTreeModel(QObject *parent = nullptr);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int subnetCount() const { return m_subnets.size(); }
+    int hostCount() const { return m_hostCount; }
+
+    void upsertHost(const QString &subnet, const QString &ip, const QString &os,
+                    const QString &vendor, const QStringList &services);
+
+public slots:
+    void clear();
+
+signals:
+    void countChanged();
+
+private:
+    struct Host {
+        QString ip;
+        QString os;
+        QString vendor;
+        QStringList services;
+    };
+
+    struct Subnet {
+        QString cidr;
+        QVector<Host> hosts;
+        QHash<QString, int> rowByIp;
+    };
+
+    int ensureSubnet(const QString &cidr);
+
+    QVector<Subnet> m_subnets;
+    QHash<QString, int> m_rowBySubnet;
+    int m_hostCount;
+};
@@ -0,0 +1,146 @@
+#include "OpenMetrics.h"
+
+#include <iterator>
+#include <numeric>
+
+namespace OpenMetrics {
+
+const char ContentType[] = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+namespace {
+const QByteArray kPrefix = "netsecops_";
+
+struct CounterFamily {
+    Metrics::Counter counter;
+    const char *family;
+    const char *label;   // empty, or the one label that tells samples apart
+    const char *unit;
+    const char *help;
+};
+
+struct HistogramFamily {
+    Metrics::Histogram histogram;
+    const char *family;
+    const char *label;
+    const char *unit;
+    const char *help;
+};
+
+// Samples of one family must be adjacent, so the tables are grouped by family
+const CounterFamily kCounters[] = {
+    {Metrics::ProbesOpen, "probes", "outcome=\"open\"", "", "TCP probes by outcome"},
+    {Metrics::ProbesRefused, "probes", "outcome=\"refused\"", "", ""},
+    {Metrics::ProbesTimedOut, "probes", "outcome=\"timed_out\"", "", ""},
+    {Metrics::ProbesFailed, "probes", "outcome=\"failed\"", "", ""},
+    {Metrics::ThrottleWaits, "throttle_waits", "", "", "Probes held back by host or subnet rate limits"},
+    {Metrics::HostsScanned, "hosts_scanned", "", "", "Hosts whose scan pass finished"},
+    {Metrics::HostsFound, "hosts_found", "", "", "Hosts found online"},
+    {Metrics::PortsFound, "ports_found", "", "", "Open TCP and UDP ports found"},
+    {Metrics::HostsProfiled, "hosts_profiled", "", "", "Hosts the mapper identified"},
+    {Metrics::ProcessesStarted, "processes_started", "", "", "Helper processes started"},
+    {Metrics::ProcessStartFailures, "process_start_failures", "", "", "Helper processes that failed to start"},
+    {Metrics::JobsCompleted, "jobs", "result=\"completed\"", "", "Remote jobs by result"},
+    {Metrics::JobsFailed, "jobs", "result=\"failed\"", "", ""},
+    {Metrics::TransferBytes, "transfer_bytes", "", "bytes", "Bytes deployed or retrieved by completed transfer jobs"},
+};
+
+const HistogramFamily kHistograms[] = {
+    {Metrics::ProbeLatency, "probe_duration_seconds", "", "seconds", "TCP connect attempt"},
+    {Metrics::ProcessSpawn, "process_spawn_seconds", "", "seconds", "Helper process start until running"},
+    {Metrics::HostPing, "host_phase_duration_seconds", "phase=\"ping\"", "seconds", "Per-host scan phases"},
+    {Metrics::HostResolve, "host_phase_duration_seconds", "phase=\"resolve\"", "seconds", ""},
+    {Metrics::HostMac, "host_phase_duration_seconds", "phase=\"mac\"", "seconds", ""},
+    {Metrics::HostScan, "host_phase_duration_seconds", "phase=\"total\"", "seconds", ""},
+    {Metrics::SchedulerQueue, "scheduler_queue_depth", "", "", "Probes parked behind rate limits, per hand-out"},
+    {Metrics::UiBatch, "model_batch_rows", "", "", "Rows per results model update"},
+    {Metrics::JobSsh, "job_duration_seconds", "protocol=\"SSH\"", "seconds", "Remote job start to finish"},
+    {Metrics::JobWinRm, "job_duration_seconds", "protocol=\"WinRM\"", "seconds", ""},
+    {Metrics::JobPowerShell, "job_duration_seconds", "protocol=\"PowerShell\"", "seconds", ""},
+    {Metrics::JobWmi, "job_duration_seconds", "protocol=\"WMI\"", "seconds", ""},
+    {Metrics::JobSchtasks, "job_duration_seconds", "protocol=\"SCHTASKS\"", "seconds", ""},
+    {Metrics::JobCustom, "job_duration_seconds", "protocol=\"Custom\"", "seconds", ""},
+    {Metrics::JobScp, "job_duration_seconds", "protocol=\"SCP/SFTP\"", "seconds", ""},
+    {Metrics::JobSmb, "job_duration_seconds", "protocol=\"SMB\"", "seconds", ""},
+    {Metrics::JobDelta, "job_duration_seconds", "protocol=\"SCP/SFTP Delta\"", "seconds", ""},
+    {Metrics::JobOther, "job_duration_seconds", "protocol=\"other\"", "seconds", ""},
+};
+
+const double kSecondBounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 300};
+const double kCountBounds[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000};
+
+QByteArray number(double value)
+{
+    return QByteArray::number(value, 'g', 15);
+}
+
+void writeHeader(QByteArray *out, const QByteArray &family, const char *type, const char *unit, const char *help)
+{
+    *out += "# TYPE " + family + ' ' + type + '\n';
+    if (*unit)
+        *out += "# UNIT " + family + ' ' + unit + '\n';
+    if (*help)
+        *out += "# HELP " + family + ' ' + help + '\n';
+}
+
+// name{label,extra} or name{extra} or name
+QByteArray sample(const QByteArray &name, const char *label, const QByteArray &extra = QByteArray())
+{
+    QByteArray labels = label;
+    if (!extra.isEmpty())
+        labels += (labels.isEmpty() ? "" : ",") + extra;
+    return labels.isEmpty() ? name : name + '{' + labels + '}';
+}
+}
+
+QByteArray format(const Metrics::Snapshot &snapshot, const QList<Gauge> &gauges)
+{
+    QByteArray out;
+    out.reserve(32 * 1024);
+
+    QByteArray previous;
+    for (const CounterFamily &c : kCounters) {
+        const QByteArray family = kPrefix + c.family;
+        if (family != previous)
+            writeHeader(&out, family, "counter", c.unit, c.help);
+        previous = family;
+        out += sample(family + "_total", c.label) + ' ' + QByteArray::number(snapshot.counters[c.counter]) + '\n';
+    }
+
+    previous.clear();
+    for (const HistogramFamily &h : kHistograms) {
+        const QByteArray family = kPrefix + h.family;
+        if (family != previous)
+            writeHeader(&out, family, "histogram", h.unit, h.help);
+        previous = family;
+
+        // Timings are recorded in microseconds and exposed in seconds
+        const Metrics::HistogramSnapshot &histogram = snapshot.histograms[h.histogram];
+        const bool seconds = *h.unit != '\0';
+        const double scale = seconds ? 1e6 : 1;
+        const double *bounds = seconds ? kSecondBounds : kCountBounds;
+        const int boundCount = seconds ? int(std::size(kSecondBounds)) : int(std::size(kCountBounds));
+        for (int i = 0; i < boundCount; ++i) {
+            const quint64 below = histogram.countAtMost(quint64(qRound64(bounds[i] * scale)));
+            out += sample(family + "_bucket", h.label, "le=\"" + number(bounds[i]) + '"') + ' '
+                   + QByteArray::number(below) + '\n';
+        }
+        // Taken from the same buckets as le, since the snapshot reads count
+        // separately and a racing record can leave the two apart
+        const quint64 total = std::accumulate(histogram.buckets.cbegin(), histogram.buckets.cend(), quint64(0));
+        out += sample(family + "_bucket", h.label, "le=\"+Inf\"") + ' ' + QByteArray::number(total) + '\n';
+        out += sample(family + "_count", h.label) + ' ' + QByteArray::number(total) + '\n';
+        out += sample(family + "_sum", h.label) + ' ' + number(histogram.sum / scale) + '\n';
+    }
+
+    for (const Gauge &gauge : gauges) {
+        const QByteArray family = kPrefix + gauge.name;
+        writeHeader(&out, family, "gauge", "", gauge.help.constData());
+        out += family + ' ' + number(gauge.value) + '\n';
+    }
+
+    out += "# EOF\n";
+    return out;
+}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include "Metrics.h"
+
+// OpenMetrics text exposition of the engine metrics, for Prometheus and
+// anything else that scrapes it. Formatting works on a Metrics snapshot,
+// so a scrape reads the per-thread slots once and never touches the
+// recording paths. HDR buckets are folded into fixed `le` bounds, each
+// exact to the histogram's resolution.
+namespace OpenMetrics {
+
+extern const char ContentType[];
+
+// Point-in-time values the caller reads from the engines, e.g. active jobs
+struct Gauge {
+    QByteArray name;   // without the netsecops_ prefix
+    QByteArray help;
+    double value;
+};
+
+QByteArray format(const Metrics::Snapshot &snapshot, const QList<Gauge> &gauges = {});
+
+}
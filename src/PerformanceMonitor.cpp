@@ -0,0 +1,112 @@
+#include "PerformanceMonitor.h"
+#include <QDateTime>
+
+namespace {
+const int kDefaultIntervalMs = 1000;
+const int kMinIntervalMs = 100;
+
+double perSecond(quint64 delta, qint64 ms)
+{
+    return ms > 0 ? qRound64(delta * 10000.0 / ms) / 10.0 : 0;
+}
+}
+
+PerformanceMonitor::PerformanceMonitor(QObject *parent)
+    : QObject(parent)
+    , m_previousMs(0)
+{
+    m_timer = new QTimer(this);
+    m_timer->setInterval(kDefaultIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &PerformanceMonitor::refresh);
+}
+
+void PerformanceMonitor::setActive(bool active)
+{
+    if (active == m_timer->isActive())
+        return;
+    if (active) {
+        // The first interval starts now rather than at the last poll
+        m_previous = Metrics::snapshot();
+        m_previousMs = QDateTime::currentMSecsSinceEpoch();
+        m_timer->start();
+    } else {
+        m_timer->stop();
+    }
+    emit activeChanged();
+}
+
+void PerformanceMonitor::setInterval(int ms)
+{
+    ms = qMax(kMinIntervalMs, ms);
+    if (ms == m_timer->interval())
+        return;
+    m_timer->setInterval(ms);
+    emit intervalChanged();
+}
+
+void PerformanceMonitor::refresh()
+{
+    const Metrics::Snapshot current = Metrics::snapshot();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 elapsed = now - m_previousMs;
+
+    m_counters.clear();
+    for (int c = 0; c < Metrics::CounterCount; ++c) {
+        const quint64 total = current.counters[c];
+        m_counters.append(QVariantMap{
+            {"name", Metrics::name(Metrics::Counter(c))},
+            {"total", total},
+            {"perSecond", perSecond(total - qMin(total, m_previous.counters[c]), elapsed)},
+        });
+    }
+
+    m_histograms.clear();
+    for (int h = 0; h < Metrics::HistogramCount; ++h) {
+        const Metrics::HistogramSnapshot &all = current.histograms[h];
+        const Metrics::HistogramSnapshot window = all.since(m_previous.histograms[h]);
+        const bool timing = *Metrics::unit(Metrics::Histogram(h)) != '\0';
+        QVariantMap entry{
+            {"name", Metrics::name(Metrics::Histogram(h))},
+            {"unit", Metrics::unit(Metrics::Histogram(h))},
+            {"count", all.count},
+            {"perSecond", perSecond(window.count, elapsed)},
+            {"p50", window.percentile(50)},
+            {"p90", window.percentile(90)},
+            {"p99", window.percentile(99)},
+            {"max", all.max},
+            {"mean", window.mean()},
+        };
+        // Time spent in this stage during the interval, summed over threads
+        if (timing)
+            entry.insert("totalMs", window.sum / 1000);
+        m_histograms.append(entry);
+    }
+
+    m_previous = current;
+    m_previousMs = now;
+    emit updated();
+}
+
+QJsonObject PerformanceMonitor::toJson(const Metrics::Snapshot &snapshot)
+{
+    QJsonObject counters;
+    for (int c = 0; c < Metrics::CounterCount; ++c)
+        counters.insert(Metrics::name(Metrics::Counter(c)), qint64(snapshot.counters[c]));
+
+    QJsonObject histograms;
+    for (int h = 0; h < Metrics::HistogramCount; ++h) {
+        const Metrics::HistogramSnapshot &histogram = snapshot.histograms[h];
+        if (!histogram.count)
+            continue;
+        histograms.insert(Metrics::name(Metrics::Histogram(h)), QJsonObject{
+            {"unit", Metrics::unit(Metrics::Histogram(h))},
+            {"count", qint64(histogram.count)},
+            {"sum", qint64(histogram.sum)},
+            {"p50", qint64(histogram.percentile(50))},
+            {"p90", qint64(histogram.percentile(90))},
+            {"p99", qint64(histogram.percentile(99))},
+            {"max", qint64(histogram.max)},
+        });
+    }
+    return {{"counters", counters}, {"histograms", histograms}};
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QObject>
+#include <QJsonObject>
+#include <QTimer>
+#include <QVariantList>
+#include "Metrics.h"
+
+// Polls Metrics snapshots on a timer for the Dashboard's performance panel.
+// Rates and percentiles cover the last interval, so the view shows what
+// the engines are doing now. Nothing is signalled per event; while
+// inactive the monitor costs nothing.
+class PerformanceMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+    Q_PROPERTY(QVariantList counters READ counters NOTIFY updated)
+    Q_PROPERTY(QVariantList histograms READ histograms NOTIFY updated)
+
+public:
+    explicit PerformanceMonitor(QObject *parent = nullptr);
+
+    bool isActive() const { return m_timer->isActive(); }
+    void setActive(bool active);
+    int interval() const { return m_timer->interval(); }
+    void setInterval(int ms);
+
+    // name, total, perSecond
+    QVariantList counters() const { return m_counters; }
+    // name, unit, count, perSecond, p50, p90, p99, max, mean and totalMs for timings
+    QVariantList histograms() const { return m_histograms; }
+
+    // Totals since start, for the CLI and the benchmark
+    static QJsonObject toJson(const Metrics::Snapshot &snapshot);
+
+public slots:
+    void refresh();
+
+signals:
+    void activeChanged();
+    void intervalChanged();
+    void updated();
+
+private:
+    QTimer *m_timer;
+    Metrics::Snapshot m_previous;
+    qint64 m_previousMs;
+    QVariantList m_counters;
+    QVariantList m_histograms;
+};
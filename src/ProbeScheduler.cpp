@@ -0,0 +1,310 @@
+#include "ProbeScheduler.h"
+#include "IpAddress.h"
+#include "Metrics.h"
+#include <QHash>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <algorithm>
+#include <climits>
+
+namespace {
+const int kMaxParked = 256;     // lookahead past throttled probes
+const double kBurstSeconds = 0.25;
+
+quint64 mulMod(quint64 a, quint64 b, quint64 m)
+{
+    if (m <= 0xFFFFFFFFull)
+        return a * b % m;
+
+    // Shift-and-add keeps wide moduli from overflowing 64 bits
+    quint64 result = 0;
+    a %= m;
+    while (b) {
+        if (b & 1)
+            result = (result + a) % m;
+        a = (a << 1) % m;
+        b >>= 1;
+    }
+    return result;
+}
+
+quint64 powMod(quint64 base, quint64 exponent, quint64 m)
+{
+    quint64 result = 1 % m;
+    base %= m;
+    while (exponent) {
+        if (exponent & 1)
+            result = mulMod(result, base, m);
+        base = mulMod(base, base, m);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+bool isPrime(quint64 n)
+{
+    if (n < 2)
+        return false;
+    for (quint64 d = 2; d * d <= n; ++d) {
+        if (n % d == 0)
+            return false;
+    }
+    return true;
+}
+
+QList<quint64> primeFactors(quint64 n)
+{
+    QList<quint64> factors;
+    for (quint64 d = 2; d * d <= n; ++d) {
+        if (n % d == 0) {
+            factors << d;
+            while (n % d == 0)
+                n /= d;
+        }
+    }
+    if (n > 1)
+        factors << n;
+    return factors;
+}
+}
+
+CyclicPermutation::CyclicPermutation(quint64 size)
+    : m_size(size)
+    , m_prime(size + 1)
+    , m_generator(1)
+    , m_current(1)
+    , m_emitted(0)
+{
+    while (!isPrime(m_prime))
+        ++m_prime;
+    if (m_prime <= 3) {
+        m_generator = m_prime - 1;
+        return;
+    }
+
+    // g generates the group when g^((p-1)/q) != 1 for every prime q dividing p-1
+    QRandomGenerator *random = QRandomGenerator::global();
+    const QList<quint64> factors = primeFactors(m_prime - 1);
+    for (;;) {
+        const quint64 candidate = 2 + random->generate64() % (m_prime - 2);
+        const bool primitive = std::all_of(factors.cbegin(), factors.cend(), [&](quint64 q) {
+            return powMod(candidate, (m_prime - 1) / q, m_prime) != 1;
+        });
+        if (primitive) {
+            m_generator = candidate;
+            break;
+        }
+    }
+    m_current = 1 + random->generate64() % (m_prime - 1);
+}
+
+void CyclicPermutation::restore(quint64 prime, quint64 generator, quint64 current, quint64 emitted)
+{
+    m_prime = prime;
+    m_generator = generator;
+    m_current = current;
+    m_emitted = emitted;
+}
+
+bool CyclicPermutation::next(quint64 *index)
+{
+    if (m_emitted >= m_size)
+        return false;
+
+    do {
+        m_current = mulMod(m_current, m_generator, m_prime);
+    } while (m_current > m_size);
+
+    ++m_emitted;
+    *index = m_current - 1;
+    return true;
+}
+
+ProbeScheduler::ProbeScheduler(const QStringList &hosts, const QList<int> &ports, int hostRate, int subnetRate)
+    : m_hosts(hosts)
+    , m_ports(ports)
+    , m_hostRate(qMax(0, hostRate))
+    , m_subnetRate(qMax(0, subnetRate))
+    , m_order(quint64(hosts.size()) * quint64(qMax(1, ports.size())))
+    , m_hostBuckets(hosts.size())
+    , m_hostSubnet(hosts.size())
+    , m_remaining(hosts.size(), qMax(1, ports.size()))
+    , m_open(hosts.size())
+    , m_completed(0)
+{
+    // Hosts that are not literal addresses get a bucket of their own
+    QHash<QString, int> subnets;
+    for (int i = 0; i < m_hosts.size(); ++i) {
+        const IpAddress address = IpAddress::fromString(m_hosts[i]);
+        const QString key = address.isValid()
+            ? IpSubnet::of(address, address.isIPv4() ? 24 : 64).toString()
+            : m_hosts[i];
+        auto it = subnets.constFind(key);
+        if (it == subnets.constEnd())
+            it = subnets.insert(key, subnets.size());
+        m_hostSubnet[i] = it.value();
+    }
+    m_subnetBuckets.resize(subnets.size());
+
+    // Buckets start full so the first burst goes out at once
+    for (TokenBucket &bucket : m_hostBuckets)
+        bucket.tokens = qMax(1.0, m_hostRate * kBurstSeconds);
+    for (TokenBucket &bucket : m_subnetBuckets)
+        bucket.tokens = qMax(1.0, m_subnetRate * kBurstSeconds);
+    m_clock.start();
+
+    qDebug() << "Probe schedule:" << m_order.size() << "probes over" << m_hosts.size() << "hosts in"
+             << subnets.size() << "subnets, limits" << hostRate << "/s per host," << subnetRate << "/s per subnet";
+}
+
+quint64 ProbeScheduler::completed() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_completed;
+}
+
+bool ProbeScheduler::next(Probe *probe, int *waitMs)
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.nsecsElapsed();
+    int wait = INT_MAX;
+
+    // Parked probes first, oldest first, so nothing starves
+    for (int i = 0; i < m_parked.size(); ++i) {
+        const int needed = take(m_parked[i], now);
+        if (needed == 0) {
+            *probe = m_parked.takeAt(i);
+            m_inFlight.append(*probe);
+            Metrics::record(Metrics::SchedulerQueue, quint64(m_parked.size()));
+            return true;
+        }
+        wait = qMin(wait, needed);
+    }
+
+    quint64 index;
+    while (m_parked.size() < kMaxParked && m_order.next(&index)) {
+        Probe candidate;
+        candidate.host = int(index % quint64(m_hosts.size()));
+        const int portIndex = int(index / quint64(m_hosts.size()));
+        candidate.port = portIndex < m_ports.size() ? m_ports[portIndex] : 0;
+
+        const int needed = take(candidate, now);
+        if (needed == 0) {
+            *probe = candidate;
+            m_inFlight.append(candidate);
+            Metrics::record(Metrics::SchedulerQueue, quint64(m_parked.size()));
+            return true;
+        }
+        m_parked.append(candidate);
+        wait = qMin(wait, needed);
+    }
+
+    *waitMs = m_parked.isEmpty() ? -1 : qMax(1, wait);
+    if (*waitMs > 0)
+        Metrics::count(Metrics::ThrottleWaits);
+    return false;
+}
+
+bool ProbeScheduler::complete(const Probe &probe, bool open)
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_inFlight.size(); ++i) {
+        if (m_inFlight[i].host == probe.host && m_inFlight[i].port == probe.port) {
+            m_inFlight.remove(i);
+            break;
+        }
+    }
+    if (open)
+        m_open[probe.host] << probe.port;
+    ++m_completed;
+    return --m_remaining[probe.host] == 0;
+}
+
+QList<int> ProbeScheduler::openPorts(int host) const
+{
+    QMutexLocker locker(&m_mutex);
+    QList<int> ports = m_open.at(host);
+    std::sort(ports.begin(), ports.end());
+    return ports;
+}
+
+ProbeScheduler::State ProbeScheduler::state() const
+{
+    QMutexLocker locker(&m_mutex);
+    State state;
+    state.prime = m_order.prime();
+    state.generator = m_order.generator();
+    state.current = m_order.current();
+    state.emitted = m_order.emitted();
+    state.pending = m_inFlight + m_parked;
+    state.remaining = m_remaining;
+    state.open = m_open;
+    return state;
+}
+
+bool ProbeScheduler::restore(const State &state, const QBitArray &finished)
+{
+    const int hosts = m_hosts.size();
+    if (state.remaining.size() != hosts || state.open.size() != hosts || finished.size() != hosts
+        || state.emitted > m_order.size()) {
+        qWarning() << "Probe schedule does not match the target list, starting over";
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_order.restore(state.prime, state.generator, state.current, state.emitted);
+    m_remaining = state.remaining;
+    m_open = state.open;
+
+    m_parked.clear();
+    m_inFlight.clear();
+    for (const Probe &probe : state.pending) {
+        if (probe.host >= 0 && probe.host < hosts)
+            m_parked.append(probe);
+    }
+
+    const quint64 portCount = quint64(qMax(1, m_ports.size()));
+    m_completed = 0;
+    for (int host = 0; host < hosts; ++host) {
+        m_completed += portCount - quint64(m_remaining[host]);
+        if (m_remaining[host] == 0 && !finished.testBit(host)) {
+            // Probed before the interruption but never finished
+            m_remaining[host] = 1;
+            m_parked.append(Probe{host, 0});
+            --m_completed;
+        }
+    }
+    return true;
+}
+
+int ProbeScheduler::take(const Probe &probe, qint64 now)
+{
+    // Finishing a host without TCP ports sends nothing through the buckets
+    if (probe.port == 0)
+        return 0;
+
+    TokenBucket &host = m_hostBuckets[probe.host];
+    TokenBucket &subnet = m_subnetBuckets[m_hostSubnet[probe.host]];
+    const int needed = qMax(refill(host, m_hostRate, now), refill(subnet, m_subnetRate, now));
+    if (needed > 0)
+        return needed;
+
+    if (m_hostRate > 0)
+        host.tokens -= 1;
+    if (m_subnetRate > 0)
+        subnet.tokens -= 1;
+    return 0;
+}
+
+int ProbeScheduler::refill(TokenBucket &bucket, double rate, qint64 now) const
+{
+    if (rate <= 0)
+        return 0;
+
+    const double burst = qMax(1.0, rate * kBurstSeconds);
+    bucket.tokens = qMin(burst, bucket.tokens + double(now - bucket.stamp) * rate / 1e9);
+    bucket.stamp = now;
+    if (bucket.tokens >= 1)
+        return 0;
+    return qMax(1, int((1 - bucket.tokens) * 1000 / rate + 0.5));
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QAtomicInt>
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+
+// Walks 0..size-1 in a pseudo-random order by stepping through the
+// multiplicative group of the smallest prime above size from a random
+// start, skipping values past the end. Only the prime, the generator and
+// the current element are stored, whatever the size.
+class CyclicPermutation
+{
+public:
+    explicit CyclicPermutation(quint64 size);
+
+    quint64 size() const { return m_size; }
+    bool next(quint64 *index);
+
+    // The walk is fully described by these four values, so it can be saved
+    // and picked up again exactly where it stopped
+    quint64 prime() const { return m_prime; }
+    quint64 generator() const { return m_generator; }
+    quint64 current() const { return m_current; }
+    quint64 emitted() const { return m_emitted; }
+    void restore(quint64 prime, quint64 generator, quint64 current, quint64 emitted);
+
+private:
+    quint64 m_size;
+    quint64 m_prime;
+    quint64 m_generator;
+    quint64 m_current;
+    quint64 m_emitted;
+};
+
+// Hands out every (host, port) probe of a scan in cyclic-permutation order,
+// so consecutive probes land on different hosts and subnets instead of
+// walking one firewall port by port. Token buckets per host and per subnet
+// (/24 for IPv4, /64 for IPv6) cap the probe rate; a probe whose bucket is
+// empty is parked and later ones are tried, so one slow target never stalls
+// the workers. Thread-safe; shared by all workers of a scan.
+class ProbeScheduler
+{
+public:
+    struct Probe {
+        int host = -1;
+        int port = 0; // 0 when the scan has no TCP ports: the host only needs finishing
+    };
+
+    // Everything needed to continue the schedule after a restart
+    struct State {
+        quint64 prime = 0;
+        quint64 generator = 0;
+        quint64 current = 0;
+        quint64 emitted = 0;
+        QVector<Probe> pending;       // parked or in flight: handed out again on resume
+        QVector<int> remaining;       // probes left per host
+        QVector<QList<int>> open;     // open ports found so far per host
+    };
+
+    // Rates are probes per second, 0 for no limit
+    ProbeScheduler(const QStringList &hosts, const QList<int> &ports, int hostRate, int subnetRate);
+
+    int hostCount() const { return m_hosts.size(); }
+    QString host(int index) const { return m_hosts.at(index); }
+    quint64 total() const { return m_order.size(); }
+    quint64 completed() const;
+
+    // False with *waitMs > 0 while everything left is throttled, and with
+    // *waitMs = -1 once every probe has been handed out
+    bool next(Probe *probe, int *waitMs);
+
+    // Records a finished probe; true when it was the host's last one
+    bool complete(const Probe &probe, bool open);
+    QList<int> openPorts(int host) const;
+
+    State state() const;
+    // Call before handing out probes; hosts whose probes are all done but
+    // which are not in finished get a finishing probe again
+    bool restore(const State &state, const QBitArray &finished);
+
+    void cancel() { m_cancelled.storeRelaxed(1); }
+    bool isCancelled() const { return m_cancelled.loadRelaxed() != 0; }
+
+private:
+    struct TokenBucket {
+        double tokens = 0;
+        qint64 stamp = 0;
+    };
+
+    int take(const Probe &probe, qint64 now); // 0 when taken, else ms until it could be
+    int refill(TokenBucket &bucket, double rate, qint64 now) const;
+
+    QStringList m_hosts;
+    QList<int> m_ports;
+    double m_hostRate;
+    double m_subnetRate;
+
+    mutable QMutex m_mutex;
+    CyclicPermutation m_order;
+    QVector<Probe> m_parked;
+    QVector<Probe> m_inFlight;
+    QVector<TokenBucket> m_hostBuckets;
+    QVector<TokenBucket> m_subnetBuckets;
+    QVector<int> m_hostSubnet;
+    QVector<int> m_remaining;
+    QVector<QList<int>> m_open;
+    quint64 m_completed;
+    QElapsedTimer m_clock;
+    QAtomicInt m_cancelled;
+};
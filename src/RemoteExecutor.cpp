@@ -1,17 +1,165 @@
 #include "RemoteExecutor.h"
+#include "IpAddress.h"
 #include "CredentialManager.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include <QDebug>
 #include <QRegularExpression>
 #include <QHostAddress>
 #include <QJsonObject>
 #include <QFileInfo>
+#include <QCryptographicHash>
+#include <QProcessEnvironment>
+#include <algorithm>
+
+namespace {
+// Direct pushes allowed in parallel when relaying; relays take over the rest
+const int kFanOutDirectSlots = 4;
+// Branching factor of the relay tree
+const int kFanOutRelayWidth = 4;
+const qint64 kFanOutChunkSize = 256 * 1024;
+
+Metrics::Histogram jobHistogram(const QString &protocol)
+{
+    if (protocol == "SSH") return Metrics::JobSsh;
+    if (protocol == "WinRM") return Metrics::JobWinRm;
+    if (protocol == "PowerShell") return Metrics::JobPowerShell;
+    if (protocol == "WMI") return Metrics::JobWmi;
+    if (protocol == "SCHTASKS") return Metrics::JobSchtasks;
+    if (protocol == "Custom") return Metrics::JobCustom;
+    if (protocol == "SCP/SFTP Delta") return Metrics::JobDelta;
+    if (protocol.startsWith("SCP/SFTP")) return Metrics::JobScp;
+    if (protocol == "SMB") return Metrics::JobSmb;
+    return Metrics::JobOther;
+}
+
+QString shellQuote(const QString &value)
+{
+    QString quoted = value;
+    quoted.replace("'", "'\\''");
+    return "'" + quoted + "'";
+}
+
+// Variable the PowerShell launchers read the password from
+const char kPasswordVariable[] = "NETSECOPS_PASSWORD";
+
+QString psQuote(const QString &value)
+{
+    QString quoted = value;
+    quoted.replace("'", "''");
+    return "'" + quoted + "'";
+}
+
+// Script prefix that builds $c from the password in the environment and
+// drops the variable before any remote call is made
+QString psCredential(const QString &username)
+{
+    return QString("$p = ConvertTo-SecureString $env:%1 -AsPlainText -Force; Remove-Item Env:%1; "
+                   "$c = New-Object PSCredential(%2, $p); ")
+        .arg(kPasswordVariable, psQuote(username));
+}
+
+QString powerShellProgram()
+{
+#ifdef Q_OS_WIN
+    return "powershell";
+#else
+    return "pwsh";
+#endif
+}
+
+// Passwords go to the child through its environment, which only the owner
+// can read, never through a command line any local user can see in ps. The
+// UTF-16 copy only lives until start() has forked and is wiped afterwards.
+void startWithPassword(QProcess *process, const QString &program, const QStringList &args,
+                       const char *variable, QByteArrayView password)
+{
+    if (password.isEmpty()) {
+        process->start(program, args);
+        return;
+    }
+    
+    QString value = QString::fromUtf8(password);
+    {
+        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+        env.insert(variable, value);
+        process->setProcessEnvironment(env);
+    }
+    process->start(program, args);
+    process->setProcessEnvironment(QProcessEnvironment());
+    SecureBuffer::wipe(value.data(), value.size() * qsizetype(sizeof(QChar)));
+}
+
+// Wraps program in sshpass when the credential is a password; sshpass -e
+// takes it from SSHPASS, which startSshTool fills in
+QString withSshpass(const QString &program, QStringList &args, const CredentialHandle &credential)
+{
+    if (credential.password().isEmpty() || !credential.privateKey().isEmpty()) {
+        return program;
+    }
+    args = QStringList() << "-e" << program << args;
+    return "sshpass";
+}
+
+void startSshTool(QProcess *process, const QString &program, const QStringList &args,
+                  const CredentialHandle &credential)
+{
+    startWithPassword(process, program, args, "SSHPASS",
+                      program == "sshpass" ? credential.password() : QByteArrayView());
+}
+}
 
 RemoteExecutor::RemoteExecutor(QObject *parent)
     : QObject(parent)
     , m_isExecuting(false)
     , m_nextJobId(1)
+    , m_nextDeploymentId(1)
     , m_credentialManager(nullptr)
 {
+    // Every job path already reports through these, including start failures
+    connect(this, &RemoteExecutor::jobStarted, this, &RemoteExecutor::startJobMetrics);
+    connect(this, &RemoteExecutor::jobCompleted, this, [this](int jobId) { finishJobMetrics(jobId, true); });
+    connect(this, &RemoteExecutor::jobFailed, this, [this](int jobId) { finishJobMetrics(jobId, false); });
+}
+
+RemoteExecutor::~RemoteExecutor()
+{
+    // Hashes read deployment buffers that are only valid while we live
+    m_hashPool.waitForDone();
+}
+
+void RemoteExecutor::startJobMetrics(int jobId)
+{
+    const ExecutionJob job = m_activeJobs.value(jobId);
+    JobMetrics &metrics = m_jobMetrics[jobId];
+    metrics.clock.start();
+    metrics.traceStart = Trace::now();
+    metrics.target = job.target;
+    metrics.histogram = jobHistogram(job.protocol);
+    if (job.type == "File Deploy") {
+        metrics.bytes = job.deploymentId ? m_deployments.value(job.deploymentId).buffer.size()
+                                         : QFileInfo(job.sourcePath).size();
+    } else if (job.type == "File Retrieve") {
+        metrics.retrievedPath = job.destPath;
+    }
+}
+
+void RemoteExecutor::finishJobMetrics(int jobId, bool ok)
+{
+    auto it = m_jobMetrics.find(jobId);
+    if (it == m_jobMetrics.end())
+        return;
+    Metrics::record(it->histogram, quint64(it->clock.nsecsElapsed() / 1000));
+    // Jobs overlap on the event loop thread, so each gets its own track
+    Trace::complete("exec", Metrics::name(it->histogram), it->traceStart, it->target, quint64(jobId));
+    Metrics::count(ok ? Metrics::JobsCompleted : Metrics::JobsFailed);
+    if (ok) {
+        const QFileInfo retrieved(it->retrievedPath);
+        const qint64 bytes = retrieved.isFile() ? retrieved.size() : it->bytes;
+        if (bytes > 0)
+            Metrics::count(Metrics::TransferBytes, quint64(bytes));
+    }
+    m_jobMetrics.erase(it);
 }
 
 void RemoteExecutor::setCredentialManager(CredentialManager *credManager)
@@ -45,8 +193,14 @@ void RemoteExecutor::executeCommand(const QString &targets, const QString &comma
         qDebug() << "Activity: Command execution started -" << protocol << "on" << target;
         
         // Get credential for target
-        QJsonObject credential = getOrPromptCredential(target, protocol);
-        if (credential.isEmpty()) {
+        QString credentialError;
+        CredentialHandle credential = getOrPromptCredential(target, protocol, &credentialError);
+        if (!credential.isValid() && !credentialError.isEmpty()) {
+            emit jobFailed(jobId, credentialError);
+            m_activeJobs.remove(jobId);
+            continue;
+        }
+        if (!credential.isValid()) {
             emit credentialRequired(target, protocol, jobId);
             continue; // Don't remove job, wait for credential
         }
@@ -80,6 +234,14 @@ void RemoteExecutor::executeQuickCommand(const QString &targets, const QString &
 
 void RemoteExecutor::stopExecution(int jobId)
 {
+    // Stopped jobs are neither finished nor failed for the metrics
+    m_jobMetrics.remove(jobId);
+    
+    if (m_activeJobs.contains(jobId) && m_activeJobs[jobId].deploymentId) {
+        stopFanOutJob(jobId);
+        return;
+    }
+    
     if (m_activeJobs.contains(jobId)) {
         ExecutionJob &job = m_activeJobs[jobId];
         if (job.process) {
@@ -106,6 +268,11 @@ void RemoteExecutor::deployFile(const QString &sourcePath, const QString &destPa
     qDebug() << "Targets:" << targets;
     qDebug() << "Protocol:" << protocol;
     
+    if (protocol.startsWith("SCP/SFTP Fan-out")) {
+        deployFileFanOut(sourcePath, destPath, targets, protocol.endsWith("Relay"));
+        return;
+    }
+    
     QStringList targetList = parseTargets(targets);
     qDebug() << "Parsed Targets:" << targetList;
     
@@ -121,19 +288,25 @@ void RemoteExecutor::deployFile(const QString &sourcePath, const QString &destPa
         job.status = "running";
         job.progress = 0;
         job.process = nullptr;
+        job.sourcePath = sourcePath;
+        job.destPath = destPath;
         
         m_activeJobs[jobId] = job;
         
         emit jobStarted(jobId, job.type, target);
         
-        QJsonObject credential = getOrPromptCredential(target, protocol);
-        if (credential.isEmpty()) {
-            emit jobFailed(jobId, "No credential available for " + target);
+        QString credentialError;
+        CredentialHandle credential = getOrPromptCredential(target, protocol, &credentialError);
+        if (!credential.isValid()) {
+            emit jobFailed(jobId, credentialError.isEmpty() ? "No credential available for " + target
+                                                            : credentialError);
             m_activeJobs.remove(jobId);
             continue;
         }
         
-        if (protocol == "SCP/SFTP") {
+        if (protocol == "SCP/SFTP Delta") {
+            transferDelta(sourcePath, destPath, target, true, jobId, credential);
+        } else if (protocol.startsWith("SCP/SFTP")) {
             transferSCP(sourcePath, destPath, target, true, jobId, credential);
         } else if (protocol == "SMB") {
             transferSMB(sourcePath, destPath, target, true, jobId, credential);
@@ -168,19 +341,25 @@ void RemoteExecutor::retrieveFile(const QString &sourcePath, const QString &dest
         job.status = "running";
         job.progress = 0;
         job.process = nullptr;
+        job.sourcePath = sourcePath;
+        job.destPath = destPath;
         
         m_activeJobs[jobId] = job;
         
         emit jobStarted(jobId, job.type, target);
         
-        QJsonObject credential = getOrPromptCredential(target, protocol);
-        if (credential.isEmpty()) {
-            emit jobFailed(jobId, "No credential available for " + target);
+        QString credentialError;
+        CredentialHandle credential = getOrPromptCredential(target, protocol, &credentialError);
+        if (!credential.isValid()) {
+            emit jobFailed(jobId, credentialError.isEmpty() ? "No credential available for " + target
+                                                            : credentialError);
             m_activeJobs.remove(jobId);
             continue;
         }
         
-        if (protocol == "SCP/SFTP") {
+        if (protocol == "SCP/SFTP Delta") {
+            transferDelta(sourcePath, destPath, target, false, jobId, credential);
+        } else if (protocol.startsWith("SCP/SFTP")) {
             transferSCP(sourcePath, destPath, target, false, jobId, credential);
         } else if (protocol == "SMB") {
             transferSMB(sourcePath, destPath, target, false, jobId, credential);
@@ -192,9 +371,22 @@ void RemoteExecutor::retrieveFile(const QString &sourcePath, const QString &dest
     emit activeJobsChanged();
 }
 
-void RemoteExecutor::executeSSH(const QString &target, const QString &command, int jobId, const QJsonObject &credential)
+void RemoteExecutor::executeSSH(const QString &target, const QString &command, int jobId, const CredentialHandle &credential)
 {
+    // The key file belongs to the job and goes with it on every path
+    QSharedPointer<QTemporaryFile> keyFile;
+    if (!credential.privateKey().isEmpty()) {
+        keyFile = writeKeyFile(credential.privateKey());
+        if (!keyFile) {
+            emit jobFailed(jobId, "Cannot write private key for " + target);
+            m_activeJobs.remove(jobId);
+            return;
+        }
+        m_activeJobs[jobId].keyFiles << keyFile;
+    }
+    
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
@@ -207,20 +399,11 @@ void RemoteExecutor::executeSSH(const QString &target, const QString &command, i
     args << "-o" << "StrictHostKeyChecking=no"
          << "-o" << "ConnectTimeout=10";
     
-    QString username = credential["username"].toString();
-    QString password = credential["password"].toString();
-    QString privateKey = credential["privateKey"].toString();
+    QString username = credential.username();
     
-    if (!privateKey.isEmpty()) {
+    if (keyFile) {
         // Use SSH key authentication
-        QString keyFile = "/tmp/ssh_key_" + QString::number(jobId);
-        QFile file(keyFile);
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write(privateKey.toUtf8());
-            file.close();
-            file.setPermissions(QFile::ReadOwner);
-        }
-        args << "-i" << keyFile;
+        args << "-i" << keyFile->fileName();
     }
     
     if (!username.isEmpty()) {
@@ -234,16 +417,10 @@ void RemoteExecutor::executeSSH(const QString &target, const QString &command, i
     sanitizedCommand.replace(QRegularExpression("[;&|`$(){}\[\]<>\"'\\\\]"), "");
     args << sanitizedCommand;
     
-    if (!password.isEmpty() && privateKey.isEmpty()) {
-        // Use sshpass for password authentication
-        QStringList sshpassArgs;
-        sshpassArgs << "-p" << password << "ssh" << args;
-        qDebug() << "SSH Command:" << "sshpass" << sshpassArgs.join(" ");
-        process->start("sshpass", sshpassArgs);
-    } else {
-        qDebug() << "SSH Command:" << "ssh" << args.join(" ");
-        process->start("ssh", args);
-    }
+    // sshpass for password authentication
+    QString program = withSshpass("ssh", args, credential);
+    qDebug() << "SSH Command:" << program << args.join(" ");
+    startSshTool(process, program, args, credential);
     
     if (!process->waitForStarted(5000)) {
         emit jobFailed(jobId, "Failed to start SSH process");
@@ -255,12 +432,14 @@ void RemoteExecutor::executeSSH(const QString &target, const QString &command, i
 void RemoteExecutor::executeWinRM(const QString &target, const QString &command, int jobId)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
 #ifdef Q_OS_WIN
     // Use winrs for WinRM
@@ -288,12 +467,14 @@ void RemoteExecutor::executeWinRM(const QString &target, const QString &command,
 void RemoteExecutor::executePowerShell(const QString &target, const QString &command, int jobId)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
     // PowerShell remoting
     QStringList args;
@@ -322,12 +503,14 @@ void RemoteExecutor::executePowerShell(const QString &target, const QString &com
 void RemoteExecutor::transferSCP(const QString &source, const QString &dest, const QString &target, bool upload, int jobId)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
     QStringList args;
     args << "-o" << "StrictHostKeyChecking=no";
@@ -353,12 +536,14 @@ void RemoteExecutor::transferSCP(const QString &source, const QString &dest, con
 void RemoteExecutor::transferSMB(const QString &source, const QString &dest, const QString &target, bool upload, int jobId)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
 #ifdef Q_OS_WIN
     // Use robocopy for Windows SMB transfers
@@ -398,9 +583,18 @@ void RemoteExecutor::onProcessFinished(int exitCode, QProcess::ExitStatus exitSt
     QProcess *process = qobject_cast<QProcess*>(sender());
     if (!process || !m_processJobs.contains(process)) return;
     
+    // Whatever is still buffered belongs to the job before it is judged
+    readProcessOutput(process);
     int jobId = m_processJobs[process];
     m_processJobs.remove(process);
     
+    if (m_activeJobs.contains(jobId) && m_activeJobs[jobId].deploymentId) {
+        finishFanOutStage(jobId, exitCode == 0 && exitStatus == QProcess::NormalExit,
+                          m_activeJobs[jobId].errorOutput);
+        process->deleteLater();
+        return;
+    }
+    
     if (m_activeJobs.contains(jobId)) {
         ExecutionJob &job = m_activeJobs[jobId];
         job.progress = 100;
@@ -409,8 +603,22 @@ void RemoteExecutor::onProcessFinished(int exitCode, QProcess::ExitStatus exitSt
             job.status = "completed";
             emit jobCompleted(jobId, job.output);
         } else {
+            QString error = job.errorOutput;
+            
+            // Remote host has no rsync: redo the transfer as a plain copy
+            if (job.protocol == "SCP/SFTP Delta" && exitStatus == QProcess::NormalExit
+                && (exitCode == 127 || error.contains("command not found"))) {
+                qDebug() << "rsync unavailable on" << job.target << "- falling back to SCP";
+                job.protocol = "SCP/SFTP";
+                job.progress = 0;
+                job.errorOutput.clear();
+                process->deleteLater();
+                transferSCP(job.sourcePath, job.destPath, job.target, job.type == "File Deploy", jobId,
+                            getOrPromptCredential(job.target, job.protocol));
+                return;
+            }
+            
             job.status = "failed";
-            QString error = process->readAllStandardError();
             emit jobFailed(jobId, error.isEmpty() ? "Process failed" : error);
         }
         
@@ -429,59 +637,86 @@ void RemoteExecutor::onProcessOutput()
     QProcess *process = qobject_cast<QProcess*>(sender());
     if (!process || !m_processJobs.contains(process)) return;
     
-    int jobId = m_processJobs[process];
+    readProcessOutput(process);
+}
+
+void RemoteExecutor::readProcessOutput(QProcess *process)
+{
+    int jobId = m_processJobs.value(process);
     QString output = process->readAllStandardOutput();
+    // stderr streams to listeners as well; "permission denied" is output too
+    QString errorOutput = process->readAllStandardError();
+    if (!m_activeJobs.contains(jobId) || (output.isEmpty() && errorOutput.isEmpty())) return;
     
-    if (m_activeJobs.contains(jobId)) {
-        m_activeJobs[jobId].output += output;
-        m_activeJobs[jobId].progress = qMin(90, m_activeJobs[jobId].progress + 10);
-        
+    ExecutionJob &job = m_activeJobs[jobId];
+    job.output += output;
+    job.errorOutput += errorOutput;
+    job.progress = qMin(90, job.progress + 10);
+    
+    if (!output.isEmpty()) {
         emit outputReceived(jobId, output);
-        emit jobProgress(jobId, m_activeJobs[jobId].progress);
     }
+    if (!errorOutput.isEmpty()) {
+        emit outputReceived(jobId, errorOutput);
+    }
+    emit jobProgress(jobId, job.progress);
 }
 
 QStringList RemoteExecutor::parseTargets(const QString &targets)
 {
     QStringList result;
     
-    // Handle range format: 192.168.1.100-110
-    QRegularExpression rangeRegex(R"((\d+\.\d+\.\d+\.)(\d+)-(\d+))");
-    QRegularExpressionMatch rangeMatch = rangeRegex.match(targets);
-    
-    if (rangeMatch.hasMatch()) {
-        QString baseIP = rangeMatch.captured(1);
-        int startHost = rangeMatch.captured(2).toInt();
-        int endHost = rangeMatch.captured(3).toInt();
-        
-        for (int i = startHost; i <= endHost; ++i) {
-            result << baseIP + QString::number(i);
-        }
-    } else {
-        // Handle comma-separated list
-        QStringList parts = targets.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
-        for (const QString &part : parts) {
-            QString trimmed = part.trimmed();
-            if (!trimmed.isEmpty()) {
-                result << trimmed;
+    // Comma-separated list; each entry is a host, an address of either family,
+    // or a range: 192.168.1.100-110, 2001:db8::10-2001:db8::20, 2001:db8::10-20
+    QStringList parts = targets.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        QString trimmed = part.trimmed();
+        const int dash = trimmed.indexOf('-');
+        const IpAddress first = dash > 0 ? IpAddress::fromString(trimmed.left(dash)) : IpAddress();
+
+        if (first.isValid()) {
+            const QString tail = trimmed.mid(dash + 1);
+            IpAddress last = IpAddress::fromString(tail);
+            if (!last.isValid() && first.isIPv4()) {
+                last = IpAddress::fromString(trimmed.left(dash).section('.', 0, 2) + '.' + tail);
+            } else if (!last.isValid()) {
+                // Last group only, in hex like the address itself
+                last = IpAddress::fromString(trimmed.left(dash).section(':', 0, -2) + ':' + tail);
+            }
+
+            if (last.family() == first.family() && last >= first) {
+                const quint64 span = first.distanceTo(last);
+                for (quint64 i = 0; i <= qMin<quint64>(span, 65535); ++i) {
+                    result << first.offset(i).toString();
+                }
+                continue;
             }
         }
+
+        if (!trimmed.isEmpty()) {
+            result << trimmed;
+        }
     }
     
     return result;
 }
 
-QJsonObject RemoteExecutor::getOrPromptCredential(const QString &host, const QString &protocol)
+CredentialHandle RemoteExecutor::getOrPromptCredential(const QString &host, const QString &protocol, QString *error)
 {
     if (!m_credentialManager) {
         qWarning() << "No credential manager available";
-        return QJsonObject();
+        return CredentialHandle();
     }
     
     // Try to get existing credential for host
-    QJsonObject credential = m_credentialManager->getCredentialForHost(host);
-    
-    if (credential.isEmpty()) {
+    QString lookupError;
+    CredentialHandle credential = m_credentialManager->credentialForHost(host, &lookupError);
+    
+    if (!lookupError.isEmpty()) {
+        // A stored credential that can't be opened must not turn into a passwordless login
+        qWarning() << lookupError;
+        if (error) *error = lookupError;
+    } else if (!credential.isValid()) {
         qDebug() << "No credential found for host:" << host << "protocol:" << protocol;
         // In a real implementation, this would trigger a credential prompt dialog
         // For now, emit signal to request credential input
@@ -491,29 +726,25 @@ QJsonObject RemoteExecutor::getOrPromptCredential(const QString &host, const QSt
     return credential;
 }
 
-void RemoteExecutor::executeWinRM(const QString &target, const QString &command, int jobId, const QJsonObject &credential)
+void RemoteExecutor::executeWinRM(const QString &target, const QString &command, int jobId, const CredentialHandle &credential)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
-    QString username = credential["username"].toString();
-    QString password = credential["password"].toString();
+    QString username = credential.username();
     
-#ifdef Q_OS_WIN
     QStringList args;
-    args << "-r:" + target << "-u:" + username << "-p:" + password << command;
-    process->start("winrs", args);
-#else
-    QStringList args;
-    args << "-Command" << QString("Invoke-Command -ComputerName %1 -Credential (New-Object PSCredential('%2', (ConvertTo-SecureString '%3' -AsPlainText -Force))) -ScriptBlock {%4}")
-                           .arg(target, username, password, command);
-    process->start("pwsh", args);
-#endif
+    args << "-Command" << psCredential(username)
+                          + QString("Invoke-Command -ComputerName %1 -Credential $c -ScriptBlock {%2}")
+                                .arg(psQuote(target), command);
+    startWithPassword(process, powerShellProgram(), args, kPasswordVariable, credential.password());
     
     if (!process->waitForStarted(5000)) {
         emit jobFailed(jobId, "Failed to start WinRM process");
@@ -522,32 +753,29 @@ void RemoteExecutor::executeWinRM(const QString &target, const QString &command,
     }
 }
 
-void RemoteExecutor::executePowerShell(const QString &target, const QString &command, int jobId, const QJsonObject &credential)
+void RemoteExecutor::executePowerShell(const QString &target, const QString &command, int jobId, const CredentialHandle &credential)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
-    QString username = credential["username"].toString();
-    QString password = credential["password"].toString();
+    QString username = credential.username();
     
     QStringList args;
     // Sanitize command to prevent injection
     QString sanitizedCommand = command;
     sanitizedCommand.replace(QRegularExpression("[;&|`$(){}\[\]<>\"'\\\\]"), "");
     
-    args << "-Command" << QString("Invoke-Command -ComputerName %1 -Credential (New-Object PSCredential('%2', (ConvertTo-SecureString '%3' -AsPlainText -Force))) -ScriptBlock {%4}")
-                         .arg(target, username, password, sanitizedCommand);
-    
-#ifdef Q_OS_WIN
-    process->start("powershell", args);
-#else
-    process->start("pwsh", args);
-#endif
+    args << "-Command" << psCredential(username)
+                          + QString("Invoke-Command -ComputerName %1 -Credential $c -ScriptBlock {%2}")
+                                .arg(psQuote(target), sanitizedCommand);
+    startWithPassword(process, powerShellProgram(), args, kPasswordVariable, credential.password());
     
     if (!process->waitForStarted(5000)) {
         emit jobFailed(jobId, "Failed to start PowerShell process");
@@ -556,18 +784,19 @@ void RemoteExecutor::executePowerShell(const QString &target, const QString &com
     }
 }
 
-void RemoteExecutor::transferSCP(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const QJsonObject &credential)
+void RemoteExecutor::transferSCP(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const CredentialHandle &credential)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
-    QString username = credential["username"].toString();
-    QString password = credential["password"].toString();
+    QString username = credential.username();
     
     QStringList args;
     args << "-o" << "StrictHostKeyChecking=no";
@@ -578,15 +807,9 @@ void RemoteExecutor::transferSCP(const QString &source, const QString &dest, con
         args << username + "@" + target +":" + source << dest;
     }
     
-    if (!password.isEmpty()) {
-        QStringList sshpassArgs;
-        sshpassArgs << "-p" << password << "scp" << args;
-        qDebug() << "SCP Command:" << "sshpass" << sshpassArgs.join(" ");
-        process->start("sshpass", sshpassArgs);
-    } else {
-        qDebug() << "SCP Command:" << "scp" << args.join(" ");
-        process->start("scp", args);
-    }
+    QString program = withSshpass("scp", args, credential);
+    qDebug() << "SCP Command:" << program << args.join(" ");
+    startSshTool(process, program, args, credential);
     
     if (!process->waitForStarted(5000)) {
         emit jobFailed(jobId, "Failed to start SCP process");
@@ -595,45 +818,47 @@ void RemoteExecutor::transferSCP(const QString &source, const QString &dest, con
     }
 }
 
-void RemoteExecutor::transferSMB(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const QJsonObject &credential)
+void RemoteExecutor::transferSMB(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const CredentialHandle &credential)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
-    QString username = credential["username"].toString();
-    QString password = credential["password"].toString();
+    QString username = credential.username();
     
 #ifdef Q_OS_WIN
-    QString netCommand;
-    if (upload) {
-        // Upload: local -> remote
-        netCommand = QString("net use \\\\%1\\C$ /user:%2 %3 && copy %4 \\\\%1\\C$\\%5 && net use \\\\%1\\C$ /delete")
-                    .arg(target, username, password, source, dest);
-    } else {
-        // Download: remote -> local  
-        netCommand = QString("net use \\\\%1\\C$ /user:%2 %3 && copy \\\\%1\\C$\\%4 %5 && net use \\\\%1\\C$ /delete")
-                    .arg(target, username, password, source, dest);
-    }
-    
-    qDebug() << "SMB Command:" << "cmd /c" << netCommand;
+    // net use only takes the password on its command line, a PSDrive can
+    // take it from the environment
+    QString share = QString("\\\\%1\\C$").arg(target);
+    QString remote = share + "\\" + (upload ? dest : source);
+    QString copy = upload ? QString("Copy-Item %1 %2").arg(psQuote(source), psQuote(remote))
+                          : QString("Copy-Item %1 %2").arg(psQuote(remote), psQuote(dest));
+    QString script = psCredential(username)
+                     + QString("New-PSDrive -Name NetSecOps -PSProvider FileSystem -Root %1 -Credential $c | Out-Null; "
+                               "try { %2 } finally { Remove-PSDrive NetSecOps }")
+                           .arg(psQuote(share), copy);
+    
+    qDebug() << "SMB Command: New-PSDrive" << share << "as" << username << (upload ? "put" : "get") << source << dest;
     
     QStringList args;
-    args << "/c" << netCommand;
-    process->start("cmd", args);
+    args << "-Command" << script;
+    startWithPassword(process, powerShellProgram(), args, kPasswordVariable, credential.password());
 #else
+    // smbclient takes the password from PASSWD instead of the command line
     QStringList args;
-    args << "//" + target + "/C$" << "-U" << username + "%" + password;
+    args << "//" + target + "/C$" << "-U" << username;
     if (upload) {
         args << "-c" << "put " + source + " " + dest;
     } else {
         args << "-c" << "get " + source + " " + dest;
     }
-    process->start("smbclient", args);
+    startWithPassword(process, "smbclient", args, "PASSWD", credential.password());
 #endif
     
     if (!process->waitForStarted(5000)) {
@@ -643,16 +868,72 @@ void RemoteExecutor::transferSMB(const QString &source, const QString &dest, con
     }
 }
 
+void RemoteExecutor::transferDelta(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const CredentialHandle &credential)
+{
+    // The key file belongs to the job and goes with it on every path
+    QSharedPointer<QTemporaryFile> keyFile;
+    if (!credential.privateKey().isEmpty()) {
+        keyFile = writeKeyFile(credential.privateKey());
+        if (!keyFile) {
+            emit jobFailed(jobId, "Cannot write private key for " + target);
+            m_activeJobs.remove(jobId);
+            return;
+        }
+        m_activeJobs[jobId].keyFiles << keyFile;
+    }
+    
+    QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
+    m_processJobs[process] = jobId;
+    m_activeJobs[jobId].process = process;
+    
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &RemoteExecutor::onProcessFinished);
+    connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
+    
+    QString username = credential.username();
+    
+    QString sshCommand = "ssh -o StrictHostKeyChecking=no -o ConnectTimeout=10";
+    if (keyFile) {
+        sshCommand += " -i " + shellQuote(keyFile->fileName());
+    }
+    
+    QString remote = (username.isEmpty() ? QString() : username + "@") + target + ":";
+    
+    // rsync checksums the existing copy in blocks (rolling weak + strong sum)
+    // and only ships literal data for blocks that changed
+    QStringList args;
+    args << "--no-whole-file" << "--inplace" << "--partial" << "--times" << "--stats"
+         << "-e" << sshCommand;
+    
+    if (upload) {
+        args << source << remote + dest;
+    } else {
+        args << remote + source << dest;
+    }
+    
+    QString program = withSshpass("rsync", args, credential);
+    qDebug() << "Delta Command:" << program << args.join(" ");
+    startSshTool(process, program, args, credential);
+    
+    if (!process->waitForStarted(5000)) {
+        // No local rsync, a full copy still gets the file there
+        qDebug() << "rsync not available locally - falling back to SCP";
+        m_processJobs.remove(process);
+        process->deleteLater();
+        m_activeJobs[jobId].protocol = "SCP/SFTP";
+        transferSCP(source, dest, target, upload, jobId, credential);
+    }
+}
+
 void RemoteExecutor::executeWithCredential(int jobId, const QString &username, const QString &password)
 {
     if (!m_activeJobs.contains(jobId)) return;
     
     ExecutionJob &job = m_activeJobs[jobId];
     
-    QJsonObject credential;
-    credential["username"] = username;
-    credential["password"] = password;
-    credential["type"] = "Password";
+    CredentialHandle credential = CredentialHandle::fromPassword(username, password);
     
     if (job.protocol == "SSH") {
         executeSSH(job.target, job.command, jobId, credential);
@@ -671,28 +952,30 @@ void RemoteExecutor::executeWithCredential(int jobId, const QString &username, c
     }
 }
 
-void RemoteExecutor::executeWMI(const QString &target, const QString &command, int jobId, const QJsonObject &credential)
+void RemoteExecutor::executeWMI(const QString &target, const QString &command, int jobId, const CredentialHandle &credential)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
-    QString username = credential["username"].toString();
-    QString password = credential["password"].toString();
+    QString username = credential.username();
     
+    // wmic wants /password: on its command line, Invoke-WmiMethod makes the
+    // same Win32_Process.Create call with a credential object
     QStringList args;
-    args << "/node:" + target
-         << "/user:" + username
-         << "/password:" + password
-         << "process" << "call" << "create"
-         << "\"cmd.exe /c " + command + "\"";
+    args << "-Command" << psCredential(username)
+                          + QString("Invoke-WmiMethod -Class Win32_Process -Name Create -ArgumentList %1 "
+                                    "-ComputerName %2 -Credential $c")
+                                .arg(psQuote("cmd.exe /c " + command), psQuote(target));
     
-    qDebug() << "Executing WMI:" << "wmic" << args.join(" ");
-    process->start("wmic", args);
+    qDebug() << "Executing WMI: Win32_Process.Create on" << target << "as" << username << command;
+    startWithPassword(process, powerShellProgram(), args, kPasswordVariable, credential.password());
     
     if (!process->waitForStarted(5000)) {
         emit jobFailed(jobId, "Failed to start WMI process");
@@ -701,28 +984,34 @@ void RemoteExecutor::executeWMI(const QString &target, const QString &command, i
     }
 }
 
-void RemoteExecutor::executeSCHTASKS(const QString &target, const QString &command, int jobId, const QJsonObject &credential)
+void RemoteExecutor::executeSCHTASKS(const QString &target, const QString &command, int jobId, const CredentialHandle &credential)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
-    QString username = credential["username"].toString();
-    QString password = credential["password"].toString();
+    QString username = credential.username();
     QString taskName = "NetSecOps_" + QString::number(jobId);
     
+    // schtasks /P puts the password on the command line; the ScheduledTasks
+    // cmdlets register and run the same task over a CIM session instead.
     // Use raw command without any processing
-    QString batchCommand = QString(
-        "schtasks /Create /S %1 /U %2 /P %3 /TN %4 /TR \"%5\" /SC ONCE /ST 00:00 /RL HIGHEST /F && "
-        "schtasks /Run /S %1 /U %2 /P %3 /TN %4"
-    ).arg(target, username, password, taskName, command);
+    QString script = psCredential(username) + QString(
+        "$s = New-CimSession -ComputerName %1 -Credential $c; "
+        "$a = New-ScheduledTaskAction -Execute 'cmd.exe' -Argument %3; "
+        "Register-ScheduledTask -CimSession $s -TaskName %2 -Action $a -RunLevel Highest -Force | Out-Null; "
+        "Start-ScheduledTask -CimSession $s -TaskName %2"
+    ).arg(psQuote(target), psQuote(taskName), psQuote("/c " + command));
     
-    qDebug() << "Executing SCHTASKS:" << batchCommand;
-    process->start("cmd", QStringList() << "/c" << batchCommand);
+    qDebug() << "Executing SCHTASKS:" << taskName << "on" << target << "as" << username;
+    startWithPassword(process, powerShellProgram(), QStringList() << "-Command" << script,
+                      kPasswordVariable, credential.password());
     
     
     if (!process->waitForStarted(5000)) {
@@ -737,15 +1026,17 @@ int RemoteExecutor::generateJobId()
     return m_nextJobId++;
 }
 
-void RemoteExecutor::executeCustom(const QString &target, const QString &command, int jobId, const QJsonObject &credential)
+void RemoteExecutor::executeCustom(const QString &target, const QString &command, int jobId, const CredentialHandle &credential)
 {
     QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
     m_processJobs[process] = jobId;
     m_activeJobs[jobId].process = process;
     
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RemoteExecutor::onProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
     
     qDebug() << "Executing Custom:" << command;
     process->start("cmd", QStringList() << "/c" << command);
@@ -756,3 +1047,452 @@ void RemoteExecutor::executeCustom(const QString &target, const QString &command
         process->deleteLater();
     }
 }
+
+void RemoteExecutor::deployFileFanOut(const QString &sourcePath, const QString &destPath, const QString &targets, bool relay)
+{
+    QStringList targetList = parseTargets(targets);
+    if (targetList.isEmpty()) return;
+    
+    FanOutDeployment dep;
+    dep.id = m_nextDeploymentId++;
+    dep.sourcePath = sourcePath;
+    dep.destPath = destPath;
+    dep.relay = relay;
+    dep.hashing = true;
+    dep.directActive = 0;
+    dep.remaining = 0;
+    dep.file = new QFile(sourcePath);
+    
+    if (!dep.file->open(QIODevice::ReadOnly)) {
+        qWarning() << "Fan-out: cannot open" << sourcePath << dep.file->errorString();
+        delete dep.file;
+        for (const QString &target : targetList) {
+            int jobId = generateJobId();
+            emit jobStarted(jobId, "File Deploy", target);
+            emit jobFailed(jobId, "Cannot open " + sourcePath);
+        }
+        return;
+    }
+    
+    // Map the artifact once; every push streams out of the same pages
+    qint64 size = dep.file->size();
+    uchar *mapped = size > 0 ? dep.file->map(0, size) : nullptr;
+    if (mapped) {
+        dep.buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), size);
+    } else {
+        dep.buffer = dep.file->readAll();
+    }
+    
+    m_deployments[dep.id] = dep;
+    
+    for (const QString &target : targetList) {
+        int jobId = generateJobId();
+        
+        ExecutionJob job;
+        job.id = jobId;
+        job.type = "File Deploy";
+        job.target = target;
+        job.command = QString("Deploy %1 to %2").arg(sourcePath, destPath);
+        job.protocol = "SCP/SFTP";
+        job.status = "running";
+        job.progress = 0;
+        job.process = nullptr;
+        job.deploymentId = dep.id;
+        job.stage = "verify";
+        
+        m_activeJobs[jobId] = job;
+        m_deployments[dep.id].remaining++;
+        
+        emit jobStarted(jobId, job.type, target);
+        
+        QString credentialError;
+        CredentialHandle credential = getOrPromptCredential(target, job.protocol, &credentialError);
+        if (!credential.isValid()) {
+            completeFanOutJob(jobId, false, credentialError.isEmpty() ? "No credential available for " + target
+                                                                      : credentialError);
+            continue;
+        }
+        m_deployments[dep.id].credentials[target] = credential;
+    }
+    
+    // Hashing a large artifact takes a while, so it runs off the GUI thread,
+    // over the same bytes every push streams; hosts are checked against the
+    // hash once it is known
+    const int deploymentId = dep.id;
+    const QByteArray buffer = m_deployments[deploymentId].buffer;
+    m_hashPool.start(QRunnable::create([this, deploymentId, buffer]() {
+        const QString hex = QString::fromLatin1(QCryptographicHash::hash(buffer, QCryptographicHash::Sha256).toHex());
+        QMetaObject::invokeMethod(this, [this, deploymentId, hex]() {
+            startFanOutVerify(deploymentId, hex);
+        }, Qt::QueuedConnection);
+    }));
+    
+    scheduleFanOut(dep.id);
+    
+    m_isExecuting = !m_activeJobs.isEmpty();
+    emit isExecutingChanged();
+    emit activeJobsChanged();
+}
+
+void RemoteExecutor::startFanOutVerify(int deploymentId, const QString &hash)
+{
+    if (!m_deployments.contains(deploymentId)) return;
+    m_deployments[deploymentId].hashing = false;
+    
+    // Jobs stopped while the artifact was hashed are gone already; with none
+    // left, scheduleFanOut below retires the deployment
+    QList<int> jobIds;
+    for (auto it = m_activeJobs.cbegin(); it != m_activeJobs.cend(); ++it) {
+        if (it->deploymentId == deploymentId) {
+            jobIds << it.key();
+        }
+    }
+    std::sort(jobIds.begin(), jobIds.end());
+    
+    FanOutDeployment &dep = m_deployments[deploymentId];
+    dep.hash = hash;
+    qDebug() << "Fan-out deploy" << deploymentId << dep.sourcePath << "sha256" << dep.hash
+             << "to" << jobIds.size() << "hosts" << (dep.relay ? "with relay" : "direct");
+    
+    for (int jobId : std::as_const(jobIds)) {
+        const QString target = m_activeJobs[jobId].target;
+        
+        // Skip hosts that already hold an identical copy
+        QString remoteCommand = QString("sha256sum %1 2>/dev/null").arg(shellQuote(dep.destPath));
+        QStringList args;
+        QString program = buildSSHCommand(target, remoteCommand, jobId, dep.credentials[target], args);
+        if (program.isEmpty()) {
+            completeFanOutJob(jobId, false, "Cannot write private key for " + target);
+        } else if (!startFanOutProcess(jobId, program, args, dep.credentials[target])) {
+            completeFanOutJob(jobId, false, "Failed to start SSH process");
+        }
+    }
+    
+    scheduleFanOut(deploymentId);
+}
+
+QSharedPointer<QTemporaryFile> RemoteExecutor::writeKeyFile(QByteArrayView privateKey)
+{
+    // Created 0600 under a unique name, and removed again as soon as the
+    // last job stage holding it lets go
+    if (!m_keyDir.isValid()) {
+        qWarning() << "No private directory for SSH keys:" << m_keyDir.errorString();
+        return QSharedPointer<QTemporaryFile>();
+    }
+    
+    auto file = QSharedPointer<QTemporaryFile>::create(m_keyDir.filePath("key-XXXXXX"));
+    if (!file->open() || file->write(privateKey.data(), privateKey.size()) != privateKey.size()
+        || !file->flush()) {
+        qWarning() << "Failed to write SSH key file:" << file->errorString();
+        return QSharedPointer<QTemporaryFile>();
+    }
+    file->close();
+    return file;
+}
+
+QString RemoteExecutor::buildSSHCommand(const QString &target, const QString &remoteCommand, int jobId,
+                                        const CredentialHandle &credential, QStringList &args)
+{
+    args.clear();
+    args << "-o" << "StrictHostKeyChecking=no"
+         << "-o" << "ConnectTimeout=10";
+    
+    QString username = credential.username();
+    QByteArrayView privateKey = credential.privateKey();
+    
+    if (!privateKey.isEmpty()) {
+        // One file per host and stage; a relay stage holds two different keys
+        QSharedPointer<QTemporaryFile> keyFile = writeKeyFile(privateKey);
+        if (!keyFile) {
+            return QString();
+        }
+        m_activeJobs[jobId].keyFiles << keyFile;
+        args << "-i" << keyFile->fileName();
+    }
+    
+    if (!username.isEmpty()) {
+        args << "-l" << username;
+    }
+    
+    args << target << remoteCommand;
+    
+    return withSshpass("ssh", args, credential);
+}
+
+QProcess *RemoteExecutor::startFanOutProcess(int jobId, const QString &program, const QStringList &args,
+                                             const CredentialHandle &credential, QProcess *feeder)
+{
+    QProcess *process = new QProcess(this);
+    Metrics::watchSpawn(process);
+    m_processJobs[process] = jobId;
+    m_activeJobs[jobId].process = process;
+    m_activeJobs[jobId].output.clear();
+    m_activeJobs[jobId].errorOutput.clear();
+    
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &RemoteExecutor::onProcessFinished);
+    connect(process, &QProcess::readyReadStandardOutput, this, &RemoteExecutor::onProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &RemoteExecutor::onProcessOutput);
+    
+    if (feeder) {
+        feeder->setStandardOutputProcess(process);
+    }
+    startSshTool(process, program, args, credential);
+    
+    if (!process->waitForStarted(5000)) {
+        m_processJobs.remove(process);
+        m_activeJobs[jobId].process = nullptr;
+        process->deleteLater();
+        return nullptr;
+    }
+    return process;
+}
+
+void RemoteExecutor::startFanOutPush(int jobId)
+{
+    ExecutionJob &job = m_activeJobs[jobId];
+    FanOutDeployment &dep = m_deployments[job.deploymentId];
+    job.stage = "push";
+    job.streamOffset = 0;
+    
+    // Write to a side file so an interrupted push never passes the hash check
+    QString part = dep.destPath + ".part";
+    QString remoteCommand = QString("cat > %1 && mv -f %1 %2").arg(shellQuote(part), shellQuote(dep.destPath));
+    QStringList args;
+    QString program = buildSSHCommand(job.target, remoteCommand, jobId, dep.credentials[job.target], args);
+    if (program.isEmpty()) {
+        completeFanOutJob(jobId, false, "Cannot write private key for " + job.target);
+        return;
+    }
+    
+    QProcess *process = startFanOutProcess(jobId, program, args, dep.credentials[job.target]);
+    if (!process) {
+        completeFanOutJob(jobId, false, "Failed to start SSH process");
+        return;
+    }
+    
+    dep.directActive++;
+    connect(process, &QProcess::bytesWritten, this, &RemoteExecutor::onFanOutBytesWritten);
+    writeArtifactChunk(process);
+}
+
+void RemoteExecutor::startFanOutRelay(int jobId, const QString &relayHost)
+{
+    ExecutionJob &job = m_activeJobs[jobId];
+    FanOutDeployment &dep = m_deployments[job.deploymentId];
+    job.stage = "relay";
+    job.relayHost = relayHost;
+    
+    // The relay's verified copy is piped from one ssh session into the
+    // other, so neither host is handed a way to log in to the other. The
+    // target checks the hash before the copy replaces anything.
+    QString part = dep.destPath + ".part";
+    QString feedCommand = QString("cat %1").arg(shellQuote(dep.destPath));
+    QString remoteCommand = QString("cat > %1 && echo %2 | sha256sum -c --status && mv -f %1 %3")
+                                .arg(shellQuote(part), shellQuote(dep.hash + "  " + part), shellQuote(dep.destPath));
+    QStringList feedArgs;
+    QStringList args;
+    QString feedProgram = buildSSHCommand(relayHost, feedCommand, jobId, dep.credentials[relayHost], feedArgs);
+    QString program = buildSSHCommand(job.target, remoteCommand, jobId, dep.credentials[job.target], args);
+    
+    qDebug() << "Fan-out relay" << relayHost << "->" << job.target;
+    
+    QProcess *feeder = new QProcess(this);
+    Metrics::watchSpawn(feeder);
+    if (feedProgram.isEmpty() || program.isEmpty()
+        || !startFanOutProcess(jobId, program, args, dep.credentials[job.target], feeder)) {
+        delete feeder;
+        job.keyFiles.clear();
+        job.relayHost.clear();
+        job.directOnly = true;
+        dep.pending.prepend(jobId);
+        return;
+    }
+    
+    // A feeder that fails leaves the target with a short copy, which the
+    // hash check turns into a failed stage and a direct push
+    job.feeder = feeder;
+    startSshTool(feeder, feedProgram, feedArgs, dep.credentials[relayHost]);
+    dep.relayLoad[relayHost]++;
+    job.progress = 50;
+    emit jobProgress(jobId, job.progress);
+}
+
+void RemoteExecutor::onFanOutBytesWritten()
+{
+    QProcess *process = qobject_cast<QProcess*>(sender());
+    if (!process || !m_processJobs.contains(process)) return;
+    
+    writeArtifactChunk(process);
+}
+
+void RemoteExecutor::writeArtifactChunk(QProcess *process)
+{
+    int jobId = m_processJobs.value(process);
+    if (!m_activeJobs.contains(jobId)) return;
+    
+    ExecutionJob &job = m_activeJobs[jobId];
+    const FanOutDeployment &dep = m_deployments[job.deploymentId];
+    qint64 size = dep.buffer.size();
+    
+    // Keep at most one chunk queued in QProcess so pushes never copy the whole file
+    if (job.streamOffset > size || process->bytesToWrite() > 0) return;
+    
+    if (job.streamOffset == size) {
+        process->closeWriteChannel();
+        job.streamOffset = size + 1;
+        return;
+    }
+    
+    qint64 length = qMin(kFanOutChunkSize, size - job.streamOffset);
+    process->write(dep.buffer.constData() + job.streamOffset, length);
+    job.streamOffset += length;
+    
+    int progress = static_cast<int>(job.streamOffset * 90 / qMax<qint64>(size, 1));
+    if (progress != job.progress) {
+        job.progress = progress;
+        emit jobProgress(jobId, progress);
+    }
+}
+
+void RemoteExecutor::finishFanOutStage(int jobId, bool ok, const QString &error)
+{
+    ExecutionJob &job = m_activeJobs[jobId];
+    int deploymentId = job.deploymentId;
+    FanOutDeployment &dep = m_deployments[deploymentId];
+    job.process = nullptr;
+    job.keyFiles.clear();
+    if (job.feeder) {
+        job.feeder->kill();
+        job.feeder->deleteLater();
+        job.feeder = nullptr;
+    }
+    
+    if (job.stage == "verify") {
+        QString remoteHash = job.output.section(' ', 0, 0).trimmed();
+        if (ok && remoteHash == dep.hash) {
+            completeFanOutJob(jobId, true, "Already up to date (sha256 " + dep.hash + ")");
+        } else {
+            job.output.clear();
+            job.progress = 10;
+            emit jobProgress(jobId, job.progress);
+            dep.pending.append(jobId);
+        }
+    } else if (job.stage == "push") {
+        dep.directActive--;
+        completeFanOutJob(jobId, ok, ok ? QString("Deployed sha256 %1").arg(dep.hash)
+                                        : (error.isEmpty() ? "Process failed" : error));
+    } else if (job.stage == "relay") {
+        dep.relayLoad[job.relayHost]--;
+        if (ok) {
+            completeFanOutJob(jobId, true, QString("Deployed sha256 %1 via %2").arg(dep.hash, job.relayHost));
+        } else {
+            // Relay could not reach the target; fall back to a direct push
+            qDebug() << "Fan-out relay" << job.relayHost << "failed for" << job.target << error;
+            job.relayHost.clear();
+            job.directOnly = true;
+            dep.pending.prepend(jobId);
+        }
+    }
+    
+    scheduleFanOut(deploymentId);
+}
+
+void RemoteExecutor::completeFanOutJob(int jobId, bool ok, const QString &output)
+{
+    ExecutionJob job = m_activeJobs.take(jobId);
+    FanOutDeployment &dep = m_deployments[job.deploymentId];
+    dep.remaining--;
+    
+    if (ok) {
+        // Hosts holding a good copy can serve the rest of the fleet
+        if (!dep.relays.contains(job.target) && dep.credentials.contains(job.target)) {
+            dep.relays << job.target;
+        }
+        emit jobProgress(jobId, 100);
+        emit jobCompleted(jobId, output);
+    } else {
+        emit jobFailed(jobId, output);
+    }
+}
+
+void RemoteExecutor::scheduleFanOut(int deploymentId)
+{
+    if (!m_deployments.contains(deploymentId)) return;
+    
+    int index = 0;
+    while (index < m_deployments[deploymentId].pending.size()) {
+        FanOutDeployment &dep = m_deployments[deploymentId];
+        int jobId = dep.pending[index];
+        
+        QString relayHost;
+        if (dep.relay && !m_activeJobs[jobId].directOnly) {
+            int lowest = kFanOutRelayWidth;
+            for (const QString &host : dep.relays) {
+                int load = dep.relayLoad.value(host);
+                if (load < lowest && host != m_activeJobs[jobId].target) {
+                    lowest = load;
+                    relayHost = host;
+                }
+            }
+        }
+        
+        if (relayHost.isEmpty() && dep.relay && dep.directActive >= kFanOutDirectSlots) {
+            index++;
+            continue;
+        }
+        
+        dep.pending.removeAt(index);
+        if (relayHost.isEmpty()) {
+            startFanOutPush(jobId);
+        } else {
+            startFanOutRelay(jobId, relayHost);
+        }
+        index = 0;
+    }
+    
+    FanOutDeployment &dep = m_deployments[deploymentId];
+    if (dep.remaining <= 0 && !dep.hashing) {
+        qDebug() << "Fan-out deploy" << deploymentId << "finished," << dep.relays.size() << "hosts hold the artifact";
+        dep.buffer.clear();
+        dep.file->close();
+        delete dep.file;
+        m_deployments.remove(deploymentId);
+    }
+    
+    m_isExecuting = !m_activeJobs.isEmpty();
+    emit isExecutingChanged();
+    emit activeJobsChanged();
+}
+
+void RemoteExecutor::stopFanOutJob(int jobId)
+{
+    ExecutionJob &job = m_activeJobs[jobId];
+    int deploymentId = job.deploymentId;
+    FanOutDeployment &dep = m_deployments[deploymentId];
+    dep.pending.removeAll(jobId);
+    
+    if (job.process) {
+        QProcess *process = job.process;
+        m_processJobs.remove(process);
+        disconnect(process, nullptr, this, nullptr);
+        process->kill();
+        process->waitForFinished(3000);
+        process->deleteLater();
+        
+        if (job.stage == "push") {
+            dep.directActive--;
+        } else if (job.stage == "relay") {
+            dep.relayLoad[job.relayHost]--;
+        }
+    }
+    if (job.feeder) {
+        job.feeder->kill();
+        job.feeder->deleteLater();
+    }
+    
+    m_activeJobs.remove(jobId);
+    dep.remaining--;
+    emit jobCompleted(jobId, "Execution stopped by user");
+    scheduleFanOut(deploymentId);
+}
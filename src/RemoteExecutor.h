@@ -7,6 +7,14 @@
 #include <QHash>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include "CredentialHandle.h"
+#include "Metrics.h"
 
 class CredentialManager;
 
@@ -18,8 +26,37 @@ struct ExecutionJob {
     QString protocol;
     QString status;
     int progress;
-    QString output;
+    QString output;          // stdout
+    QString errorOutput;     // stderr, streamed like stdout and kept for the failure message
     QProcess *process;
+    QString sourcePath;      // transfer endpoints, kept for protocol fallback
+    QString destPath;
+    int deploymentId = 0;    // fan-out deployment this job belongs to, 0 if standalone
+    QString stage;           // fan-out stage: "verify", "push" or "relay"
+    QString relayHost;
+    qint64 streamOffset = 0;
+    bool directOnly = false;
+    QProcess *feeder = nullptr;  // relay stage: streams the relay's copy into process
+    QList<QSharedPointer<QTemporaryFile>> keyFiles; // private keys of the current stage
+};
+
+// One artifact pushed to many hosts. The source is mapped (or read) once,
+// hashed once, and every push streams from the same buffer.
+struct FanOutDeployment {
+    int id;
+    QString sourcePath;
+    QString destPath;
+    QString hash;            // hex SHA-256 of the artifact, empty until hashed
+    QFile *file;
+    QByteArray buffer;       // raw view over the mapping, or the file contents
+    bool relay;
+    bool hashing;            // buffer is being read by m_hashPool, keep it mapped
+    QList<int> pending;      // jobs waiting for a push slot
+    QStringList relays;      // hosts known to hold the artifact
+    QHash<QString, int> relayLoad;
+    QHash<QString, CredentialHandle> credentials;
+    int directActive;
+    int remaining;
 };
 
 class RemoteExecutor : public QObject
@@ -30,6 +67,7 @@ class RemoteExecutor : public QObject
 
 public:
     explicit RemoteExecutor(QObject *parent = nullptr);
+    ~RemoteExecutor();
     Q_INVOKABLE void setCredentialManager(CredentialManager *credManager);
     
     bool isExecuting() const { return m_isExecuting; }
@@ -47,6 +85,7 @@ public slots:
     void executeQuickCommand(const QString &targets, const QString &command);
     void stopExecution(int jobId);
     void deployFile(const QString &sourcePath, const QString &destPath, const QString &targets, const QString &protocol);
+    void deployFileFanOut(const QString &sourcePath, const QString &destPath, const QString &targets, bool relay);
     void retrieveFile(const QString &sourcePath, const QString &destPath, const QString &targets, const QString &protocol);
     Q_INVOKABLE void executeWithCredential(int jobId, const QString &username, const QString &password);
 
@@ -63,23 +102,58 @@ signals:
 private slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onProcessOutput();
+    void onFanOutBytesWritten();
 
 private:
-    void executeSSH(const QString &target, const QString &command, int jobId, const QJsonObject &credential);
-    void executeWinRM(const QString &target, const QString &command, int jobId, const QJsonObject &credential);
-    void executePowerShell(const QString &target, const QString &command, int jobId, const QJsonObject &credential);
-    void executeWMI(const QString &target, const QString &command, int jobId, const QJsonObject &credential);
-    void executeSCHTASKS(const QString &target, const QString &command, int jobId, const QJsonObject &credential);
-    void executeCustom(const QString &target, const QString &command, int jobId, const QJsonObject &credential);
-    void transferSCP(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const QJsonObject &credential);
-    void transferSMB(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const QJsonObject &credential);
-    QJsonObject getOrPromptCredential(const QString &host, const QString &protocol);
+    void executeSSH(const QString &target, const QString &command, int jobId, const CredentialHandle &credential);
+    void executeWinRM(const QString &target, const QString &command, int jobId, const CredentialHandle &credential);
+    void executePowerShell(const QString &target, const QString &command, int jobId, const CredentialHandle &credential);
+    void executeWMI(const QString &target, const QString &command, int jobId, const CredentialHandle &credential);
+    void executeSCHTASKS(const QString &target, const QString &command, int jobId, const CredentialHandle &credential);
+    void executeCustom(const QString &target, const QString &command, int jobId, const CredentialHandle &credential);
+    void transferSCP(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const CredentialHandle &credential);
+    void transferSMB(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const CredentialHandle &credential);
+    void transferDelta(const QString &source, const QString &dest, const QString &target, bool upload, int jobId, const CredentialHandle &credential);
+    // error is set when a stored credential exists but cannot be used
+    CredentialHandle getOrPromptCredential(const QString &host, const QString &protocol, QString *error = nullptr);
+    QSharedPointer<QTemporaryFile> writeKeyFile(QByteArrayView privateKey);
+    QString buildSSHCommand(const QString &target, const QString &remoteCommand, int jobId,
+                            const CredentialHandle &credential, QStringList &args);
+    QProcess *startFanOutProcess(int jobId, const QString &program, const QStringList &args,
+                                 const CredentialHandle &credential, QProcess *feeder = nullptr);
+    void startFanOutVerify(int deploymentId, const QString &hash);
+    void startFanOutPush(int jobId);
+    void startFanOutRelay(int jobId, const QString &relayHost);
+    void finishFanOutStage(int jobId, bool ok, const QString &error);
+    void completeFanOutJob(int jobId, bool ok, const QString &output);
+    void scheduleFanOut(int deploymentId);
+    void stopFanOutJob(int jobId);
+    void writeArtifactChunk(QProcess *process);
+    void readProcessOutput(QProcess *process);
     QStringList parseTargets(const QString &targets);
     int generateJobId();
+    void startJobMetrics(int jobId);
+    void finishJobMetrics(int jobId, bool ok);
     
+    // Per-job latency, transfer and trace accounting, fed by our own job signals
+    struct JobMetrics {
+        QElapsedTimer clock;
+        qint64 traceStart = 0;
+        QString target;
+        Metrics::Histogram histogram;
+        qint64 bytes = 0;        // artifact size for deploys
+        QString retrievedPath;   // measured on completion for retrieves
+    };
+    
+
     bool m_isExecuting;
     QHash<int, ExecutionJob> m_activeJobs;
     QHash<QProcess*, int> m_processJobs;
+    QHash<int, FanOutDeployment> m_deployments;
+    QHash<int, JobMetrics> m_jobMetrics;
     int m_nextJobId;
+    int m_nextDeploymentId;
     CredentialManager *m_credentialManager;
+    QTemporaryDir m_keyDir;  // 0700, holds the per-stage private key files
+    QThreadPool m_hashPool;  // own pool: scans clear the global one
 };
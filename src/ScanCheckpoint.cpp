@@ -0,0 +1,190 @@
+#include "ScanCheckpoint.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const quint32 kMagic = 0x4E53434B; // "NSCK"
+const quint32 kVersion = 1;
+const char *kSuffix = ".ckpt";
+
+QString pathFor(const QString &id)
+{
+    return ScanCheckpoint::directory() + "/" + id + kSuffix;
+}
+
+void prepare(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_6_0);
+}
+
+void writeHeader(QDataStream &out, const ScanCheckpoint &c)
+{
+    out << kMagic << kVersion << c.id << c.network << c.portRange << c.savedAt << qint32(c.threads)
+        << qint32(c.hostRateLimit) << qint32(c.subnetRateLimit) << c.totalProbes << c.completedProbes;
+}
+
+bool readHeader(QDataStream &in, ScanCheckpoint *c)
+{
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != kMagic || version != kVersion)
+        return false;
+
+    qint32 threads, hostRate, subnetRate;
+    in >> c->id >> c->network >> c->portRange >> c->savedAt >> threads >> hostRate >> subnetRate
+       >> c->totalProbes >> c->completedProbes;
+    c->threads = threads;
+    c->hostRateLimit = hostRate;
+    c->subnetRateLimit = subnetRate;
+    return in.status() == QDataStream::Ok;
+}
+
+QByteArray writeBody(const ScanCheckpoint &c)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    prepare(out);
+
+    const ProbeScheduler::State &s = c.schedule;
+    out << c.targets << c.tcpPorts << c.udpPorts << c.finished;
+    out << s.prime << s.generator << s.current << s.emitted;
+
+    out << quint32(s.pending.size());
+    for (const ProbeScheduler::Probe &probe : s.pending)
+        out << qint32(probe.host) << qint32(probe.port);
+    out << s.remaining << s.open;
+
+    out << quint32(c.results.size());
+    for (const HostInfo &host : c.results) {
+        out << host.ip << host.hostname << host.mac << host.openPorts << host.openUdpPorts
+            << host.isOnline << host.responseTime;
+    }
+    return qCompress(body);
+}
+
+bool readBody(const QByteArray &compressed, ScanCheckpoint *c)
+{
+    const QByteArray body = qUncompress(compressed);
+    QDataStream in(body);
+    prepare(in);
+
+    ProbeScheduler::State &s = c->schedule;
+    in >> c->targets >> c->tcpPorts >> c->udpPorts >> c->finished;
+    in >> s.prime >> s.generator >> s.current >> s.emitted;
+
+    quint32 pending = 0;
+    in >> pending;
+    s.pending.clear();
+    for (quint32 i = 0; i < pending && in.status() == QDataStream::Ok; ++i) {
+        qint32 host, port;
+        in >> host >> port;
+        s.pending.append(ProbeScheduler::Probe{host, port});
+    }
+    in >> s.remaining >> s.open;
+
+    quint32 results = 0;
+    in >> results;
+    c->results.clear();
+    for (quint32 i = 0; i < results && in.status() == QDataStream::Ok; ++i) {
+        HostInfo host;
+        in >> host.ip >> host.hostname >> host.mac >> host.openPorts >> host.openUdpPorts
+           >> host.isOnline >> host.responseTime;
+        c->results.append(host);
+    }
+    return in.status() == QDataStream::Ok && c->finished.size() == c->targets.size();
+}
+}
+
+QString ScanCheckpoint::newId()
+{
+    return QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + "-"
+        + QString::number(QRandomGenerator::global()->bounded(0x10000), 16);
+}
+
+bool ScanCheckpoint::isValidId(const QString &id)
+{
+    static const QRegularExpression pattern("^[0-9]{8}-[0-9]{6}-[0-9a-f]{1,4}$");
+    return pattern.match(id).hasMatch();
+}
+
+QString ScanCheckpoint::directory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/scans";
+}
+
+bool ScanCheckpoint::save() const
+{
+    if (!isValidId(id))
+        return false;
+    QDir().mkpath(directory());
+
+    QSaveFile file(pathFor(id));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write scan checkpoint:" << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    prepare(out);
+    writeHeader(out, *this);
+    out << writeBody(*this);
+    return file.commit();
+}
+
+bool ScanCheckpoint::load(const QString &id, ScanCheckpoint *checkpoint)
+{
+    if (!isValidId(id))
+        return false;
+    QFile file(pathFor(id));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    prepare(in);
+    if (!readHeader(in, checkpoint))
+        return false;
+
+    QByteArray body;
+    in >> body;
+    if (in.status() != QDataStream::Ok || !readBody(body, checkpoint)) {
+        qWarning() << "Scan checkpoint" << id << "is damaged";
+        return false;
+    }
+    return true;
+}
+
+void ScanCheckpoint::remove(const QString &id)
+{
+    if (isValidId(id))
+        QFile::remove(pathFor(id));
+}
+
+QList<ScanCheckpoint> ScanCheckpoint::list()
+{
+    QList<ScanCheckpoint> checkpoints;
+    const QStringList files = QDir(directory()).entryList(QStringList() << QString("*") + kSuffix, QDir::Files);
+    for (const QString &name : files) {
+        QFile file(directory() + "/" + name);
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        QDataStream in(&file);
+        prepare(in);
+        ScanCheckpoint checkpoint;
+        if (readHeader(in, &checkpoint))
+            checkpoints << checkpoint;
+    }
+
+    std::sort(checkpoints.begin(), checkpoints.end(), [](const ScanCheckpoint &a, const ScanCheckpoint &b) {
+        return a.savedAt > b.savedAt;
+    });
+    return checkpoints;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QBitArray>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include "NetworkScanner.h"
+#include "ProbeScheduler.h"
+
+// On-disk state of an interrupted scan: the inputs, the probe schedule
+// position, which hosts are finished and the hosts found so far. Stored as
+// a small uncompressed header (enough to list saved scans) followed by a
+// qCompress'd QDataStream body, one file per scan under AppDataLocation/scans.
+struct ScanCheckpoint {
+    QString id;
+    QString network;
+    QString portRange;
+    QDateTime savedAt;
+    int threads = 50;
+    int hostRateLimit = 0;
+    int subnetRateLimit = 0;
+    quint64 totalProbes = 0;
+    quint64 completedProbes = 0;
+
+    QStringList targets;
+    QList<int> tcpPorts;
+    QList<int> udpPorts;
+    ProbeScheduler::State schedule;
+    QBitArray finished;
+    QList<HostInfo> results; // online hosts already reported
+
+    static QString newId();
+    // Only ids shaped like newId()'s are accepted, so an id can't name a
+    // file outside directory()
+    static bool isValidId(const QString &id);
+    static QString directory();
+
+    // Written to a temporary file and renamed over the previous checkpoint,
+    // so a crash mid-write leaves the last good one in place
+    bool save() const;
+    static bool load(const QString &id, ScanCheckpoint *checkpoint);
+    static void remove(const QString &id);
+
+    // Headers only, newest first
+    static QList<ScanCheckpoint> list();
+};
@@ -0,0 +1,434 @@
+#include "ScanCoordinator.h"
+#include "NetworkScanner.h"
+#include "ScanProtocol.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QHostAddress>
+#include <QDebug>
+
+namespace {
+const int kShardHosts = 32;          // small enough that shards spread evenly
+const int kStallMs = 30000;          // silent this long with a shard: presumed dead
+const int kBackupAfterMs = 15000;    // a shard running this long may get a backup copy
+const int kWatchdogMs = 2000;
+}
+
+ScanCoordinator::ScanCoordinator(QObject *parent)
+    : QObject(parent)
+    , m_nextWorkerId(1)
+    , m_threadsPerWorker(50)
+    , m_hostRate(50)
+    , m_subnetRate(500)
+    , m_totalHosts(0)
+    , m_isScanning(false)
+    , m_progress(0)
+    , m_hostsFound(0)
+    , m_portsFound(0)
+{
+    m_watchdog = new QTimer(this);
+    m_watchdog->setInterval(kWatchdogMs);
+    connect(m_watchdog, &QTimer::timeout, this, &ScanCoordinator::checkWorkers);
+}
+
+ScanCoordinator::~ScanCoordinator()
+{
+    stopScan();
+}
+
+int ScanCoordinator::workerCount() const
+{
+    int ready = 0;
+    for (const Worker &worker : m_workers) {
+        if (worker.ready)
+            ++ready;
+    }
+    return ready;
+}
+
+void ScanCoordinator::setToken(const QString &token)
+{
+    if (token == m_token)
+        return;
+    m_token = token;
+    emit tokenChanged();
+}
+
+void ScanCoordinator::setRateLimits(int hostRate, int subnetRate)
+{
+    m_hostRate = qMax(0, hostRate);
+    m_subnetRate = qMax(0, subnetRate);
+}
+
+bool ScanCoordinator::listen(const QString &address)
+{
+    const ScanProtocol::Endpoint endpoint = ScanProtocol::Endpoint::parse(address);
+
+    if (endpoint.local) {
+        QLocalServer::removeServer(endpoint.name); // stale socket from a crashed run
+        auto *server = new QLocalServer(this);
+        if (!server->listen(endpoint.name)) {
+            qWarning() << "Coordinator cannot listen on" << address << ":" << server->errorString();
+            delete server;
+            return false;
+        }
+        connect(server, &QLocalServer::newConnection, this, [this, server]() {
+            while (QLocalSocket *socket = server->nextPendingConnection())
+                addWorker(socket);
+        });
+        m_localServers << server;
+    } else {
+        // Workers receive target lists and feed results, so without a token
+        // only this machine may join
+        const QHostAddress any = m_token.isEmpty() ? QHostAddress(QHostAddress::LocalHost) : QHostAddress(QHostAddress::Any);
+        const QHostAddress host = endpoint.name.isEmpty() ? any : QHostAddress(endpoint.name);
+        if (m_token.isEmpty() && !host.isLoopback()) {
+            qWarning() << "Coordinator needs a token to listen beyond loopback, refusing" << address;
+            return false;
+        }
+        auto *server = new QTcpServer(this);
+        if (!server->listen(host, endpoint.port)) {
+            qWarning() << "Coordinator cannot listen on" << address << ":" << server->errorString();
+            delete server;
+            return false;
+        }
+        connect(server, &QTcpServer::newConnection, this, [this, server]() {
+            while (QTcpSocket *socket = server->nextPendingConnection())
+                addWorker(socket);
+        });
+        m_tcpServers << server;
+    }
+
+    qDebug() << "Coordinator listening on" << address;
+    return true;
+}
+
+void ScanCoordinator::addWorker(QIODevice *socket)
+{
+    const int id = m_nextWorkerId++;
+    Worker worker;
+    worker.socket = socket;
+    worker.lastSeen.start();
+    m_workers.insert(id, worker);
+
+    connect(socket, &QIODevice::readyRead, this, [this, id]() { onReadyRead(id); });
+    if (auto *tcp = qobject_cast<QTcpSocket *>(socket))
+        connect(tcp, &QTcpSocket::disconnected, this, [this, id]() { onDisconnected(id); });
+    else if (auto *local = qobject_cast<QLocalSocket *>(socket))
+        connect(local, &QLocalSocket::disconnected, this, [this, id]() { onDisconnected(id); });
+
+    // Workers that never introduce themselves are dropped by the watchdog
+    m_watchdog->start();
+}
+
+void ScanCoordinator::onReadyRead(int workerId)
+{
+    auto it = m_workers.find(workerId);
+    if (it == m_workers.end())
+        return;
+
+    QList<QJsonObject> messages;
+    const bool ok = ScanProtocol::receive(it->socket, &messages);
+    it->lastSeen.restart();
+    for (const QJsonObject &message : messages)
+        handleMessage(workerId, message);
+
+    if (!ok) {
+        qWarning() << "Dropping worker" << workerId << ": oversized message";
+        it = m_workers.find(workerId);
+        if (it != m_workers.end())
+            it->socket->close();
+    }
+}
+
+void ScanCoordinator::handleMessage(int workerId, const QJsonObject &message)
+{
+    auto it = m_workers.find(workerId);
+    if (it == m_workers.end())
+        return;
+
+    const QString type = message.value("type").toString();
+    if (!it->ready) {
+        auto *tcp = qobject_cast<QTcpSocket *>(it->socket);
+        const bool remote = tcp && !tcp->peerAddress().isLoopback();
+        if (type != "hello" || message.value("version").toInt() != ScanProtocol::Version
+            || message.value("token").toString() != m_token || (remote && m_token.isEmpty())) {
+            qWarning() << "Rejecting worker" << workerId << ": bad handshake";
+            it->socket->close();
+            return;
+        }
+        it->ready = true;
+        it->name = message.value("worker").toString(QString("worker-%1").arg(workerId));
+        qDebug() << "Worker joined:" << it->name;
+        emit workerJoined(it->name);
+        emit workersChanged();
+        dispatch();
+        return;
+    }
+
+    const int shardId = message.value("shard").toInt(-1);
+    if (shardId < 0 || shardId >= m_shards.size() || !m_shards[shardId].workers.contains(workerId))
+        return; // stale message about a shard this worker no longer holds
+    Shard &shard = m_shards[shardId];
+
+    if (type == "host") {
+        const QString ip = message.value("ip").toString();
+        if (m_reported.contains(ip))
+            return;
+        m_reported.insert(ip);
+
+        const QList<int> ports = ScanProtocol::toIntList(message.value("tcp").toArray());
+        const QList<int> udpPorts = ScanProtocol::toIntList(message.value("udp").toArray());
+        m_hostsFound++;
+        m_portsFound += ports.size() + udpPorts.size();
+        emit hostDiscovered(ip, message.value("hostname").toString(), message.value("mac").toString(), ports, udpPorts);
+        emit hostsFoundChanged();
+        emit portsFoundChanged();
+    } else if (type == "progress") {
+        shard.percent = qMax(shard.percent, message.value("percent").toInt());
+    } else if (type == "done") {
+        // First copy to finish wins; the others are called off
+        shard.state = Shard::Done;
+        shard.percent = 100;
+        const QSet<int> holders = shard.workers;
+        for (int other : holders) {
+            if (other != workerId)
+                ScanProtocol::send(m_workers[other].socket, {{"type", "cancel"}, {"shard", shardId}});
+            release(other);
+        }
+        updateProgress();
+
+        bool allDone = true;
+        for (const Shard &s : std::as_const(m_shards)) {
+            if (s.state != Shard::Done) {
+                allDone = false;
+                break;
+            }
+        }
+        if (allDone)
+            finishScan();
+        else
+            dispatch();
+    }
+}
+
+void ScanCoordinator::onDisconnected(int workerId)
+{
+    auto it = m_workers.find(workerId);
+    if (it == m_workers.end())
+        return;
+
+    const QString name = it->name;
+    const bool wasReady = it->ready;
+    const int shardId = it->shard;
+    release(workerId);
+    it->socket->deleteLater();
+    m_workers.erase(it);
+
+    if (!wasReady)
+        return;
+
+    qDebug() << "Worker lost:" << name;
+    emit workerLost(name);
+    emit workersChanged();
+
+    if (shardId >= 0 && m_shards[shardId].state == Shard::Running && m_shards[shardId].workers.isEmpty()) {
+        m_shards[shardId].state = Shard::Pending;
+        m_shards[shardId].percent = 0;
+        emit shardRequeued(shardId, name);
+    }
+    dispatch();
+}
+
+void ScanCoordinator::startScan(const QString &network, const QString &portRange, int threadsPerWorker)
+{
+    if (m_isScanning) return;
+
+    QList<IpSubnet> harvest;
+    QStringList names;
+    const QStringList targets = NetworkScanner::generateIPList(network, &harvest, &names);
+
+    m_shards.clear();
+    m_reported.clear();
+    for (int i = 0; i < targets.size(); i += kShardHosts) {
+        Shard shard;
+        shard.targets = targets.mid(i, kShardHosts);
+        shard.hosts = shard.targets.size();
+        m_shards << shard;
+    }
+    // Wide IPv6 blocks are harvested by whichever worker takes them
+    for (const IpSubnet &subnet : harvest) {
+        Shard shard;
+        shard.targets << subnet.toString();
+        shard.hosts = 1;
+        m_shards << shard;
+    }
+
+    m_portRange = portRange;
+    m_threadsPerWorker = threadsPerWorker;
+    m_totalHosts = 0;
+    for (const Shard &shard : std::as_const(m_shards))
+        m_totalHosts += shard.hosts;
+
+    m_isScanning = true;
+    m_progress = 0;
+    m_hostsFound = 0;
+    m_portsFound = 0;
+    qDebug() << "Coordinating scan of" << targets.size() << "hosts in" << m_shards.size() << "shards across"
+             << workerCount() << "workers";
+
+    emit scanStarted(network, portRange);
+    emit isScanningChanged();
+    emit progressChanged();
+    emit hostsFoundChanged();
+    emit portsFoundChanged();
+
+    if (m_shards.isEmpty()) {
+        finishScan();
+        return;
+    }
+    if (workerCount() == 0)
+        qDebug() << "No workers connected yet; shards wait for the first one";
+
+    m_watchdog->start();
+    dispatch();
+}
+
+void ScanCoordinator::stopScan()
+{
+    if (!m_isScanning) return;
+
+    for (auto it = m_workers.begin(); it != m_workers.end(); ++it) {
+        if (it->shard >= 0) {
+            ScanProtocol::send(it->socket, {{"type", "cancel"}, {"shard", it->shard}});
+            release(it.key());
+        }
+    }
+    m_shards.clear();
+
+    m_isScanning = false;
+    emit isScanningChanged();
+    emit scanCompleted();
+}
+
+void ScanCoordinator::dispatch()
+{
+    if (!m_isScanning)
+        return;
+
+    for (auto it = m_workers.begin(); it != m_workers.end(); ++it) {
+        if (!it->ready || it->shard >= 0)
+            continue;
+
+        int next = -1;
+        for (int i = 0; i < m_shards.size(); ++i) {
+            if (m_shards[i].state == Shard::Pending) {
+                next = i;
+                break;
+            }
+        }
+
+        // Nothing queued: back up the shard that has been running longest
+        if (next < 0) {
+            qint64 longest = kBackupAfterMs;
+            for (int i = 0; i < m_shards.size(); ++i) {
+                const Shard &shard = m_shards[i];
+                if (shard.state == Shard::Running && shard.workers.size() == 1 && shard.started.elapsed() > longest) {
+                    longest = shard.started.elapsed();
+                    next = i;
+                }
+            }
+        }
+        if (next < 0)
+            return;
+
+        assign(it.key(), next);
+    }
+}
+
+void ScanCoordinator::assign(int workerId, int shardId)
+{
+    Worker &worker = m_workers[workerId];
+    Shard &shard = m_shards[shardId];
+
+    // The subnet budget is for the whole sweep, and shards of one subnet may
+    // run on every worker at once
+    const int workers = qMax(1, workerCount());
+    const int subnetRate = m_subnetRate > 0 ? qMax(1, m_subnetRate / workers) : 0;
+
+    QJsonArray targets;
+    for (const QString &target : std::as_const(shard.targets))
+        targets.append(target);
+    ScanProtocol::send(worker.socket, {{"type", "shard"}, {"shard", shardId}, {"targets", targets},
+                                       {"ports", m_portRange}, {"threads", m_threadsPerWorker},
+                                       {"hostRate", m_hostRate}, {"subnetRate", subnetRate}});
+
+    if (shard.state == Shard::Pending) {
+        shard.state = Shard::Running;
+        shard.started.start();
+    } else {
+        qDebug() << "Backing up shard" << shardId << "on" << worker.name;
+    }
+    shard.workers.insert(workerId);
+    worker.shard = shardId;
+    worker.lastSeen.restart();
+}
+
+void ScanCoordinator::release(int workerId)
+{
+    auto it = m_workers.find(workerId);
+    if (it == m_workers.end() || it->shard < 0)
+        return;
+    if (it->shard < m_shards.size())
+        m_shards[it->shard].workers.remove(workerId);
+    it->shard = -1;
+}
+
+void ScanCoordinator::checkWorkers()
+{
+    // Progress messages double as heartbeats; a busy worker that has gone
+    // quiet is cut off and its shard goes back to the queue
+    QList<QIODevice *> stale;
+    for (const Worker &worker : std::as_const(m_workers)) {
+        const bool silent = worker.lastSeen.elapsed() > kStallMs;
+        if (silent && (worker.shard >= 0 || !worker.ready))
+            stale << worker.socket;
+    }
+    for (QIODevice *socket : stale) {
+        qWarning() << "Worker stalled, reassigning its shard";
+        socket->close();
+    }
+
+    updateProgress();
+    dispatch();
+
+    if (!m_isScanning && m_workers.isEmpty())
+        m_watchdog->stop();
+}
+
+void ScanCoordinator::updateProgress()
+{
+    if (!m_isScanning || m_totalHosts == 0)
+        return;
+
+    qint64 done = 0;
+    for (const Shard &shard : std::as_const(m_shards))
+        done += qint64(shard.hosts) * shard.percent;
+    const int progress = qMin<int>(99, int(done / m_totalHosts));
+    if (progress != m_progress) {
+        m_progress = progress;
+        emit progressChanged();
+    }
+}
+
+void ScanCoordinator::finishScan()
+{
+    m_isScanning = false;
+    m_progress = 100;
+    qDebug() << "Distributed scan completed. Found" << m_hostsFound << "hosts with" << m_portsFound << "open ports";
+
+    emit isScanningChanged();
+    emit progressChanged();
+    emit scanCompleted();
+}
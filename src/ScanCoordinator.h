@@ -0,0 +1,121 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+class QIODevice;
+class QTcpServer;
+class QLocalServer;
+
+// Splits a sweep into shards of a few dozen hosts and hands them to
+// ScanWorker instances connected over TCP or a local socket, one shard per
+// worker at a time. Results stream back and are re-emitted with the same
+// signals as NetworkScanner, so views take either. A dead worker's shard
+// is queued again; once the queue is empty, idle workers also take a
+// backup copy of the longest-running shard, and whichever copy finishes
+// first wins, so a slow worker never holds up the end of a sweep.
+class ScanCoordinator : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool isScanning READ isScanning NOTIFY isScanningChanged)
+    Q_PROPERTY(int progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(int hostsFound READ hostsFound NOTIFY hostsFoundChanged)
+    Q_PROPERTY(int portsFound READ portsFound NOTIFY portsFoundChanged)
+    Q_PROPERTY(int workerCount READ workerCount NOTIFY workersChanged)
+    Q_PROPERTY(QString token READ token WRITE setToken NOTIFY tokenChanged)
+
+public:
+    explicit ScanCoordinator(QObject *parent = nullptr);
+    ~ScanCoordinator();
+
+    bool isScanning() const { return m_isScanning; }
+    int progress() const { return m_progress; }
+    int hostsFound() const { return m_hostsFound; }
+    int portsFound() const { return m_portsFound; }
+    int workerCount() const;
+    QString token() const { return m_token; }
+    void setToken(const QString &token);
+
+    // Per-subnet probe budget for the whole sweep, split across the workers
+    void setRateLimits(int hostRate, int subnetRate);
+
+    // "local:<name>", "host:port" or ":port"; may be called for several addresses
+    Q_INVOKABLE bool listen(const QString &address);
+
+public slots:
+    void startScan(const QString &network, const QString &portRange, int threadsPerWorker);
+    void stopScan();
+
+signals:
+    void isScanningChanged();
+    void progressChanged();
+    void hostsFoundChanged();
+    void portsFoundChanged();
+    void workersChanged();
+    void tokenChanged();
+    void hostDiscovered(const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports,
+                        const QList<int> &udpPorts);
+    void workerJoined(const QString &name);
+    void workerLost(const QString &name);
+    void shardRequeued(int shard, const QString &worker);
+    void scanStarted(const QString &network, const QString &ports);
+    void scanCompleted();
+    void scanFailed(const QString &error);
+
+private:
+    struct Shard {
+        enum State { Pending, Running, Done };
+
+        QStringList targets;
+        int hosts = 0;
+        State state = Pending;
+        QSet<int> workers;      // more than one while a backup copy runs
+        QElapsedTimer started;
+        int percent = 0;        // best progress reported by any copy
+    };
+
+    struct Worker {
+        QIODevice *socket = nullptr;
+        QString name;
+        bool ready = false;     // hello accepted
+        int shard = -1;
+        QElapsedTimer lastSeen;
+    };
+
+    void addWorker(QIODevice *socket);
+    void onReadyRead(int workerId);
+    void onDisconnected(int workerId);
+    void handleMessage(int workerId, const QJsonObject &message);
+    void dispatch();
+    void assign(int workerId, int shardId);
+    void release(int workerId);
+    void checkWorkers();
+    void updateProgress();
+    void finishScan();
+
+    QList<QTcpServer *> m_tcpServers;
+    QList<QLocalServer *> m_localServers;
+    QHash<int, Worker> m_workers;
+    int m_nextWorkerId;
+    QString m_token;
+
+    QVector<Shard> m_shards;
+    QSet<QString> m_reported;   // hosts already emitted, so backup copies don't repeat them
+    QString m_portRange;
+    int m_threadsPerWorker;
+    int m_hostRate;
+    int m_subnetRate;
+    int m_totalHosts;
+
+    bool m_isScanning;
+    int m_progress;
+    int m_hostsFound;
+    int m_portsFound;
+    QTimer *m_watchdog;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+// Coordinator <-> worker wire format: one compact JSON object per line over
+// a TCP or local socket, each with a "type".
+//
+//   worker -> coordinator   hello {version, token, worker}
+//                           host {shard, ip, hostname, mac, tcp, udp}
+//                           progress {shard, percent}   (doubles as heartbeat)
+//                           done {shard}
+//   coordinator -> worker   shard {shard, targets, ports, threads, hostRate, subnetRate}
+//                           cancel {shard}
+namespace ScanProtocol {
+
+const int Version = 1;
+const quint16 DefaultPort = 47800;
+const qint64 MaxLineBytes = 4 * 1024 * 1024;
+
+// "local:<name>" for a local socket, otherwise "host:port", ":port" or "host"
+struct Endpoint {
+    bool local = false;
+    QString name; // local socket name, or host for TCP
+    quint16 port = DefaultPort;
+
+    static Endpoint parse(const QString &address)
+    {
+        Endpoint endpoint;
+        if (address.startsWith("local:")) {
+            endpoint.local = true;
+            endpoint.name = address.mid(6);
+            return endpoint;
+        }
+
+        // IPv6 literals are written "[addr]:port"
+        const int colon = address.lastIndexOf(':');
+        const bool hasPort = colon >= 0 && (address.count(':') == 1 || address.at(colon - 1) == ']');
+        endpoint.name = hasPort ? address.left(colon) : address;
+        endpoint.name.remove('[').remove(']');
+        if (hasPort)
+            endpoint.port = quint16(address.mid(colon + 1).toUInt());
+        return endpoint;
+    }
+};
+
+inline void send(QIODevice *device, const QJsonObject &message)
+{
+    device->write(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    device->write("\n");
+}
+
+// Complete lines only; a partial line waits in the socket buffer. False
+// when the peer sends a line too long to be ours, and should be dropped.
+inline bool receive(QIODevice *device, QList<QJsonObject> *messages)
+{
+    while (device->canReadLine()) {
+        const QJsonDocument document = QJsonDocument::fromJson(device->readLine(MaxLineBytes));
+        if (document.isObject())
+            messages->append(document.object());
+    }
+    return device->bytesAvailable() < MaxLineBytes;
+}
+
+inline QJsonArray toArray(const QList<int> &values)
+{
+    QJsonArray array;
+    for (int value : values)
+        array.append(value);
+    return array;
+}
+
+inline QList<int> toIntList(const QJsonArray &array)
+{
+    QList<int> values;
+    for (const QJsonValue &value : array)
+        values << value.toInt();
+    return values;
+}
+}
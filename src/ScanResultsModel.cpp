@@ -1,40 +1,55 @@
 #include "ScanResultsModel.h"
+#include "Metrics.h"
 #include <QDebug>
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+QVariant portsToVariant(const QList<int> &tcp, const QList<int> &udp)
+{
+    QVariantList list;
+    list.reserve(tcp.size() + udp.size());
+    for (int port : tcp)
+        list.append(port);
+    for (int port : udp)
+        list.append(QString("%1/udp").arg(port));
+    return QVariant(list);
+}
+}
 
 ScanResultsModel::ScanResultsModel(QObject *parent)
     : QAbstractListModel(parent)
+    , m_ipRangeActive(false)
+    , m_sortRole(IpRole)
+    , m_sortOrder(Qt::AscendingOrder)
 {
 }
 
 int ScanResultsModel::rowCount(const QModelIndex &parent) const
 {
-    Q_UNUSED(parent)
-    return m_results.size();
+    if (parent.isValid())
+        return 0;
+    return m_rows.size();
 }
 
 QVariant ScanResultsModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_results.size())
+    if (!index.isValid() || index.row() >= m_rows.size())
         return QVariant();
 
-    const ScanResult &result = m_results[index.row()];
+    const int source = m_rows[index.row()];
 
     switch (role) {
     case IpRole:
-        return result.ip;
+        return m_columns.ip[source];
     case HostnameRole:
-        return result.hostname;
-    case MacRole:{
-        return result.mac;
-    }
-    case PortsRole: {
-        QVariantList list;
-        for (int port : result.ports)
-            list.append(port);
-        return list;
-    }
+        return m_columns.hostname[source];
+    case MacRole:
+        return m_columns.mac[source];
+    case PortsRole:
+        return m_columns.portsVariant[source];
     case StatusRole:
-        return result.status;
+        return m_columns.status[source];
     }
 
     return QVariant();
@@ -51,26 +66,430 @@ QHash<int, QByteArray> ScanResultsModel::roleNames() const
     return roles;
 }
 
-void ScanResultsModel::addResult(const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports)
+void ScanResultsModel::addResult(const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports,
+                                 const QList<int> &udpPorts)
+{
+    traceDebug() << "Adding result:" << ip << "with" << ports.size() << "ports:" << ports << "UDP:" << udpPorts;
+    upsertResults({ScanResult{ip, hostname, mac, ports, udpPorts}});
+}
+
+void ScanResultsModel::addResults(const QVariantList &results)
+{
+    QList<ScanResult> batch;
+    batch.reserve(results.size());
+    for (const QVariant &entry : results) {
+        const QVariantMap map = entry.toMap();
+        ScanResult result;
+        result.ip = map.value("ip").toString();
+        result.hostname = map.value("hostname").toString();
+        result.mac = map.value("mac").toString();
+        const QVariantList ports = map.value("ports").toList();
+        for (const QVariant &port : ports)
+            result.ports.append(port.toInt());
+        const QVariantList udpPorts = map.value("udpPorts").toList();
+        for (const QVariant &port : udpPorts)
+            result.udpPorts.append(port.toInt());
+        batch.append(result);
+    }
+    upsertResults(batch);
+}
+
+void ScanResultsModel::upsertResults(const QList<ScanResult> &results)
+{
+    Metrics::record(Metrics::UiBatch, quint64(results.size()));
+    const int firstNew = m_columns.size();
+    QVector<int> added;
+
+    for (const ScanResult &result : results) {
+        if (result.ip.isEmpty())
+            continue;
+
+        auto it = m_sourceByIp.constFind(result.ip);
+        if (it == m_sourceByIp.constEnd()) {
+            added.append(appendColumns(result));
+        } else if (it.value() >= firstNew) {
+            // Repeated within this batch and not visible yet
+            updateColumns(it.value(), result);
+        } else {
+            updateRow(it.value(), result);
+        }
+    }
+
+    added.erase(std::remove_if(added.begin(), added.end(),
+                               [this](int source) { return !acceptsRow(source); }),
+                added.end());
+    insertSorted(added);
+
+    if (m_columns.size() != firstNew || !added.isEmpty())
+        emit countChanged();
+}
+
+int ScanResultsModel::appendColumns(const ScanResult &result)
+{
+    QList<int> sortedPorts = result.ports;
+    std::sort(sortedPorts.begin(), sortedPorts.end());
+    QList<int> sortedUdpPorts = result.udpPorts;
+    std::sort(sortedUdpPorts.begin(), sortedUdpPorts.end());
+
+    const int source = m_columns.size();
+    m_columns.ip.append(result.ip);
+    m_columns.address.append(IpAddress::fromString(result.ip));
+    m_columns.hostname.append(result.hostname);
+    m_columns.mac.append(result.mac);
+    m_columns.ports.append(sortedPorts);
+    m_columns.udpPorts.append(sortedUdpPorts);
+    m_columns.portsVariant.append(portsToVariant(sortedPorts, sortedUdpPorts));
+    m_columns.status.append(QStringLiteral("online"));
+    m_sourceByIp.insert(result.ip, source);
+    return source;
+}
+
+QList<int> ScanResultsModel::updateColumns(int source, const ScanResult &result)
+{
+    QList<int> roles;
+
+    // A rescan that failed to resolve a name or MAC keeps the known one
+    if (!result.hostname.isEmpty() && result.hostname != m_columns.hostname[source]) {
+        m_columns.hostname[source] = result.hostname;
+        roles.append(HostnameRole);
+    }
+    if (!result.mac.isEmpty() && result.mac != m_columns.mac[source]) {
+        m_columns.mac[source] = result.mac;
+        roles.append(MacRole);
+    }
+
+    QList<int> sortedPorts = result.ports;
+    std::sort(sortedPorts.begin(), sortedPorts.end());
+    QList<int> sortedUdpPorts = result.udpPorts;
+    std::sort(sortedUdpPorts.begin(), sortedUdpPorts.end());
+    if (sortedPorts != m_columns.ports[source] || sortedUdpPorts != m_columns.udpPorts[source]) {
+        m_columns.ports[source] = sortedPorts;
+        m_columns.udpPorts[source] = sortedUdpPorts;
+        m_columns.portsVariant[source] = portsToVariant(sortedPorts, sortedUdpPorts);
+        roles.append(PortsRole);
+    }
+
+    if (m_columns.status[source] != QLatin1String("online")) {
+        m_columns.status[source] = QStringLiteral("online");
+        roles.append(StatusRole);
+    }
+
+    return roles;
+}
+
+void ScanResultsModel::updateRow(int source, const ScanResult &result)
+{
+    // Visible rows are exactly the accepted ones, so locate the row before
+    // the sort key changes underneath the binary search
+    const bool wasVisible = acceptsRow(source);
+    const int oldRow = wasVisible ? rowOfSource(source) : -1;
+
+    const QList<int> roles = updateColumns(source, result);
+    if (roles.isEmpty())
+        return;
+
+    const bool visible = acceptsRow(source);
+    if (wasVisible && !visible) {
+        beginRemoveRows(QModelIndex(), oldRow, oldRow);
+        m_rows.removeAt(oldRow);
+        endRemoveRows();
+        emit countChanged();
+    } else if (!wasVisible && visible) {
+        const int row = insertPosition(source);
+        beginInsertRows(QModelIndex(), row, row);
+        m_rows.insert(row, source);
+        endInsertRows();
+        emit countChanged();
+    } else if (visible) {
+        m_rows.removeAt(oldRow);
+        const int newRow = insertPosition(source);
+        m_rows.insert(oldRow, source);
+
+        if (newRow != oldRow) {
+            beginMoveRows(QModelIndex(), oldRow, oldRow, QModelIndex(), newRow > oldRow ? newRow + 1 : newRow);
+            m_rows.removeAt(oldRow);
+            m_rows.insert(newRow, source);
+            endMoveRows();
+        }
+
+        const QModelIndex changed = index(newRow);
+        emit dataChanged(changed, changed, roles);
+    }
+}
+
+int ScanResultsModel::rowOfSource(int source) const
 {
-    beginInsertRows(QModelIndex(), m_results.size(), m_results.size());
-    
-    ScanResult result;
-    result.ip = ip;
-    result.hostname = hostname;
-    result.mac = mac;
-    result.ports = ports;
-    result.status = "online";
-    
-    qDebug() << "Adding result:" << ip << "with" << ports.size() << "ports:" << ports;
-    
-    m_results.append(result);
-    endInsertRows();
+    auto it = std::lower_bound(m_rows.cbegin(), m_rows.cend(), source,
+                               [this](int a, int b) { return lessThan(a, b); });
+    return (it != m_rows.cend() && *it == source) ? int(it - m_rows.cbegin()) : -1;
 }
 
 void ScanResultsModel::clear()
 {
     beginResetModel();
-    m_results.clear();
+    m_columns = ScanResultColumns();
+    m_rows.clear();
+    m_sourceByIp.clear();
     endResetModel();
+    emit countChanged();
+}
+
+void ScanResultsModel::setIpFilter(const QString &filter)
+{
+    const QString trimmed = filter.trimmed();
+    if (trimmed == m_ipFilter)
+        return;
+    m_ipFilter = trimmed;
+
+    // Accepts a CIDR block, "first-last", "a.b.c.N-M" or a single address of
+    // either family; anything else is matched as a text prefix while the user is typing
+    m_ipRangeActive = false;
+    if (trimmed.contains('/')) {
+        const IpSubnet subnet = IpSubnet::parse(trimmed);
+        if (subnet.isValid()) {
+            m_ipLow = subnet.network;
+            m_ipHigh = subnet.last();
+            m_ipRangeActive = true;
+        }
+    } else if (trimmed.contains('-')) {
+        const QString first = trimmed.section('-', 0, 0).trimmed();
+        QString last = trimmed.section('-', 1).trimmed();
+        if (!last.contains('.') && !last.contains(':'))
+            last = first.section('.', 0, 2) + '.' + last;
+        m_ipLow = IpAddress::fromString(first);
+        m_ipHigh = IpAddress::fromString(last);
+        m_ipRangeActive = m_ipLow.isValid() && m_ipHigh.family() == m_ipLow.family() && m_ipHigh >= m_ipLow;
+    } else {
+        const IpAddress single = IpAddress::fromString(trimmed);
+        if (single.isValid()) {
+            m_ipLow = m_ipHigh = single;
+            m_ipRangeActive = true;
+        }
+    }
+
+    refilter();
+    emit filterChanged();
+}
+
+void ScanResultsModel::setPortFilter(const QString &filter)
+{
+    const QString trimmed = filter.trimmed();
+    if (trimmed == m_portFilter)
+        return;
+    m_portFilter = trimmed;
+
+    // "22, 80, 8000-8100"
+    m_portRanges.clear();
+    const QStringList parts = trimmed.split(QRegularExpression("[,\\s]+"), Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        bool okFirst = false;
+        bool okLast = false;
+        const int first = part.section('-', 0, 0).toInt(&okFirst);
+        const int last = part.contains('-') ? part.section('-', 1).toInt(&okLast) : first;
+        if (okFirst && (okLast || !part.contains('-')) && last >= first)
+            m_portRanges.append({first, last});
+    }
+
+    refilter();
+    emit filterChanged();
+}
+
+void ScanResultsModel::setStatusFilter(const QString &filter)
+{
+    const QString trimmed = filter.trimmed();
+    if (trimmed == m_statusFilter)
+        return;
+    m_statusFilter = trimmed;
+    refilter();
+    emit filterChanged();
+}
+
+void ScanResultsModel::setHostnameFilter(const QString &filter)
+{
+    const QString trimmed = filter.trimmed();
+    if (trimmed == m_hostnameFilter)
+        return;
+    m_hostnameFilter = trimmed;
+    refilter();
+    emit filterChanged();
+}
+
+void ScanResultsModel::setSortRole(int role)
+{
+    if (role == m_sortRole)
+        return;
+    m_sortRole = role;
+    resort();
+    emit sortChanged();
+}
+
+void ScanResultsModel::setSortOrder(Qt::SortOrder order)
+{
+    if (order == m_sortOrder)
+        return;
+    m_sortOrder = order;
+    resort();
+    emit sortChanged();
+}
+
+bool ScanResultsModel::acceptsRow(int source) const
+{
+    if (m_ipRangeActive) {
+        const IpAddress &ip = m_columns.address[source];
+        if (ip.family() != m_ipLow.family() || ip < m_ipLow || ip > m_ipHigh)
+            return false;
+    } else if (!m_ipFilter.isEmpty() && !m_columns.ip[source].startsWith(m_ipFilter)) {
+        return false;
+    }
+
+    if (!m_portRanges.isEmpty()) {
+        bool matched = false;
+        for (const QList<int> *ports : {&m_columns.ports[source], &m_columns.udpPorts[source]}) {
+            for (const PortRange &range : m_portRanges) {
+                auto it = std::lower_bound(ports->cbegin(), ports->cend(), range.first);
+                if (it != ports->cend() && *it <= range.last) {
+                    matched = true;
+                    break;
+                }
+            }
+        }
+        if (!matched)
+            return false;
+    }
+
+    if (!m_statusFilter.isEmpty()
+        && m_columns.status[source].compare(m_statusFilter, Qt::CaseInsensitive) != 0)
+        return false;
+
+    if (!m_hostnameFilter.isEmpty()
+        && !m_columns.hostname[source].contains(m_hostnameFilter, Qt::CaseInsensitive))
+        return false;
+
+    return true;
+}
+
+bool ScanResultsModel::lessThan(int left, int right) const
+{
+    int order = 0;
+
+    switch (m_sortRole) {
+    case IpRole: {
+        const IpAddress &a = m_columns.address[left];
+        const IpAddress &b = m_columns.address[right];
+        if (a.isValid() && b.isValid())
+            order = a < b ? -1 : (b < a ? 1 : 0); // IPv4 before IPv6
+        else if (a.isValid() || b.isValid())
+            order = a.isValid() ? -1 : 1; // addresses before anything unparsed
+        else
+            order = m_columns.ip[left].compare(m_columns.ip[right]);
+        break;
+    }
+    case HostnameRole:
+        order = m_columns.hostname[left].compare(m_columns.hostname[right], Qt::CaseInsensitive);
+        break;
+    case MacRole:
+        order = m_columns.mac[left].compare(m_columns.mac[right], Qt::CaseInsensitive);
+        break;
+    case PortsRole:
+        order = (m_columns.ports[left].size() + m_columns.udpPorts[left].size())
+              - (m_columns.ports[right].size() + m_columns.udpPorts[right].size());
+        break;
+    case StatusRole:
+        order = m_columns.status[left].compare(m_columns.status[right], Qt::CaseInsensitive);
+        break;
+    }
+
+    if (m_sortOrder == Qt::DescendingOrder)
+        order = -order;
+
+    // Discovery order breaks ties so equal keys stay stable
+    return order != 0 ? order < 0 : left < right;
+}
+
+int ScanResultsModel::insertPosition(int source) const
+{
+    auto it = std::upper_bound(m_rows.cbegin(), m_rows.cend(), source,
+                               [this](int a, int b) { return lessThan(a, b); });
+    return int(it - m_rows.cbegin());
+}
+
+void ScanResultsModel::refilter()
+{
+    // Diff against the visible rows so views only see the rows that changed
+    const int total = m_columns.size();
+    QVector<bool> accepted(total);
+    QVector<bool> visible(total, false);
+    for (int source = 0; source < total; ++source)
+        accepted[source] = acceptsRow(source);
+    for (int source : std::as_const(m_rows))
+        visible[source] = true;
+
+    // Remove rejected rows in contiguous runs, back to front
+    for (int row = m_rows.size() - 1; row >= 0; ) {
+        if (accepted[m_rows[row]]) {
+            --row;
+            continue;
+        }
+        const int last = row;
+        while (row >= 0 && !accepted[m_rows[row]])
+            --row;
+        beginRemoveRows(QModelIndex(), row + 1, last);
+        m_rows.remove(row + 1, last - row);
+        endRemoveRows();
+    }
+
+    QVector<int> added;
+    for (int source = 0; source < total; ++source) {
+        if (accepted[source] && !visible[source])
+            added.append(source);
+    }
+    insertSorted(added);
+
+    emit countChanged();
+}
+
+void ScanResultsModel::insertSorted(QVector<int> sources)
+{
+    std::sort(sources.begin(), sources.end(), [this](int a, int b) { return lessThan(a, b); });
+
+    // Merge the newly accepted rows in, one insert per contiguous run
+    int row = 0;
+    for (int i = 0; i < sources.size(); ) {
+        while (row < m_rows.size() && lessThan(m_rows[row], sources[i]))
+            ++row;
+        int end = i + 1;
+        while (end < sources.size() && (row >= m_rows.size() || lessThan(sources[end], m_rows[row])))
+            ++end;
+        beginInsertRows(QModelIndex(), row, row + end - i - 1);
+        m_rows.insert(row, end - i, 0);
+        std::copy(sources.cbegin() + i, sources.cbegin() + end, m_rows.begin() + row);
+        endInsertRows();
+        row += end - i;
+        i = end;
+    }
+}
+
+void ScanResultsModel::resort()
+{
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+
+    const QModelIndexList persistent = persistentIndexList();
+    QVector<int> persistentSources;
+    persistentSources.reserve(persistent.size());
+    for (const QModelIndex &index : persistent)
+        persistentSources.append(m_rows[index.row()]);
+
+    std::sort(m_rows.begin(), m_rows.end(), [this](int a, int b) { return lessThan(a, b); });
+
+    QVector<int> rowOf(m_columns.size(), -1);
+    for (int row = 0; row < m_rows.size(); ++row)
+        rowOf[m_rows[row]] = row;
+
+    QModelIndexList updated;
+    updated.reserve(persistent.size());
+    for (int i = 0; i < persistent.size(); ++i)
+        updated.append(index(rowOf[persistentSources[i]], persistent[i].column()));
+    changePersistentIndexList(persistent, updated);
+
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
 }
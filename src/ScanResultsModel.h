@@ -2,19 +2,43 @@
 
 #include <QAbstractListModel>
 #include <QQmlEngine>
+#include <QVector>
+#include "IpAddress.h"
 
 struct ScanResult {
     QString ip;
     QString hostname;
     QString mac;
     QList<int> ports;
-    QString status;
+    QList<int> udpPorts;
+};
+
+// Column-per-field storage; rows are indices shared by every column
+struct ScanResultColumns {
+    QVector<QString> ip;
+    QVector<IpAddress> address; // numeric key for sorting and range filters, invalid if unparsed
+    QVector<QString> hostname;
+    QVector<QString> mac;
+    QVector<QList<int>> ports;  // sorted ascending
+    QVector<QList<int>> udpPorts; // sorted ascending
+    QVector<QVariant> portsVariant; // converted once for QML; UDP entries read "53/udp"
+    QVector<QString> status;
+
+    int size() const { return ip.size(); }
 };
 
 class ScanResultsModel : public QAbstractListModel
 {
     Q_OBJECT
     QML_ELEMENT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY countChanged)
+    Q_PROPERTY(QString ipFilter READ ipFilter WRITE setIpFilter NOTIFY filterChanged)
+    Q_PROPERTY(QString portFilter READ portFilter WRITE setPortFilter NOTIFY filterChanged)
+    Q_PROPERTY(QString statusFilter READ statusFilter WRITE setStatusFilter NOTIFY filterChanged)
+    Q_PROPERTY(QString hostnameFilter READ hostnameFilter WRITE setHostnameFilter NOTIFY filterChanged)
+    Q_PROPERTY(int sortRole READ sortRole WRITE setSortRole NOTIFY sortChanged)
+    Q_PROPERTY(Qt::SortOrder sortOrder READ sortOrder WRITE setSortOrder NOTIFY sortChanged)
 
 public:
     enum Roles {
@@ -24,6 +48,7 @@ public:
         PortsRole,
         StatusRole
     };
+    Q_ENUM(Roles)
 
     explicit ScanResultsModel(QObject *parent = nullptr);
 
@@ -31,10 +56,69 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
+    int count() const { return m_rows.size(); }
+    int totalCount() const { return m_columns.size(); }
+
+    QString ipFilter() const { return m_ipFilter; }
+    QString portFilter() const { return m_portFilter; }
+    QString statusFilter() const { return m_statusFilter; }
+    QString hostnameFilter() const { return m_hostnameFilter; }
+    int sortRole() const { return m_sortRole; }
+    Qt::SortOrder sortOrder() const { return m_sortOrder; }
+
+    void setIpFilter(const QString &filter);
+    void setPortFilter(const QString &filter);
+    void setStatusFilter(const QString &filter);
+    void setHostnameFilter(const QString &filter);
+    void setSortRole(int role);
+    void setSortOrder(Qt::SortOrder order);
+
+    // Inserts new hosts in one sorted merge and updates known ones in place
+    void upsertResults(const QList<ScanResult> &results);
+
 public slots:
-    void addResult(const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports);
+    void addResult(const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports,
+                   const QList<int> &udpPorts = QList<int>());
+    void addResults(const QVariantList &results);
     void clear();
 
+signals:
+    void countChanged();
+    void filterChanged();
+    void sortChanged();
+
 private:
-    QList<ScanResult> m_results;
+    struct PortRange {
+        int first;
+        int last;
+    };
+
+    int appendColumns(const ScanResult &result);
+    QList<int> updateColumns(int source, const ScanResult &result);
+    void updateRow(int source, const ScanResult &result);
+    int rowOfSource(int source) const;
+    void insertSorted(QVector<int> sources);
+    bool acceptsRow(int source) const;
+    bool lessThan(int left, int right) const;
+    int insertPosition(int source) const;
+    void refilter();
+    void resort();
+
+    ScanResultColumns m_columns;
+    QVector<int> m_rows; // visible rows in sort order, as indices into m_columns
+    QHash<QString, int> m_sourceByIp; // ip -> index into m_columns
+
+    QString m_ipFilter;
+    QString m_portFilter;
+    QString m_statusFilter;
+    QString m_hostnameFilter;
+
+    // Parsed filter state, rebuilt when a filter string changes
+    IpAddress m_ipLow;
+    IpAddress m_ipHigh;
+    bool m_ipRangeActive;
+    QVector<PortRange> m_portRanges;
+
+    int m_sortRole;
+    Qt::SortOrder m_sortOrder;
 };
@@ -0,0 +1,165 @@
+#include "ScanWorker.h"
+#include "ScanProtocol.h"
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QDebug>
+
+namespace {
+const int kRetryMs = 3000;
+}
+
+ScanWorker::ScanWorker(const QString &name, QObject *parent)
+    : QObject(parent)
+    , m_socket(nullptr)
+    , m_name(name)
+    , m_shard(-1)
+    , m_shardHosts(0)
+    , m_cancelling(false)
+{
+    // Shards are tracked by the coordinator; nothing to resume locally
+    m_scanner.setCheckpointsEnabled(false);
+
+    m_retry = new QTimer(this);
+    m_retry->setSingleShot(true);
+    m_retry->setInterval(kRetryMs);
+    connect(m_retry, &QTimer::timeout, this, &ScanWorker::openSocket);
+
+    connect(&m_scanner, &NetworkScanner::hostDiscovered, this,
+            [this](const QString &ip, const QString &hostname, const QString &mac, const QList<int> &ports,
+                   const QList<int> &udpPorts) {
+        if (m_shard < 0 || m_cancelling)
+            return;
+        ++m_shardHosts;
+        send({{"type", "host"}, {"shard", m_shard}, {"ip", ip}, {"hostname", hostname}, {"mac", mac},
+              {"tcp", ScanProtocol::toArray(ports)}, {"udp", ScanProtocol::toArray(udpPorts)}});
+    });
+
+    // The scanner reports every 500 ms, which also serves as the heartbeat
+    connect(&m_scanner, &NetworkScanner::progressChanged, this, [this]() {
+        if (m_shard < 0 || m_cancelling)
+            return;
+        send({{"type", "progress"}, {"shard", m_shard}, {"percent", m_scanner.progress()}});
+    });
+
+    connect(&m_scanner, &NetworkScanner::scanCompleted, this, [this]() {
+        const int shard = m_shard;
+        if (shard < 0)
+            return;
+        if (!m_cancelling) {
+            send({{"type", "done"}, {"shard", shard}});
+            qDebug() << "Shard" << shard << "done," << m_shardHosts << "hosts up";
+            emit shardFinished(shard, m_shardHosts);
+        }
+        m_shard = -1;
+        m_cancelling = false;
+    });
+}
+
+void ScanWorker::connectTo(const QString &address, const QString &token)
+{
+    m_address = address;
+    m_token = token;
+    openSocket();
+}
+
+void ScanWorker::openSocket()
+{
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->deleteLater();
+        m_socket = nullptr;
+    }
+
+    const ScanProtocol::Endpoint endpoint = ScanProtocol::Endpoint::parse(m_address);
+    if (endpoint.local) {
+        auto *socket = new QLocalSocket(this);
+        connect(socket, &QLocalSocket::connected, this, &ScanWorker::onConnected);
+        connect(socket, &QLocalSocket::disconnected, this, &ScanWorker::onDisconnected);
+        connect(socket, &QLocalSocket::errorOccurred, this, [this]() {
+            if (!m_retry->isActive())
+                m_retry->start();
+        });
+        m_socket = socket;
+        connect(socket, &QIODevice::readyRead, this, &ScanWorker::onReadyRead);
+        socket->connectToServer(endpoint.name);
+    } else {
+        auto *socket = new QTcpSocket(this);
+        connect(socket, &QTcpSocket::connected, this, &ScanWorker::onConnected);
+        connect(socket, &QTcpSocket::disconnected, this, &ScanWorker::onDisconnected);
+        connect(socket, &QTcpSocket::errorOccurred, this, [this]() {
+            if (!m_retry->isActive())
+                m_retry->start();
+        });
+        m_socket = socket;
+        connect(socket, &QIODevice::readyRead, this, &ScanWorker::onReadyRead);
+        socket->connectToHost(endpoint.name.isEmpty() ? QString("127.0.0.1") : endpoint.name, endpoint.port);
+    }
+}
+
+void ScanWorker::onConnected()
+{
+    qDebug() << "Worker" << m_name << "connected to" << m_address;
+    send({{"type", "hello"}, {"version", ScanProtocol::Version}, {"token", m_token}, {"worker", m_name}});
+    emit connected();
+}
+
+void ScanWorker::onDisconnected()
+{
+    // The coordinator requeues whatever we held; stop and wait for it to return
+    if (m_shard >= 0) {
+        m_cancelling = true;
+        m_scanner.stopScan();
+    }
+    qDebug() << "Worker" << m_name << "lost the coordinator, retrying";
+    emit disconnected();
+    m_retry->start();
+}
+
+void ScanWorker::onReadyRead()
+{
+    QList<QJsonObject> messages;
+    if (!ScanProtocol::receive(m_socket, &messages)) {
+        m_socket->close();
+        return;
+    }
+
+    for (const QJsonObject &message : std::as_const(messages)) {
+        const QString type = message.value("type").toString();
+        if (type == "shard") {
+            startShard(message);
+        } else if (type == "cancel" && message.value("shard").toInt() == m_shard) {
+            qDebug() << "Shard" << m_shard << "cancelled by the coordinator";
+            m_cancelling = true;
+            m_scanner.stopScan();
+        }
+    }
+}
+
+void ScanWorker::startShard(const QJsonObject &message)
+{
+    if (m_shard >= 0) {
+        // Coordinator sends one shard at a time; a second one replaces the first
+        m_cancelling = true;
+        m_scanner.stopScan();
+    }
+
+    QStringList targets;
+    for (const QJsonValue &target : message.value("targets").toArray())
+        targets << target.toString();
+
+    m_shard = message.value("shard").toInt();
+    m_shardHosts = 0;
+    m_cancelling = false;
+    m_scanner.setHostRateLimit(message.value("hostRate").toInt(m_scanner.hostRateLimit()));
+    m_scanner.setSubnetRateLimit(message.value("subnetRate").toInt(m_scanner.subnetRateLimit()));
+
+    qDebug() << "Shard" << m_shard << ":" << targets.size() << "targets";
+    emit shardStarted(m_shard, targets.size());
+    m_scanner.startScan(targets.join(','), message.value("ports").toString(), message.value("threads").toInt(50));
+}
+
+void ScanWorker::send(const QJsonObject &message)
+{
+    if (m_socket && m_socket->isOpen())
+        ScanProtocol::send(m_socket, message);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include "NetworkScanner.h"
+
+class QIODevice;
+
+// Worker side of a distributed sweep: connects to a ScanCoordinator, runs
+// each shard it is handed on its own NetworkScanner and streams the hosts
+// back. Reconnects on its own if the coordinator goes away.
+class ScanWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScanWorker(const QString &name, QObject *parent = nullptr);
+
+    void connectTo(const QString &address, const QString &token);
+    bool isBusy() const { return m_shard >= 0; }
+
+signals:
+    void connected();
+    void disconnected();
+    void shardStarted(int shard, int targets);
+    void shardFinished(int shard, int hosts);
+
+private:
+    void openSocket();
+    void onConnected();
+    void onDisconnected();
+    void onReadyRead();
+    void startShard(const QJsonObject &message);
+    void send(const QJsonObject &message);
+
+    NetworkScanner m_scanner;
+    QIODevice *m_socket;
+    QTimer *m_retry;
+    QString m_name;
+    QString m_address;
+    QString m_token;
+    int m_shard;
+    int m_shardHosts;
+    bool m_cancelling;
+};
@@ -0,0 +1,84 @@
+#include "SecureBuffer.h"
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+qsizetype pageSize()
+{
+#ifdef Q_OS_WIN
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return sysconf(_SC_PAGESIZE);
+#endif
+}
+}
+
+SecureBuffer::SecureBuffer(qsizetype size)
+    : m_data(nullptr)
+    , m_size(size)
+    , m_capacity(0)
+    , m_locked(false)
+{
+    if (size <= 0) {
+        m_size = 0;
+        return;
+    }
+
+    // Whole pages, so unlocking one buffer never unlocks a neighbour's secret
+    qsizetype page = pageSize();
+    m_capacity = ((size + page - 1) / page) * page;
+
+#ifdef Q_OS_WIN
+    m_data = static_cast<char *>(VirtualAlloc(nullptr, m_capacity, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+    if (m_data) {
+        m_locked = VirtualLock(m_data, m_capacity);
+    }
+#else
+    void *mapped = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    m_data = mapped == MAP_FAILED ? nullptr : static_cast<char *>(mapped);
+    if (m_data) {
+        m_locked = mlock(m_data, m_capacity) == 0;
+#ifdef MADV_DONTDUMP
+        madvise(m_data, m_capacity, MADV_DONTDUMP);
+#endif
+    }
+#endif
+
+    if (!m_data) {
+        qWarning() << "SecureBuffer: allocation of" << size << "bytes failed";
+        m_size = 0;
+        m_capacity = 0;
+    } else if (!m_locked) {
+        qDebug() << "SecureBuffer: could not lock pages, secret may be swapped";
+    }
+}
+
+SecureBuffer::~SecureBuffer()
+{
+    if (!m_data) return;
+
+    wipe(m_data, m_capacity);
+
+#ifdef Q_OS_WIN
+    if (m_locked) VirtualUnlock(m_data, m_capacity);
+    VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+    if (m_locked) munlock(m_data, m_capacity);
+    munmap(m_data, m_capacity);
+#endif
+}
+
+void SecureBuffer::wipe(void *data, qsizetype size)
+{
+    // volatile stops the compiler from dropping stores to memory about to be freed
+    volatile char *p = static_cast<volatile char *>(data);
+    while (size-- > 0) *p++ = 0;
+}
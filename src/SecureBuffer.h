@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QByteArrayView>
+
+// Page-backed buffer for secret material. Pages are locked against swapping
+// where the OS allows it and are zeroed before being released.
+class SecureBuffer
+{
+public:
+    explicit SecureBuffer(qsizetype size = 0);
+    ~SecureBuffer();
+
+    SecureBuffer(const SecureBuffer &) = delete;
+    SecureBuffer &operator=(const SecureBuffer &) = delete;
+
+    char *data() { return m_data; }
+    const char *constData() const { return m_data; }
+    qsizetype size() const { return m_size; }
+    bool isLocked() const { return m_locked; }
+
+    QByteArrayView view(qsizetype offset, qsizetype length) const
+    {
+        return QByteArrayView(m_data + offset, length);
+    }
+
+    static void wipe(void *data, qsizetype size);
+
+private:
+    char *m_data;
+    qsizetype m_size;
+    qsizetype m_capacity;
+    bool m_locked;
+};
@@ -0,0 +1,122 @@
+#include "TopologyGraph.h"
+#include <QDebug>
+
+namespace {
+const QString kLocalId = QStringLiteral("local");
+
+quint64 edgeKey(int from, int to)
+{
+    // Undirected: store the pair in a fixed order
+    if (from > to)
+        std::swap(from, to);
+    return (quint64(quint32(from)) << 32) | quint32(to);
+}
+}
+
+TopologyGraph::TopologyGraph(QObject *parent)
+    : QObject(parent)
+{
+}
+
+int TopologyGraph::ensureNode(const QString &id, TopologyNode::Kind kind, const QString &label, const QString &subnet)
+{
+    auto it = m_index.constFind(id);
+    if (it != m_index.constEnd())
+        return it.value();
+
+    TopologyNode node;
+    node.id = id;
+    node.kind = kind;
+    node.label = label;
+    node.subnet = subnet;
+
+    const int index = m_nodes.size();
+    m_nodes.append(node);
+    m_index.insert(id, index);
+    emit nodeAdded(index);
+    emit changed();
+    return index;
+}
+
+int TopologyGraph::ensureLocal()
+{
+    return ensureNode(kLocalId, TopologyNode::Local, QStringLiteral("This host"), QString());
+}
+
+int TopologyGraph::ensureSubnet(const QString &cidr)
+{
+    const QString id = "subnet:" + cidr;
+    return ensureNode(id, TopologyNode::Subnet, cidr, id);
+}
+
+int TopologyGraph::ensureHost(const QString &ip, const QString &subnetCidr, const QString &os, const QString &deviceType)
+{
+    const int subnet = ensureSubnet(subnetCidr);
+    const int host = ensureNode("ip:" + ip, TopologyNode::Host, ip, m_nodes[subnet].id);
+
+    TopologyNode &node = m_nodes[host];
+    if (node.os != os || node.deviceType != deviceType) {
+        node.os = os;
+        node.deviceType = deviceType;
+        emit nodeUpdated(host);
+    }
+
+    // A hop router that also answered the sweep keeps its router role
+    if (node.kind == TopologyNode::Host)
+        addEdge(subnet, host);
+    return host;
+}
+
+bool TopologyGraph::addEdge(int from, int to)
+{
+    if (from < 0 || to < 0 || from == to)
+        return false;
+
+    const quint64 key = edgeKey(from, to);
+    if (m_edgeKeys.contains(key))
+        return false;
+
+    m_edgeKeys.insert(key);
+    m_edges.append(qMakePair(from, to));
+    emit edgeAdded(from, to);
+    emit changed();
+    return true;
+}
+
+void TopologyGraph::addPath(const QStringList &hops, const QString &subnetCidr)
+{
+    int previous = ensureLocal();
+    for (const QString &hop : hops) {
+        if (hop.isEmpty())
+            continue;
+
+        const int router = ensureNode("ip:" + hop, TopologyNode::Router, hop, QStringLiteral("routers"));
+        if (m_nodes[router].kind != TopologyNode::Router) {
+            // Seen first as a swept host, now known to forward traffic
+            m_nodes[router].kind = TopologyNode::Router;
+            emit nodeUpdated(router);
+        }
+        addEdge(previous, router);
+        previous = router;
+    }
+
+    const int subnet = ensureSubnet(subnetCidr);
+    addEdge(previous, subnet);
+    m_linkedSubnets.insert(subnet);
+}
+
+bool TopologyGraph::isSubnetLinked(const QString &cidr) const
+{
+    return m_linkedSubnets.contains(indexOf("subnet:" + cidr));
+}
+
+void TopologyGraph::clear()
+{
+    m_nodes.clear();
+    m_edges.clear();
+    m_index.clear();
+    m_edgeKeys.clear();
+    m_linkedSubnets.clear();
+    emit cleared();
+    emit changed();
+}
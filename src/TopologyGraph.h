@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QStringList>
+
+struct TopologyNode {
+    enum Kind { Local, Router, Subnet, Host };
+
+    QString id;       // "local", "subnet:<cidr>" or "ip:<address>"
+    QString label;
+    QString os;
+    QString deviceType;
+    QString subnet;   // owning subnet id, used to group nodes in the layout
+    Kind kind;
+};
+
+// Graph of this machine, hop routers, subnets and hosts. Nodes are found by
+// id through a hash, edges are deduplicated, and every addition is signalled
+// so views can grow with it instead of rebuilding.
+class TopologyGraph : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int nodeCount READ nodeCount NOTIFY changed)
+    Q_PROPERTY(int edgeCount READ edgeCount NOTIFY changed)
+
+public:
+    explicit TopologyGraph(QObject *parent = nullptr);
+
+    int nodeCount() const { return m_nodes.size(); }
+    int edgeCount() const { return m_edges.size(); }
+    const QVector<TopologyNode> &nodes() const { return m_nodes; }
+    const QVector<QPair<int, int>> &edges() const { return m_edges; }
+    int indexOf(const QString &id) const { return m_index.value(id, -1); }
+
+    int ensureLocal();
+    int ensureSubnet(const QString &cidr);
+    int ensureHost(const QString &ip, const QString &subnetCidr, const QString &os, const QString &deviceType);
+    bool addEdge(int from, int to);
+
+    // Links local -> hop 1 -> ... -> hop n -> subnet; unanswered hops are
+    // empty strings and are bridged over
+    void addPath(const QStringList &hops, const QString &subnetCidr);
+    bool isSubnetLinked(const QString &cidr) const;
+
+    Q_INVOKABLE void clear();
+
+signals:
+    void nodeAdded(int index);
+    void nodeUpdated(int index);
+    void edgeAdded(int from, int to);
+    void cleared();
+    void changed();
+
+private:
+    int ensureNode(const QString &id, TopologyNode::Kind kind, const QString &label, const QString &subnet);
+
+    QVector<TopologyNode> m_nodes;
+    QVector<QPair<int, int>> m_edges;
+    QHash<QString, int> m_index;
+    QSet<quint64> m_edgeKeys;
+    QSet<int> m_linkedSubnets; // subnets with a path back to the local node
+};
@@ -0,0 +1,668 @@
+#include "TopologyView.h"
+#include <QSGGeometryNode>
+#include <QSGFlatColorMaterial>
+#include <QSGVertexColorMaterial>
+#include <QSGTransformNode>
+#include <QMouseEvent>
+#include <QHoverEvent>
+#include <QWheelEvent>
+#include <QtMath>
+#include <cstring>
+
+namespace {
+const qreal kHostRadius = 20.0;
+const qreal kGatewayRadius = 28.0;
+const qreal kGridSpacing = 40.0;
+const qreal kCellSize = 64.0;
+const qreal kClusterSpacing = 1400.0;
+const qreal kRingOffset = 90.0;
+const qreal kSpiralStep = 42.0;
+const qreal kGoldenAngle = 2.39996323;
+const qreal kMinZoom = 0.05;
+const qreal kMaxZoom = 4.0;
+const qreal kDiscDetailZoom = 0.5; // below this nodes are drawn as single quads
+const int kDiscSegments = 12;
+
+QColor colorForDeviceType(const QString &type)
+{
+    if (type == "router" || type == "gateway") return QColor("#f59e0b");
+    if (type == "switch") return QColor("#a855f7");
+    if (type == "server") return QColor("#22c55e");
+    if (type == "printer") return QColor("#ec4899");
+    if (type == "phone" || type == "mobile") return QColor("#06b6d4");
+    if (type == "camera" || type == "iot") return QColor("#ef4444");
+    return QColor("#3b82f6");
+}
+
+QColor colorForGraphNode(const TopologyNode &node)
+{
+    switch (node.kind) {
+    case TopologyNode::Local: return QColor("#f8fafc");
+    case TopologyNode::Router: return colorForDeviceType("router");
+    case TopologyNode::Subnet: return QColor("#14b8a6");
+    case TopologyNode::Host: break;
+    }
+    return colorForDeviceType(node.deviceType);
+}
+
+qint64 cellKey(const QPointF &world)
+{
+    const qint64 cx = qFloor(world.x() / kCellSize);
+    const qint64 cy = qFloor(world.y() / kCellSize);
+    return (cx << 32) ^ (cy & 0xffffffff);
+}
+
+void setVertex(QSGGeometry::ColoredPoint2D &v, qreal x, qreal y, const QColor &c)
+{
+    // Vertex colour material expects premultiplied alpha
+    const int a = c.alpha();
+    v.set(float(x), float(y), uchar(c.red() * a / 255), uchar(c.green() * a / 255),
+          uchar(c.blue() * a / 255), uchar(a));
+}
+
+struct UnitCircle {
+    qreal cos[kDiscSegments + 1];
+    qreal sin[kDiscSegments + 1];
+    UnitCircle()
+    {
+        for (int i = 0; i <= kDiscSegments; ++i) {
+            cos[i] = qCos(2 * M_PI * i / kDiscSegments);
+            sin[i] = qSin(2 * M_PI * i / kDiscSegments);
+        }
+    }
+};
+
+void appendDisc(QVector<QSGGeometry::ColoredPoint2D> &out, const QPointF &center, qreal radius, const QColor &color)
+{
+    // Positions stream in every frame while the layout runs; skip the trig
+    static const UnitCircle circle;
+    const int first = out.size();
+    out.resize(first + kDiscSegments * 3);
+    QSGGeometry::ColoredPoint2D *v = out.data() + first;
+    for (int i = 0; i < kDiscSegments; ++i) {
+        setVertex(*v++, center.x(), center.y(), color);
+        setVertex(*v++, center.x() + radius * circle.cos[i], center.y() + radius * circle.sin[i], color);
+        setVertex(*v++, center.x() + radius * circle.cos[i + 1], center.y() + radius * circle.sin[i + 1], color);
+    }
+}
+
+QSGGeometryNode *createGeometryNode(const QSGGeometry::AttributeSet &attributes, unsigned int mode, QSGMaterial *material)
+{
+    QSGGeometryNode *node = new QSGGeometryNode;
+    QSGGeometry *geometry = new QSGGeometry(attributes, 0);
+    geometry->setDrawingMode(mode);
+    geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+    node->setGeometry(geometry);
+    node->setFlag(QSGNode::OwnsGeometry);
+    node->setMaterial(material);
+    node->setFlag(QSGNode::OwnsMaterial);
+    return node;
+}
+
+template <typename Vertex>
+void upload(QSGGeometryNode *node, const QVector<Vertex> &vertices)
+{
+    QSGGeometry *geometry = node->geometry();
+    if (geometry->vertexCount() != vertices.size())
+        geometry->allocate(vertices.size());
+    if (!vertices.isEmpty())
+        std::memcpy(geometry->vertexData(), vertices.constData(), vertices.size() * sizeof(Vertex));
+    node->markDirty(QSGNode::DirtyGeometry);
+}
+}
+
+TopologyView::TopologyView(QQuickItem *parent)
+    : QQuickItem(parent)
+    , m_layout(new LayoutEngine(this))
+    , m_graph(nullptr)
+    , m_builtDetail(Discs)
+    , m_builtNodes(0)
+    , m_builtEdges(0)
+    , m_hoverDirty(true)
+    , m_cacheDirty(true)
+    , m_zoom(1.0)
+    , m_dragged(false)
+    , m_hovered(-1)
+{
+    setFlag(ItemHasContents, true);
+    setAcceptedMouseButtons(Qt::LeftButton);
+    setAcceptHoverEvents(true);
+
+    connect(m_layout, &LayoutEngine::positionsUpdated, this, &TopologyView::setNodePositions);
+    connect(m_layout, &LayoutEngine::runningChanged, this, &TopologyView::layoutRunningChanged);
+}
+
+void TopologyView::setZoom(qreal zoom)
+{
+    zoomAround(QPointF(width() / 2, height() / 2), zoom / m_zoom);
+}
+
+QString TopologyView::hoveredIp() const
+{
+    return m_hovered >= 0 ? m_nodes[m_hovered].ip : QString();
+}
+
+QString TopologyView::hoveredName() const
+{
+    return m_hovered >= 0 ? m_nodes[m_hovered].name : QString();
+}
+
+QString TopologyView::hoveredOs() const
+{
+    return m_hovered >= 0 ? m_nodes[m_hovered].os : QString();
+}
+
+QPointF TopologyView::hoveredPosition() const
+{
+    if (m_hovered < 0)
+        return QPointF();
+    return (m_positions[m_hovered] - m_pan) * m_zoom;
+}
+
+void TopologyView::setNodePositions(const QVector<QPointF> &positions)
+{
+    if (positions.size() != m_nodes.size())
+        return;
+
+    m_positions = positions;
+    rebuildSpatialIndex();
+    m_cacheDirty = true;
+    m_hoverDirty = true;
+    update();
+    if (m_hovered >= 0)
+        emit hoveredChanged();
+}
+
+void TopologyView::addHost(const QString &ip, const QString &name, const QString &os, const QString &deviceType)
+{
+    if (m_graph)
+        return; // the graph owns the nodes
+
+    auto existing = m_nodeByIp.constFind(ip);
+    if (existing != m_nodeByIp.constEnd()) {
+        Node &node = m_nodes[existing.value()];
+        node.name = name;
+        node.os = os;
+        node.color = node.gateway ? colorForDeviceType("gateway") : colorForDeviceType(deviceType);
+        m_cacheDirty = true;
+        update();
+        return;
+    }
+
+    // Without a topology graph, a .1 host stands in for the /24's gateway
+    const bool gateway = ip.endsWith(".1");
+    const QString clusterKey = ip.contains('.') ? ip.section('.', 0, 2) : QString();
+    const QColor color = gateway ? colorForDeviceType("gateway") : colorForDeviceType(deviceType);
+    const int index = insertNode(ip, ip, name, os, color, gateway, clusterKey);
+
+    const Cluster &cluster = m_clusters[clusterKey];
+    if (cluster.gateway == index) {
+        for (int member : cluster.members) {
+            if (member != index)
+                appendEdge(index, member);
+        }
+    } else if (cluster.gateway >= 0) {
+        appendEdge(cluster.gateway, index);
+    }
+}
+
+int TopologyView::insertNode(const QString &key, const QString &address, const QString &name, const QString &os,
+                             const QColor &color, bool hub, const QString &clusterKey)
+{
+    const int index = m_nodes.size();
+
+    auto clusterIt = m_clusters.find(clusterKey);
+    if (clusterIt == m_clusters.end()) {
+        // New subnets are laid out on a coarse grid, four per row
+        const int i = m_clusters.size();
+        Cluster cluster;
+        cluster.center = QPointF((i % 4) * kClusterSpacing, (i / 4) * kClusterSpacing);
+        clusterIt = m_clusters.insert(clusterKey, cluster);
+    }
+    Cluster &cluster = clusterIt.value();
+
+    Node node;
+    node.ip = address;
+    node.name = name.isEmpty() ? address : name;
+    node.os = os;
+    node.gateway = hub;
+    node.color = color;
+
+    // The first hub of a cluster takes its centre, later ones spiral out
+    const bool central = hub && cluster.gateway < 0;
+    if (central)
+        cluster.gateway = index;
+    const QPointF position = placeNode(cluster, central);
+    m_nodes.append(node);
+    m_positions.append(position);
+    m_nodeByIp.insert(key, index);
+    indexNode(index);
+    m_layout->addNode(position, cluster.center);
+    cluster.members.append(index);
+
+    update();
+    emit nodeCountChanged();
+    return index;
+}
+
+void TopologyView::setGraph(TopologyGraph *graph)
+{
+    if (graph == m_graph)
+        return;
+
+    if (m_graph)
+        disconnect(m_graph, nullptr, this, nullptr);
+    m_graph = graph;
+    clear();
+
+    if (m_graph) {
+        // Replay what is already known, then follow additions
+        for (int i = 0; i < m_graph->nodeCount(); ++i)
+            onGraphNodeAdded(i);
+        for (const QPair<int, int> &edge : m_graph->edges())
+            appendEdge(edge.first, edge.second);
+
+        connect(m_graph, &TopologyGraph::nodeAdded, this, &TopologyView::onGraphNodeAdded);
+        connect(m_graph, &TopologyGraph::nodeUpdated, this, &TopologyView::onGraphNodeUpdated);
+        connect(m_graph, &TopologyGraph::edgeAdded, this, [this](int from, int to) {
+            appendEdge(from, to);
+            update();
+        });
+        connect(m_graph, &TopologyGraph::cleared, this, &TopologyView::clear);
+        connect(m_graph, &QObject::destroyed, this, [this]() { m_graph = nullptr; });
+        resetView();
+    }
+    emit graphChanged();
+}
+
+void TopologyView::onGraphNodeAdded(int index)
+{
+    const TopologyNode &node = m_graph->nodes()[index];
+    const bool hub = node.kind != TopologyNode::Host;
+    insertNode(node.id, node.kind == TopologyNode::Local ? QStringLiteral("localhost") : node.label,
+               node.label, node.os, colorForGraphNode(node), hub, node.subnet);
+}
+
+void TopologyView::onGraphNodeUpdated(int index)
+{
+    const TopologyNode &node = m_graph->nodes()[index];
+    Node &view = m_nodes[index];
+    view.os = node.os;
+    view.gateway = node.kind != TopologyNode::Host;
+    view.color = colorForGraphNode(node);
+    m_cacheDirty = true;
+    update();
+    if (m_hovered == index)
+        emit hoveredChanged();
+}
+
+void TopologyView::addEdge(const QString &fromIp, const QString &toIp)
+{
+    const int from = m_nodeByIp.value(fromIp, -1);
+    const int to = m_nodeByIp.value(toIp, -1);
+    if (from < 0 || to < 0 || from == to)
+        return;
+
+    appendEdge(from, to);
+    update();
+}
+
+void TopologyView::clear()
+{
+    m_nodes.clear();
+    m_positions.clear();
+    m_edges.clear();
+    m_nodeByIp.clear();
+    m_clusters.clear();
+    m_spatial.clear();
+    m_layout->clear();
+    m_cacheDirty = true;
+    setHovered(-1);
+    update();
+    emit nodeCountChanged();
+}
+
+void TopologyView::zoomBy(qreal factor)
+{
+    zoomAround(QPointF(width() / 2, height() / 2), factor);
+}
+
+void TopologyView::resetView()
+{
+    if (m_positions.isEmpty()) {
+        m_zoom = 1.0;
+        m_pan = QPointF(-width() / 2, -height() / 2);
+    } else {
+        qreal left = m_positions.first().x();
+        qreal top = m_positions.first().y();
+        qreal right = left;
+        qreal bottom = top;
+        for (const QPointF &p : std::as_const(m_positions)) {
+            left = qMin(left, p.x());
+            top = qMin(top, p.y());
+            right = qMax(right, p.x());
+            bottom = qMax(bottom, p.y());
+        }
+        const QRectF bounds = QRectF(QPointF(left, top), QPointF(right, bottom))
+                                  .adjusted(-kGatewayRadius * 2, -kGatewayRadius * 2, kGatewayRadius * 2, kGatewayRadius * 2);
+
+        const qreal fit = qMin(width() / bounds.width(), height() / bounds.height());
+        m_zoom = qBound(kMinZoom, fit, 1.5);
+        m_pan = bounds.center() - QPointF(width() / 2, height() / 2) / m_zoom;
+    }
+
+    update();
+    emit viewChanged();
+    if (m_hovered >= 0)
+        emit hoveredChanged();
+}
+
+QPointF TopologyView::placeNode(Cluster &cluster, bool gateway)
+{
+    if (gateway)
+        return cluster.center;
+
+    // Golden-angle spiral: new hosts never displace the ones already drawn
+    const int k = cluster.placed++;
+    const qreal radius = kRingOffset + kSpiralStep * qSqrt(k);
+    const qreal angle = k * kGoldenAngle;
+    return cluster.center + QPointF(radius * qCos(angle), radius * qSin(angle));
+}
+
+void TopologyView::appendEdge(int from, int to)
+{
+    m_edges.append(qMakePair(from, to));
+    m_layout->addEdge(from, to);
+}
+
+void TopologyView::indexNode(int node)
+{
+    m_spatial[cellKey(m_positions[node])].append(node);
+}
+
+void TopologyView::rebuildSpatialIndex()
+{
+    m_spatial.clear();
+    for (int i = 0; i < m_positions.size(); ++i)
+        indexNode(i);
+}
+
+int TopologyView::nodeAt(const QPointF &itemPos) const
+{
+    const QPointF world = m_pan + itemPos / m_zoom;
+    // Keep small nodes clickable when zoomed out
+    const qreal reach = qMax(kGatewayRadius, 6.0 / m_zoom);
+    const int span = qCeil(reach / kCellSize);
+
+    int best = -1;
+    qreal bestDistance = reach * reach;
+    for (int dx = -span; dx <= span; ++dx) {
+        for (int dy = -span; dy <= span; ++dy) {
+            const QPointF probe = world + QPointF(dx * kCellSize, dy * kCellSize);
+            auto cell = m_spatial.constFind(cellKey(probe));
+            if (cell == m_spatial.constEnd())
+                continue;
+            for (int node : cell.value()) {
+                const QPointF d = m_positions[node] - world;
+                const qreal distance = d.x() * d.x() + d.y() * d.y();
+                if (distance <= bestDistance) {
+                    bestDistance = distance;
+                    best = node;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void TopologyView::setHovered(int node)
+{
+    if (node == m_hovered)
+        return;
+    m_hovered = node;
+    m_hoverDirty = true;
+    update();
+    emit hoveredChanged();
+}
+
+void TopologyView::zoomAround(const QPointF &itemPos, qreal factor)
+{
+    const qreal zoom = qBound(kMinZoom, m_zoom * factor, kMaxZoom);
+    if (qFuzzyCompare(zoom, m_zoom))
+        return;
+
+    // Keep the world point under the cursor fixed
+    const QPointF anchor = m_pan + itemPos / m_zoom;
+    m_zoom = zoom;
+    m_pan = anchor - itemPos / m_zoom;
+
+    update();
+    emit viewChanged();
+    if (m_hovered >= 0)
+        emit hoveredChanged();
+}
+
+QRectF TopologyView::viewportRect() const
+{
+    return QRectF(m_pan, QSizeF(width(), height()) / m_zoom);
+}
+
+TopologyView::Detail TopologyView::detailLevel() const
+{
+    return m_zoom >= kDiscDetailZoom ? Discs : Dots;
+}
+
+void TopologyView::appendNodeVertices(int node, QVector<QSGGeometry::ColoredPoint2D> &out) const
+{
+    const QPointF &p = m_positions[node];
+    const qreal radius = m_nodes[node].gateway ? kGatewayRadius : kHostRadius;
+    const QColor &color = m_nodes[node].color;
+
+    if (!m_cullRect.intersects(QRectF(p.x() - radius, p.y() - radius, radius * 2, radius * 2)))
+        return;
+
+    if (m_builtDetail == Dots) {
+        // Two triangles; zoomed out, a disc is only a few pixels anyway
+        const int first = out.size();
+        out.resize(first + 6);
+        QSGGeometry::ColoredPoint2D *v = out.data() + first;
+        setVertex(v[0], p.x() - radius, p.y() - radius, color);
+        setVertex(v[1], p.x() + radius, p.y() - radius, color);
+        setVertex(v[2], p.x() - radius, p.y() + radius, color);
+        setVertex(v[3], p.x() + radius, p.y() - radius, color);
+        setVertex(v[4], p.x() + radius, p.y() + radius, color);
+        setVertex(v[5], p.x() - radius, p.y() + radius, color);
+        return;
+    }
+
+    appendDisc(out, p, radius, color);
+    appendDisc(out, p, radius - 3, QColor("#0f1419"));
+    appendDisc(out, p, radius * 0.35, color);
+}
+
+void TopologyView::appendEdgeVertices(int edge, QVector<QSGGeometry::Point2D> &out) const
+{
+    const QPointF &a = m_positions[m_edges[edge].first];
+    const QPointF &b = m_positions[m_edges[edge].second];
+    if (!m_cullRect.intersects(QRectF(a, b).normalized().adjusted(-1, -1, 1, 1)))
+        return;
+
+    QSGGeometry::Point2D from;
+    QSGGeometry::Point2D to;
+    from.set(float(a.x()), float(a.y()));
+    to.set(float(b.x()), float(b.y()));
+    out.append(from);
+    out.append(to);
+}
+
+void TopologyView::rebuildVertexCache()
+{
+    m_nodeVertices.clear();
+    m_edgeVertices.clear();
+    m_gridVertices.clear();
+
+    for (int i = 0; i < m_nodes.size(); ++i)
+        appendNodeVertices(i, m_nodeVertices);
+    for (int i = 0; i < m_edges.size(); ++i)
+        appendEdgeVertices(i, m_edgeVertices);
+
+    // Grid lines only where they are still distinguishable
+    if (m_builtDetail == Discs) {
+        QSGGeometry::Point2D v;
+        for (qreal x = qFloor(m_cullRect.left() / kGridSpacing) * kGridSpacing; x <= m_cullRect.right(); x += kGridSpacing) {
+            v.set(float(x), float(m_cullRect.top()));
+            m_gridVertices.append(v);
+            v.set(float(x), float(m_cullRect.bottom()));
+            m_gridVertices.append(v);
+        }
+        for (qreal y = qFloor(m_cullRect.top() / kGridSpacing) * kGridSpacing; y <= m_cullRect.bottom(); y += kGridSpacing) {
+            v.set(float(m_cullRect.left()), float(y));
+            m_gridVertices.append(v);
+            v.set(float(m_cullRect.right()), float(y));
+            m_gridVertices.append(v);
+        }
+    }
+
+    m_builtNodes = m_nodes.size();
+    m_builtEdges = m_edges.size();
+}
+
+QSGNode *TopologyView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    QSGTransformNode *root = static_cast<QSGTransformNode *>(oldNode);
+    if (!root) {
+        root = new QSGTransformNode;
+
+        QSGFlatColorMaterial *gridMaterial = new QSGFlatColorMaterial;
+        gridMaterial->setColor(QColor("#1e2328"));
+        root->appendChildNode(createGeometryNode(QSGGeometry::defaultAttributes_Point2D(), QSGGeometry::DrawLines, gridMaterial));
+
+        QSGFlatColorMaterial *edgeMaterial = new QSGFlatColorMaterial;
+        QColor edgeColor("#3b82f6");
+        edgeColor.setAlphaF(0.6);
+        edgeMaterial->setColor(edgeColor);
+        root->appendChildNode(createGeometryNode(QSGGeometry::defaultAttributes_Point2D(), QSGGeometry::DrawLines, edgeMaterial));
+
+        root->appendChildNode(createGeometryNode(QSGGeometry::defaultAttributes_ColoredPoint2D(), QSGGeometry::DrawTriangles,
+                                                 new QSGVertexColorMaterial));
+
+        QSGFlatColorMaterial *hoverMaterial = new QSGFlatColorMaterial;
+        hoverMaterial->setColor(QColor("#f8fafc"));
+        root->appendChildNode(createGeometryNode(QSGGeometry::defaultAttributes_Point2D(), QSGGeometry::DrawLineStrip, hoverMaterial));
+
+        m_cacheDirty = true;
+    }
+
+    QSGGeometryNode *gridNode = static_cast<QSGGeometryNode *>(root->childAtIndex(0));
+    QSGGeometryNode *edgeNode = static_cast<QSGGeometryNode *>(root->childAtIndex(1));
+    QSGGeometryNode *nodeNode = static_cast<QSGGeometryNode *>(root->childAtIndex(2));
+    QSGGeometryNode *hoverNode = static_cast<QSGGeometryNode *>(root->childAtIndex(3));
+
+    // Panning inside the cull margin only moves the transform; geometry is
+    // rebuilt when the view leaves it, the detail level flips or data changes
+    const QRectF viewport = viewportRect();
+    const Detail detail = detailLevel();
+    if (m_cacheDirty || detail != m_builtDetail || !m_cullRect.contains(viewport)) {
+        m_cullRect = viewport.adjusted(-viewport.width() / 2, -viewport.height() / 2,
+                                       viewport.width() / 2, viewport.height() / 2);
+        m_builtDetail = detail;
+        rebuildVertexCache();
+        upload(gridNode, m_gridVertices);
+        upload(edgeNode, m_edgeVertices);
+        upload(nodeNode, m_nodeVertices);
+        m_cacheDirty = false;
+    } else if (m_builtNodes < m_nodes.size() || m_builtEdges < m_edges.size()) {
+        // Newly discovered hosts: append their vertices, keep everything else
+        for (int i = m_builtNodes; i < m_nodes.size(); ++i)
+            appendNodeVertices(i, m_nodeVertices);
+        for (int i = m_builtEdges; i < m_edges.size(); ++i)
+            appendEdgeVertices(i, m_edgeVertices);
+        m_builtNodes = m_nodes.size();
+        m_builtEdges = m_edges.size();
+        upload(edgeNode, m_edgeVertices);
+        upload(nodeNode, m_nodeVertices);
+    }
+
+    if (m_hoverDirty) {
+        QVector<QSGGeometry::Point2D> ring;
+        if (m_hovered >= 0) {
+            const QPointF &p = m_positions[m_hovered];
+            const qreal radius = (m_nodes[m_hovered].gateway ? kGatewayRadius : kHostRadius) + 4;
+            for (int i = 0; i <= 24; ++i) {
+                const qreal angle = 2 * M_PI * i / 24;
+                QSGGeometry::Point2D v;
+                v.set(float(p.x() + radius * qCos(angle)), float(p.y() + radius * qSin(angle)));
+                ring.append(v);
+            }
+        }
+        upload(hoverNode, ring);
+        m_hoverDirty = false;
+    }
+
+    QMatrix4x4 matrix;
+    matrix.scale(float(m_zoom), float(m_zoom));
+    matrix.translate(float(-m_pan.x()), float(-m_pan.y()));
+    root->setMatrix(matrix);
+    root->markDirty(QSGNode::DirtyMatrix);
+
+    return root;
+}
+
+void TopologyView::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (m_nodes.isEmpty() && oldGeometry.size().isEmpty())
+        resetView();
+    update();
+}
+
+void TopologyView::mousePressEvent(QMouseEvent *event)
+{
+    m_pressPos = event->position();
+    m_pressPan = m_pan;
+    m_dragged = false;
+    event->accept();
+}
+
+void TopologyView::mouseMoveEvent(QMouseEvent *event)
+{
+    const QPointF delta = event->position() - m_pressPos;
+    if (!m_dragged && delta.manhattanLength() < 4)
+        return;
+
+    m_dragged = true;
+    m_pan = m_pressPan - delta / m_zoom;
+    update();
+    emit viewChanged();
+    if (m_hovered >= 0)
+        emit hoveredChanged();
+}
+
+void TopologyView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (!m_dragged) {
+        const int node = nodeAt(event->position());
+        if (node >= 0)
+            emit nodeClicked(m_nodes[node].ip);
+    }
+    m_dragged = false;
+}
+
+void TopologyView::hoverMoveEvent(QHoverEvent *event)
+{
+    setHovered(nodeAt(event->position()));
+}
+
+void TopologyView::hoverLeaveEvent(QHoverEvent *event)
+{
+    Q_UNUSED(event)
+    setHovered(-1);
+}
+
+void TopologyView::wheelEvent(QWheelEvent *event)
+{
+    zoomAround(event->position(), event->angleDelta().y() > 0 ? 1.1 : 0.9);
+    event->accept();
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <QQuickItem>
+#include <QHash>
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+#include <QColor>
+#include <QSGGeometry>
+#include "LayoutEngine.h"
+#include "TopologyGraph.h"
+
+// Network map drawn straight into the scene graph. Nodes and edges are kept
+// in flat arrays and batched into one geometry node each; only what falls
+// near the viewport is uploaded, and detail drops as the map zooms out.
+class TopologyView : public QQuickItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(int nodeCount READ nodeCount NOTIFY nodeCountChanged)
+    Q_PROPERTY(qreal zoom READ zoom WRITE setZoom NOTIFY viewChanged)
+    Q_PROPERTY(QString hoveredIp READ hoveredIp NOTIFY hoveredChanged)
+    Q_PROPERTY(QString hoveredName READ hoveredName NOTIFY hoveredChanged)
+    Q_PROPERTY(QString hoveredOs READ hoveredOs NOTIFY hoveredChanged)
+    Q_PROPERTY(QPointF hoveredPosition READ hoveredPosition NOTIFY hoveredChanged)
+    Q_PROPERTY(bool layoutRunning READ layoutRunning NOTIFY layoutRunningChanged)
+    Q_PROPERTY(TopologyGraph *graph READ graph WRITE setGraph NOTIFY graphChanged)
+
+public:
+    explicit TopologyView(QQuickItem *parent = nullptr);
+
+    int nodeCount() const { return m_nodes.size(); }
+    qreal zoom() const { return m_zoom; }
+    void setZoom(qreal zoom);
+
+    QString hoveredIp() const;
+    QString hoveredName() const;
+    QString hoveredOs() const;
+    QPointF hoveredPosition() const;
+    bool layoutRunning() const { return m_layout->isRunning(); }
+
+    // When set, nodes and links mirror the graph instead of addHost()
+    TopologyGraph *graph() const { return m_graph; }
+    void setGraph(TopologyGraph *graph);
+
+    // World-space positions, index-aligned with the order nodes were added
+    QVector<QPointF> nodePositions() const { return m_positions; }
+    void setNodePositions(const QVector<QPointF> &positions);
+
+public slots:
+    void addHost(const QString &ip, const QString &name, const QString &os, const QString &deviceType);
+    void addEdge(const QString &fromIp, const QString &toIp);
+    void clear();
+    void zoomBy(qreal factor);
+    void resetView();
+
+signals:
+    void nodeCountChanged();
+    void viewChanged();
+    void hoveredChanged();
+    void nodeClicked(const QString &ip);
+    void layoutRunningChanged();
+    void graphChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void hoverMoveEvent(QHoverEvent *event) override;
+    void hoverLeaveEvent(QHoverEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private:
+    struct Node {
+        QString ip;
+        QString name;
+        QString os;
+        QColor color;
+        bool gateway;
+    };
+
+    struct Cluster {
+        QPointF center;
+        int gateway = -1;
+        int placed = 0;
+        QVector<int> members;
+    };
+
+    enum Detail { Dots, Discs };
+
+    int insertNode(const QString &key, const QString &address, const QString &name, const QString &os,
+                   const QColor &color, bool hub, const QString &clusterKey);
+    void onGraphNodeAdded(int index);
+    void onGraphNodeUpdated(int index);
+    QPointF placeNode(Cluster &cluster, bool gateway);
+    void appendEdge(int from, int to);
+    void indexNode(int node);
+    void rebuildSpatialIndex();
+    int nodeAt(const QPointF &itemPos) const;
+    void setHovered(int node);
+    void zoomAround(const QPointF &itemPos, qreal factor);
+    QRectF viewportRect() const;
+    Detail detailLevel() const;
+
+    void appendNodeVertices(int node, QVector<QSGGeometry::ColoredPoint2D> &out) const;
+    void appendEdgeVertices(int edge, QVector<QSGGeometry::Point2D> &out) const;
+    void rebuildVertexCache();
+
+    QVector<Node> m_nodes;
+    QVector<QPointF> m_positions;
+    QVector<QPair<int, int>> m_edges;
+    QHash<QString, int> m_nodeByIp; // ip, or graph node id in graph mode
+    QHash<QString, Cluster> m_clusters; // keyed by /24 prefix, or subnet id in graph mode
+    QHash<qint64, QVector<int>> m_spatial; // coarse grid cell -> nodes, for hit testing
+    LayoutEngine *m_layout; // refines the seeded positions on a worker thread
+    TopologyGraph *m_graph;
+
+    // Vertex data for the current cull rectangle, reused across frames
+    QVector<QSGGeometry::ColoredPoint2D> m_nodeVertices;
+    QVector<QSGGeometry::Point2D> m_edgeVertices;
+    QVector<QSGGeometry::Point2D> m_gridVertices;
+    QRectF m_cullRect;
+    Detail m_builtDetail;
+    int m_builtNodes;
+    int m_builtEdges;
+    bool m_hoverDirty;
+    bool m_cacheDirty;
+
+    QPointF m_pan; // world point at the item's top-left corner
+    qreal m_zoom;
+    QPointF m_pressPos;
+    QPointF m_pressPan;
+    bool m_dragged;
+    int m_hovered;
+};
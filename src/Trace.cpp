@@ -0,0 +1,208 @@
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+
+#include <atomic>
+
+namespace Trace {
+
+namespace {
+const int kRingCapacity = 16384; // events kept per thread
+const int kDetailBytes = 48;
+
+struct Event {
+    const char *category;
+    const char *name;
+    qint64 startNs;
+    qint64 durationNs;
+    quint64 asyncId;
+    char detail[kDetailBytes];
+};
+
+// Written by one thread only; head is published with release so a reader
+// sees every event below it
+struct Ring {
+    std::atomic<quint64> head{0};
+    int tid = 0;
+    QString threadName;
+    bool exited = false;
+    Event events[kRingCapacity];
+};
+
+std::atomic<bool> enabled{false};
+
+struct Registry {
+    QMutex mutex;
+    QList<Ring *> rings;
+    int nextTid = 1;
+    QElapsedTimer clock;
+};
+
+Registry &registry()
+{
+    // Never destroyed: pool threads may still exit after static teardown starts
+    static Registry *instance = [] {
+        auto *registry = new Registry;
+        registry->clock.start();
+        return registry;
+    }();
+    return *instance;
+}
+
+struct LocalRing {
+    Ring *ring = nullptr;
+
+    ~LocalRing()
+    {
+        if (!ring)
+            return;
+        // Kept until the next recording starts, so a dump still shows the thread
+        Registry &r = registry();
+        QMutexLocker locker(&r.mutex);
+        ring->exited = true;
+    }
+};
+
+Ring &local()
+{
+    thread_local LocalRing local;
+    if (!local.ring) {
+        auto *ring = new Ring;
+        QThread *thread = QThread::currentThread();
+        const bool main = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+        Registry &r = registry();
+        QMutexLocker locker(&r.mutex);
+        ring->tid = r.nextTid++;
+        // Pool threads all share one object name, so the tid tells them apart
+        ring->threadName = main ? QStringLiteral("main")
+                                : QString("%1 %2").arg(thread->objectName().isEmpty() ? "worker" : thread->objectName())
+                                                  .arg(ring->tid);
+        r.rings << ring;
+        local.ring = ring;
+    }
+    return *local.ring;
+}
+
+double micros(qint64 ns)
+{
+    return ns / 1000.0;
+}
+}
+
+bool isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool on)
+{
+    if (on && !isEnabled()) {
+        Registry &r = registry();
+        QMutexLocker locker(&r.mutex);
+        for (auto it = r.rings.begin(); it != r.rings.end();) {
+            if ((*it)->exited) {
+                delete *it;
+                it = r.rings.erase(it);
+            } else {
+                // Only the owner writes head, but no owner is recording yet
+                (*it)->head.store(0, std::memory_order_release);
+                ++it;
+            }
+        }
+    }
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+qint64 now()
+{
+    return registry().clock.nsecsElapsed();
+}
+
+void complete(const char *category, const char *name, qint64 startNs, const QString &detail, quint64 asyncId)
+{
+    // A span that straddles the stop is dropped, which keeps dumps quiet
+    if (!isEnabled())
+        return;
+
+    Ring &ring = local();
+    const quint64 head = ring.head.load(std::memory_order_relaxed);
+    Event &event = ring.events[head % kRingCapacity];
+    event.category = category;
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = now() - startNs;
+    event.asyncId = asyncId;
+    qstrncpy(event.detail, detail.toUtf8().constData(), kDetailBytes);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+QByteArray toChromeJson()
+{
+    QJsonArray events;
+    Registry &r = registry();
+    QMutexLocker locker(&r.mutex);
+    for (const Ring *ring : std::as_const(r.rings)) {
+        const quint64 head = ring->head.load(std::memory_order_acquire);
+        if (!head)
+            continue;
+        events.append(QJsonObject{
+            {"ph", "M"}, {"name", "thread_name"}, {"pid", 1}, {"tid", ring->tid},
+            {"args", QJsonObject{{"name", ring->threadName}}},
+        });
+
+        const quint64 count = qMin<quint64>(head, kRingCapacity);
+        for (quint64 i = head - count; i < head; ++i) {
+            const Event &event = ring->events[i % kRingCapacity];
+            QJsonObject base{
+                {"name", event.name}, {"cat", event.category}, {"pid", 1}, {"tid", ring->tid},
+            };
+            if (*event.detail)
+                base.insert("args", QJsonObject{{"detail", QString::fromUtf8(event.detail)}});
+
+            if (!event.asyncId) {
+                base.insert("ph", "X");
+                base.insert("ts", micros(event.startNs));
+                base.insert("dur", micros(event.durationNs));
+                events.append(base);
+                continue;
+            }
+            // Async spans are a begin/end pair matched on category and id
+            base.insert("id", QString::number(event.asyncId, 16).prepend("0x"));
+            QJsonObject end = base;
+            base.insert("ph", "b");
+            base.insert("ts", micros(event.startNs));
+            end.insert("ph", "e");
+            end.insert("ts", micros(event.startNs + event.durationNs));
+            end.remove("args");
+            events.append(base);
+            events.append(end);
+        }
+    }
+    locker.unlock();
+
+    return QJsonDocument(QJsonObject{
+        {"traceEvents", events},
+        {"displayTimeUnit", "ms"},
+    }).toJson(QJsonDocument::Compact);
+}
+
+bool writeChromeJson(const QString &path)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write trace to" << path << file.errorString();
+        return false;
+    }
+    file.write(toChromeJson());
+    return file.commit();
+}
+
+}
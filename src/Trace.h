@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+// Timeline spans for the per-host scan and profile phases and for remote
+// jobs, exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// Off by default; while off a span costs one relaxed load. While on, each
+// thread appends to its own fixed-size ring, so recording takes no lock
+// and old events are overwritten rather than growing without bound.
+namespace Trace {
+
+bool isEnabled();
+// Starting discards what the previous recording left behind
+void setEnabled(bool enabled);
+
+// Nanoseconds on the trace clock
+qint64 now();
+
+// A finished span. asyncId 0 draws it on the recording thread's track;
+// anything else gets a track of its own, for work that hops threads or
+// overlaps on one (queue waits, remote jobs). name and category must be
+// string literals; detail is copied and truncated.
+void complete(const char *category, const char *name, qint64 startNs, const QString &detail = QString(),
+              quint64 asyncId = 0);
+
+// Everything recorded so far. Stop recording first for a consistent view.
+QByteArray toChromeJson();
+bool writeChromeJson(const QString &path);
+
+// Records from construction to destruction
+class Span
+{
+public:
+    Span(const char *category, const char *name, const QString &detail = QString())
+        : m_category(category), m_name(name), m_detail(detail), m_start(isEnabled() ? now() : -1) {}
+    ~Span()
+    {
+        if (m_start >= 0)
+            complete(m_category, m_name, m_start, m_detail);
+    }
+
+private:
+    Q_DISABLE_COPY(Span)
+
+    const char *m_category;
+    const char *m_name;
+    QString m_detail;
+    qint64 m_start;
+};
+
+}
@@ -0,0 +1,432 @@
+#include "UdpProber.h"
+#include "IpAddress.h"
+#include <QUdpSocket>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QDebug>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace {
+const int kMaxRounds = 3;
+const int kRoundWaitMs = 800;
+const int kThrottledWaitMs = 1100; // Linux refills its ICMP error budget about once a second
+const int kBatchSize = 64;
+const int kMaxDatagram = 2048;
+
+struct UdpPayload {
+    int port;
+    const char *service;
+    QByteArray (*build)();
+    bool (*matches)(const QByteArray &reply);
+    bool anySourcePort; // replies come from a fresh port (TFTP)
+};
+
+QByteArray bytes(std::initializer_list<quint8> list)
+{
+    QByteArray data;
+    data.reserve(int(list.size()));
+    for (quint8 b : list)
+        data.append(char(b));
+    return data;
+}
+
+bool isDnsResponse(const QByteArray &reply, quint8 idHigh, quint8 idLow)
+{
+    return reply.size() >= 12 && quint8(reply[0]) == idHigh && quint8(reply[1]) == idLow
+        && (quint8(reply[2]) & 0x80);
+}
+
+// version.bind TXT CH: answered (or refused) by nearly every DNS server
+QByteArray dnsProbe()
+{
+    QByteArray data = bytes({0x4e, 0x53, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    data.append("\x07version\x04" "bind", 13);
+    data.append(bytes({0x00, 0x00, 0x10, 0x00, 0x03}));
+    return data;
+}
+bool dnsMatches(const QByteArray &reply) { return isDnsResponse(reply, 0x4e, 0x53); }
+
+QByteArray tftpProbe()
+{
+    QByteArray data = bytes({0x00, 0x01});
+    data.append("netsecops-probe", 16); // with the terminating NUL
+    data.append("octet", 6);
+    return data;
+}
+bool tftpMatches(const QByteArray &reply)
+{
+    // DATA or ERROR both prove a TFTP server
+    return reply.size() >= 4 && reply[0] == 0 && (reply[1] == 3 || reply[1] == 5);
+}
+
+// Client mode request, version 4
+QByteArray ntpProbe()
+{
+    QByteArray data(48, '\0');
+    data[0] = char(0xe3);
+    return data;
+}
+bool ntpMatches(const QByteArray &reply) { return reply.size() >= 48 && (quint8(reply[0]) & 0x07) == 4; }
+
+// NBSTAT query for the wildcard name "*"
+QByteArray netbiosProbe()
+{
+    QByteArray data = bytes({0x4e, 0x42, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20});
+    data.append("CK");
+    data.append(QByteArray(30, 'A'));
+    data.append(bytes({0x00, 0x00, 0x21, 0x00, 0x01}));
+    return data;
+}
+bool netbiosMatches(const QByteArray &reply) { return isDnsResponse(reply, 0x4e, 0x42); }
+
+// SNMPv1 GetRequest for sysDescr.0 with community "public"
+QByteArray snmpProbe()
+{
+    QByteArray data = bytes({0x30, 0x29, 0x02, 0x01, 0x00, 0x04, 0x06});
+    data.append("public");
+    data.append(bytes({0xa0, 0x1c, 0x02, 0x04, 0x4e, 0x53, 0x4f, 0x50, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00,
+                       0x30, 0x0e, 0x30, 0x0c, 0x06, 0x08, 0x2b, 0x06, 0x01, 0x02, 0x01, 0x01, 0x01, 0x00,
+                       0x05, 0x00}));
+    return data;
+}
+bool snmpMatches(const QByteArray &reply)
+{
+    return reply.size() > 2 && quint8(reply[0]) == 0x30 && reply.contains(char(0xa2)); // GetResponse PDU
+}
+
+QByteArray ssdpProbe()
+{
+    return QByteArray("M-SEARCH * HTTP/1.1\r\nHOST: 239.255.255.250:1900\r\n"
+                      "MAN: \"ssdp:discover\"\r\nMX: 1\r\nST: ssdp:all\r\n\r\n");
+}
+bool ssdpMatches(const QByteArray &reply) { return reply.startsWith("HTTP/1.1"); }
+
+QByteArray sipProbe()
+{
+    return QByteArray("OPTIONS sip:nm SIP/2.0\r\nVia: SIP/2.0/UDP nm;branch=z9hG4bK-netsecops\r\n"
+                      "From: <sip:nm@nm>;tag=netsecops\r\nTo: <sip:nm2@nm2>\r\nCall-ID: netsecops\r\n"
+                      "CSeq: 42 OPTIONS\r\nMax-Forwards: 70\r\nContent-Length: 0\r\n\r\n");
+}
+bool sipMatches(const QByteArray &reply) { return reply.startsWith("SIP/2.0"); }
+
+// _services._dns-sd._udp.local PTR, asking for a unicast reply
+QByteArray mdnsProbe()
+{
+    QByteArray data = bytes({0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    data.append("\x09_services\x07_dns-sd\x04_udp\x05local", 29);
+    data.append(bytes({0x00, 0x00, 0x0c, 0x80, 0x01}));
+    return data;
+}
+bool mdnsMatches(const QByteArray &reply) { return reply.size() >= 12 && (quint8(reply[2]) & 0x80); }
+
+const UdpPayload kPayloads[] = {
+    {53, "DNS", dnsProbe, dnsMatches, false},
+    {69, "TFTP", tftpProbe, tftpMatches, true},
+    {123, "NTP", ntpProbe, ntpMatches, false},
+    {137, "NetBIOS-NS", netbiosProbe, netbiosMatches, false},
+    {161, "SNMP", snmpProbe, snmpMatches, false},
+    {1900, "SSDP", ssdpProbe, ssdpMatches, false},
+    {5060, "SIP", sipProbe, sipMatches, false},
+    {5353, "mDNS", mdnsProbe, mdnsMatches, false},
+};
+
+const UdpPayload *payloadFor(int port)
+{
+    for (const UdpPayload &payload : kPayloads) {
+        if (payload.port == port)
+            return &payload;
+    }
+    return nullptr;
+}
+}
+
+UdpProber::UdpProber(const QString &ip)
+    : m_ip(ip)
+{
+}
+
+QString UdpProber::serviceName(int port)
+{
+    const UdpPayload *payload = payloadFor(port);
+    return payload ? QString::fromLatin1(payload->service) : QString();
+}
+
+QList<UdpProber::Result> UdpProber::probe(const QList<int> &ports)
+{
+    QList<Probe> probes;
+    probes.reserve(ports.size());
+    for (int port : ports) {
+        const UdpPayload *payload = payloadFor(port);
+        probes.append(Probe{port, payload ? payload->build() : QByteArray(), OpenFiltered, false});
+    }
+
+#ifdef Q_OS_LINUX
+    runBatched(probes);
+#else
+    runPortable(probes);
+#endif
+
+    QList<Result> results;
+    results.reserve(probes.size());
+    for (const Probe &probe : std::as_const(probes))
+        results.append(Result{probe.port, probe.state, probe.confirmed, serviceName(probe.port)});
+    return results;
+}
+
+void UdpProber::recordReply(Probe &probe, const QByteArray &reply)
+{
+    const UdpPayload *payload = payloadFor(probe.port);
+    probe.state = Open;
+    probe.confirmed = payload && payload->matches(reply);
+}
+
+#ifdef Q_OS_LINUX
+void UdpProber::runBatched(QList<Probe> &probes)
+{
+    const IpAddress target = IpAddress::fromString(m_ip);
+    if (!target.isValid()) {
+        runPortable(probes); // host names and scoped addresses go through Qt
+        return;
+    }
+
+    const bool ipv6 = target.isIPv6();
+    const int fd = ::socket(ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        qWarning() << "UDP probe socket failed:" << strerror(errno);
+        return;
+    }
+    const int on = 1;
+    if (ipv6)
+        ::setsockopt(fd, SOL_IPV6, IPV6_RECVERR, &on, sizeof(on));
+    else
+        ::setsockopt(fd, SOL_IP, IP_RECVERR, &on, sizeof(on));
+
+    sockaddr_storage base;
+    std::memset(&base, 0, sizeof(base));
+    socklen_t baseLength;
+    if (ipv6) {
+        auto *sin6 = reinterpret_cast<sockaddr_in6 *>(&base);
+        sin6->sin6_family = AF_INET6;
+        const Q_IPV6ADDR address = target.toIPv6();
+        std::memcpy(&sin6->sin6_addr, address.c, 16);
+        baseLength = sizeof(sockaddr_in6);
+    } else {
+        auto *sin = reinterpret_cast<sockaddr_in *>(&base);
+        sin->sin_family = AF_INET;
+        sin->sin_addr.s_addr = htonl(target.toIPv4());
+        baseLength = sizeof(sockaddr_in);
+    }
+    auto portOf = [ipv6](const sockaddr_storage &address) {
+        return ipv6 ? ntohs(reinterpret_cast<const sockaddr_in6 &>(address).sin6_port)
+                    : ntohs(reinterpret_cast<const sockaddr_in &>(address).sin_port);
+    };
+
+    QHash<int, int> byPort;
+    int anySourceProbe = -1;
+    for (int i = 0; i < probes.size(); ++i) {
+        byPort.insert(probes[i].port, i);
+        const UdpPayload *payload = payloadFor(probes[i].port);
+        if (payload && payload->anySourcePort)
+            anySourceProbe = i;
+    }
+
+    QVector<sockaddr_storage> names(kBatchSize);
+    QVector<iovec> vectors(kBatchSize);
+    QVector<mmsghdr> messages(kBatchSize);
+    QVector<QByteArray> buffers(kBatchSize, QByteArray(kMaxDatagram, '\0'));
+
+    for (int round = 0; round < kMaxRounds; ++round) {
+        QVector<int> pending;
+        for (int i = 0; i < probes.size(); ++i) {
+            if (probes[i].state == OpenFiltered)
+                pending.append(i);
+        }
+        if (pending.isEmpty())
+            break;
+
+        // Send every pending probe, kBatchSize datagrams per system call
+        for (int offset = 0; offset < pending.size(); offset += kBatchSize) {
+            const int count = qMin(kBatchSize, int(pending.size()) - offset);
+            for (int n = 0; n < count; ++n) {
+                Probe &probe = probes[pending[offset + n]];
+                names[n] = base;
+                if (ipv6)
+                    reinterpret_cast<sockaddr_in6 &>(names[n]).sin6_port = htons(quint16(probe.port));
+                else
+                    reinterpret_cast<sockaddr_in &>(names[n]).sin_port = htons(quint16(probe.port));
+                vectors[n].iov_base = probe.payload.data();
+                vectors[n].iov_len = size_t(probe.payload.size());
+                std::memset(&messages[n], 0, sizeof(mmsghdr));
+                messages[n].msg_hdr.msg_name = &names[n];
+                messages[n].msg_hdr.msg_namelen = baseLength;
+                messages[n].msg_hdr.msg_iov = &vectors[n];
+                messages[n].msg_hdr.msg_iovlen = 1;
+            }
+            int sent = 0;
+            int failures = 0;
+            while (sent < count && failures < 8) {
+                const int result = ::sendmmsg(fd, messages.data() + sent, unsigned(count - sent), 0);
+                if (result > 0) {
+                    sent += result;
+                    continue;
+                }
+                ++failures;
+                if (result < 0 && errno == EAGAIN) {
+                    pollfd out{fd, POLLOUT, 0};
+                    ::poll(&out, 1, 50);
+                }
+                // Otherwise an earlier ICMP error was reported here and cleared;
+                // the error queue still holds it for the loop below
+            }
+        }
+
+        // Collect replies and ICMP errors until the round's deadline
+        int unreachables = 0;
+        const int waitMs = round == 0 ? kRoundWaitMs : kThrottledWaitMs;
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < waitMs) {
+            pollfd in{fd, POLLIN | POLLERR, 0};
+            if (::poll(&in, 1, int(waitMs - timer.elapsed())) <= 0)
+                break;
+
+            if (in.revents & POLLIN) {
+                for (int n = 0; n < kBatchSize; ++n) {
+                    vectors[n].iov_base = buffers[n].data();
+                    vectors[n].iov_len = size_t(kMaxDatagram);
+                    std::memset(&messages[n], 0, sizeof(mmsghdr));
+                    messages[n].msg_hdr.msg_name = &names[n];
+                    messages[n].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+                    messages[n].msg_hdr.msg_iov = &vectors[n];
+                    messages[n].msg_hdr.msg_iovlen = 1;
+                }
+                const int received = ::recvmmsg(fd, messages.data(), kBatchSize, MSG_DONTWAIT, nullptr);
+                for (int n = 0; n < received; ++n) {
+                    const QByteArray reply(buffers[n].constData(), int(messages[n].msg_len));
+                    auto it = byPort.constFind(portOf(names[n]));
+                    if (it != byPort.constEnd())
+                        recordReply(probes[it.value()], reply);
+                    else if (anySourceProbe >= 0 && tftpMatches(reply))
+                        recordReply(probes[anySourceProbe], reply);
+                }
+            }
+
+            if (in.revents & POLLERR) {
+                // Each queued error names the probe's destination and the ICMP type/code
+                for (;;) {
+                    sockaddr_storage offender;
+                    char control[512];
+                    char scratch[1];
+                    iovec vector{scratch, sizeof(scratch)};
+                    msghdr message;
+                    std::memset(&message, 0, sizeof(message));
+                    message.msg_name = &offender;
+                    message.msg_namelen = sizeof(offender);
+                    message.msg_iov = &vector;
+                    message.msg_iovlen = 1;
+                    message.msg_control = control;
+                    message.msg_controllen = sizeof(control);
+                    if (::recvmsg(fd, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+                        break;
+
+                    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+                        const bool isError = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                                          || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+                        if (!isError)
+                            continue;
+                        sock_extended_err error;
+                        std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+                        auto it = byPort.constFind(portOf(offender));
+                        if (it == byPort.constEnd())
+                            continue;
+
+                        const bool portUnreachable =
+                            (error.ee_origin == SO_EE_ORIGIN_ICMP && error.ee_type == 3 && error.ee_code == 3)
+                            || (error.ee_origin == SO_EE_ORIGIN_ICMP6 && error.ee_type == 1 && error.ee_code == 4);
+                        const bool unreachable =
+                            (error.ee_origin == SO_EE_ORIGIN_ICMP && error.ee_type == 3)
+                            || (error.ee_origin == SO_EE_ORIGIN_ICMP6 && error.ee_type == 1);
+                        Probe &probe = probes[it.value()];
+                        if (probe.state != OpenFiltered || !unreachable)
+                            continue;
+                        probe.state = portUnreachable ? Closed : Filtered;
+                        ++unreachables;
+                    }
+                }
+            }
+
+            const bool settled = std::none_of(pending.cbegin(), pending.cend(),
+                                              [&probes](int i) { return probes[i].state == OpenFiltered; });
+            if (settled)
+                break;
+        }
+
+        // A host that answered some ports with ICMP but stayed silent on
+        // others is most likely rate-limiting its errors: try those again
+        // once the budget refills. Total silence means a filter, not a limit.
+        if (unreachables == 0 && round > 0)
+            break;
+    }
+
+    ::close(fd);
+}
+#else
+void UdpProber::runBatched(QList<Probe> &probes)
+{
+    runPortable(probes);
+}
+#endif
+
+void UdpProber::runPortable(QList<Probe> &probes)
+{
+    QUdpSocket socket;
+    QHostAddress target(m_ip);
+    if (target.isNull()) {
+        qWarning() << "UDP probe needs an address, got" << m_ip;
+        return;
+    }
+    if (!socket.bind(target.protocol() == QAbstractSocket::IPv6Protocol ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4, 0)) {
+        qWarning() << "UDP probe bind failed:" << socket.errorString();
+        return;
+    }
+
+    QHash<int, int> byPort;
+    for (int i = 0; i < probes.size(); ++i)
+        byPort.insert(probes[i].port, i);
+
+    // Without an ICMP error channel, retries only help against packet loss
+    for (int round = 0; round < 2; ++round) {
+        bool sent = false;
+        for (Probe &probe : probes) {
+            if (probe.state == OpenFiltered) {
+                socket.writeDatagram(probe.payload, target, quint16(probe.port));
+                sent = true;
+            }
+        }
+        if (!sent)
+            break;
+
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < kRoundWaitMs && socket.waitForReadyRead(int(kRoundWaitMs - timer.elapsed()))) {
+            while (socket.hasPendingDatagrams()) {
+                QByteArray reply(int(socket.pendingDatagramSize()), '\0');
+                quint16 port = 0;
+                socket.readDatagram(reply.data(), reply.size(), nullptr, &port);
+                auto it = byPort.constFind(port);
+                if (it != byPort.constEnd())
+                    recordReply(probes[it.value()], reply);
+            }
+        }
+    }
+}
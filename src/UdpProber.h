@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+// UDP port probing for one host. Each well-known port gets a protocol-correct
+// payload from a per-port table, so services that ignore empty datagrams
+// still answer, and replies are checked against what that protocol returns.
+// On Linux probes go out and come back in batches (sendmmsg/recvmmsg) on one
+// socket, and ICMP port-unreachable is read from the socket error queue
+// without raw-socket privileges. Elsewhere unanswered ports stay open|filtered.
+class UdpProber
+{
+public:
+    enum State {
+        Open,          // something answered
+        Closed,        // ICMP port unreachable
+        Filtered,      // ICMP unreachable of another kind (admin prohibited, ...)
+        OpenFiltered   // no answer either way
+    };
+
+    struct Result {
+        int port;
+        State state;
+        bool confirmed; // reply matched the payload table for that port
+        QString service;
+    };
+
+    explicit UdpProber(const QString &ip);
+
+    QList<Result> probe(const QList<int> &ports);
+
+    // Service name for a port in the payload table, empty if unknown
+    static QString serviceName(int port);
+
+private:
+    struct Probe {
+        int port;
+        QByteArray payload;
+        State state;
+        bool confirmed;
+    };
+
+    void runBatched(QList<Probe> &probes);
+    void runPortable(QList<Probe> &probes);
+    static void recordReply(Probe &probe, const QByteArray &reply);
+
+    QString m_ip;
+};
@@ -0,0 +1,82 @@
+#include <QtTest>
+#include <QDir>
+#include <QSettings>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include "CredentialManager.h"
+
+// Credentials from the old QSettings array must land in SQLite before the
+// array, their only other copy, is removed
+class tst_CredentialMigration : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void legacyArrayMovesIntoDatabase();
+
+private:
+    QString m_configPath;
+};
+
+void tst_CredentialMigration::init()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_configPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    QDir(m_configPath).removeRecursively();
+    QVERIFY(QDir().mkpath(m_configPath));
+}
+
+void tst_CredentialMigration::cleanup()
+{
+    QDir(m_configPath).removeRecursively();
+}
+
+void tst_CredentialMigration::legacyArrayMovesIntoDatabase()
+{
+    {
+        QSettings legacy(m_configPath + "/credentials.conf", QSettings::IniFormat);
+        legacy.beginWriteArray("Credentials");
+        for (int i = 0; i < 3; ++i) {
+            legacy.setArrayIndex(i);
+            legacy.setValue("id", i + 1);
+            legacy.setValue("name", QString("legacy-%1").arg(i + 1));
+            legacy.setValue("host", QString("10.0.0.%1").arg(i + 1));
+            legacy.setValue("username", "admin");
+            legacy.setValue("type", "Password");
+        }
+        legacy.endArray();
+        legacy.sync();
+        QCOMPARE(legacy.status(), QSettings::NoError);
+    }
+
+    {
+        // The constructor runs loadCredentials(), which migrates the array
+        CredentialManager manager;
+        QCOMPARE(manager.credentialCount(), 3);
+    }
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "verify");
+        db.setDatabaseName(m_configPath + "/credentials.db");
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("SELECT id, name, host FROM credentials ORDER BY id"));
+        for (int i = 1; i <= 3; ++i) {
+            QVERIFY(query.next());
+            QCOMPARE(query.value(0).toInt(), i);
+            QCOMPARE(query.value(1).toString(), QString("legacy-%1").arg(i));
+            QCOMPARE(query.value(2).toString(), QString("10.0.0.%1").arg(i));
+        }
+        QVERIFY(!query.next());
+    }
+    QSqlDatabase::removeDatabase("verify");
+
+    QSettings legacy(m_configPath + "/credentials.conf", QSettings::IniFormat);
+    QVERIFY(!legacy.childGroups().contains("Credentials"));
+}
+
+QTEST_GUILESS_MAIN(tst_CredentialMigration)
+#include "tst_credentialmigration.moc"
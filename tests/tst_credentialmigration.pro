@@ -0,0 +1,11 @@
+QT = core sql testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_credentialmigration
+
+include(../core.pri)
+
+SOURCES += \
+    tst_credentialmigration.cpp